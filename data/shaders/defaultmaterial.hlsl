@@ -1,5 +1,7 @@
 #define MyRS1 "RootFlags( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT ),"                                                \
-              "CBV(b0, visibility = SHADER_VISIBILITY_VERTEX),"                                                 \
+              "SRV(t0, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
+              "SRV(t1, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
+              "CBV(b0, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
               "DescriptorTable( SRV(t0, numDescriptors = 3), visibility = SHADER_VISIBILITY_PIXEL),"            \
               "StaticSampler(s0, visibility = SHADER_VISIBILITY_PIXEL),"                                        \
               "StaticSampler(s1, "                                                                              \
@@ -11,14 +13,21 @@
                              "comparisonFunc = COMPARISON_LESS,"                                                \
                              "borderColor = STATIC_BORDER_COLOR_OPAQUE_BLACK,"                                  \
                              "visibility = SHADER_VISIBILITY_PIXEL)"
-struct ShadingData
+struct ObjectData
 {
-    float4x4 m_worldCamProj;
-    float4x4 m_worldLightProj[2];
+    float4x4 m_world;
     float4x4 m_normalWorld;
+};
+struct FrameData
+{
+    float4x4 m_cameraViewProj;
+    float4x4 m_lightViewProj[2];
     float4 m_lightDirection[2];
 };
-ConstantBuffer<ShadingData> g_shadingData : register(b0);
+// NOTE the instances index into the object data of the block of models they belong to
+StructuredBuffer<uint> g_instances : register(t0, space1);
+StructuredBuffer<ObjectData> g_objectData : register(t1, space1);
+ConstantBuffer<FrameData> g_frameData : register(b0, space1);
 
 struct Interpolators
 {
@@ -48,15 +57,22 @@ float SampleShadowMap(float3 positionLS, Texture2D shadowMap)
 
 Interpolators VertexShaderMain(float4 position : POSITION, 
                                 float2 uv : TEXCOORD,
-                                float4 normal : NORMAL)
+                                float4 packedNormal : NORMAL,
+                                uint instanceId : SV_InstanceID)
 {
+    const ObjectData objectData = g_objectData[g_instances[instanceId]];
+    const float4 positionWS = mul(position, objectData.m_world);
+
+    // NOTE normal comes as 10:10:10:2 unorm
+    const float4 normal = float4(packedNormal.xyz * 2.0f - 1.0f, 1.0f);
+
     Interpolators result;
-    result.m_position = mul(position, g_shadingData.m_worldCamProj);
-    result.m_positionLS0 = mul(position, g_shadingData.m_worldLightProj[0]);
-    result.m_positionLS1 = mul(position, g_shadingData.m_worldLightProj[1]);
-    result.m_normal = normalize(mul(normal, g_shadingData.m_normalWorld));
-    result.m_lightDirection0 = normalize(g_shadingData.m_lightDirection[0].xyz);
-    result.m_lightDirection1 = normalize(g_shadingData.m_lightDirection[1].xyz);
+    result.m_position = mul(positionWS, g_frameData.m_cameraViewProj);
+    result.m_positionLS0 = mul(positionWS, g_frameData.m_lightViewProj[0]);
+    result.m_positionLS1 = mul(positionWS, g_frameData.m_lightViewProj[1]);
+    result.m_normal = normalize(mul(normal, objectData.m_normalWorld));
+    result.m_lightDirection0 = normalize(g_frameData.m_lightDirection[0].xyz);
+    result.m_lightDirection1 = normalize(g_frameData.m_lightDirection[1].xyz);
 
     result.m_uv = uv;
     return result;
@@ -1,12 +1,26 @@
 #define MyRS1 "RootFlags( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT ),"                                                \
-              "CBV(b0, visibility = SHADER_VISIBILITY_VERTEX),"                                                 \
+              "SRV(t0, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
+              "SRV(t1, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
+              "CBV(b0, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
               "DescriptorTable( CBV(b0), visibility = SHADER_VISIBILITY_PIXEL)"                                 \
 
-struct ShadingData
+// NOTE same layouts as the shadows receivers, only the world and camera transforms
+// are used
+struct ObjectData
 {
-    float4x4 m_worldCamProj;
+    float4x4 m_world;
+    float4x4 m_normalWorld;
 };
-ConstantBuffer<ShadingData> g_shadingData : register(b0);
+struct FrameData
+{
+    float4x4 m_cameraViewProj;
+    float4x4 m_lightViewProj[2];
+    float4 m_lightDirection[2];
+};
+// NOTE the instances index into the object data of the block of models they belong to
+StructuredBuffer<uint> g_instances : register(t0, space1);
+StructuredBuffer<ObjectData> g_objectData : register(t1, space1);
+ConstantBuffer<FrameData> g_frameData : register(b0, space1);
 
 struct Interpolators
 {
@@ -19,10 +33,14 @@ struct MaterialData
 };
 ConstantBuffer<MaterialData> g_MaterialData : register(b0);
 
-Interpolators VertexShaderMain(float4 position : POSITION)
+Interpolators VertexShaderMain(float4 position : POSITION,
+                               uint instanceId : SV_InstanceID)
 {
+    const ObjectData objectData = g_objectData[g_instances[instanceId]];
+    const float4 positionWS = mul(position, objectData.m_world);
+
     Interpolators result;
-    result.m_position = mul(position, g_shadingData.m_worldCamProj);
+    result.m_position = mul(positionWS, g_frameData.m_cameraViewProj);
     return result;
 }
 
@@ -1,13 +1,33 @@
-#define MyRS1 "RootFlags( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT ),"    \
-              "CBV(b0, visibility = SHADER_VISIBILITY_VERTEX)"
+#define MyRS1 "RootFlags( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT ),"                                    \
+              "SRV(t0, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                         \
+              "SRV(t1, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                         \
+              "CBV(b0, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                         \
+              "RootConstants(num32BitConstants = 1, b1, space = 1, visibility = SHADER_VISIBILITY_VERTEX)"
 
-struct Transformation
+// NOTE same layouts as the forward pass, only the world and light transforms are used
+struct ObjectData
 {
-    float4x4 worldCamProj;
+    float4x4 m_world;
+    float4x4 m_normalWorld;
 };
-ConstantBuffer<Transformation> g_transformation : register(b0);
+struct FrameData
+{
+    float4x4 m_cameraViewProj;
+    float4x4 m_lightViewProj[2];
+    float4 m_lightDirection[2];
+};
+struct LightData
+{
+    uint m_lightIndex;
+};
+// NOTE the instances index into the object data of the block of models they belong to
+StructuredBuffer<uint> g_instances : register(t0, space1);
+StructuredBuffer<ObjectData> g_objectData : register(t1, space1);
+ConstantBuffer<FrameData> g_frameData : register(b0, space1);
+ConstantBuffer<LightData> g_lightData : register(b1, space1);
 
-float4  VertexShaderMain(float4 position : POSITION) : SV_POSITION
+float4  VertexShaderMain(float4 position : POSITION, uint instanceId : SV_InstanceID) : SV_POSITION
 {
-    return mul(position, g_transformation.worldCamProj);
+    const float4 positionWS = mul(position, g_objectData[g_instances[instanceId]].m_world);
+    return mul(positionWS, g_frameData.m_lightViewProj[g_lightData.m_lightIndex]);
 }
\ No newline at end of file
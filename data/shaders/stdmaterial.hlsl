@@ -1,5 +1,7 @@
 #define MyRS1 "RootFlags( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT ),"                                                \
-              "CBV(b0, visibility = SHADER_VISIBILITY_VERTEX),"                                                 \
+              "SRV(t0, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
+              "SRV(t1, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
+              "CBV(b0, space = 1, visibility = SHADER_VISIBILITY_VERTEX),"                                     \
               "DescriptorTable( SRV(t0, numDescriptors = 4), visibility = SHADER_VISIBILITY_PIXEL),"            \
               "StaticSampler(s0, visibility = SHADER_VISIBILITY_PIXEL),"                                        \
               "StaticSampler(s1, "                                                                              \
@@ -11,14 +13,21 @@
                              "comparisonFunc = COMPARISON_LESS,"                                                \
                              "borderColor = STATIC_BORDER_COLOR_OPAQUE_BLACK,"                                  \
                              "visibility = SHADER_VISIBILITY_PIXEL)"
-struct ShadingData
+struct ObjectData
 {
-    float4x4    m_worldCamProj;
-    float4x4    m_worldLightProj[2];
+    float4x4    m_world;
     float4x4    m_normalWorld;
+};
+struct FrameData
+{
+    float4x4    m_cameraViewProj;
+    float4x4    m_lightViewProj[2];
     float4      m_lightDirection[2];
 };
-ConstantBuffer<ShadingData> g_shadingData : register(b0);
+// NOTE the instances index into the object data of the block of models they belong to
+StructuredBuffer<uint> g_instances : register(t0, space1);
+StructuredBuffer<ObjectData> g_objectData : register(t1, space1);
+ConstantBuffer<FrameData> g_frameData : register(b0, space1);
 
 Texture2D colorTexture : register(t0);
 Texture2D normalTexture : register(t1);
@@ -50,27 +59,41 @@ float SampleShadowMap(float3 positionLS, Texture2D shadowMap)
 
 float3 SampleNormalMap(float2 uv)
 {
-    return normalize(normalTexture.Sample(linearSampler, uv) * 2.0f - 1.0f).xyz;
+    // NOTE z is rebuilt from xy so it works with two channels (BC5) normal maps
+    const float2 xy = normalTexture.Sample(linearSampler, uv).xy * 2.0f - 1.0f;
+    return normalize(float3(xy, sqrt(saturate(1.0f - dot(xy, xy)))));
 }
 
 Interpolators VertexShaderMain(float4 position : POSITION, 
                                 float2 uv : TEXCOORD,
-                                float4 normal : NORMAL, 
-                                float4 tangent : TANGENT,
-                                float4 binormal : BINORMAL)
+                                float4 packedNormal : NORMAL, 
+                                float4 packedTangent : TANGENT,
+                                uint instanceId : SV_InstanceID)
 {
+    const ObjectData objectData = g_objectData[g_instances[instanceId]];
+    const float4 positionWS = mul(position, objectData.m_world);
+
+    // NOTE normal and tangent come as 10:10:10:2 unorm. The binormal is rebuilt
+    // from them with its sign stored in the tangent w.
+    const float3 normalOS = packedNormal.xyz * 2.0f - 1.0f;
+    const float3 tangentOS = packedTangent.xyz * 2.0f - 1.0f;
+    const float binormalSign = packedTangent.w > 0.5f ? 1.0f : -1.0f;
+    const float4 normal = float4(normalOS, 1.0f);
+    const float4 tangent = float4(tangentOS, 1.0f);
+    const float4 binormal = float4(cross(normalOS, tangentOS) * binormalSign, 1.0f);
+
     Interpolators result;
-    result.m_position = mul(position, g_shadingData.m_worldCamProj);
-    result.m_positionLS0 = mul(position, g_shadingData.m_worldLightProj[0]).xyz;
-    result.m_positionLS1 = mul(position, g_shadingData.m_worldLightProj[1]).xyz;
+    result.m_position = mul(positionWS, g_frameData.m_cameraViewProj);
+    result.m_positionLS0 = mul(positionWS, g_frameData.m_lightViewProj[0]).xyz;
+    result.m_positionLS1 = mul(positionWS, g_frameData.m_lightViewProj[1]).xyz;
 
-    const float4 normalWS = mul(normal, g_shadingData.m_normalWorld);
-    const float4 tangentWS = mul(tangent, g_shadingData.m_normalWorld);
-    const float4 binormalWS = mul(binormal, g_shadingData.m_normalWorld);
+    const float4 normalWS = mul(normal, objectData.m_normalWorld);
+    const float4 tangentWS = mul(tangent, objectData.m_normalWorld);
+    const float4 binormalWS = mul(binormal, objectData.m_normalWorld);
     float4x4 worldToTangentSpace = {tangentWS, binormalWS, normalWS, float4(0,0,0,1)};
     worldToTangentSpace = transpose(worldToTangentSpace);
-    result.m_lightDirectionTS0 = normalize(mul(float4(g_shadingData.m_lightDirection[0].xyz, 1.0f), worldToTangentSpace)).xyz;
-    result.m_lightDirectionTS1 = normalize(mul(float4(g_shadingData.m_lightDirection[1].xyz, 1.0f), worldToTangentSpace)).xyz;
+    result.m_lightDirectionTS0 = normalize(mul(float4(g_frameData.m_lightDirection[0].xyz, 1.0f), worldToTangentSpace)).xyz;
+    result.m_lightDirectionTS1 = normalize(mul(float4(g_frameData.m_lightDirection[1].xyz, 1.0f), worldToTangentSpace)).xyz;
 
     result.m_uv = uv;
     return result;
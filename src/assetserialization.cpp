@@ -0,0 +1,137 @@
+#include "assetserialization.h"
+
+using namespace D3D12Basics;
+
+void BinaryWriter::Write(const std::wstring& str)
+{
+    Write(static_cast<uint64_t>(str.size()));
+    m_file.write(reinterpret_cast<const char*>(str.data()), str.size() * sizeof(wchar_t));
+}
+
+void BinaryWriter::WriteBlob(const void* data, size_t sizeBytes)
+{
+    const char padding[g_blobAlignment] = {};
+    const uint64_t offset = Offset();
+    m_file.write(padding, AlignToPowerof2(offset, g_blobAlignment) - offset);
+    m_file.write(reinterpret_cast<const char*>(data), sizeBytes);
+}
+
+std::wstring BinaryReader::ReadString()
+{
+    const size_t length = static_cast<size_t>(Read<uint64_t>());
+    assert(m_offset + length * sizeof(wchar_t) <= m_sizeBytes);
+
+    std::wstring str(length, L'\0');
+    memcpy(&str[0], m_data + m_offset, length * sizeof(wchar_t));
+    m_offset += length * sizeof(wchar_t);
+
+    return str;
+}
+
+const uint8_t* BinaryReader::ReadBlob(size_t sizeBytes)
+{
+    m_offset = AlignToPowerof2(m_offset, g_blobAlignment);
+    assert(m_offset + sizeBytes <= m_sizeBytes);
+
+    const uint8_t* blob = m_data + m_offset;
+    m_offset += sizeBytes;
+
+    return blob;
+}
+
+void D3D12Basics::WriteModel(BinaryWriter& writer, const Model& model, uint64_t meshIndex)
+{
+    writer.Write(model.m_name);
+    writer.Write(model.m_type);
+    writer.Write(model.m_uvScaleOffset);
+    writer.Write(model.m_transform);
+    writer.Write(model.m_normalTransform);
+
+    writer.Write(model.m_material.m_diffuseColor);
+    writer.Write(model.m_material.m_diffuseTexture);
+    writer.Write(model.m_material.m_specularTexture);
+    writer.Write(model.m_material.m_normalsTexture);
+    writer.Write(model.m_material.m_shadowReceiver);
+    writer.Write(model.m_material.m_shadowCaster);
+
+    writer.Write(meshIndex);
+}
+
+Model D3D12Basics::ReadModel(BinaryReader& reader, size_t& meshIndex)
+{
+    Model model;
+    model.m_name = reader.ReadString();
+    model.m_type = reader.Read<Model::Type>();
+    model.m_uvScaleOffset = reader.Read<Float4>();
+    model.m_transform = reader.Read<Matrix44>();
+    model.m_normalTransform = reader.Read<Matrix44>();
+
+    model.m_material.m_diffuseColor = reader.Read<Float3>();
+    model.m_material.m_diffuseTexture = reader.ReadString();
+    model.m_material.m_specularTexture = reader.ReadString();
+    model.m_material.m_normalsTexture = reader.ReadString();
+    model.m_material.m_shadowReceiver = reader.Read<bool>();
+    model.m_material.m_shadowCaster = reader.Read<bool>();
+
+    meshIndex = static_cast<size_t>(reader.Read<uint64_t>());
+
+    return model;
+}
+
+void D3D12Basics::WriteMeshData(BinaryWriter& writer, const MeshData& meshData)
+{
+    writer.Write(static_cast<uint64_t>(meshData.VerticesCount()));
+    writer.Write(static_cast<uint64_t>(meshData.VertexSizeBytes()));
+    writer.Write(static_cast<uint64_t>(meshData.Vertices().size()));
+    writer.Write(static_cast<uint64_t>(meshData.IndicesCount()));
+    writer.WriteBlob(meshData.Vertices().data(), meshData.Vertices().size() * sizeof(float));
+    writer.WriteBlob(meshData.Indices().data(), meshData.IndicesCount() * sizeof(uint32_t));
+}
+
+MeshData D3D12Basics::ReadMeshData(BinaryReader& reader)
+{
+    const size_t verticesCount = static_cast<size_t>(reader.Read<uint64_t>());
+    const size_t vertexSizeBytes = static_cast<size_t>(reader.Read<uint64_t>());
+    const size_t verticesElementsCount = static_cast<size_t>(reader.Read<uint64_t>());
+    const size_t indicesCount = static_cast<size_t>(reader.Read<uint64_t>());
+
+    const float* vertices = reinterpret_cast<const float*>(reader.ReadBlob(verticesElementsCount * sizeof(float)));
+    const uint32_t* indices = reinterpret_cast<const uint32_t*>(reader.ReadBlob(indicesCount * sizeof(uint32_t)));
+    return MeshData{ std::vector<float>(vertices, vertices + verticesElementsCount),
+                     std::vector<uint32_t>(indices, indices + indicesCount),
+                     verticesCount, vertexSizeBytes };
+}
+
+void D3D12Basics::WriteTextureData(BinaryWriter& writer, const TextureData& textureData)
+{
+    const auto& desc = textureData.GetDesc();
+    assert(desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE3D);
+
+    const auto& subresources = textureData.GetSubResources();
+    writer.Write(desc);
+    writer.Write(static_cast<uint64_t>(subresources.size()));
+    for (const auto& subresource : subresources)
+    {
+        writer.Write(static_cast<int64_t>(subresource.RowPitch));
+        writer.Write(static_cast<int64_t>(subresource.SlicePitch));
+        writer.WriteBlob(subresource.pData, static_cast<size_t>(subresource.SlicePitch));
+    }
+}
+
+TextureData D3D12Basics::ReadTextureData(BinaryReader& reader, const MappedFilePtr& file)
+{
+    const auto desc = reader.Read<D3D12_RESOURCE_DESC>();
+    const size_t subresourcesCount = static_cast<size_t>(reader.Read<uint64_t>());
+    assert(subresourcesCount > 0);
+
+    std::vector<D3D12_SUBRESOURCE_DATA> subresources(subresourcesCount);
+    for (auto& subresource : subresources)
+    {
+        subresource.RowPitch = static_cast<LONG_PTR>(reader.Read<int64_t>());
+        subresource.SlicePitch = static_cast<LONG_PTR>(reader.Read<int64_t>());
+        subresource.pData = reader.ReadBlob(static_cast<size_t>(subresource.SlicePitch));
+    }
+
+    uint8_t* rawData = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(subresources[0].pData));
+    return TextureData{ desc, std::shared_ptr<uint8_t[]>(file, rawData), std::move(subresources) };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// project includes
+#include "scene.h"
+
+// c++ includes
+#include <string>
+#include <fstream>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+namespace D3D12Basics
+{
+    // NOTE blobs are aligned so the data can be used straight from a mapped file
+    const size_t g_blobAlignment = 16;
+
+    // Trivially copyable values, strings and aligned blobs written as they are in memory
+    class BinaryWriter
+    {
+    public:
+        BinaryWriter(const std::wstring& fileName) : m_file(std::filesystem::path(fileName),
+                                                            std::ios::out | std::ios::binary | std::ios::trunc)
+        {}
+
+        bool IsValid() const { return m_file.good(); }
+
+        uint64_t Offset() { return static_cast<uint64_t>(m_file.tellp()); }
+
+        void Seek(uint64_t offset) { m_file.seekp(offset); }
+
+        template<typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types are written as is");
+            m_file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void Write(const std::wstring& str);
+
+        void WriteBlob(const void* data, size_t sizeBytes);
+
+    private:
+        std::ofstream m_file;
+    };
+
+    // NOTE the data is validated before reading so the reads only assert
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const uint8_t* data, size_t sizeBytes) : m_data(data), m_sizeBytes(sizeBytes), m_offset(0)
+        {}
+
+        template<typename T>
+        T Read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types are read as is");
+            assert(m_offset + sizeof(T) <= m_sizeBytes);
+
+            T value;
+            memcpy(&value, m_data + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+
+            return value;
+        }
+
+        std::wstring ReadString();
+
+        const uint8_t* ReadBlob(size_t sizeBytes);
+
+    private:
+        const uint8_t*  m_data;
+        size_t          m_sizeBytes;
+        size_t          m_offset;
+    };
+
+    // NOTE the model id is not written. meshIndex is the index of its mesh in the container.
+    void WriteModel(BinaryWriter& writer, const Model& model, uint64_t meshIndex);
+
+    Model ReadModel(BinaryReader& reader, size_t& meshIndex);
+
+    void WriteMeshData(BinaryWriter& writer, const MeshData& meshData);
+
+    // NOTE MeshData owns its vertices and indices so they are copied
+    MeshData ReadMeshData(BinaryReader& reader);
+
+    void WriteTextureData(BinaryWriter& writer, const TextureData& textureData);
+
+    // NOTE the texture keeps the mapped file alive and its data points into it
+    TextureData ReadTextureData(BinaryReader& reader, const MappedFilePtr& file);
+}
@@ -0,0 +1,239 @@
+#include "bakedscene.h"
+
+// project includes
+#include "vertexformat.h"
+#include "assetserialization.h"
+
+// c++ includes
+#include <cassert>
+#include <filesystem>
+#include <unordered_map>
+#include <type_traits>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    // NOTE "D3BS" in memory
+    const uint32_t g_bakedSceneMagic = 0x53423344;
+
+    struct BakedSceneHeader
+    {
+        uint32_t                m_magic;
+        uint32_t                m_version;
+        uint32_t                m_vertexStrideBytes;
+        uint32_t                m_optimizeMeshesOverdraw;
+        uint32_t                m_generateTextureMips;
+        uint32_t                m_textureCompression;
+        uint32_t                m_keepSceneHierarchy;
+        uint32_t                m_padding;
+        uint64_t                m_fileSizeBytes;
+        uint64_t                m_sceneFileSizeBytes;
+        int64_t                 m_sceneFileWriteTime;
+        uint64_t                m_meshesCount;
+        uint64_t                m_modelsCount;
+        uint64_t                m_texturesCount;
+        uint64_t                m_texturePathsCount;
+        MeshOptimizationStats   m_meshOptimizationStats;
+    };
+    static_assert(std::is_trivially_copyable_v<BakedSceneHeader>, "BakedSceneHeader is written as is");
+
+    std::wstring BakedSceneFile(const std::wstring& sceneFile)
+    {
+        return sceneFile + L".baked";
+    }
+
+    bool SceneFileStamp(const std::wstring& sceneFile, uint64_t& sizeBytes, int64_t& writeTime)
+    {
+        std::error_code error;
+        sizeBytes = static_cast<uint64_t>(std::filesystem::file_size(sceneFile, error));
+        if (error)
+            return false;
+
+        writeTime = static_cast<int64_t>(std::filesystem::last_write_time(sceneFile, error).time_since_epoch().count());
+        return !error;
+    }
+
+}
+
+bool D3D12Basics::BakeScene(const std::wstring& sceneFile, const BakedSceneSettings& settings,
+                            const std::vector<Model>& models, const MeshDataCache& meshDataCache,
+                            const TextureDataCache& textureDataCache, const MeshOptimizationStats& meshOptimizationStats)
+{
+    BakedSceneHeader header{};
+    header.m_magic = g_bakedSceneMagic;
+    header.m_version = g_bakedSceneVersion;
+    header.m_vertexStrideBytes = static_cast<uint32_t>(QuantizedVertexFormat::m_strideBytes);
+    header.m_optimizeMeshesOverdraw = settings.m_optimizeMeshesOverdraw ? 1 : 0;
+    header.m_generateTextureMips = settings.m_generateTextureMips ? 1 : 0;
+    header.m_textureCompression = static_cast<uint32_t>(settings.m_textureCompression);
+    header.m_keepSceneHierarchy = settings.m_keepSceneHierarchy ? 1 : 0;
+    header.m_meshOptimizationStats = meshOptimizationStats;
+    if (sceneFile.empty() || !SceneFileStamp(sceneFile, header.m_sceneFileSizeBytes, header.m_sceneFileWriteTime))
+        return false;
+
+    // Meshes shared by several models (instanced) are written once
+    std::vector<size_t> meshIds;
+    std::vector<uint64_t> modelsMeshIndex;
+    {
+        std::unordered_map<size_t, uint64_t> meshesById;
+        modelsMeshIndex.reserve(models.size());
+        for (const auto& model : models)
+        {
+            auto mesh = meshesById.emplace(model.MeshId(), meshIds.size());
+            if (mesh.second)
+                meshIds.push_back(model.MeshId());
+
+            modelsMeshIndex.push_back(mesh.first->second);
+        }
+    }
+
+    // Textures shared by several paths are written once
+    std::vector<const TextureData*> textures;
+    std::vector<std::pair<const std::wstring*, uint64_t>> texturePaths;
+    {
+        std::unordered_map<std::wstring, uint64_t> texturesByPath;
+        std::unordered_map<const void*, uint64_t> texturesByData;
+        auto addTexture = [&](const std::wstring& textureFile)
+        {
+            if (textureFile.empty() || texturesByPath.count(textureFile))
+                return;
+
+            assert(textureDataCache.count(textureFile) == 1);
+            const auto& textureData = textureDataCache.at(textureFile);
+            assert(!textureData.GetSubResources().empty());
+
+            auto texture = texturesByData.emplace(textureData.GetSubResources()[0].pData, textures.size());
+            if (texture.second)
+                textures.push_back(&textureData);
+
+            texturesByPath[textureFile] = texture.first->second;
+            texturePaths.emplace_back(&textureFile, texture.first->second);
+        };
+
+        for (const auto& model : models)
+        {
+            addTexture(model.m_material.m_diffuseTexture);
+            addTexture(model.m_material.m_specularTexture);
+            addTexture(model.m_material.m_normalsTexture);
+        }
+    }
+    header.m_meshesCount = meshIds.size();
+    header.m_modelsCount = models.size();
+    header.m_texturesCount = textures.size();
+    header.m_texturePathsCount = texturePaths.size();
+
+    const std::wstring bakedSceneFile = BakedSceneFile(sceneFile);
+    const std::wstring tempBakedSceneFile = bakedSceneFile + L".tmp";
+    {
+        BinaryWriter writer(tempBakedSceneFile);
+        if (!writer.IsValid())
+            return false;
+
+        // NOTE written again at the end with the file size
+        writer.Write(header);
+
+        for (const auto meshId : meshIds)
+        {
+            assert(meshDataCache.count(meshId) == 1);
+            WriteMeshData(writer, meshDataCache.at(meshId));
+        }
+
+        for (size_t i = 0; i < models.size(); ++i)
+            WriteModel(writer, models[i], modelsMeshIndex[i]);
+
+        for (const auto* texture : textures)
+            WriteTextureData(writer, *texture);
+
+        for (const auto& texturePath : texturePaths)
+        {
+            writer.Write(*texturePath.first);
+            writer.Write(texturePath.second);
+        }
+
+        header.m_fileSizeBytes = writer.Offset();
+        writer.Seek(0);
+        writer.Write(header);
+
+        if (!writer.IsValid())
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempBakedSceneFile, bakedSceneFile, error);
+    return !error;
+}
+
+BakedSceneLoader::BakedSceneLoader(const std::wstring& sceneFile, const BakedSceneSettings& settings)
+{
+    if (sceneFile.empty())
+        return;
+
+    auto file = std::make_shared<MappedFile>(BakedSceneFile(sceneFile));
+    if (!file->IsValid() || file->SizeBytes() < sizeof(BakedSceneHeader))
+        return;
+
+    BakedSceneHeader header;
+    memcpy(&header, file->Data(), sizeof(BakedSceneHeader));
+
+    uint64_t sceneFileSizeBytes = 0;
+    int64_t sceneFileWriteTime = 0;
+    if (!SceneFileStamp(sceneFile, sceneFileSizeBytes, sceneFileWriteTime))
+        return;
+
+    const bool isValid =    header.m_magic == g_bakedSceneMagic &&
+                            header.m_version == g_bakedSceneVersion &&
+                            header.m_vertexStrideBytes == QuantizedVertexFormat::m_strideBytes &&
+                            header.m_optimizeMeshesOverdraw == (settings.m_optimizeMeshesOverdraw ? 1u : 0u) &&
+                            header.m_generateTextureMips == (settings.m_generateTextureMips ? 1u : 0u) &&
+                            header.m_textureCompression == static_cast<uint32_t>(settings.m_textureCompression) &&
+                            header.m_keepSceneHierarchy == (settings.m_keepSceneHierarchy ? 1u : 0u) &&
+                            header.m_fileSizeBytes == file->SizeBytes() &&
+                            header.m_sceneFileSizeBytes == sceneFileSizeBytes &&
+                            header.m_sceneFileWriteTime == sceneFileWriteTime;
+    if (isValid)
+        m_file = std::move(file);
+}
+
+void BakedSceneLoader::Load(Scene& scene, MeshDataCache& meshDataCache, TextureDataCache& textureDataCache,
+                            MeshOptimizationStats& meshOptimizationStats)
+{
+    assert(IsValid());
+
+    BinaryReader reader(m_file->Data(), m_file->SizeBytes());
+    const auto header = reader.Read<BakedSceneHeader>();
+
+    // NOTE same models ids as the SceneLoader would assign. The meshes ids start at
+    // the same id too but they are the baked meshes indices, not the scene file ones.
+    const size_t modelIdStart = scene.m_models.empty() ? 0 : scene.m_models.back().m_id + 1;
+    for (size_t i = 0; i < header.m_meshesCount; ++i)
+        meshDataCache[modelIdStart + i] = ReadMeshData(reader);
+
+    scene.m_models.reserve(scene.m_models.size() + static_cast<size_t>(header.m_modelsCount));
+    for (size_t i = 0; i < header.m_modelsCount; ++i)
+    {
+        size_t meshIndex = 0;
+        Model model = ReadModel(reader, meshIndex);
+        assert(meshIndex < header.m_meshesCount);
+        model.m_id = modelIdStart + i;
+        model.m_meshId = modelIdStart + meshIndex;
+
+        scene.m_models.push_back(std::move(model));
+    }
+
+    std::vector<TextureData> textures;
+    textures.reserve(static_cast<size_t>(header.m_texturesCount));
+    for (size_t i = 0; i < header.m_texturesCount; ++i)
+        textures.push_back(ReadTextureData(reader, m_file));
+
+    for (size_t i = 0; i < header.m_texturePathsCount; ++i)
+    {
+        const std::wstring texturePath = reader.ReadString();
+        const size_t textureIndex = static_cast<size_t>(reader.Read<uint64_t>());
+        assert(textureIndex < textures.size());
+
+        textureDataCache[texturePath] = textures[textureIndex];
+    }
+
+    meshOptimizationStats.Add(header.m_meshOptimizationStats);
+}
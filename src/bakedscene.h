@@ -0,0 +1,55 @@
+#pragma once
+
+// project includes
+#include "scene.h"
+#include "meshoptimizer.h"
+#include "texturecompression.h"
+
+// c++ includes
+#include <string>
+#include <vector>
+
+namespace D3D12Basics
+{
+    // NOTE bump it whenever the layout of the file or the processing of the meshes
+    // and textures changes
+    const uint32_t g_bakedSceneVersion = 4;
+
+    // Settings the baked data depends on
+    struct BakedSceneSettings
+    {
+        bool m_optimizeMeshesOverdraw;
+        bool m_generateTextureMips;
+        TextureCompression m_textureCompression;
+        bool m_keepSceneHierarchy;
+    };
+
+    // Writes the models loaded from the scene file together with their processed
+    // meshes (optimized and quantized) and decoded textures, taken from the caches.
+    // NOTE the meshes shared by several models are written once
+    // NOTE the file is written to a temporary file and renamed afterwards so a
+    // partially written file is never loaded
+    bool BakeScene(const std::wstring& sceneFile, const BakedSceneSettings& settings,
+                   const std::vector<Model>& models, const MeshDataCache& meshDataCache,
+                   const TextureDataCache& textureDataCache, const MeshOptimizationStats& meshOptimizationStats);
+
+    // Memory maps the baked file of a scene file. Nothing is parsed: the models are
+    // read from fixed size records, the meshes are copied from the mapped blobs and
+    // the textures point straight into the mapped file so they are uploaded from it.
+    // NOTE the baked file is not valid if it is missing, the version, the vertex format
+    // or the settings dont match or the scene file changed (size and write time)
+    class BakedSceneLoader
+    {
+    public:
+        BakedSceneLoader(const std::wstring& sceneFile, const BakedSceneSettings& settings);
+
+        bool IsValid() const { return m_file != nullptr; }
+
+        // Appends the models to the scene and their meshes and textures to the caches
+        void Load(Scene& scene, MeshDataCache& meshDataCache, TextureDataCache& textureDataCache,
+                  MeshOptimizationStats& meshOptimizationStats);
+
+    private:
+        MappedFilePtr m_file;
+    };
+}
@@ -0,0 +1,156 @@
+#include "buddyallocator.h"
+
+using namespace D3D12Basics;
+
+// c++ includes
+#include <limits>
+#include <cassert>
+#include <algorithm>
+
+// project includes
+#include "utils.h"
+
+const size_t BuddyAllocator::m_invalidOffset = std::numeric_limits<size_t>::max();
+const BuddyAllocator::BlockIndex BuddyAllocator::m_invalidBlock = std::numeric_limits<BlockIndex>::max();
+
+BuddyAllocator::BuddyAllocator(size_t sizeBytes, size_t minBlockSizeBytes) :    m_sizeBytes(sizeBytes),
+                                                                                m_minBlockSizeBytes(minBlockSizeBytes),
+                                                                                m_freeSizeBytes(sizeBytes)
+{
+    assert(m_minBlockSizeBytes);
+    assert(IsPowerOf2(m_sizeBytes));
+    assert(IsPowerOf2(m_minBlockSizeBytes));
+    assert(m_minBlockSizeBytes <= m_sizeBytes);
+
+    m_minBlockSizeLog2 = Log2(m_minBlockSizeBytes);
+    m_ordersCount = Log2(m_sizeBytes) - m_minBlockSizeLog2 + 1;
+    assert(m_ordersCount <= std::numeric_limits<uint8_t>::max());
+
+    const size_t blocksCount = m_sizeBytes >> m_minBlockSizeLog2;
+    assert(blocksCount <= m_invalidBlock);
+
+    m_freeListHeads.resize(m_ordersCount, m_invalidBlock);
+    m_nextFree.resize(blocksCount, m_invalidBlock);
+    m_prevFree.resize(blocksCount, m_invalidBlock);
+    m_blockOrder.resize(blocksCount, 0);
+    m_isBlockFree.resize(blocksCount, 0);
+
+    // The whole range starts as one free block of the biggest order
+    PushFreeBlock(0, m_ordersCount - 1);
+}
+
+size_t BuddyAllocator::Allocate(size_t sizeBytes)
+{
+    assert(sizeBytes);
+    if (sizeBytes > m_sizeBytes)
+        return m_invalidOffset;
+
+    const uint32_t order = Order(sizeBytes);
+
+    // Smallest free block that fits
+    uint32_t freeOrder = order;
+    while (freeOrder < m_ordersCount && m_freeListHeads[freeOrder] == m_invalidBlock)
+        ++freeOrder;
+    if (freeOrder == m_ordersCount)
+        return m_invalidOffset;
+
+    const BlockIndex block = m_freeListHeads[freeOrder];
+    RemoveFreeBlock(block, freeOrder);
+
+    // Split it until it has the requested order. The upper halves go to the free lists.
+    while (freeOrder > order)
+    {
+        --freeOrder;
+        PushFreeBlock(block + (BlockIndex(1) << freeOrder), freeOrder);
+    }
+
+    m_blockOrder[block] = static_cast<uint8_t>(order);
+    m_freeSizeBytes -= m_minBlockSizeBytes << order;
+
+    return static_cast<size_t>(block) << m_minBlockSizeLog2;
+}
+
+void BuddyAllocator::Deallocate(size_t offset)
+{
+    assert(offset < m_sizeBytes);
+    assert((offset & (m_minBlockSizeBytes - 1)) == 0);
+
+    BlockIndex block = static_cast<BlockIndex>(offset >> m_minBlockSizeLog2);
+    assert(!m_isBlockFree[block]);
+
+    uint32_t order = m_blockOrder[block];
+    m_freeSizeBytes += m_minBlockSizeBytes << order;
+
+    // Coalesce with the buddy while it is free and it hasnt been split
+    while (order + 1 < m_ordersCount)
+    {
+        const BlockIndex buddy = block ^ (BlockIndex(1) << order);
+        if (!m_isBlockFree[buddy] || m_blockOrder[buddy] != order)
+            break;
+
+        RemoveFreeBlock(buddy, order);
+        block = std::min(block, buddy);
+        ++order;
+    }
+
+    PushFreeBlock(block, order);
+}
+
+size_t BuddyAllocator::BlockSizeBytes(size_t sizeBytes) const
+{
+    return m_minBlockSizeBytes << Order(sizeBytes);
+}
+
+size_t BuddyAllocator::LargestFreeBlockSizeBytes() const
+{
+    for (uint32_t order = m_ordersCount; order > 0; --order)
+    {
+        if (m_freeListHeads[order - 1] != m_invalidBlock)
+            return m_minBlockSizeBytes << (order - 1);
+    }
+
+    return 0;
+}
+
+uint32_t BuddyAllocator::Order(size_t sizeBytes) const
+{
+    uint32_t order = 0;
+    while ((m_minBlockSizeBytes << order) < sizeBytes)
+        ++order;
+    return order;
+}
+
+void BuddyAllocator::PushFreeBlock(BlockIndex block, uint32_t order)
+{
+    assert(order < m_ordersCount);
+    assert(!m_isBlockFree[block]);
+
+    const BlockIndex head = m_freeListHeads[order];
+    m_nextFree[block] = head;
+    m_prevFree[block] = m_invalidBlock;
+    if (head != m_invalidBlock)
+        m_prevFree[head] = block;
+    m_freeListHeads[order] = block;
+
+    m_blockOrder[block] = static_cast<uint8_t>(order);
+    m_isBlockFree[block] = 1;
+}
+
+void BuddyAllocator::RemoveFreeBlock(BlockIndex block, uint32_t order)
+{
+    assert(m_isBlockFree[block]);
+    assert(m_blockOrder[block] == order);
+
+    const BlockIndex next = m_nextFree[block];
+    const BlockIndex prev = m_prevFree[block];
+    if (prev != m_invalidBlock)
+        m_nextFree[prev] = next;
+    else
+        m_freeListHeads[order] = next;
+    if (next != m_invalidBlock)
+        m_prevFree[next] = prev;
+
+    m_nextFree[block] = m_invalidBlock;
+    m_prevFree[block] = m_invalidBlock;
+    m_isBlockFree[block] = 0;
+}
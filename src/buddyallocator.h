@@ -0,0 +1,66 @@
+#pragma once
+
+// c++ includes
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace D3D12Basics
+{
+    // Binary buddy allocator. Only handles offsets inside a range of sizeBytes,
+    // it doesnt know anything about the memory behind it so it can be used
+    // to suballocate any kind of resource.
+    // Blocks are power of 2 sizes between minBlockSizeBytes and sizeBytes and
+    // a block offset is always aligned to its size.
+    // Allocate and Deallocate are O(log n) being n the number of min blocks:
+    // the free lists are intrusive double linked lists indexed by min block so
+    // removing a buddy from its free list is constant time.
+    // Deallocate coalesces the freed block with its buddy as long as it is free.
+    // https://en.wikipedia.org/wiki/Buddy_memory_allocation
+    class BuddyAllocator
+    {
+    public:
+        static const size_t m_invalidOffset;
+
+        // NOTE sizeBytes and minBlockSizeBytes have to be power of 2
+        BuddyAllocator(size_t sizeBytes, size_t minBlockSizeBytes);
+
+        // Returns m_invalidOffset when there is no free block big enough
+        size_t Allocate(size_t sizeBytes);
+
+        void Deallocate(size_t offset);
+
+        // Size of the block that would be used to allocate sizeBytes
+        size_t BlockSizeBytes(size_t sizeBytes) const;
+
+        size_t SizeBytes() const { return m_sizeBytes; }
+
+        size_t FreeSizeBytes() const { return m_freeSizeBytes; }
+
+        size_t LargestFreeBlockSizeBytes() const;
+
+    private:
+        using BlockIndex = uint32_t;
+        static const BlockIndex m_invalidBlock;
+
+        const size_t    m_sizeBytes;
+        const size_t    m_minBlockSizeBytes;
+        uint32_t        m_minBlockSizeLog2;
+        uint32_t        m_ordersCount;
+        size_t          m_freeSizeBytes;
+
+        // One free list per order. Order 0 is the min block size.
+        std::vector<BlockIndex> m_freeListHeads;
+
+        // Per min block data. Only valid for the first min block of a block.
+        std::vector<BlockIndex> m_nextFree;
+        std::vector<BlockIndex> m_prevFree;
+        std::vector<uint8_t>    m_blockOrder;
+        std::vector<uint8_t>    m_isBlockFree;
+
+        uint32_t Order(size_t sizeBytes) const;
+
+        void PushFreeBlock(BlockIndex block, uint32_t order);
+        void RemoveFreeBlock(BlockIndex block, uint32_t order);
+    };
+}
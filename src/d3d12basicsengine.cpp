@@ -5,12 +5,16 @@
 #include <sstream>
 #include <filesystem>
 #include <iostream>
+#include <numeric>
+#include <unordered_map>
 
 // project includes
-#include "meshgenerator.h"
 #include "d3d12scenerender.h"
 #include "d3d12imgui.h"
 #include "d3d12utils.h"
+#include "vertexquantization.h"
+#include "textureloader.h"
+#include "bakedscene.h"
 
 // thirdparty libraries include
 #include "imgui/imgui.h"
@@ -25,6 +29,27 @@ namespace
     static const float g_defaultClearColor[4] = { 0.0f, 0.2f, 0.4f, 1.0f };
     static const float g_shadowMapClearColor[4] = { 0.0f };
 
+    // NOTE bump it whenever the meshes import or processing change so the derived
+    // data cache entries are not used anymore
+    static const uint32_t g_meshLoaderVersion = 1;
+
+    // NOTE the texture paths of the models are made from the data working path
+    struct ModelsDerivedDataParams
+    {
+        uint64_t m_dataWorkingPathHash;
+        uint32_t m_version;
+        uint32_t m_keepSceneHierarchy;
+    };
+
+    struct MeshDerivedDataParams
+    {
+        uint32_t m_version;
+        uint32_t m_meshIndex;
+        uint32_t m_keepSceneHierarchy;
+        uint32_t m_optimizeMeshesOverdraw;
+        uint32_t m_vertexStrideBytes;
+    };
+
     float ImGuiPlotGetter(const void* data, int index)
     {
         const StopClock::SplitTimeBuffer* splitTimeBuffer = (const StopClock::SplitTimeBuffer*)data;
@@ -69,19 +94,35 @@ namespace
 
 D3D12BasicsEngine::D3D12BasicsEngine(const Settings& settings, 
                                      Scene&& scene)   : m_gpu(settings.m_isWaitableForPresentEnabled),
-                                                        m_sceneLoadingDone(false), m_quit(false), 
+                                                        m_sceneImportDone(false), m_sceneLoadingDone(false), 
+                                                        m_firstModelAddedTime(0.0f), m_sceneAddedTime(0.0f),
+                                                        m_isSceneAdded(false), m_quit(false), 
                                                         m_scene(std::move(scene)), 
                                                         m_fileMonitor(L"./data"),
                                                         m_enableParallelCmdsLits(false),
-                                                        m_sceneLoadingTime(0.0f),
+                                                        m_enableInstancing(true),
+                                                        m_enableCulling(true),
+                                                        m_recordToNullBackend(false),
+                                                        m_optimizeMeshesOverdraw(settings.m_optimizeMeshesOverdraw),
+                                                        m_generateTextureMips(settings.m_generateTextureMips),
+                                                        m_textureCompression(settings.m_textureCompression),
+                                                        m_keepSceneHierarchy(settings.m_keepSceneHierarchy),
                                                         m_drawCallsCount(0)
 {
     m_window = std::make_unique<CustomWindow>(m_gpu.GetSafestResolutionSupported());
     assert(m_window);
 
     m_gpu.SetOutputWindow(m_window->GetHWND());
+    m_gpu.SetUploadBudget(settings.m_uploadBudgetSizeBytes);
 
-    m_sceneRender = std::make_unique<D3D12SceneRender>(m_gpu, m_fileMonitor, m_scene, m_textureDataCache, m_meshDataCache);
+    if (!settings.m_derivedDataCachePath.empty())
+    {
+        m_derivedDataCache = std::make_unique<DerivedDataCache>(settings.m_derivedDataCachePath,
+                                                                settings.m_derivedDataCacheMaxSizeBytes);
+        assert(m_derivedDataCache);
+    }
+
+    m_sceneRender = std::make_unique<D3D12SceneRender>(m_gpu, m_fileMonitor, m_scene, m_meshDataCache);
     assert(m_sceneRender);
 
     m_cameraController = std::make_unique<CameraController>();
@@ -112,10 +153,9 @@ D3D12BasicsEngine::D3D12BasicsEngine(const Settings& settings,
 
 D3D12BasicsEngine::~D3D12BasicsEngine()
 {
-    // NOTE: thread is still executing but it has not being joined yet
-    // this mean thrad has to be joined before destruction
-    if (m_sceneLoaderThread.joinable())
-        m_sceneLoaderThread.join();
+    // NOTE: scene loading tasks could still be running and writing to the caches
+    if (m_sceneLoadTask)
+        m_taskScheduler.WaitforTask(m_sceneLoadTask.get());
 
     // NOTE: Wait for all pending command lists to be done. This is done before
     // any resource (ie, pipeline state) is freed so there arent any
@@ -141,22 +181,34 @@ void D3D12BasicsEngine::BeginFrame()
 
 void D3D12BasicsEngine::RunFrame(void(*UpdateScene)(Scene& scene, float totalTime))
 {
-    if (m_sceneLoadingDone)
+    // NOTE the models are drawn as soon as their data is loaded, the scene render
+    // only waits for the scene import
+    if (m_sceneImportDone)
     {
         if (!m_sceneRender->AreGpuResourcesLoaded())
-        {
-            // Note This calls blocks
             m_sceneRender->LoadGpuResources();
-            
+
+        // NOTE the loading done flag is read before adding the loaded assets so the
+        // last ones are added before the scene is considered added
+        const bool sceneLoadingDone = m_sceneLoadingDone;
+        AddLoadedAssets();
+
+        if (sceneLoadingDone && !m_isSceneAdded)
+        {
+            m_isSceneAdded = true;
+            m_sceneAddedTime = m_sceneLoadingTime.Time();
+
             m_sceneLoadedUIStart.Reset();
 
             SceneLoaded();
         }
 
-        assert(m_sceneRender->AreGpuResourcesLoaded());
-
-        m_sceneRender->Update();
+        m_sceneRender->SetInstancingEnabled(m_enableInstancing);
+        m_sceneRender->SetCullingEnabled(m_enableCulling);
+        m_sceneRender->Update(m_taskScheduler);
 
+        // NOTE the render has updated the moved models
+        ClearMovedModels(m_scene);
         UpdateScene(m_scene, m_cachedTotalTime);
     }
 
@@ -197,56 +249,328 @@ void D3D12BasicsEngine::ProcessUserEvents()
 
 void D3D12BasicsEngine::LoadSceneData(const std::wstring& dataWorkingPath)
 {
-    m_sceneLoaderThread = std::thread([&]()
+    m_sceneLoadingTime.Reset();
+
+    // NOTE done before the loading task starts as the update of the scene can modify
+    // the procedural models from then on
+    ShareProceduralMeshes(m_scene.m_models);
+
+    // NOTE the scene is imported by a task that then spawns a task per texture and
+    // per mesh and waits for them. The workers waiting run the pending tasks.
+    m_sceneLoadTask = std::make_unique<enki::TaskSet>(1, 1, 1, [this, dataWorkingPath](enki::TaskSetPartition, uint32_t)
     {
         RunningTime loadingTime;
 
-        SceneLoader sceneLoader(m_scene.m_sceneFile, m_scene, dataWorkingPath);
+        // NOTE the baked scene replaces the import and the processing of the models
+        // of the scene file. It is written the first time the scene file is imported.
+        const size_t sceneFileModelsStart = m_scene.m_models.size();
+        const BakedSceneSettings bakedSceneSettings{ m_optimizeMeshesOverdraw, m_generateTextureMips, m_textureCompression,
+                                                     m_keepSceneHierarchy };
+        BakedSceneLoader bakedSceneLoader(m_scene.m_sceneFile, bakedSceneSettings);
+        m_sceneLoadingStats.m_isSceneBaked = bakedSceneLoader.IsValid();
+
+        // NOTE the derived data of the scene file is keyed by its contents. It is hashed
+        // before the import so the models found in the cache replace it. The meshes are
+        // keyed by their index in the scene file, ie their id minus the first model id.
+        const size_t sceneFileModelIdStart = m_scene.m_models.empty() ? 0 : m_scene.m_models.back().m_id + 1;
+        const bool useDerivedDataCache = !bakedSceneLoader.IsValid() && m_derivedDataCache &&
+                                         !m_scene.m_sceneFile.empty();
+        uint64_t sceneFileHash = 0;
+        DerivedDataKey modelsDerivedDataKey;
+        if (useDerivedDataCache)
+        {
+            MappedFile sceneFile(m_scene.m_sceneFile);
+            assert(sceneFile.IsValid());
+            sceneFileHash = HashBytes(sceneFile.Data(), sceneFile.SizeBytes());
 
-        for (const auto& model : m_scene.m_models)
+            const ModelsDerivedDataParams derivedDataParams
+            {
+                HashBytes(dataWorkingPath.data(), dataWorkingPath.size() * sizeof(wchar_t)),
+                g_meshLoaderVersion,
+                m_keepSceneHierarchy ? 1u : 0u
+            };
+            modelsDerivedDataKey = CreateDerivedDataKey(sceneFileHash, derivedDataParams);
+            m_sceneLoadingStats.m_areModelsCached = m_derivedDataCache->LoadModels(modelsDerivedDataKey,
+                                                                                   sceneFileModelIdStart,
+                                                                                   m_scene.m_models);
+        }
+
+        std::unique_ptr<SceneLoader> sceneLoader;
+        if (bakedSceneLoader.IsValid())
+            bakedSceneLoader.Load(m_scene, m_meshDataCache, m_textureDataCache, m_meshOptimizationStats);
+        else if (!m_sceneLoadingStats.m_areModelsCached)
         {
-            if (!model.m_material.m_diffuseTexture.empty())
-                m_textureDataCache[model.m_material.m_diffuseTexture] = std::move(sceneLoader.LoadTextureData(model.m_material.m_diffuseTexture));
+            sceneLoader = std::make_unique<SceneLoader>(m_scene.m_sceneFile, m_scene, dataWorkingPath, m_keepSceneHierarchy);
 
-            if (!model.m_material.m_normalsTexture.empty())
-                m_textureDataCache[model.m_material.m_normalsTexture] = std::move(sceneLoader.LoadTextureData(model.m_material.m_normalsTexture));
+            if (useDerivedDataCache)
+            {
+                const std::vector<Model> sceneFileModels(m_scene.m_models.begin() + sceneFileModelsStart,
+                                                         m_scene.m_models.end());
+                m_derivedDataCache->StoreModels(modelsDerivedDataKey, sceneFileModelIdStart, sceneFileModels);
+            }
+        }
 
-            if (!model.m_material.m_specularTexture.empty())
-                m_textureDataCache[model.m_material.m_specularTexture] = std::move(sceneLoader.LoadTextureData(model.m_material.m_specularTexture));
+        m_sceneLoadingStats.m_importTime = loadingTime.Time();
 
-            MeshData meshData;
-            switch (model.m_type)
+        TextureLoader textureLoader(m_generateTextureMips, m_textureCompression, m_derivedDataCache.get());
+        auto requestTexture = [&](const std::wstring& textureFile, TextureUsage usage)
+        {
+            if (!textureFile.empty() && !m_textureDataCache.count(textureFile))
+                textureLoader.Request(textureFile, usage);
+        };
+
+        // NOTE the mesh cache entries are created upfront so the tasks only write to
+        // their own entry and the cache is not modified concurrently. A mesh shared by
+        // several models is loaded once and all of them are ready when it is.
+        struct MeshEntry
+        {
+            const Model*        m_model;
+            MeshData*           m_meshData;
+            std::vector<size_t> m_modelIndices;
+        };
+        std::vector<MeshEntry> meshEntries;
+        std::unordered_map<size_t, size_t> meshEntriesIndex;
+        std::vector<size_t> cachedModels;
+        meshEntries.reserve(m_scene.m_models.size());
+        for (size_t i = 0; i < m_scene.m_models.size(); ++i)
+        {
+            const auto& model = m_scene.m_models[i];
+            requestTexture(model.m_material.m_diffuseTexture, TextureUsage::Color);
+            requestTexture(model.m_material.m_normalsTexture, TextureUsage::Normals);
+            requestTexture(model.m_material.m_specularTexture, TextureUsage::Data);
+
+            const size_t meshId = model.MeshId();
+            auto meshEntryIndex = meshEntriesIndex.find(meshId);
+            if (meshEntryIndex != meshEntriesIndex.end())
+                meshEntries[meshEntryIndex->second].m_modelIndices.push_back(i);
+            else if (!m_meshDataCache.count(meshId))
             {
-            case Model::Type::Cube:
-                meshData = CreateCube(VertexDesc{ true, true, true }, model.m_uvScaleOffset);
-                break;
-            case Model::Type::Plane:
-                meshData = CreatePlane(VertexDesc{ true, true, true }, model.m_uvScaleOffset);
-                break;
-            case Model::Type::Sphere:
-                meshData = CreateSphere(VertexDesc{ true, true, true }, model.m_uvScaleOffset, 40, 40);
-                break;
-            case Model::Type::MeshFile:
+                meshEntriesIndex[meshId] = meshEntries.size();
+                meshEntries.push_back({ &model, &m_meshDataCache[meshId], { i } });
+            }
+            else
+                cachedModels.push_back(i);
+        }
+
+        // NOTE the models and textures already in the caches (baked) are ready now.
+        // From here on the scene models and the mesh cache entries dont change and
+        // the texture cache is only modified under the loaded assets mutex.
+        {
+            std::lock_guard<std::mutex> lock(m_loadedAssetsMutex);
+            m_loadedModels.insert(m_loadedModels.end(), cachedModels.begin(), cachedModels.end());
+            for (const auto& textureData : m_textureDataCache)
+                m_loadedTextures.push_back(textureData.first);
+        }
+        m_sceneImportDone = true;
+
+        std::vector<float> meshesTimes(meshEntries.size(), 0.0f);
+        std::vector<MeshOptimizationStats> meshesOptimizationStats(meshEntries.size());
+        std::atomic<size_t> cachedMeshesCount(0);
+
+        // NOTE only the scene file meshes go through the derived data cache, the
+        // procedural ones are faster to create than to load
+        auto meshDerivedDataKey = [&](const Model& model)
+        {
+            const MeshDerivedDataParams derivedDataParams
             {
-                meshData = sceneLoader.LoadMesh(model.m_id);
-                break;
+                g_meshLoaderVersion,
+                static_cast<uint32_t>(model.MeshId() - sceneFileModelIdStart),
+                m_keepSceneHierarchy ? 1u : 0u,
+                m_optimizeMeshesOverdraw ? 1u : 0u,
+                static_cast<uint32_t>(QuantizedVertexFormat::m_strideBytes)
+            };
+            return CreateDerivedDataKey(sceneFileHash, derivedDataParams);
+        };
+
+        auto processMesh = [&](size_t meshEntryIndex, const MeshData& meshData)
+        {
+            auto& meshEntry = meshEntries[meshEntryIndex];
+            auto& meshOptimizationStats = meshesOptimizationStats[meshEntryIndex];
+            *meshEntry.m_meshData = QuantizeMesh(OptimizeMesh(meshData, m_optimizeMeshesOverdraw, meshOptimizationStats));
+
+            if (useDerivedDataCache && meshEntry.m_model->m_type == Model::Type::MeshFile)
+                m_derivedDataCache->StoreMesh(meshDerivedDataKey(*meshEntry.m_model), *meshEntry.m_meshData,
+                                              meshOptimizationStats);
+        };
+
+        auto addLoadedModels = [&](size_t meshEntryIndex)
+        {
+            std::lock_guard<std::mutex> lock(m_loadedAssetsMutex);
+            m_loadedModels.insert(m_loadedModels.end(), meshEntries[meshEntryIndex].m_modelIndices.begin(),
+                                  meshEntries[meshEntryIndex].m_modelIndices.end());
+        };
+
+        // NOTE the meshes of the cached models that are not in the cache anymore, ie evicted.
+        // They are loaded after the tasks as the scene file has to be imported for them.
+        std::vector<size_t> missingMeshEntries;
+
+        enki::TaskSet meshesTask(static_cast<uint32_t>(meshEntries.size()), 1, 1,
+                                 [&](enki::TaskSetPartition range, uint32_t)
+        {
+            for (uint32_t i = range.start; i < range.end; ++i)
+            {
+                RunningTime meshTime;
+
+                const Model& model = *meshEntries[i].m_model;
+                const bool isSceneFileMesh = model.m_type == Model::Type::MeshFile;
+                if (useDerivedDataCache && isSceneFileMesh &&
+                    m_derivedDataCache->LoadMesh(meshDerivedDataKey(model), *meshEntries[i].m_meshData,
+                                                 meshesOptimizationStats[i]))
+                {
+                    ++cachedMeshesCount;
+                }
+                else if (isSceneFileMesh && !sceneLoader)
+                {
+                    std::lock_guard<std::mutex> lock(m_loadedAssetsMutex);
+                    missingMeshEntries.push_back(i);
+                    continue;
+                }
+                else
+                {
+                    processMesh(i, isSceneFileMesh ? sceneLoader->LoadMesh<FullVertexFormat>(model.MeshId()) :
+                                                     CreateProceduralMesh(model));
+                }
+
+                meshesTimes[i] = meshTime.Time();
+
+                addLoadedModels(i);
+            }
+        });
+
+        if (!meshEntries.empty())
+            m_taskScheduler.AddTaskSetToPipe(&meshesTask);
+
+        // NOTE the textures are loaded while the meshes tasks run
+        textureLoader.Load(m_taskScheduler, [this](const std::vector<std::wstring>& textureFiles,
+                                                   const TextureData& textureData)
+        {
+            std::lock_guard<std::mutex> lock(m_loadedAssetsMutex);
+            for (const auto& textureFile : textureFiles)
+            {
+                m_textureDataCache[textureFile] = textureData;
+                m_loadedTextures.push_back(textureFile);
             }
-            default:
-                assert(false);
+        });
+
+        if (!meshEntries.empty())
+            m_taskScheduler.WaitforTask(&meshesTask);
+
+        // NOTE imported into a scene of its own as the cached models are in the scene already.
+        // Its meshes ids are their index in the scene file.
+        if (!missingMeshEntries.empty())
+        {
+            RunningTime importTime;
+            Scene importedScene;
+            SceneLoader missingMeshesLoader(m_scene.m_sceneFile, importedScene, dataWorkingPath, m_keepSceneHierarchy);
+            m_sceneLoadingStats.m_importTime += importTime.Time();
+
+            for (size_t i : missingMeshEntries)
+            {
+                RunningTime meshTime;
+
+                const size_t meshIndex = meshEntries[i].m_model->MeshId() - sceneFileModelIdStart;
+                processMesh(i, missingMeshesLoader.LoadMesh<FullVertexFormat>(meshIndex));
+
+                meshesTimes[i] = meshTime.Time();
+
+                addLoadedModels(i);
             }
+        }
+
+        MeshOptimizationStats sceneFileMeshOptimizationStats;
+        for (size_t i = 0; i < meshEntries.size(); ++i)
+        {
+            m_meshOptimizationStats.Add(meshesOptimizationStats[i]);
+
+            if (meshEntries[i].m_model->m_type != Model::Type::MeshFile)
+                m_sceneLoadingStats.m_proceduralMeshesTime += meshesTimes[i];
+
+            const size_t modelIndex = static_cast<size_t>(meshEntries[i].m_model - &m_scene.m_models[0]);
+            if (modelIndex >= sceneFileModelsStart)
+                sceneFileMeshOptimizationStats.Add(meshesOptimizationStats[i]);
+        }
+
+        if (!bakedSceneLoader.IsValid() && !m_scene.m_sceneFile.empty())
+        {
+            RunningTime bakingTime;
+
+            const std::vector<Model> sceneFileModels(m_scene.m_models.begin() + sceneFileModelsStart, m_scene.m_models.end());
+            BakeScene(m_scene.m_sceneFile, bakedSceneSettings, sceneFileModels, m_meshDataCache, m_textureDataCache,
+                      sceneFileMeshOptimizationStats);
 
-            m_meshDataCache[model.m_id] = std::move(meshData);
+            m_sceneLoadingStats.m_bakingTime = bakingTime.Time();
         }
 
+        m_sceneLoadingStats.m_textureLoaderStats = textureLoader.GetStats();
+        m_sceneLoadingStats.m_texturesTime = m_sceneLoadingStats.m_textureLoaderStats.m_readTime +
+                                             m_sceneLoadingStats.m_textureLoaderStats.m_decodeTime +
+                                             m_sceneLoadingStats.m_textureLoaderStats.m_mipsTime +
+                                             m_sceneLoadingStats.m_textureLoaderStats.m_cacheTime;
+        m_sceneLoadingStats.m_meshesTime = std::accumulate(meshesTimes.begin(), meshesTimes.end(), 0.0f);
+        m_sceneLoadingStats.m_texturesCount = m_sceneLoadingStats.m_textureLoaderStats.m_missesCount;
+        m_sceneLoadingStats.m_meshesCount = meshEntries.size();
+        m_sceneLoadingStats.m_cachedMeshesCount = cachedMeshesCount;
+
+        // NOTE the size the models sharing a mesh would take with their own vertex and
+        // index buffers
+        std::unordered_map<size_t, size_t> meshesModelsCount;
+        for (const auto& model : m_scene.m_models)
+            ++meshesModelsCount[model.MeshId()];
+        for (const auto& meshModelsCount : meshesModelsCount)
+        {
+            const auto& meshData = m_meshDataCache.at(meshModelsCount.first);
+            const size_t sharingModelsCount = meshModelsCount.second - 1;
+            m_sceneLoadingStats.m_sharedMeshesModelsCount += sharingModelsCount;
+            m_sceneLoadingStats.m_sharedMeshesSavedSizeBytes += sharingModelsCount * (meshData.VertexBufferSizeBytes() +
+                                                                                      meshData.IndexBufferSizeBytes());
+        }
+        if (m_derivedDataCache)
+            m_sceneLoadingStats.m_derivedDataCacheStats = m_derivedDataCache->GetStats();
+        m_sceneLoadingStats.m_totalTime = loadingTime.Time();
+
         m_sceneLoadingDone = true;
-        m_sceneLoadingTime = loadingTime.Time();
     });
+    assert(m_sceneLoadTask);
+
+    m_taskScheduler.AddTaskSetToPipe(m_sceneLoadTask.get());
+}
+
+void D3D12BasicsEngine::AddLoadedAssets()
+{
+    // NOTE the texture data is shared, not copied, so the lock is only held to take
+    // the loaded assets and not while creating the gpu resources
+    std::vector<size_t> loadedModels;
+    std::vector<std::pair<std::wstring, TextureData>> loadedTextures;
+    {
+        std::lock_guard<std::mutex> lock(m_loadedAssetsMutex);
+        loadedModels.swap(m_loadedModels);
+        loadedTextures.reserve(m_loadedTextures.size());
+        for (auto& textureFile : m_loadedTextures)
+            loadedTextures.emplace_back(textureFile, m_textureDataCache.at(textureFile));
+        m_loadedTextures.clear();
+    }
+
+    // NOTE textures first so the models added in the same frame dont need the
+    // default texture
+    for (const auto& loadedTexture : loadedTextures)
+        m_sceneRender->AddTexture(loadedTexture.first, loadedTexture.second);
+
+    if (loadedModels.empty())
+        return;
+
+    if (!m_sceneRender->GpuMeshesCount())
+        m_firstModelAddedTime = m_sceneLoadingTime.Time();
+
+    for (size_t modelIndex : loadedModels)
+        m_sceneRender->AddModel(m_scene.m_models[modelIndex]);
+
+    m_sceneRender->FlushModels();
 }
 
 void D3D12BasicsEngine::ShowSceneLoadUI()
 {
     std::string loadUIStr = "Scene loading!";
-    if (m_sceneRender->AreGpuResourcesLoaded())
+    if (m_isSceneAdded)
     {
         if (m_sceneLoadedUIStart.Time() > g_showSceneLoadedUITime)
             return;
@@ -266,6 +590,21 @@ void D3D12BasicsEngine::ShowSceneLoadUI()
 
     ImGui::Begin("SceneLoadedUI", nullptr, windowFlags);
     ImGui::Text(loadUIStr.c_str());
+    if (m_sceneImportDone)
+    {
+        ImGui::Text("models drawn %zu/%zu first model %.3fs", m_sceneRender->GpuMeshesCount(), m_scene.m_models.size(),
+                    m_firstModelAddedTime);
+    }
+    if (m_isSceneAdded)
+        ImGui::Text("scene drawn %.3fs", m_sceneAddedTime);
+    if (m_sceneLoadingDone)
+    {
+        ImGui::Text("%s %.3fs textures %zu %.3fs meshes %zu %.3fs (cpu) total %.3fs", 
+                    m_sceneLoadingStats.m_isSceneBaked? "baked scene" : "import", 
+                    m_sceneLoadingStats.m_importTime, m_sceneLoadingStats.m_texturesCount, 
+                    m_sceneLoadingStats.m_texturesTime, m_sceneLoadingStats.m_meshesCount, 
+                    m_sceneLoadingStats.m_meshesTime, m_sceneLoadingStats.m_totalTime);
+    }
     ImGui::End();
 }
 
@@ -291,6 +630,9 @@ void D3D12BasicsEngine::ShowMainUI()
         if (m_enableParallelCmdsLits)
             ImGui::SliderInt("Drawcalls per cmdlist", &m_drawCallsCount, 1, 
                               static_cast<int>(m_sceneRender->GpuMeshesCount()));
+        ImGui::Checkbox("Enable instancing", &m_enableInstancing);
+        ImGui::Checkbox("Enable frustum culling", &m_enableCulling);
+        ImGui::Checkbox("Record scene into null backend", &m_recordToNullBackend);
     }
 
     static bool pausePlots = false;
@@ -364,8 +706,110 @@ void D3D12BasicsEngine::ShowMainUI()
     ShowTimeUI("CPU: total time", m_cachedTotalTime);
     ImGui::Text("# draw calls: shadow pass %d", sceneStats.m_shadowPassDrawCallsCount);
     ImGui::Text("# draw calls: forward pass %d", sceneStats.m_forwardPassDrawCallsCount);
+    ImGui::Text("# visible instances: shadow pass %d forward pass %d of %zu",
+                sceneStats.m_shadowPassVisibleInstancesCount, sceneStats.m_forwardPassVisibleInstancesCount,
+                m_sceneRender->GpuMeshesCount());
+    ShowTimeUI("CPU: gpu meshes update time", sceneStats.m_gpuMeshesUpdateTime);
+    // NOTE the target is 100k dynamic objects under 1ms
+    if (m_sceneRender->GpuMeshesCount())
+    {
+        ImGui::Text("CPU: gpu meshes update time per 100k %.3fms (%zu transforms updated)",
+                    sceneStats.m_gpuMeshesUpdateTime * 1000.0f * 100000.0f / m_sceneRender->GpuMeshesCount(),
+                    sceneStats.m_updatedGpuMeshesCount);
+    }
+    ShowTimeUI("CPU: upload time", sceneStats.m_uploadTime);
+    ImGui::Text("Uploaded: frame data %.2fKB object data %.2fKB instances lists %.2fKB",
+                sceneStats.m_frameDataUploadedSizeBytes / static_cast<float>(g_1kb),
+                sceneStats.m_objectDataUploadedSizeBytes / static_cast<float>(g_1kb),
+                sceneStats.m_instancesListsUploadedSizeBytes / static_cast<float>(g_1kb));
+    if (m_recordToNullBackend)
+    {
+        const auto& nullBackendCounters = sceneStats.m_nullBackendCounters;
+        ImGui::Text("# null backend: commands %d draws %d bindings %d state changes %d barriers %d",
+                    nullBackendCounters.m_commandsCount, nullBackendCounters.m_drawsCount,
+                    nullBackendCounters.m_bindingsCount, nullBackendCounters.m_stateChangesCount,
+                    nullBackendCounters.m_barriersCount);
+    }
+    const auto dynamicMemoryStats = m_gpu.GetDynamicMemoryStats();
+    ImGui::Text("# dynamic memory pages: small %zu big %zu free %.2fMB fragmentation %.2f%%",
+                dynamicMemoryStats.m_smallPagesCount, dynamicMemoryStats.m_bigPagesCount,
+                dynamicMemoryStats.m_freeSizeBytes / static_cast<float>(g_1mb), 
+                dynamicMemoryStats.Fragmentation() * 100.0f);
+    ImGui::Text("# transient memory pages: %zu used %.2fKB", m_gpu.GetTransientMemoryPagesCount(),
+                m_gpu.GetTransientMemoryUsedSizeBytes() / static_cast<float>(g_1kb));
+    const auto& uploadQueueStats = m_gpu.GetUploadQueueStats();
+    ImGui::Text("# uploads: batches %llu pending %zu (%.2fMB) staging pages %zu",
+                uploadQueueStats.m_submittedBatchesCount, uploadQueueStats.m_pendingUploadsCount,
+                uploadQueueStats.m_pendingSizeBytes / static_cast<float>(g_1mb), 
+                uploadQueueStats.m_stagingPagesCount);
+    const auto& staticGeometryStats = sceneStats.m_staticGeometryStats;
+    ImGui::Text("# static geometry: meshes %zu (32 bits indices %zu) vbs %zu ibs %zu size %.2fMB used %.2fMB (%.2fMB separate)",
+                staticGeometryStats.m_meshesCount, staticGeometryStats.m_32BitsIndicesMeshesCount, 
+                staticGeometryStats.m_vertexBuffersCount,
+                staticGeometryStats.m_indexBuffersCount, staticGeometryStats.m_sizeBytes / static_cast<float>(g_1mb),
+                staticGeometryStats.m_usedSizeBytes / static_cast<float>(g_1mb),
+                staticGeometryStats.m_separateSizeBytes / static_cast<float>(g_1mb));
+    if (m_sceneLoadingDone)
+    {
+        const auto& before = m_meshOptimizationStats.m_before;
+        const auto& after = m_meshOptimizationStats.m_after;
+        ImGui::Text("# vertex cache (fifo %zu): acmr %.3f -> %.3f atvr %.3f -> %.3f", g_vertexCacheSimulationSize,
+                    before.ACMR(), after.ACMR(), before.ATVR(), after.ATVR());
+    }
     ShowTimeUI("CPU: loading gpu resources", sceneStats.m_loadingGPUResourcesTime);
-    ShowTimeUI("CPU: loading scene data", m_sceneLoadingTime);
+    if (m_sceneLoadingDone)
+    {
+        ShowTimeUI("CPU: loading scene data", m_sceneLoadingStats.m_totalTime);
+        ShowTimeUI(m_sceneLoadingStats.m_isSceneBaked? "CPU: loading scene data - baked scene" : 
+                                                       "CPU: loading scene data - import", 
+                   m_sceneLoadingStats.m_importTime);
+        ShowTimeUI("CPU: loading scene data - textures (tasks sum)", m_sceneLoadingStats.m_texturesTime);
+        ShowTimeUI("CPU: loading scene data - meshes (tasks sum)", m_sceneLoadingStats.m_meshesTime);
+        ShowTimeUI("CPU: loading scene data - procedural meshes (tasks sum)", m_sceneLoadingStats.m_proceduralMeshesTime);
+        ImGui::Text("# shared meshes: %zu models use %zu meshes vbs/ibs %.2fMB saved", m_scene.m_models.size(),
+                    m_scene.m_models.size() - m_sceneLoadingStats.m_sharedMeshesModelsCount,
+                    m_sceneLoadingStats.m_sharedMeshesSavedSizeBytes / static_cast<float>(g_1mb));
+        if (!m_sceneLoadingStats.m_isSceneBaked)
+            ShowTimeUI("CPU: loading scene data - baking", m_sceneLoadingStats.m_bakingTime);
+        const auto& textureLoaderStats = m_sceneLoadingStats.m_textureLoaderStats;
+        ImGui::Text("# texture loads: requests %zu path hits %zu content hits %zu misses %zu mapped %.2fMB",
+                    textureLoaderStats.m_requestsCount, textureLoaderStats.m_pathHitsCount,
+                    textureLoaderStats.m_contentHitsCount, textureLoaderStats.m_missesCount,
+                    textureLoaderStats.m_mappedSizeBytes / static_cast<float>(g_1mb));
+        if (m_derivedDataCache)
+        {
+            const auto& derivedDataCacheStats = m_sceneLoadingStats.m_derivedDataCacheStats;
+            ImGui::Text("# derived data cache: models %s meshes %zu textures %zu hit rate %.2f%% (hits %zu misses %zu)",
+                        m_sceneLoadingStats.m_areModelsCached ? "yes" : "no",
+                        m_sceneLoadingStats.m_cachedMeshesCount, textureLoaderStats.m_cachedCount,
+                        derivedDataCacheStats.HitRate() * 100.0f, derivedDataCacheStats.m_hitsCount,
+                        derivedDataCacheStats.m_missesCount);
+            ImGui::Text("# derived data cache: read %.2fMB written %.2fMB (%zu) evictions %zu size %.2fMB",
+                        derivedDataCacheStats.m_readSizeBytes / static_cast<float>(g_1mb),
+                        derivedDataCacheStats.m_writtenSizeBytes / static_cast<float>(g_1mb),
+                        derivedDataCacheStats.m_writesCount, derivedDataCacheStats.m_evictionsCount,
+                        derivedDataCacheStats.m_sizeBytes / static_cast<float>(g_1mb));
+        }
+        ImGui::Text("# texture decoder allocations: %zu %.2fMB for %.2fMB of decoded pixels",
+                    textureLoaderStats.m_decoderAllocationsCount,
+                    textureLoaderStats.m_decoderAllocatedSizeBytes / static_cast<float>(g_1mb),
+                    textureLoaderStats.m_decodedSizeBytes / static_cast<float>(g_1mb));
+        if (textureLoaderStats.m_mipsPixelsCount)
+        {
+            const float megaPixelsCount = textureLoaderStats.m_mipsPixelsCount / 1000000.0f;
+            ImGui::Text("# texture mips: %.2f megapixels %.3fms per megapixel (tasks sum)", megaPixelsCount,
+                        textureLoaderStats.m_mipsTime * 1000.0f / megaPixelsCount);
+        }
+        if (textureLoaderStats.m_compressedPixelsCount)
+        {
+            const float megaPixelsCount = textureLoaderStats.m_compressedPixelsCount / 1000000.0f;
+            ImGui::Text("# texture compression: %.2fMB to %.2fMB %.2f megapixels/s (tasks sum) psnr %.2fdB",
+                        textureLoaderStats.m_uncompressedSizeBytes / static_cast<float>(g_1mb),
+                        textureLoaderStats.m_compressedSizeBytes / static_cast<float>(g_1mb),
+                        megaPixelsCount / textureLoaderStats.m_compressionTime,
+                        textureLoaderStats.m_compressionError.PSNR());
+        }
+    }
 
     ImGui::End();
 }
@@ -383,7 +827,7 @@ void D3D12BasicsEngine::RenderFrame()
     const auto& backbufferRT = m_gpu.SwapChainBackBufferViewHandle();
     auto sceneRenderCmdLists = m_sceneRender->RecordCmdLists(backbufferRT, depthBufferViewHandle, 
                                                              m_taskScheduler, m_enableParallelCmdsLits,
-                                                             m_drawCallsCount);
+                                                             m_drawCallsCount, m_recordToNullBackend);
     auto imguiCmdList = m_imgui->EndFrame(backbufferRT, depthBufferViewHandle);
     assert(imguiCmdList);
     cmdLists.insert(cmdLists.end(), sceneRenderCmdLists.begin(), sceneRenderCmdLists.end());
@@ -7,11 +7,13 @@
 #include "d3d12fwd.h"
 #include "filemonitor.h"
 #include "d3d12scenerender.h"
+#include "meshoptimizer.h"
+#include "textureloader.h"
+#include "deriveddatacache.h"
 
 // c++ includes
 #include <atomic>
 #include <string>
-#include <thread>
 #include <mutex>
 
 // thirdparty libraries include
@@ -28,6 +30,18 @@ namespace D3D12Basics
         {
             bool m_isWaitableForPresentEnabled = false;
             std::wstring m_dataWorkingPath;
+            bool m_optimizeMeshesOverdraw = true;
+            bool m_generateTextureMips = true;
+            TextureCompression m_textureCompression = TextureCompression::Fast;
+            bool m_keepSceneHierarchy = true;
+
+            // NOTE an empty path disables the derived data cache
+            std::wstring m_derivedDataCachePath = L"./derivedcache/";
+            size_t m_derivedDataCacheMaxSizeBytes = 1024 * g_1mb;
+
+            // Maximum bytes of static memory uploaded per frame. 0 means no budget.
+            // NOTE the models are drawn once their meshes and textures are uploaded
+            size_t m_uploadBudgetSizeBytes = 0;
         };
 
         D3D12BasicsEngine(const Settings& settings, Scene&& scene);
@@ -91,6 +105,33 @@ namespace D3D12Basics
             }
         };
 
+        // NOTE textures and meshes are loaded concurrently so their times are the
+        // cpu time summed over all the tasks, not wall time
+        struct SceneLoadingStats
+        {
+            float   m_importTime        = 0.0f;
+            float   m_texturesTime      = 0.0f;
+            float   m_meshesTime        = 0.0f;
+            float   m_totalTime         = 0.0f;
+            float   m_bakingTime        = 0.0f;
+            bool    m_isSceneBaked      = false;
+            size_t  m_texturesCount     = 0;
+            size_t  m_meshesCount       = 0;
+            size_t  m_cachedMeshesCount = 0;
+
+            // NOTE the scene file was not imported when its models were in the derived data cache
+            bool    m_areModelsCached   = false;
+
+            // Generation time of the procedural meshes and the models using a mesh shared
+            // with other models with the vertex and index buffers size they didnt upload
+            float   m_proceduralMeshesTime          = 0.0f;
+            size_t  m_sharedMeshesModelsCount       = 0;
+            size_t  m_sharedMeshesSavedSizeBytes    = 0;
+
+            TextureLoader::Stats        m_textureLoaderStats;
+            DerivedDataCache::Stats     m_derivedDataCacheStats;
+        };
+
         struct CachedStats
         {
             StopClock::SplitTimeBuffer    m_beginToEndTime;
@@ -114,11 +155,32 @@ namespace D3D12Basics
         D3D12GraphicsCmdListPtr m_postCmdList;
 
         Scene                                           m_scene;
-        std::thread                                     m_sceneLoaderThread;
+        TaskSetPtr                                      m_sceneLoadTask;
+        std::atomic<bool>                               m_sceneImportDone;
         std::atomic<bool>                               m_sceneLoadingDone;
-        float                                           m_sceneLoadingTime;
+        SceneLoadingStats                               m_sceneLoadingStats;
+
+        // Models (indices into the scene models) and textures loaded by the scene
+        // loading tasks and not added to the scene render yet.
+        // NOTE the mutex also guards the texture data cache while the scene loads
+        std::mutex                                      m_loadedAssetsMutex;
+        std::vector<size_t>                             m_loadedModels;
+        std::vector<std::wstring>                       m_loadedTextures;
+
+        // Time from the start of the scene loading until the first model and all the
+        // models and textures were added to the scene render
+        RunningTime                                     m_sceneLoadingTime;
+        float                                           m_firstModelAddedTime;
+        float                                           m_sceneAddedTime;
+        bool                                            m_isSceneAdded;
         TextureDataCache                                m_textureDataCache;
         MeshDataCache                                   m_meshDataCache;
+        bool                                            m_optimizeMeshesOverdraw;
+        bool                                            m_generateTextureMips;
+        TextureCompression                              m_textureCompression;
+        bool                                            m_keepSceneHierarchy;
+        std::unique_ptr<DerivedDataCache>               m_derivedDataCache;
+        MeshOptimizationStats                           m_meshOptimizationStats;
 
         D3D12SceneRenderPtr m_sceneRender;
         GpuTexture m_depthBuffer;
@@ -140,6 +202,15 @@ namespace D3D12Basics
 
         bool m_enableParallelCmdsLits;
 
+        // NOTE models sharing mesh and material are drawn with one instanced draw
+        bool m_enableInstancing;
+
+        bool m_enableCulling;
+
+        // Note the scene cmd lists are recorded but not executed so only the
+        // cpu recording cost is measured
+        bool m_recordToNullBackend;
+
         int m_drawCallsCount;
 
         void ProcessWindowEvents();
@@ -148,6 +219,8 @@ namespace D3D12Basics
 
         void LoadSceneData(const std::wstring& dataWorkingPath);
 
+        void AddLoadedAssets();
+
         void ShowSceneLoadUI();
 
         void ShowMainUI();
@@ -28,7 +28,9 @@ namespace D3D12Basics
     class D3D12RTVDescriptorBuffer;
     class D3D12GPUDescriptorRingBuffer;
     class D3D12DynamicBufferAllocator;
+    class D3D12FrameLinearAllocator;
     class D3D12CommittedResourceAllocator;
+    class D3D12UploadQueue;
     class D3D12ImGui;
     class D3D12SceneRender;
 
@@ -43,7 +45,9 @@ namespace D3D12Basics
     using D3D12RTVDescriptorBufferPtr           = std::unique_ptr<D3D12RTVDescriptorBuffer>;
     using D3D12GPUDescriptorRingBufferPtr       = std::unique_ptr<D3D12GPUDescriptorRingBuffer>;
     using D3D12DynamicBufferAllocatorPtr        = std::unique_ptr<D3D12DynamicBufferAllocator>;
+    using D3D12FrameLinearAllocatorPtr          = std::unique_ptr<D3D12FrameLinearAllocator>;
     using D3D12CommittedResourceAllocatorPtr    = std::unique_ptr<D3D12CommittedResourceAllocator>;
+    using D3D12UploadQueuePtr                   = std::unique_ptr<D3D12UploadQueue>;
     using D3D12ImGuiPtr                         = std::unique_ptr<D3D12ImGui>;
     using D3D12SceneRenderPtr                   = std::unique_ptr<D3D12SceneRender>;
     using TaskSetPtr                            = std::unique_ptr<enki::TaskSet>;
@@ -26,51 +26,6 @@ namespace D3D12Basics
 
 namespace
 {
-    struct SubresourcesFootPrint
-    {
-        SubresourcesFootPrint(size_t subresourcesCount) :   m_layouts(subresourcesCount),
-                                                            m_rowSizesInBytes(subresourcesCount),
-                                                            m_rowsCounts(subresourcesCount)
-        {
-        }
-        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> m_layouts;
-        std::vector<UINT64>                             m_rowSizesInBytes;
-        std::vector<UINT>                               m_rowsCounts;
-        
-        UINT64 m_requiredSize;
-    };
-
-    D3D12_RESOURCE_DESC CreateBufferDesc(uint64_t sizeBytes)
-    {
-        D3D12_RESOURCE_DESC resourceDesc;
-        resourceDesc.Dimension           = D3D12_RESOURCE_DIMENSION_BUFFER;
-        // https://msdn.microsoft.com/en-us/library/windows/desktop/dn903813(v=vs.85).aspx
-        // Alignment must be 64KB (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) or 0, which is effectively 64KB.
-        resourceDesc.Alignment           = 0;
-        resourceDesc.Width               = sizeBytes;
-        resourceDesc.Height              = 1;
-        resourceDesc.DepthOrArraySize    = 1;
-        resourceDesc.MipLevels           = 1;
-        resourceDesc.Format              = DXGI_FORMAT_UNKNOWN;
-        resourceDesc.SampleDesc          = { 1, 0 };
-        resourceDesc.Layout              = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-        resourceDesc.Flags               = D3D12_RESOURCE_FLAG_NONE;
-    
-        return resourceDesc;
-    }
-
-    SubresourcesFootPrint CreateSubresourceFootPrint(ID3D12DevicePtr device, size_t subresourcesCount, D3D12_RESOURCE_DESC desc)
-    {
-        SubresourcesFootPrint subresourcesFootPrint(subresourcesCount);
-
-        // TODO implement this function, cache the results and use the table.
-        device->GetCopyableFootprints(&desc, 0, static_cast<UINT>(subresourcesCount), 0, &subresourcesFootPrint.m_layouts[0],
-                                      &subresourcesFootPrint.m_rowsCounts[0], &subresourcesFootPrint.m_rowSizesInBytes[0],
-                                      &subresourcesFootPrint.m_requiredSize);
-
-        return subresourcesFootPrint;
-    }
-
     ID3D12ResourcePtr D3D12CreateDynamicCommittedBuffer(ID3D12DevicePtr device, size_t dataSizeBytes)
     {
         D3D12_RESOURCE_DESC resourceDesc = CreateBufferDesc(dataSizeBytes);
@@ -87,226 +42,14 @@ namespace
         assert(alignedOffset >= offset);
         return (alignedOffset - offset) + alignedSize;
     }
-
-    void AssertContextIsValid(const D3D12CommittedResourceAllocator::Context& context)
-    {
-#if NDEBUG
-        assert(context.m_cmdAllocator);
-        assert(context.m_cmdList);
-#else
-        context;
-#endif // !NDEBUG
-    }
-
-    // NOTE probably for this project using CopyResource would be enough as theres no subresource copying planned
-    // TODO change to CopyResource whenever is convenient
-    class UploaderHelper
-    {
-    public:
-        UploaderHelper(const D3D12CommittedResourceAllocator::Context& context, ID3D12DevicePtr device,
-                       ID3D12CommandQueuePtr cmdQueue, const D3D12_RESOURCE_DESC& resourceDesc,
-                       size_t alignedSize, D3D12_RESOURCE_STATES stateAfter,
-                       const std::wstring& debugName) : m_context(context), m_device(device), 
-                                                        m_cmdQueue(cmdQueue),
-                                                        m_stateAfter(stateAfter)
-        {
-            assert(m_device);
-            assert(m_cmdQueue);
-
-            m_gpuSync = std::make_unique<D3D12GpuSynchronizer>(device, cmdQueue, 1, m_gpuSyncWaitClock);
-            assert(m_gpuSync);
-
-            const auto bufferDesc = CreateBufferDesc(alignedSize);
-            m_uploadHeap = CreateResourceHeap(m_device, bufferDesc, ResourceHeapType::UploadHeap,
-                                              D3D12_RESOURCE_STATE_GENERIC_READ);
-            assert(m_uploadHeap);
-            m_uploadHeap->SetName((L"Upload heap - Texture - " + debugName).c_str());
-
-            // Create default heap
-            m_defaultHeap = CreateResourceHeap(m_device, resourceDesc, ResourceHeapType::DefaultHeap,
-                                               D3D12_RESOURCE_STATE_COPY_DEST);
-            assert(m_defaultHeap);
-            m_defaultHeap->SetName(debugName.c_str());
-
-            // TODO is it guaranteed that at this point cmd allocator wont be used by the gpu?
-            AssertIfFailed(context.m_cmdAllocator->Reset());
-            AssertIfFailed(context.m_cmdList->Reset(context.m_cmdAllocator.Get(), nullptr));
-        }
-        
-        ID3D12ResourcePtr GetUploadedResource() const { return m_defaultHeap; }
-
-        ~UploaderHelper()
-        {
-            D3D12_RESOURCE_BARRIER copyDestToReadDest;
-            copyDestToReadDest.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-            copyDestToReadDest.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-            copyDestToReadDest.Transition.pResource = m_defaultHeap.Get();
-            copyDestToReadDest.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-            copyDestToReadDest.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-            copyDestToReadDest.Transition.StateAfter = m_stateAfter;
-
-            m_context.m_cmdList->ResourceBarrier(1, &copyDestToReadDest);
-
-            // Execute command list
-            AssertIfFailed(m_context.m_cmdList->Close());
-            ID3D12CommandList* ppCommandLists[] = { m_context.m_cmdList.Get() };
-            m_cmdQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
-
-            // Wait for the command list to finish executing on the gpu
-            m_gpuSync->WaitAll();
-        }
-
-    protected:
-        const D3D12CommittedResourceAllocator::Context& m_context;
-
-        ID3D12DevicePtr         m_device;
-        ID3D12CommandQueuePtr   m_cmdQueue;
-        D3D12GpuSynchronizerPtr m_gpuSync;
-
-        D3D12_RESOURCE_STATES m_stateAfter;
-
-        ID3D12ResourcePtr   m_uploadHeap;
-        ID3D12ResourcePtr   m_defaultHeap;
-
-        StopClock m_gpuSyncWaitClock;
-    };
-
-    class UploadHelperBuffer : public UploaderHelper
-    {
-    public:
-        UploadHelperBuffer(const D3D12CommittedResourceAllocator::Context& context, 
-                           ID3D12DevicePtr device, ID3D12CommandQueuePtr cmdQueue,
-                           const void* src, size_t sizeBytes, size_t alignedSize, 
-                           const std::wstring& debugName) : UploaderHelper(context, device,
-                                                                           cmdQueue, 
-                                                                           CreateBufferDesc(alignedSize),
-                                                                           alignedSize,
-                                                                           D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, 
-                                                                           debugName),
-                                                            m_alignedSize(alignedSize)
-        {
-            MemCpyBuffer(src, sizeBytes);
-            EnqueueBufferCopyCmd();
-        }
-
-    private:
-        size_t m_alignedSize;
-
-        void MemCpyBuffer(const void* src, size_t sizeBytes)
-        {
-            BYTE* destUploadHeapPtr = nullptr;
-            AssertIfFailed(m_uploadHeap->Map(0, NULL, reinterpret_cast<void**>(&destUploadHeapPtr)));
-            assert(destUploadHeapPtr);
-
-            memcpy(destUploadHeapPtr, src, sizeBytes);
-
-            m_uploadHeap->Unmap(0, NULL);
-        }
-
-        void EnqueueBufferCopyCmd()
-        {
-            const UINT64 dstOffset = 0;
-            const UINT64 srcOffset = 0;
-            const UINT64 numBytes = m_alignedSize;
-            m_context.m_cmdList->CopyBufferRegion(m_defaultHeap.Get(), dstOffset, m_uploadHeap.Get(), srcOffset, numBytes);
-        }
-    };
-
-    class UploadHelperTexture : public UploaderHelper
-    {
-    public:
-        UploadHelperTexture(const D3D12CommittedResourceAllocator::Context& context,
-                            ID3D12DevicePtr device, ID3D12CommandQueuePtr cmdQueue,
-                            const D3D12_RESOURCE_DESC& resourceDesc,
-                            const SubresourcesFootPrint& subresourcesFootPrint,
-                            const std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
-                            const std::wstring& debugName) : UploaderHelper(context, device,
-                                                                            cmdQueue, resourceDesc, 
-                                                                            subresourcesFootPrint.m_requiredSize,
-                                                                            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-                                                                            debugName)
-        {
-            MemCpySubresources(subresourcesFootPrint, subresources);
-            EnqueueTextureCopyCmd(subresourcesFootPrint.m_layouts);
-        }
-
-    private:
-        void MemCpySubresources(const SubresourcesFootPrint& subresourcesFootPrint,
-                                const std::vector<D3D12_SUBRESOURCE_DATA>& subresources)
-        {
-            BYTE* uploadHeapData = nullptr;
-            AssertIfFailed(m_uploadHeap->Map(0, NULL, reinterpret_cast<void**>(&uploadHeapData)));
-
-            for (UINT i = 0; i < subresources.size(); ++i)
-            {
-                assert(subresourcesFootPrint.m_rowSizesInBytes[i] <= (SIZE_T)-1);
-                const auto& layout = subresourcesFootPrint.m_layouts[i];
-                const auto& rowSizeBytes = subresourcesFootPrint.m_rowSizesInBytes[i];
-                const auto& rowsCount = subresourcesFootPrint.m_rowsCounts[i];
-
-                const BYTE* srcData = reinterpret_cast<const BYTE*>(subresources[i].pData);
-                SIZE_T srcRowPitch = subresources[i].RowPitch;
-                SIZE_T srcSlicePitch = subresources[i].SlicePitch;
-
-                BYTE* dstData = uploadHeapData + layout.Offset;
-                SIZE_T dstRowPitch = layout.Footprint.RowPitch;
-                SIZE_T dstSlicePitch = layout.Footprint.RowPitch * rowsCount;
-                for (UINT z = 0; z < layout.Footprint.Depth; ++z)
-                {
-                    BYTE* pDestSlice = dstData + dstSlicePitch * z;
-                    const BYTE* pSrcSlice = srcData + srcSlicePitch * z;
-                    for (UINT y = 0; y < rowsCount; ++y)
-                    {
-                        memcpy(pDestSlice + dstRowPitch * y,
-                            pSrcSlice + srcRowPitch * y,
-                            rowSizeBytes);
-                    }
-                }
-            }
-
-            m_uploadHeap->Unmap(0, NULL);
-        }
-
-        void EnqueueTextureCopyCmd(const std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& layouts)
-        {
-            D3D12_TEXTURE_COPY_LOCATION dest;
-            dest.pResource = m_defaultHeap.Get();
-            dest.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-
-            D3D12_TEXTURE_COPY_LOCATION src;
-            src.pResource = m_uploadHeap.Get();
-            src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-
-            for (UINT i = 0; i < layouts.size(); ++i)
-            {
-                src.PlacedFootprint = layouts[i];
-                dest.SubresourceIndex = i;
-                m_context.m_cmdList->CopyTextureRegion(&dest, 0, 0, 0, &src, nullptr);
-            }
-        }
-    };
 }
 
 D3D12CommittedResourceAllocator::D3D12CommittedResourceAllocator(ID3D12DevicePtr device,
-                                                                 ID3D12CommandQueuePtr cmdQueue) :  m_device(device),
-                                                                                                    m_cmdQueue(cmdQueue)
+                                                                 D3D12UploadQueue* uploadQueue) :   m_device(device),
+                                                                                                    m_uploadQueue(uploadQueue)
 {
     assert(m_device);
-    assert(m_cmdQueue);
-
-    AssertIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-                    IID_PPV_ARGS(&m_uploadingContext.m_cmdAllocator)));
-    assert(m_uploadingContext.m_cmdAllocator);
-
-    m_uploadingContext.m_cmdAllocator->SetName(L"Command Allocator D3D12CommittedResourceAllocator");
-
-    AssertIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                               m_uploadingContext.m_cmdAllocator.Get(), 
-                                               nullptr, IID_PPV_ARGS(&m_uploadingContext.m_cmdList)));
-    assert(m_uploadingContext.m_cmdList);
-    AssertIfFailed(m_uploadingContext.m_cmdList->Close());
-
-    m_uploadingContext.m_cmdList->SetName(L"Command List D3D12CommittedResourceAllocator");
+    assert(m_uploadQueue);
 }
 
 D3D12CommittedBuffer D3D12CommittedResourceAllocator::AllocateReadBackBuffer(size_t sizeBytes, size_t alignment,
@@ -337,27 +80,59 @@ D3D12CommittedBuffer D3D12CommittedResourceAllocator::AllocateBuffer(const void*
                                                                      size_t sizeBytes, size_t alignment, 
                                                                      const std::wstring& debugName)
 {
-    AssertContextIsValid(m_uploadingContext);
     const auto alignedSize = AlignToPowerof2(sizeBytes, alignment);
 
-    UploadHelperBuffer uploadHelper(m_uploadingContext, m_device, m_cmdQueue, data, sizeBytes, alignedSize, debugName);
-    auto resource = uploadHelper.GetUploadedResource();
+    auto resource = CreateResourceHeap(m_device, CreateBufferDesc(alignedSize), ResourceHeapType::DefaultHeap,
+                                       D3D12_RESOURCE_STATE_COPY_DEST);
     assert(resource);
+    resource->SetName(debugName.c_str());
+
+    const auto uploadId = m_uploadQueue->EnqueueBufferUpload(resource, data, sizeBytes, 
+                                                             D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+
+    return { resource, alignedSize, uploadId };
+}
+
+D3D12CommittedBuffer D3D12CommittedResourceAllocator::AllocateBuffer(size_t sizeBytes, size_t alignment,
+                                                                     const std::wstring& debugName)
+{
+    const auto alignedSize = AlignToPowerof2(sizeBytes, alignment);
+
+    auto resource = CreateResourceHeap(m_device, CreateBufferDesc(alignedSize), ResourceHeapType::DefaultHeap,
+                                       D3D12_RESOURCE_STATE_COPY_DEST);
+    assert(resource);
+    resource->SetName(debugName.c_str());
 
     return { resource, alignedSize };
 }
 
-ID3D12ResourcePtr D3D12CommittedResourceAllocator::AllocateTexture(const std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
-                                                                   const D3D12_RESOURCE_DESC& desc, 
-                                                                   const std::wstring& debugName)
+void D3D12CommittedResourceAllocator::UploadBufferRegion(D3D12CommittedBuffer& buffer, const void* data,
+                                                         size_t sizeBytes, size_t offsetBytes)
 {
-    AssertContextIsValid(m_uploadingContext);
+    assert(buffer.m_resource);
+    assert(offsetBytes + sizeBytes <= buffer.m_alignedSize);
+
+    // NOTE the buffer stays in copy dest until its first upload
+    const auto stateBefore = buffer.m_uploadId == D3D12UploadQueue::m_finishedUploadId ?
+                             D3D12_RESOURCE_STATE_COPY_DEST : D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
 
-    auto subresourcesFootPrint = CreateSubresourceFootPrint(m_device, subresources.size(), desc);
+    buffer.m_uploadId = m_uploadQueue->EnqueueBufferRegionUpload(buffer.m_resource, offsetBytes, data, sizeBytes,
+                                                                 stateBefore,
+                                                                 D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+}
 
-    UploadHelperTexture uploadHelper(m_uploadingContext, m_device, m_cmdQueue, desc, subresourcesFootPrint, subresources, debugName);
+D3D12CommittedTexture D3D12CommittedResourceAllocator::AllocateTexture(const std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+                                                                       const D3D12_RESOURCE_DESC& desc, 
+                                                                       const std::wstring& debugName)
+{
+    auto resource = CreateResourceHeap(m_device, desc, ResourceHeapType::DefaultHeap, D3D12_RESOURCE_STATE_COPY_DEST);
+    assert(resource);
+    resource->SetName(debugName.c_str());
 
-    return uploadHelper.GetUploadedResource();
+    const auto uploadId = m_uploadQueue->EnqueueTextureUpload(resource, desc, subresources,
+                                                              D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+    return { resource, uploadId };
 }
 
 ID3D12ResourcePtr D3D12Basics::CreateResourceHeap(ID3D12DevicePtr device, const D3D12_RESOURCE_DESC& resourceDesc, 
@@ -385,14 +160,18 @@ D3D12DynamicBufferAllocation::~D3D12DynamicBufferAllocation() = default;
 
 D3D12DynamicBufferAllocator::D3D12DynamicBufferAllocator(ID3D12DevicePtr device, 
                                                          size_t smallPageSizeInBytes,
-                                                         size_t bigPageSizeInBytes) :   m_device(device),
-                                                                                        m_smallPageSizeInBytes(smallPageSizeInBytes),
-                                                                                        m_bigPageSizeInBytes(bigPageSizeInBytes)
+                                                         size_t bigPageSizeInBytes,
+                                                         Strategy strategy) :   m_device(device),
+                                                                                m_smallPageSizeInBytes(smallPageSizeInBytes),
+                                                                                m_bigPageSizeInBytes(bigPageSizeInBytes),
+                                                                                m_strategy(strategy)
 {
     assert(m_device);
     assert(m_smallPageSizeInBytes > 0);
     assert(m_bigPageSizeInBytes > 0);
     assert(m_smallPageSizeInBytes < m_bigPageSizeInBytes);
+    assert(m_strategy != Strategy::Buddy || 
+           (D3D12Basics::IsPowerOf2(m_smallPageSizeInBytes) && D3D12Basics::IsPowerOf2(m_bigPageSizeInBytes)));
 
     AllocateSmallPage();
     AllocateBigPage();
@@ -424,6 +203,140 @@ D3D12DynamicBufferAllocation D3D12DynamicBufferAllocator::Allocate(size_t sizeIn
     const auto alignedSize = AlignToPowerof2(sizeInBytes, alignment);
     assert(alignedSize >= sizeInBytes);
 
+    D3D12DynamicBufferAllocationBlockPtr allocationBlock = (m_strategy == Strategy::Buddy) ? 
+                                                           AllocateBuddy(pages, isSmallPages, alignedSize, alignment) :
+                                                           AllocateFirstFit(pages, isSmallPages, alignedSize, alignment);
+    assert(allocationBlock);
+    assert(allocationBlock->m_pageIndex < pages.size());
+    auto& page = pages[allocationBlock->m_pageIndex];
+
+    // Calculating the aligned memory ptrs
+    const auto alignedOffset = AlignToPowerof2(allocationBlock->m_offset, alignment);
+    D3D12DynamicBufferAllocation allocation;
+    allocation.m_cpuPtr = page.m_cpuPtr + alignedOffset;
+    allocation.m_gpuPtr = page.m_gpuPtr + alignedOffset;
+    allocation.m_size = alignedSize;
+    allocation.m_allocationBlock = std::move(allocationBlock);
+
+    return allocation;
+}
+
+void D3D12DynamicBufferAllocator::Deallocate(D3D12DynamicBufferAllocation& allocation)
+{
+    assert(allocation.m_allocationBlock);
+    auto& pages = allocation.m_allocationBlock->m_isSmallPage ? m_smallPages : m_bigPages;
+    assert(allocation.m_allocationBlock->m_pageIndex < pages.size());
+
+    auto pageIndex = allocation.m_allocationBlock->m_pageIndex;
+    auto& page = pages[pageIndex];
+
+    if (m_strategy == Strategy::Buddy)
+    {
+        assert(page.m_buddyAllocator);
+        page.m_buddyAllocator->Deallocate(allocation.m_allocationBlock->m_offset);
+        allocation.m_allocationBlock.reset();
+        return;
+    }
+
+    page.m_freeBlocks.push_back(std::move(allocation.m_allocationBlock));
+
+    //// TODO erasing pages does not work. It introduces glitches and crashes. Fix it
+    //// TODO does destroying the resource immediately makes sense? would it better to 
+    //// have a strategy based on size, frequency of use and other pages size?
+    //size_t freeSize = 0;
+    //for (auto& freeBlock : page.m_freeBlocks)
+    //    freeSize += freeBlock->m_size;
+
+    //// TODO linear time! change to list for const time?
+    //if (freeSize == m_pageSizeInBytes)
+    //    m_pages.erase(m_pages.begin() + pageIndex);
+}
+
+D3D12DynamicBufferAllocator::Stats D3D12DynamicBufferAllocator::GetStats() const
+{
+    Stats stats;
+    stats.m_smallPagesCount = m_smallPages.size();
+    stats.m_bigPagesCount = m_bigPages.size();
+
+    auto accumulatePages = [this, &stats](const std::vector<Page>& pages, size_t pageSizeInBytes)
+    {
+        for (const auto& page : pages)
+        {
+            stats.m_totalSizeBytes += pageSizeInBytes;
+            if (m_strategy == Strategy::Buddy)
+            {
+                stats.m_freeSizeBytes += page.m_buddyAllocator->FreeSizeBytes();
+                stats.m_largestFreeBlockSizeBytes = std::max(stats.m_largestFreeBlockSizeBytes, 
+                                                             page.m_buddyAllocator->LargestFreeBlockSizeBytes());
+            }
+            else
+            {
+                for (const auto& freeBlock : page.m_freeBlocks)
+                {
+                    stats.m_freeSizeBytes += freeBlock->m_size;
+                    stats.m_largestFreeBlockSizeBytes = std::max(stats.m_largestFreeBlockSizeBytes, freeBlock->m_size);
+                }
+            }
+        }
+    };
+    accumulatePages(m_smallPages, m_smallPageSizeInBytes);
+    accumulatePages(m_bigPages, m_bigPageSizeInBytes);
+
+    return stats;
+}
+
+float D3D12DynamicBufferAllocator::Stats::Fragmentation() const
+{
+    if (!m_freeSizeBytes)
+        return 0.0f;
+
+    return 1.0f - static_cast<float>(m_largestFreeBlockSizeBytes) / static_cast<float>(m_freeSizeBytes);
+}
+
+void D3D12DynamicBufferAllocator::AllocatePage(size_t pageSizeInBytes, std::vector<Page>& pages)
+{
+    Page page;
+    page.m_resource = D3D12CreateDynamicCommittedBuffer(m_device, pageSizeInBytes);
+    assert(page.m_resource);
+
+    page.m_gpuPtr = page.m_resource->GetGPUVirtualAddress();
+    assert(page.m_gpuPtr);
+    // TODO first page allocation passes the assert but not the second one. Investigate!
+    //assert(D3D12Basics::IsAlignedToPowerof2(gpuPtr, g_64kb));
+
+    D3D12_RANGE readRange{ 0, 0 };
+    D3D12Basics::AssertIfFailed(page.m_resource->Map(0, &readRange, reinterpret_cast<void**>(&page.m_cpuPtr)));
+    assert(D3D12Basics::IsAlignedToPowerof2(reinterpret_cast<size_t>(page.m_cpuPtr), g_4kb));
+
+    const size_t pageIndex = pages.size();
+    if (m_strategy == Strategy::Buddy)
+    {
+        page.m_buddyAllocator = std::make_unique<BuddyAllocator>(pageSizeInBytes, 
+                                                                 D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    }
+    else
+    {
+        D3D12DynamicBufferAllocationBlock allocationBlock{ 0, pageSizeInBytes, pageIndex, &pages == &m_smallPages };
+        D3D12DynamicBufferAllocationBlockPtr freeBlock = std::make_unique<D3D12DynamicBufferAllocationBlock>(std::move(allocationBlock));
+        page.m_freeBlocks.push_back(std::move(freeBlock));
+    }
+
+    pages.push_back(std::move(page));
+}
+
+void D3D12DynamicBufferAllocator::AllocateSmallPage()
+{
+    AllocatePage(m_smallPageSizeInBytes, m_smallPages);
+}
+
+void D3D12DynamicBufferAllocator::AllocateBigPage()
+{
+    AllocatePage(m_bigPageSizeInBytes, m_bigPages);
+}
+
+D3D12DynamicBufferAllocationBlockPtr D3D12DynamicBufferAllocator::AllocateFirstFit(std::vector<Page>& pages, bool isSmallPages,
+                                                                                   size_t alignedSize, size_t alignment)
+{
     D3D12DynamicBufferAllocationBlockPtr freeBlock = nullptr;
 
     // Linearly search through all the pages for a free block that fits the requested alignedSize
@@ -462,7 +375,6 @@ D3D12DynamicBufferAllocation D3D12DynamicBufferAllocator::Allocate(size_t sizeIn
     assert(freeBlock);
     assert(freeBlock->m_size >= alignedSize);
 
-    const auto alignedOffset = AlignToPowerof2(freeBlock->m_offset, alignment);
     const auto freeBlockOffset = freeBlock->m_offset;
     const auto freeBlockPageIndex = freeBlock->m_pageIndex;
 
@@ -471,71 +383,144 @@ D3D12DynamicBufferAllocation D3D12DynamicBufferAllocator::Allocate(size_t sizeIn
     freeBlock->m_offset += totalSize;
     freeBlock->m_size -= totalSize;
     assert(freeBlockPageIndex < pages.size());
-    auto& page = pages[freeBlockPageIndex];
-    page.m_freeBlocks.push_back(std::move(freeBlock));
+    pages[freeBlockPageIndex].m_freeBlocks.push_back(std::move(freeBlock));
 
-    // Calculating the aligned memory ptrs
-    D3D12DynamicBufferAllocation allocation;
-    allocation.m_cpuPtr = page.m_cpuPtr + alignedOffset;
-    allocation.m_gpuPtr = page.m_gpuPtr + alignedOffset;
-    allocation.m_size = alignedSize;
     D3D12Basics::D3D12DynamicBufferAllocationBlock allocationBlock { freeBlockOffset, totalSize, freeBlockPageIndex, isSmallPages };
-    allocation.m_allocationBlock = std::make_unique<D3D12Basics::D3D12DynamicBufferAllocationBlock>(std::move(allocationBlock));
+    return std::make_unique<D3D12Basics::D3D12DynamicBufferAllocationBlock>(std::move(allocationBlock));
+}
 
-    return allocation;
+D3D12DynamicBufferAllocationBlockPtr D3D12DynamicBufferAllocator::AllocateBuddy(std::vector<Page>& pages, bool isSmallPages,
+                                                                                size_t alignedSize, size_t alignment)
+{
+    // NOTE a buddy block offset is aligned to the block size so asking for a block
+    // at least as big as the alignment gives aligned offsets for free
+    const size_t requestedSize = std::max(alignedSize, alignment);
+
+    size_t pageIndex = 0;
+    size_t offset = BuddyAllocator::m_invalidOffset;
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
+        offset = pages[i].m_buddyAllocator->Allocate(requestedSize);
+        if (offset != BuddyAllocator::m_invalidOffset)
+        {
+            pageIndex = i;
+            break;
+        }
+    }
+
+    // No memory no problem. Allocate another page!
+    if (offset == BuddyAllocator::m_invalidOffset)
+    {
+        if (isSmallPages)
+            AllocateSmallPage();
+        else
+            AllocateBigPage();
+
+        pageIndex = pages.size() - 1;
+        offset = pages.back().m_buddyAllocator->Allocate(requestedSize);
+    }
+    assert(offset != BuddyAllocator::m_invalidOffset);
+    assert(D3D12Basics::IsAlignedToPowerof2(offset, alignment));
+
+    const size_t blockSize = pages[pageIndex].m_buddyAllocator->BlockSizeBytes(requestedSize);
+    D3D12Basics::D3D12DynamicBufferAllocationBlock allocationBlock { offset, blockSize, pageIndex, isSmallPages };
+    return std::make_unique<D3D12Basics::D3D12DynamicBufferAllocationBlock>(std::move(allocationBlock));
 }
 
-void D3D12DynamicBufferAllocator::Deallocate(D3D12DynamicBufferAllocation& allocation)
+D3D12FrameLinearAllocator::D3D12FrameLinearAllocator(ID3D12DevicePtr device, size_t pageSizeInBytes,
+                                                     unsigned int framesCount) :    m_device(device),
+                                                                                    m_pageSizeInBytes(pageSizeInBytes),
+                                                                                    m_segments(framesCount),
+                                                                                    m_currentSegment(0)
 {
-    assert(allocation.m_allocationBlock);
-    auto& pages = allocation.m_allocationBlock->m_isSmallPage ? m_smallPages : m_bigPages;
-    assert(allocation.m_allocationBlock->m_pageIndex < pages.size());
+    assert(m_device);
+    assert(m_pageSizeInBytes > 0);
+    assert(framesCount > 0);
+}
 
-    auto pageIndex = allocation.m_allocationBlock->m_pageIndex;
-    auto& page = pages[pageIndex];
-    page.m_freeBlocks.push_back(std::move(allocation.m_allocationBlock));
+D3D12FrameLinearAllocator::~D3D12FrameLinearAllocator()
+{
+    D3D12_RANGE readRange{ 0, 0 };
+    for (auto& segment : m_segments)
+    {
+        for (auto& page : segment.m_pages)
+            page.m_resource->Unmap(0, &readRange);
+    }
+}
 
-    //// TODO erasing pages does not work. It introduces glitches and crashes. Fix it
-    //// TODO does destroying the resource immediately makes sense? would it better to 
-    //// have a strategy based on size, frequency of use and other pages size?
-    //size_t freeSize = 0;
-    //for (auto& freeBlock : page.m_freeBlocks)
-    //    freeSize += freeBlock->m_size;
+D3D12TransientAllocation D3D12FrameLinearAllocator::Allocate(size_t sizeInBytes, size_t alignment)
+{
+    assert(sizeInBytes);
+    assert(alignment);
+    assert(D3D12Basics::IsPowerOf2(alignment));
 
-    //// TODO linear time! change to list for const time?
-    //if (freeSize == m_pageSizeInBytes)
-    //    m_pages.erase(m_pages.begin() + pageIndex);
+    const auto alignedSize = AlignToPowerof2(sizeInBytes, alignment);
+    auto& segment = m_segments[m_currentSegment];
+
+    // Bump the offset in the current page. Move to the next page when it doesnt fit.
+    while (segment.m_currentPage < segment.m_pages.size())
+    {
+        const auto& page = segment.m_pages[segment.m_currentPage];
+        const auto alignedOffset = AlignToPowerof2(segment.m_offset, alignment);
+        if (alignedOffset + alignedSize <= page.m_size)
+        {
+            segment.m_offset = alignedOffset + alignedSize;
+            segment.m_usedSizeBytes += alignedSize;
+            return { page.m_cpuPtr + alignedOffset, page.m_gpuPtr + alignedOffset, alignedSize };
+        }
+
+        ++segment.m_currentPage;
+        segment.m_offset = 0;
+    }
+
+    // No memory no problem. Allocate another page!
+    // NOTE allocations bigger than the page size get a page of their own size
+    segment.m_pages.push_back(AllocatePage(std::max(m_pageSizeInBytes, alignedSize)));
+    const auto& page = segment.m_pages.back();
+    segment.m_currentPage = segment.m_pages.size() - 1;
+    segment.m_offset = alignedSize;
+    segment.m_usedSizeBytes += alignedSize;
+
+    return { page.m_cpuPtr, page.m_gpuPtr, alignedSize };
 }
 
-void D3D12DynamicBufferAllocator::AllocatePage(size_t pageSizeInBytes, std::vector<Page>& pages)
+void D3D12FrameLinearAllocator::ResetFrame(unsigned int frameIndex)
+{
+    assert(frameIndex < m_segments.size());
+    m_currentSegment = frameIndex;
+
+    auto& segment = m_segments[m_currentSegment];
+    segment.m_currentPage = 0;
+    segment.m_offset = 0;
+    segment.m_usedSizeBytes = 0;
+}
+
+size_t D3D12FrameLinearAllocator::PagesCount() const
+{
+    size_t pagesCount = 0;
+    for (const auto& segment : m_segments)
+        pagesCount += segment.m_pages.size();
+
+    return pagesCount;
+}
+
+size_t D3D12FrameLinearAllocator::CurrentFrameUsedSizeBytes() const
+{
+    return m_segments[m_currentSegment].m_usedSizeBytes;
+}
+
+D3D12FrameLinearAllocator::Page D3D12FrameLinearAllocator::AllocatePage(size_t pageSizeInBytes)
 {
     Page page;
     page.m_resource = D3D12CreateDynamicCommittedBuffer(m_device, pageSizeInBytes);
     assert(page.m_resource);
+    page.m_size = pageSizeInBytes;
 
     page.m_gpuPtr = page.m_resource->GetGPUVirtualAddress();
     assert(page.m_gpuPtr);
-    // TODO first page allocation passes the assert but not the second one. Investigate!
-    //assert(D3D12Basics::IsAlignedToPowerof2(gpuPtr, g_64kb));
 
     D3D12_RANGE readRange{ 0, 0 };
     D3D12Basics::AssertIfFailed(page.m_resource->Map(0, &readRange, reinterpret_cast<void**>(&page.m_cpuPtr)));
-    assert(D3D12Basics::IsAlignedToPowerof2(reinterpret_cast<size_t>(page.m_cpuPtr), g_4kb));
-
-    const size_t pageIndex = pages.size();
-    D3D12DynamicBufferAllocationBlock allocationBlock{ 0, pageSizeInBytes, pageIndex };
-    D3D12DynamicBufferAllocationBlockPtr freeBlock = std::make_unique<D3D12DynamicBufferAllocationBlock>(std::move(allocationBlock));
-    page.m_freeBlocks.push_back(std::move(freeBlock));
-
-    pages.push_back(std::move(page));
-}
 
-void D3D12DynamicBufferAllocator::AllocateSmallPage()
-{
-    AllocatePage(m_smallPageSizeInBytes, m_smallPages);
-}
-
-void D3D12DynamicBufferAllocator::AllocateBigPage()
-{
-    AllocatePage(m_bigPageSizeInBytes, m_bigPages);
+    return page;
 }
\ No newline at end of file
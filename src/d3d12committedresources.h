@@ -3,6 +3,8 @@
 // project includes
 #include "d3d12fwd.h"
 #include "d3d12gpu_sync.h"
+#include "buddyallocator.h"
+#include "d3d12uploadqueue.h"
 
 // c++ includes
 #include <string>
@@ -14,35 +16,46 @@
 
 namespace D3D12Basics
 {
+    // NOTE the resources are usable by the gpu once the upload queue submitted m_uploadId.
+    //      m_uploadId is D3D12UploadQueue::m_finishedUploadId when there is nothing to upload.
     struct D3D12CommittedBuffer
     {
-        ID3D12ResourcePtr   m_resource;
-        size_t              m_alignedSize;
+        ID3D12ResourcePtr           m_resource;
+        size_t                      m_alignedSize;
+        D3D12UploadQueue::UploadId  m_uploadId = D3D12UploadQueue::m_finishedUploadId;
     };
 
+    struct D3D12CommittedTexture
+    {
+        ID3D12ResourcePtr           m_resource;
+        D3D12UploadQueue::UploadId  m_uploadId = D3D12UploadQueue::m_finishedUploadId;
+    };
+
+    // Creates committed resources in the default heap and enqueues the copy of their
+    // initial data in the upload queue. It doesnt block.
     class D3D12CommittedResourceAllocator
     {
     public:
-        struct Context
-        {
-            ID3D12CommandAllocatorPtr       m_cmdAllocator;
-            ID3D12GraphicsCommandListPtr    m_cmdList;
-        };
-
-        D3D12CommittedResourceAllocator(ID3D12DevicePtr device, ID3D12CommandQueuePtr cmdQueue);
+        D3D12CommittedResourceAllocator(ID3D12DevicePtr device, D3D12UploadQueue* uploadQueue);
 
         D3D12CommittedBuffer AllocateReadBackBuffer(size_t sizeBytes, size_t alignment, const std::wstring& debugName);
 
         D3D12CommittedBuffer AllocateBuffer(const void* data, size_t sizeBytes,
                                             size_t alignment, const std::wstring& debugName);
 
-        ID3D12ResourcePtr AllocateTexture(const std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
-                                          const D3D12_RESOURCE_DESC& desc, const std::wstring& debugName);
+        // NOTE no initial data, its regions are uploaded with UploadBufferRegion
+        D3D12CommittedBuffer AllocateBuffer(size_t sizeBytes, size_t alignment, const std::wstring& debugName);
+
+        // NOTE buffer.m_uploadId becomes the id of this upload, ie it only tells about the
+        //      last region uploaded. The rest of the buffer can be used by the gpu meanwhile.
+        void UploadBufferRegion(D3D12CommittedBuffer& buffer, const void* data, size_t sizeBytes,
+                                size_t offsetBytes);
+
+        D3D12CommittedTexture AllocateTexture(const std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+                                              const D3D12_RESOURCE_DESC& desc, const std::wstring& debugName);
     private:
         ID3D12DevicePtr         m_device;
-        ID3D12CommandQueuePtr   m_cmdQueue;
-
-        Context m_uploadingContext;
+        D3D12UploadQueue*       m_uploadQueue;
     };
 
     // TODO what to do with this function?
@@ -75,19 +88,42 @@ namespace D3D12Basics
         D3D12DynamicBufferAllocationBlockPtr m_allocationBlock;
     };
 
-    // Straightforward free list allocator with first fit strategy. No coalescing.
+    // Two strategies:
+    // - FirstFit: straightforward free list allocator with first fit strategy. No coalescing.
+    // - Buddy: every page is managed by a BuddyAllocator. O(log n) allocation and 
+    //   deallocation and freed blocks are coalesced with their buddies. Wastes up to half
+    //   of a block as the sizes are rounded up to the next power of 2.
     // Grows a page when cant find a suitable space.
     // Page is aligned to the smallest 64kb  or 128kb multiple of pageSizeInBytes
-    // TODO implement buddy allocator
     // NOTE: D3D12_RESOURCE_DIMENSION is D3D12_RESOURCE_DIMENSION_BUFFER on the D3D12_RESOURCE_DESC
     // used when calling to CreateCommittedResource
     class D3D12DynamicBufferAllocator
     {
     public:
+        enum class Strategy
+        {
+            FirstFit,
+            Buddy
+        };
+
+        struct Stats
+        {
+            size_t m_smallPagesCount            = 0;
+            size_t m_bigPagesCount              = 0;
+            size_t m_totalSizeBytes             = 0;
+            size_t m_freeSizeBytes              = 0;
+            size_t m_largestFreeBlockSizeBytes  = 0;
+
+            // 0 when all the free memory is contiguous, close to 1 when it is scattered
+            // in a lot of small blocks
+            float Fragmentation() const;
+        };
+
         // NOTE pageSizeInBytes doesnt have to be aligned as it will be aligned
         // to 64kb or 128kb internally by default
+        // NOTE Buddy strategy requires power of 2 page sizes
         D3D12DynamicBufferAllocator(ID3D12DevicePtr device, size_t smallPageSizeInBytes,
-                                    size_t bigPageSizeInBytes);
+                                    size_t bigPageSizeInBytes, Strategy strategy = Strategy::FirstFit);
 
         ~D3D12DynamicBufferAllocator();
 
@@ -97,6 +133,8 @@ namespace D3D12Basics
 
         void Deallocate(D3D12DynamicBufferAllocation& allocation);
 
+        Stats GetStats() const;
+
     private:
 
         struct Page
@@ -114,12 +152,16 @@ namespace D3D12Basics
             D3D12_GPU_VIRTUAL_ADDRESS   m_gpuPtr;
 
             std::list<D3D12DynamicBufferAllocationBlockPtr>        m_freeBlocks;
+
+            // NOTE only used by the Buddy strategy
+            std::unique_ptr<BuddyAllocator>                         m_buddyAllocator;
         };
 
         ID3D12DevicePtr m_device;
 
-        const size_t m_smallPageSizeInBytes;
-        const size_t m_bigPageSizeInBytes;
+        const size_t    m_smallPageSizeInBytes;
+        const size_t    m_bigPageSizeInBytes;
+        const Strategy  m_strategy;
 
         std::vector<Page> m_smallPages;
         std::vector<Page> m_bigPages;
@@ -127,5 +169,70 @@ namespace D3D12Basics
         void AllocatePage(size_t papageSizeInBytesgeSize, std::vector<Page>& pages);
         void AllocateSmallPage();
         void AllocateBigPage();
+
+        D3D12DynamicBufferAllocationBlockPtr AllocateFirstFit(std::vector<Page>& pages, bool isSmallPages,
+                                                              size_t alignedSize, size_t alignment);
+        D3D12DynamicBufferAllocationBlockPtr AllocateBuddy(std::vector<Page>& pages, bool isSmallPages,
+                                                           size_t alignedSize, size_t alignment);
+    };
+
+    struct D3D12TransientAllocation
+    {
+        uint8_t*                    m_cpuPtr = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS   m_gpuPtr = 0;
+        size_t                      m_size = 0;
+    };
+
+    // Linear allocator for data that lives only during one frame, ie constants rewritten
+    // every frame. There is a segment of upload pages per frame in flight. Allocating
+    // bumps the offset of the current segment: no per allocation bookkeeping and no
+    // deallocation, the whole segment is reset once the gpu is done with its frame.
+    // Segments grow a page when the current one is full and keep their pages so the
+    // memory used is the peak memory written in one frame times the frames in flight.
+    // NOTE not thread safe
+    class D3D12FrameLinearAllocator
+    {
+    public:
+        D3D12FrameLinearAllocator(ID3D12DevicePtr device, size_t pageSizeInBytes, unsigned int framesCount);
+
+        ~D3D12FrameLinearAllocator();
+
+        D3D12FrameLinearAllocator(const D3D12FrameLinearAllocator&) = delete;
+
+        D3D12TransientAllocation Allocate(size_t sizeInBytes, size_t alignment);
+
+        // Makes frameIndex segment the current one and resets it. The caller has to
+        // guarantee the gpu is done with the frame that used that segment.
+        void ResetFrame(unsigned int frameIndex);
+
+        size_t PagesCount() const;
+
+        size_t CurrentFrameUsedSizeBytes() const;
+
+    private:
+        struct Page
+        {
+            ID3D12ResourcePtr           m_resource;
+            uint8_t*                    m_cpuPtr;
+            D3D12_GPU_VIRTUAL_ADDRESS   m_gpuPtr;
+            size_t                      m_size;
+        };
+
+        struct Segment
+        {
+            std::vector<Page>   m_pages;
+            size_t              m_currentPage   = 0;
+            size_t              m_offset        = 0;
+            size_t              m_usedSizeBytes = 0;
+        };
+
+        ID3D12DevicePtr m_device;
+
+        const size_t m_pageSizeInBytes;
+
+        std::vector<Segment>    m_segments;
+        unsigned int            m_currentSegment;
+
+        Page AllocatePage(size_t pageSizeInBytes);
     };
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "d3d12swapchain.h"
 #include "d3d12committedresources.h"
 #include "d3d12gpu_sync.h"
+#include "d3d12nulldevice.h"
 
 // c++ includes
 #include <sstream>
@@ -105,6 +106,8 @@ namespace D3D12Basics
 {
     const uint32_t D3D12Gpu::m_smallPageSize   = g_64kb;
     const uint32_t D3D12Gpu::m_bigPageSize     = g_4mb;
+    const uint32_t D3D12Gpu::m_transientPageSize = g_1mb;
+    const uint32_t D3D12Gpu::m_stagingPageSize   = g_16mb;
 
     struct D3D12GpuShareableState
     {
@@ -209,7 +212,8 @@ D3D12GraphicsCmdList::D3D12GraphicsCmdList(D3D12GpuShareableState* gpuState,
                                            FrameStats::NamedCmdListTimes& cmdListsTimes,
                                            StopClock::SplitTimeBuffer& splitTimes,
                                            const std::wstring& debugName)   :   m_gpuState(gpuState), 
-                                                                                m_cmdListsTimes(cmdListsTimes)
+                                                                                m_cmdListsTimes(cmdListsTimes),
+                                                                                m_nullCmdList(nullptr)
 {
     assert(m_gpuState);
     assert(m_gpuState->m_device);
@@ -241,6 +245,21 @@ D3D12GraphicsCmdList::D3D12GraphicsCmdList(D3D12GpuShareableState* gpuState,
     m_debugName = debugName;
 }
 
+D3D12GraphicsCmdList::D3D12GraphicsCmdList(D3D12GpuShareableState* gpuState,
+                                           FrameStats::NamedCmdListTimes& cmdListsTimes,
+                                           const std::wstring& debugName)   :   m_gpuState(gpuState),
+                                                                                m_debugName(debugName),
+                                                                                m_cmdListsTimes(cmdListsTimes)
+{
+    assert(m_gpuState);
+
+    m_nullCmdList = new D3D12NullGraphicsCmdList();
+    assert(m_nullCmdList);
+
+    // Note the cmd list is created with a ref count of 1 that is handed over to the com ptr
+    m_cmdList.Attach(m_nullCmdList);
+}
+
 D3D12GraphicsCmdList::~D3D12GraphicsCmdList()
 {
     m_cmdListsTimes.erase(m_debugName);
@@ -248,12 +267,19 @@ D3D12GraphicsCmdList::~D3D12GraphicsCmdList()
 
 void D3D12GraphicsCmdList::Open()
 {
-    auto cmdAllocator = m_cmdAllocators[m_gpuState->m_currentFrameIndex];
+    if (IsNull())
+    {
+        AssertIfFailed(m_cmdList->Reset(nullptr, nullptr));
+    }
+    else
+    {
+        auto cmdAllocator = m_cmdAllocators[m_gpuState->m_currentFrameIndex];
 
-    AssertIfFailed(cmdAllocator->Reset());
-    AssertIfFailed(m_cmdList->Reset(cmdAllocator.Get(), nullptr));
+        AssertIfFailed(cmdAllocator->Reset());
+        AssertIfFailed(m_cmdList->Reset(cmdAllocator.Get(), nullptr));
 
-    m_timeStamp->Begin();
+        m_timeStamp->Begin();
+    }
 
     ID3D12DescriptorHeap* ppHeaps[] = { m_gpuState->m_descriptorHeap };
     m_cmdList->SetDescriptorHeaps(1, ppHeaps);
@@ -261,31 +287,60 @@ void D3D12GraphicsCmdList::Open()
 
 void D3D12GraphicsCmdList::Close()
 {
-    m_timeStamp->End();
+    if (!IsNull())
+        m_timeStamp->End();
 
     AssertIfFailed(m_cmdList->Close());
 }
 
-D3D12Gpu::D3D12Gpu(bool isWaitableForPresentEnabled)    :    m_isWaitableForPresentEnabled(isWaitableForPresentEnabled),
-                                                             m_nextHandleId(0), m_currentFrame(0), m_stacksSetSize(1)
+const D3D12NullCmdListCounters& D3D12GraphicsCmdList::NullCounters() const
+{
+    assert(IsNull());
+
+    return m_nullCmdList->Counters();
+}
+
+D3D12Gpu::D3D12Gpu(bool isWaitableForPresentEnabled, Backend backend) :    m_backend(backend),
+                                                                            m_isWaitableForPresentEnabled(isWaitableForPresentEnabled),
+                                                                            m_currentFrame(0), m_stacksSetSize(1)
 {
     m_state = std::make_unique<D3D12GpuShareableState>();
     assert(m_state);
 
-    auto adapter = CreateDXGIInfrastructure();
-    assert(adapter);
+    if (IsNullBackend())
+    {
+        CreateNullDevice();
+    }
+    else
+    {
+        auto adapter = CreateDXGIInfrastructure();
+        assert(adapter);
 
-    CreateDevice(adapter);
+        CreateDevice(adapter);
+    }
     CheckFeatureSupport();
 
+    // NOTE the dynamic allocations live until FreeMemory, a copy per frame in flight that is
+    // only rewritten when its data changes, so they cant go in the per frame linear allocator
+    // (that one is the transient memory below). Buddy keeps their churn from fragmenting the
+    // pages. Its rounding to a power of 2 costs little here: the object data blocks are 128kb
+    // and the constant buffers are 256 bytes aligned anyway. Only the imgui buffers pay for it.
     m_dynamicMemoryAllocator = std::make_unique<D3D12DynamicBufferAllocator>(m_state->m_device, 
                                                                              m_smallPageSize, 
-                                                                             m_bigPageSize);
+                                                                             m_bigPageSize,
+                                                                             D3D12DynamicBufferAllocator::Strategy::Buddy);
     assert(m_dynamicMemoryAllocator);
 
+    m_transientMemoryAllocator = std::make_unique<D3D12FrameLinearAllocator>(m_state->m_device, m_transientPageSize,
+                                                                             D3D12GpuConfig::m_framesInFlight);
+    assert(m_transientMemoryAllocator);
+
     CreateCommandInfrastructure();
 
-    m_committedResourceAllocator = std::make_unique<D3D12CommittedResourceAllocator>(m_state->m_device, m_graphicsCmdQueue);
+    m_uploadQueue = std::make_unique<D3D12UploadQueue>(m_state->m_device, m_graphicsCmdQueue, m_stagingPageSize);
+    assert(m_uploadQueue);
+
+    m_committedResourceAllocator = std::make_unique<D3D12CommittedResourceAllocator>(m_state->m_device, m_uploadQueue.get());
     assert(m_committedResourceAllocator);
 
     CreateDescriptorHeaps();
@@ -310,6 +365,9 @@ unsigned int D3D12Gpu::GetFormatPlaneCount(DXGI_FORMAT format) const
 
 void D3D12Gpu::SetOutputWindow(HWND hwnd)
 {
+    // NOTE theres no output with the null backend
+    assert(!IsNullBackend());
+
     // NOTE only one output supported
     m_swapChain = std::make_unique<D3D12SwapChain>(hwnd, g_swapChainFormat, m_safestResolution,
                                                    m_factory, m_state->m_device, m_graphicsCmdQueue,
@@ -321,7 +379,7 @@ void D3D12Gpu::SetOutputWindow(HWND hwnd)
 
 const Resolution& D3D12Gpu::GetCurrentResolution() const 
 { 
-    return m_swapChain->GetCurrentResolution(); 
+    return m_swapChain ? m_swapChain->GetCurrentResolution() : m_safestResolution;
 }
 
 bool D3D12Gpu::IsFrameFinished(uint64_t frameId)
@@ -353,9 +411,9 @@ D3D12GpuMemoryHandle D3D12Gpu::AllocateDynamicMemory(size_t sizeBytes, const std
         allocation.m_frameId[i] = m_currentFrame;
     }
 
-    m_dynamicMemoryAllocations[m_nextHandleId] = std::move(allocation);
+    const auto handleId = m_dynamicMemoryAllocations.Insert(std::move(allocation));
 
-    return EncodeGpuMemoryHandle(m_nextHandleId++, true, ResourceType::Buffer);
+    return EncodeGpuMemoryHandle(handleId, true, ResourceType::Buffer);
 }
 
 D3D12GpuMemoryHandle D3D12Gpu::AllocateStaticMemory(const void* data, size_t sizeBytes, const std::wstring& debugName)
@@ -364,21 +422,34 @@ D3D12GpuMemoryHandle D3D12Gpu::AllocateStaticMemory(const void* data, size_t siz
                                                                         D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT,
                                                                         debugName);
 
-    m_staticBufferMemoryAllocations[m_nextHandleId] = StaticBufferAlloc{ m_currentFrame, committedBuffer };
+    const auto handleId = m_staticBufferMemoryAllocations.Insert(StaticBufferAlloc{ m_currentFrame, committedBuffer });
 
-    return EncodeGpuMemoryHandle(m_nextHandleId++, false, ResourceType::Buffer);
+    return EncodeGpuMemoryHandle(handleId, false, ResourceType::Buffer);
+}
+
+D3D12GpuMemoryHandle D3D12Gpu::AllocateStaticMemory(size_t sizeBytes, const std::wstring& debugName)
+{
+    auto committedBuffer = m_committedResourceAllocator->AllocateBuffer(sizeBytes,
+                                                                        D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT,
+                                                                        debugName);
+
+    const auto handleId = m_staticBufferMemoryAllocations.Insert(StaticBufferAlloc{ m_currentFrame, committedBuffer });
+
+    return EncodeGpuMemoryHandle(handleId, false, ResourceType::Buffer);
 }
 
 D3D12GpuMemoryHandle D3D12Gpu::AllocateStaticMemory(const std::vector<D3D12_SUBRESOURCE_DATA>& subresources, 
                                                     const D3D12_RESOURCE_DESC& desc,
                                                     const std::wstring& debugName)
 {
-    auto resource = m_committedResourceAllocator->AllocateTexture(subresources, desc, debugName);
-    assert(resource);
+    auto committedTexture = m_committedResourceAllocator->AllocateTexture(subresources, desc, debugName);
+    assert(committedTexture.m_resource);
 
-    m_staticTextureMemoryAllocations[m_nextHandleId] = StaticTextureAlloc{ m_currentFrame, resource };
+    const auto handleId = m_staticTextureMemoryAllocations.Insert(StaticTextureAlloc{ m_currentFrame, 
+                                                                                      committedTexture.m_resource,
+                                                                                      committedTexture.m_uploadId });
 
-    return EncodeGpuMemoryHandle(m_nextHandleId++, false, ResourceType::Texture);
+    return EncodeGpuMemoryHandle(handleId, false, ResourceType::Texture);
 }
 
 D3D12GpuMemoryHandle D3D12Gpu::AllocateStaticMemory(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, 
@@ -389,9 +460,9 @@ D3D12GpuMemoryHandle D3D12Gpu::AllocateStaticMemory(const D3D12_RESOURCE_DESC& d
     assert(resource);
     resource->SetName(debugName.c_str());
 
-    m_staticTextureMemoryAllocations[m_nextHandleId] = StaticTextureAlloc{ m_currentFrame, resource };
+    const auto handleId = m_staticTextureMemoryAllocations.Insert(StaticTextureAlloc{ m_currentFrame, resource });
 
-    return EncodeGpuMemoryHandle(m_nextHandleId++, false, ResourceType::Texture);
+    return EncodeGpuMemoryHandle(handleId, false, ResourceType::Texture);
 }
 
 void D3D12Gpu::UpdateMemory(D3D12GpuMemoryHandle memHandle, const void* data, size_t sizeBytes, size_t offsetBytes)
@@ -402,9 +473,9 @@ void D3D12Gpu::UpdateMemory(D3D12GpuMemoryHandle memHandle, const void* data, si
     assert(DecodeGpuMemoryHandle_IsDynamic(memHandle));
 
     auto decodedHandle = DecodeGpuMemoryHandle_ID(memHandle);
-    assert(m_dynamicMemoryAllocations.count(decodedHandle) == 1);
+    assert(m_dynamicMemoryAllocations.Contains(decodedHandle));
 
-    auto& memoryAlloc = m_dynamicMemoryAllocations[decodedHandle];
+    auto& memoryAlloc = m_dynamicMemoryAllocations.Get(decodedHandle);
     assert(memoryAlloc.m_allocation[m_state->m_currentFrameIndex].m_cpuPtr);
 
     memcpy(memoryAlloc.m_allocation[m_state->m_currentFrameIndex].m_cpuPtr + offsetBytes, data, sizeBytes);
@@ -412,6 +483,51 @@ void D3D12Gpu::UpdateMemory(D3D12GpuMemoryHandle memHandle, const void* data, si
     memoryAlloc.m_frameId[m_state->m_currentFrameIndex] = m_currentFrame;
 }
 
+D3D12UploadQueue::UploadId D3D12Gpu::UpdateStaticMemory(D3D12GpuMemoryHandle memHandle, const void* data,
+                                                        size_t sizeBytes, size_t offsetBytes)
+{
+    assert(memHandle.IsValid());
+    assert(data);
+    assert(sizeBytes > 0);
+    assert(!DecodeGpuMemoryHandle_IsDynamic(memHandle));
+    assert(DecodeGpuMemoryHandle_ResourceType(memHandle) == ResourceType::Buffer);
+
+    auto decodedHandle = DecodeGpuMemoryHandle_ID(memHandle);
+    assert(m_staticBufferMemoryAllocations.Contains(decodedHandle));
+
+    auto& memoryAlloc = m_staticBufferMemoryAllocations.Get(decodedHandle);
+    m_committedResourceAllocator->UploadBufferRegion(memoryAlloc.m_committedBuffer, data, sizeBytes, offsetBytes);
+
+    return memoryAlloc.m_committedBuffer.m_uploadId;
+}
+
+bool D3D12Gpu::IsUploadFinished(D3D12UploadQueue::UploadId uploadId)
+{
+    return m_uploadQueue->IsUploadFinished(uploadId);
+}
+
+bool D3D12Gpu::IsMemoryReady(D3D12GpuMemoryHandle memHandle)
+{
+    assert(memHandle.IsValid());
+    if (DecodeGpuMemoryHandle_IsDynamic(memHandle))
+        return true;
+
+    const auto decodedHandle = DecodeGpuMemoryHandle_ID(memHandle);
+    if (DecodeGpuMemoryHandle_ResourceType(memHandle) == ResourceType::Texture)
+    {
+        assert(m_staticTextureMemoryAllocations.Contains(decodedHandle));
+        return m_uploadQueue->IsUploadFinished(m_staticTextureMemoryAllocations.Get(decodedHandle).m_uploadId);
+    }
+
+    assert(m_staticBufferMemoryAllocations.Contains(decodedHandle));
+    return m_uploadQueue->IsUploadFinished(m_staticBufferMemoryAllocations.Get(decodedHandle).m_committedBuffer.m_uploadId);
+}
+
+void D3D12Gpu::SetUploadBudget(size_t budgetSizeBytes)
+{
+    m_uploadQueue->SetSubmitBudget(budgetSizeBytes);
+}
+
 void D3D12Gpu::FreeMemory(D3D12GpuMemoryHandle memHandle)
 {
     assert(memHandle.IsValid());
@@ -419,6 +535,15 @@ void D3D12Gpu::FreeMemory(D3D12GpuMemoryHandle memHandle)
     m_retiredAllocations.push_back(memHandle);
 }
 
+D3D12TransientAllocation D3D12Gpu::AllocateTransientMemory(size_t sizeBytes, size_t alignment)
+{
+    auto allocation = m_transientMemoryAllocator->Allocate(sizeBytes, alignment);
+    assert(allocation.m_cpuPtr);
+    assert(D3D12Basics::IsAlignedToPowerof2(allocation.m_gpuPtr, alignment));
+
+    return allocation;
+}
+
 D3D12GpuViewHandle D3D12Gpu::CreateConstantBufferView(D3D12GpuMemoryHandle memHandle)
 {
     assert(memHandle.IsValid());
@@ -429,8 +554,8 @@ D3D12GpuViewHandle D3D12Gpu::CreateConstantBufferView(D3D12GpuMemoryHandle memHa
     {
         // Create a descriptor per frames in flight pointing each to the corresponding
         // memory of that buffer in that frame
-        assert(m_dynamicMemoryAllocations.count(decodedHandle) == 1);
-        auto& memoryAlloc = m_dynamicMemoryAllocations[decodedHandle];
+        assert(m_dynamicMemoryAllocations.Contains(decodedHandle));
+        auto& memoryAlloc = m_dynamicMemoryAllocations.Get(decodedHandle);
 
         for (unsigned int i = 0; i < D3D12GpuConfig::m_framesInFlight; ++i)
         {
@@ -447,8 +572,8 @@ D3D12GpuViewHandle D3D12Gpu::CreateConstantBufferView(D3D12GpuMemoryHandle memHa
     {
         assert(DecodeGpuMemoryHandle_ResourceType(memHandle) == ResourceType::Buffer);
 
-        assert(m_staticBufferMemoryAllocations.count(decodedHandle) == 1);
-        auto& memoryAlloc = m_staticBufferMemoryAllocations[decodedHandle];
+        assert(m_staticBufferMemoryAllocations.Contains(decodedHandle));
+        auto& memoryAlloc = m_staticBufferMemoryAllocations.Get(decodedHandle);
 
         D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
         cbvDesc.BufferLocation = memoryAlloc.m_committedBuffer.m_resource->GetGPUVirtualAddress();
@@ -469,7 +594,7 @@ D3D12GpuViewHandle D3D12Gpu::CreateTextureView(D3D12GpuMemoryHandle memHandle, c
     assert(DecodeGpuMemoryHandle_ResourceType(memHandle) == ResourceType::Texture);
 
     auto decodedHandle = DecodeGpuMemoryHandle_ID(memHandle);
-    assert(m_staticTextureMemoryAllocations.count(decodedHandle) == 1);
+    assert(m_staticTextureMemoryAllocations.Contains(decodedHandle));
 
     // TODO only 2d textures with limited props supported
     D3D12_SHADER_RESOURCE_VIEW_DESC viewDesc;
@@ -482,7 +607,7 @@ D3D12GpuViewHandle D3D12Gpu::CreateTextureView(D3D12GpuMemoryHandle memHandle, c
     viewDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
     DescriptorHandlesPtrs descriptors;
-    auto& memoryAllocation = m_staticTextureMemoryAllocations[decodedHandle];
+    auto& memoryAllocation = m_staticTextureMemoryAllocations.Get(decodedHandle);
     descriptors[0] = m_cpuSRV_CBVDescHeap->CreateSRV(memoryAllocation.m_resource.Get(), viewDesc);
     assert(descriptors[0]);
     
@@ -499,7 +624,7 @@ D3D12GpuViewHandle D3D12Gpu::CreateRenderTargetView(D3D12GpuMemoryHandle memHand
     assert(DecodeGpuMemoryHandle_ResourceType(memHandle) == ResourceType::Texture);
 
     auto decodedHandle = DecodeGpuMemoryHandle_ID(memHandle);
-    assert(m_staticTextureMemoryAllocations.count(decodedHandle) == 1);
+    assert(m_staticTextureMemoryAllocations.Contains(decodedHandle));
 
     // TODO only 2d textures with limited props supported
     D3D12_SHADER_RESOURCE_VIEW_DESC viewDesc;
@@ -512,7 +637,7 @@ D3D12GpuViewHandle D3D12Gpu::CreateRenderTargetView(D3D12GpuMemoryHandle memHand
     viewDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
     DescriptorHandlesPtrs descriptors;
-    auto& memoryAllocation = m_staticTextureMemoryAllocations[decodedHandle];
+    auto& memoryAllocation = m_staticTextureMemoryAllocations.Get(decodedHandle);
     descriptors[0] = m_cpuRTVDescHeap->CreateRTV(memoryAllocation.m_resource.Get());
     assert(descriptors[0]);
 
@@ -528,7 +653,7 @@ D3D12GpuViewHandle D3D12Gpu::CreateDepthStencilView(D3D12GpuMemoryHandle memHand
     assert(DecodeGpuMemoryHandle_ResourceType(memHandle) == ResourceType::Texture);
 
     auto decodedHandle = DecodeGpuMemoryHandle_ID(memHandle);
-    assert(m_staticTextureMemoryAllocations.count(decodedHandle) == 1);
+    assert(m_staticTextureMemoryAllocations.Contains(decodedHandle));
 
     D3D12_DEPTH_STENCIL_VIEW_DESC desc;
     desc.Format             = format;
@@ -537,7 +662,7 @@ D3D12GpuViewHandle D3D12Gpu::CreateDepthStencilView(D3D12GpuMemoryHandle memHand
     desc.Texture2D.MipSlice = 0;
 
     DescriptorHandlesPtrs descriptors;
-    auto& memoryAllocation = m_staticTextureMemoryAllocations[decodedHandle];
+    auto& memoryAllocation = m_staticTextureMemoryAllocations.Get(decodedHandle);
     descriptors[0] = m_dsvDescPool->CreateDSV(memoryAllocation.m_resource.Get(), desc, nullptr);
     assert(descriptors[0]);
 
@@ -584,15 +709,26 @@ D3D12GraphicsCmdListPtr D3D12Gpu::CreateCmdList(const std::wstring& debugName)
                                                   debugName);
 }
 
+D3D12GraphicsCmdListPtr D3D12Gpu::CreateNullCmdList(const std::wstring& debugName)
+{
+    return std::make_unique<D3D12GraphicsCmdList>(m_state.get(), m_frameStats.m_cmdListTimes, debugName);
+}
+
 void D3D12Gpu::ExecuteCmdLists(const D3D12CmdLists& cmdLists)
 {
-    m_graphicsCmdQueue->ExecuteCommandLists(static_cast<UINT>(cmdLists.size()), &cmdLists[0]);
+    // NOTE submitting the pending uploads first so the cmd lists see them
+    m_uploadQueue->Submit();
+
+    if (!cmdLists.empty())
+        m_graphicsCmdQueue->ExecuteCommandLists(static_cast<UINT>(cmdLists.size()), &cmdLists[0]);
 }
 
 void D3D12Gpu::PresentFrame()
 {
+    // NOTE without a swap chain, ie the null backend, theres nothing to present
     g_gpuViewMarkerPrePresentFrame.Mark();
-    m_swapChain->Present(D3D12GpuConfig::m_vsync);
+    if (m_swapChain)
+        m_swapChain->Present(D3D12GpuConfig::m_vsync);
     g_gpuViewMarkerPostPresentFrame.Mark();
 
     g_gpuViewMarkerPreWaitFrame.Mark();
@@ -604,7 +740,7 @@ void D3D12Gpu::PresentFrame()
     //      the present if its already being counted for in the fence?
     //      Does the waitable object work signal in a different time than 
     //      the fence?
-    if (m_isWaitableForPresentEnabled)
+    if (m_isWaitableForPresentEnabled && m_swapChain)
     {
         m_swapChain->WaitForPresent();
     }
@@ -617,6 +753,9 @@ void D3D12Gpu::PresentFrame()
     m_gpuDescriptorRingBuffer->NextStacksSet();
     m_gpuDescriptorRingBuffer->ClearStacksSet();
 
+    // NOTE the fence wait above guarantees the frame that used this segment is done
+    m_transientMemoryAllocator->ResetFrame(m_state->m_currentFrameIndex);
+
     // TODO destroy retired buffers depending on if the frames they were bound are
     // still in flight.
     DestroyRetiredAllocations();
@@ -661,17 +800,40 @@ void D3D12Gpu::OnToggleFullScreen()
     // NOTE the actual resizing of the buffer doesnt happen here
     //      so its safe to keep the gpu working a little bit more
     //      until the actual resize happens.
+    assert(m_swapChain);
     m_swapChain->ToggleFullScreen();
 }
 
 void D3D12Gpu::OnResize(const Resolution& resolution)
 {
+    assert(m_swapChain);
+
     m_gpuSync->WaitAll();
 
     const auto& swapChainDisplayMode = FindClosestDisplayModeMatch(g_swapChainFormat, resolution);
     m_swapChain->Resize(swapChainDisplayMode);
 }
 
+D3D12DynamicBufferAllocator::Stats D3D12Gpu::GetDynamicMemoryStats() const
+{
+    return m_dynamicMemoryAllocator->GetStats();
+}
+
+size_t D3D12Gpu::GetTransientMemoryPagesCount() const
+{
+    return m_transientMemoryAllocator->PagesCount();
+}
+
+size_t D3D12Gpu::GetTransientMemoryUsedSizeBytes() const
+{
+    return m_transientMemoryAllocator->CurrentFrameUsedSizeBytes();
+}
+
+const D3D12UploadQueue::Stats& D3D12Gpu::GetUploadQueueStats() const
+{
+    return m_uploadQueue->GetStats();
+}
+
 void D3D12Gpu::UpdateConcurrentBindersCount(unsigned int concurrentBindersCount)
 {
     if (concurrentBindersCount == m_stacksSetSize)
@@ -698,22 +860,49 @@ void D3D12Gpu::SetBindings(ID3D12GraphicsCommandListPtr cmdList, const D3D12Bind
         D3D12_GPU_VIRTUAL_ADDRESS memoryVA{};
         if (DecodeGpuMemoryHandle_IsDynamic(cbv.m_memoryHandle))
         {
-            assert(m_dynamicMemoryAllocations.count(decodedHandle) == 1);
-            memoryVA = m_dynamicMemoryAllocations[decodedHandle].m_allocation[m_state->m_currentFrameIndex].m_gpuPtr;
-            m_dynamicMemoryAllocations[decodedHandle].m_frameId[m_state->m_currentFrameIndex] = m_currentFrame;
+            assert(m_dynamicMemoryAllocations.Contains(decodedHandle));
+            auto& memoryAlloc = m_dynamicMemoryAllocations.Get(decodedHandle);
+            memoryVA = memoryAlloc.m_allocation[m_state->m_currentFrameIndex].m_gpuPtr;
+            memoryAlloc.m_frameId[m_state->m_currentFrameIndex] = m_currentFrame;
         }
         else
         {
             assert(DecodeGpuMemoryHandle_ResourceType(cbv.m_memoryHandle) == ResourceType::Texture);
 
-            assert(m_staticBufferMemoryAllocations.count(decodedHandle) == 1);
-            memoryVA = m_staticBufferMemoryAllocations[decodedHandle].m_committedBuffer.m_resource->GetGPUVirtualAddress();
-            m_staticBufferMemoryAllocations[decodedHandle].m_frameId = m_currentFrame;
+            assert(m_staticBufferMemoryAllocations.Contains(decodedHandle));
+            auto& memoryAlloc = m_staticBufferMemoryAllocations.Get(decodedHandle);
+            memoryVA = memoryAlloc.m_committedBuffer.m_resource->GetGPUVirtualAddress();
+            memoryAlloc.m_frameId = m_currentFrame;
         }
 
         cmdList->SetGraphicsRootConstantBufferView(static_cast<UINT>(cbv.m_bindingSlot), memoryVA);
     }
 
+    for (auto& cbv : bindings.m_transientConstantBufferViews)
+    {
+        assert(cbv.m_gpuPtr);
+        cmdList->SetGraphicsRootConstantBufferView(static_cast<UINT>(cbv.m_bindingSlot), cbv.m_gpuPtr);
+    }
+
+    // NOTE only dynamic memory, the copy of the current frame
+    for (auto& srv : bindings.m_shaderResourceViews)
+    {
+        assert(DecodeGpuMemoryHandle_IsDynamic(srv.m_memoryHandle));
+        auto decodedHandle = DecodeGpuMemoryHandle_ID(srv.m_memoryHandle);
+        assert(m_dynamicMemoryAllocations.Contains(decodedHandle));
+        auto& memoryAlloc = m_dynamicMemoryAllocations.Get(decodedHandle);
+        memoryAlloc.m_frameId[m_state->m_currentFrameIndex] = m_currentFrame;
+
+        cmdList->SetGraphicsRootShaderResourceView(static_cast<UINT>(srv.m_bindingSlot), 
+                                                   memoryAlloc.m_allocation[m_state->m_currentFrameIndex].m_gpuPtr);
+    }
+
+    for (auto& srv : bindings.m_transientShaderResourceViews)
+    {
+        assert(srv.m_gpuPtr);
+        cmdList->SetGraphicsRootShaderResourceView(static_cast<UINT>(srv.m_bindingSlot), srv.m_gpuPtr);
+    }
+
     // TODO figure out how to copy the descriptors in batches (maybe having arrays of views?) if possible
     for (auto& cpuDescriptorTable : bindings.m_descriptorTables)
     {
@@ -722,36 +911,34 @@ void D3D12Gpu::SetBindings(ID3D12GraphicsCommandListPtr cmdList, const D3D12Bind
         for (auto viewHandle : cpuDescriptorTable.m_views)
         {
             assert(viewHandle.IsValid());
-            assert(viewHandle.m_id < m_memoryViews.size());
-            auto& view = m_memoryViews[viewHandle.m_id];
-            assert(view);
+            const auto& view = m_memoryViews.Get(viewHandle.m_id);
 
-            auto decodedHandle = DecodeGpuMemoryHandle_ID(view->m_memHandle);
+            auto decodedHandle = DecodeGpuMemoryHandle_ID(view.m_memHandle);
             D3D12_CPU_DESCRIPTOR_HANDLE descriptorHandle{};
-            if (DecodeGpuMemoryHandle_IsDynamic(view->m_memHandle))
+            if (DecodeGpuMemoryHandle_IsDynamic(view.m_memHandle))
             {
-                assert(m_dynamicMemoryAllocations.count(decodedHandle) == 1);
-                DynamicMemoryAlloc& dynamicAllocation = m_dynamicMemoryAllocations[decodedHandle];
+                assert(m_dynamicMemoryAllocations.Contains(decodedHandle));
+                DynamicMemoryAlloc& dynamicAllocation = m_dynamicMemoryAllocations.Get(decodedHandle);
                 dynamicAllocation.m_frameId[m_state->m_currentFrameIndex] = m_currentFrame;
 
-                descriptorHandle = view->m_frameDescriptors[m_state->m_currentFrameIndex]->m_cpuHandle;
+                descriptorHandle = view.m_frameDescriptors[m_state->m_currentFrameIndex]->m_cpuHandle;
             }
             else
             {
-                descriptorHandle = view->m_frameDescriptors[0]->m_cpuHandle;
+                descriptorHandle = view.m_frameDescriptors[0]->m_cpuHandle;
 
-                if (!view->m_memHandle.IsNull())
+                if (!view.m_memHandle.IsNull())
                 {
-                    const auto resourceType = DecodeGpuMemoryHandle_ResourceType(view->m_memHandle);
+                    const auto resourceType = DecodeGpuMemoryHandle_ResourceType(view.m_memHandle);
                     if (resourceType == ResourceType::Texture)
                     {
-                        assert(m_staticTextureMemoryAllocations.count(decodedHandle) == 1);
-                        m_staticTextureMemoryAllocations[decodedHandle].m_frameId = m_currentFrame;
+                        assert(m_staticTextureMemoryAllocations.Contains(decodedHandle));
+                        m_staticTextureMemoryAllocations.Get(decodedHandle).m_frameId = m_currentFrame;
                     }
                     else
                     {
-                        assert(m_staticBufferMemoryAllocations.count(decodedHandle) == 1);
-                        m_staticBufferMemoryAllocations[decodedHandle].m_frameId = m_currentFrame;
+                        assert(m_staticBufferMemoryAllocations.Contains(decodedHandle));
+                        m_staticBufferMemoryAllocations.Get(decodedHandle).m_frameId = m_currentFrame;
                     }
                 }
             }
@@ -780,14 +967,16 @@ void D3D12Gpu::SetVertexBuffer(ID3D12GraphicsCommandListPtr cmdList, D3D12GpuMem
 }
 
 void D3D12Gpu::SetIndexBuffer(ID3D12GraphicsCommandListPtr cmdList, D3D12GpuMemoryHandle memHandle,
-                              size_t indexBufferSizeBytes)
+                              size_t indexBufferSizeBytes, size_t indexSizeBytes)
 {
     assert(memHandle.IsValid());
+    assert(indexSizeBytes == sizeof(uint16_t) || indexSizeBytes == sizeof(uint32_t));
 
     D3D12_INDEX_BUFFER_VIEW indexBufferView
     {
         GetBufferVA(memHandle),
-        static_cast<UINT>(indexBufferSizeBytes), DXGI_FORMAT_R16_UINT
+        static_cast<UINT>(indexBufferSizeBytes), 
+        indexSizeBytes == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT
     };
     cmdList->IASetIndexBuffer(&indexBufferView);
 }
@@ -795,14 +984,12 @@ void D3D12Gpu::SetIndexBuffer(ID3D12GraphicsCommandListPtr cmdList, D3D12GpuMemo
 D3D12_CPU_DESCRIPTOR_HANDLE D3D12Gpu::GetViewCPUHandle(D3D12GpuViewHandle gpuViewHandle) const
 {
     assert(gpuViewHandle.IsValid());
-    assert(gpuViewHandle.m_id < m_memoryViews.size());
 
-    auto& memoryView = m_memoryViews[gpuViewHandle.m_id];
-    assert(memoryView);
+    const auto& memoryView = m_memoryViews.Get(gpuViewHandle.m_id);
 
-    const bool isDynamic = DecodeGpuMemoryHandle_IsDynamic(memoryView->m_memHandle);
+    const bool isDynamic = DecodeGpuMemoryHandle_IsDynamic(memoryView.m_memHandle);
 
-	return memoryView->m_frameDescriptors[isDynamic ? m_state->m_currentFrameIndex : 0]->m_cpuHandle;
+	return memoryView.m_frameDescriptors[isDynamic ? m_state->m_currentFrameIndex : 0]->m_cpuHandle;
 }
 
 ID3D12Resource* D3D12Gpu::GetResource(D3D12GpuMemoryHandle memHandle)
@@ -816,14 +1003,14 @@ ID3D12Resource* D3D12Gpu::GetResource(D3D12GpuMemoryHandle memHandle)
     const auto resourceType = DecodeGpuMemoryHandle_ResourceType(memHandle);
     if (resourceType == ResourceType::Texture)
     {
-        assert(m_staticTextureMemoryAllocations.count(decodedHandle) == 1);
-        resource = m_staticTextureMemoryAllocations[decodedHandle].m_resource;
+        assert(m_staticTextureMemoryAllocations.Contains(decodedHandle));
+        resource = m_staticTextureMemoryAllocations.Get(decodedHandle).m_resource;
         assert(resource);
     }
     else
     {
-        assert(m_staticBufferMemoryAllocations.count(decodedHandle) == 1);
-        resource = m_staticBufferMemoryAllocations[decodedHandle].m_committedBuffer.m_resource;
+        assert(m_staticBufferMemoryAllocations.Contains(decodedHandle));
+        resource = m_staticBufferMemoryAllocations.Get(decodedHandle).m_committedBuffer.m_resource;
         assert(resource);
     }
 
@@ -904,6 +1091,16 @@ void D3D12Gpu::CreateDevice(IDXGIAdapterPtr adapter)
     assert(m_state->m_device);
 }
 
+void D3D12Gpu::CreateNullDevice()
+{
+    m_safestDisplayMode = CreateDefaultDisplayMode();
+    m_safestResolution = { m_safestDisplayMode.Width, m_safestDisplayMode.Height };
+
+    // Note the device is created with a ref count of 1 that is handed over to the com ptr
+    m_state->m_device.Attach(new D3D12NullDevice());
+    assert(m_state->m_device);
+}
+
 // Note depending on the preferred gpu in a system with a dgpu and a igpu, the enum outputs might failed.
 // Thats why theres a check for the output enum to work when searching for a suitable adapter.
 IDXGIAdapterPtr D3D12Gpu::CreateDXGIInfrastructure()
@@ -983,8 +1180,8 @@ D3D12_GPU_VIRTUAL_ADDRESS D3D12Gpu::GetBufferVA(D3D12GpuMemoryHandle memHandle)
 
     if (DecodeGpuMemoryHandle_IsDynamic(memHandle))
     {
-        assert(m_dynamicMemoryAllocations.count(decodedHandle) == 1);
-        auto& memoryAllocation = m_dynamicMemoryAllocations[decodedHandle];
+        assert(m_dynamicMemoryAllocations.Contains(decodedHandle));
+        auto& memoryAllocation = m_dynamicMemoryAllocations.Get(decodedHandle);
         assert(memoryAllocation.m_allocation[m_state->m_currentFrameIndex].m_gpuPtr);
         // NOTE: record the frame when the function got called
         // NOTE: assuming GetBufferVA means binding to the pipeline isnt the best way
@@ -997,15 +1194,14 @@ D3D12_GPU_VIRTUAL_ADDRESS D3D12Gpu::GetBufferVA(D3D12GpuMemoryHandle memHandle)
     ID3D12ResourcePtr resource = nullptr;
     if (resourceType == ResourceType::Texture)
     {
-        assert(decodedHandle < m_staticTextureMemoryAllocations.size());
-        assert(m_staticTextureMemoryAllocations.count(decodedHandle) == 1);
-        resource = m_staticTextureMemoryAllocations[decodedHandle].m_resource;
+        assert(m_staticTextureMemoryAllocations.Contains(decodedHandle));
+        resource = m_staticTextureMemoryAllocations.Get(decodedHandle).m_resource;
         assert(resource);
     }
     else
     {
-        assert(m_staticBufferMemoryAllocations.count(decodedHandle) == 1);
-        resource = m_staticBufferMemoryAllocations[decodedHandle].m_committedBuffer.m_resource;
+        assert(m_staticBufferMemoryAllocations.Contains(decodedHandle));
+        resource = m_staticBufferMemoryAllocations.Get(decodedHandle).m_committedBuffer.m_resource;
         assert(resource);
     }
 
@@ -1025,8 +1221,8 @@ void D3D12Gpu::DestroyRetiredAllocations()
 
         if (DecodeGpuMemoryHandle_IsDynamic(memAllocation))
         {
-            assert(m_dynamicMemoryAllocations.count(decodedHandle) == 1);
-            auto& dynamicMemoryAllocation = m_dynamicMemoryAllocations[decodedHandle];
+            assert(m_dynamicMemoryAllocations.Contains(decodedHandle));
+            auto& dynamicMemoryAllocation = m_dynamicMemoryAllocations.Get(decodedHandle);
             for (auto i = 0; i < D3D12GpuConfig::m_framesInFlight; ++i)
                 completelyRetired &= dynamicMemoryAllocation.m_frameId[i] <= lastRetiredFrameId;
 
@@ -1034,10 +1230,9 @@ void D3D12Gpu::DestroyRetiredAllocations()
             {
                 for (auto i = 0; i < D3D12GpuConfig::m_framesInFlight; ++i)
                     m_dynamicMemoryAllocator->Deallocate(dynamicMemoryAllocation.m_allocation[i]);
-            }
 
-            // TODO is it worth it to remove it?
-             m_dynamicMemoryAllocations.erase(memAllocation.m_id);
+                m_dynamicMemoryAllocations.Erase(decodedHandle);
+            }
         }
         else
         {
@@ -1045,21 +1240,19 @@ void D3D12Gpu::DestroyRetiredAllocations()
             ID3D12ResourcePtr resource = nullptr;
             if (resourceType == ResourceType::Texture)
             {
-                assert(m_staticTextureMemoryAllocations.count(decodedHandle) == 1);
-                const auto frameId = m_staticTextureMemoryAllocations[decodedHandle].m_frameId;
+                assert(m_staticTextureMemoryAllocations.Contains(decodedHandle));
+                const auto frameId = m_staticTextureMemoryAllocations.Get(decodedHandle).m_frameId;
                 completelyRetired = frameId <= lastRetiredFrameId;
-                // TODO is it worth it to remove it?
                 if (completelyRetired)
-                    m_staticBufferMemoryAllocations.erase(memAllocation.m_id);
+                    m_staticTextureMemoryAllocations.Erase(decodedHandle);
             }
             else 
             {
-                assert(m_staticBufferMemoryAllocations.count(decodedHandle) == 1);
-                const auto frameId = m_staticBufferMemoryAllocations[decodedHandle].m_frameId;
+                assert(m_staticBufferMemoryAllocations.Contains(decodedHandle));
+                const auto frameId = m_staticBufferMemoryAllocations.Get(decodedHandle).m_frameId;
                 completelyRetired = frameId <= lastRetiredFrameId;
-                // TODO is it worth it to remove it?
                 if (completelyRetired)
-                    m_staticBufferMemoryAllocations.erase(memAllocation.m_id);
+                    m_staticBufferMemoryAllocations.Erase(decodedHandle);
             }
         }
 
@@ -1072,11 +1265,5 @@ void D3D12Gpu::DestroyRetiredAllocations()
 
 D3D12GpuViewHandle D3D12Gpu::CreateView(D3D12GpuMemoryHandle memHandle, DescriptorHandlesPtrs&& descriptors)
 {
-    D3D12GpuMemoryViewPtr view = std::make_unique<D3D12GpuMemoryView>(memHandle, std::move(descriptors));
-    assert(view);
-
-    D3D12GpuViewHandle viewHandle{ m_memoryViews.size() };
-    m_memoryViews.push_back(std::move(view));
-
-    return viewHandle;
+    return { m_memoryViews.Insert(D3D12GpuMemoryView(memHandle, std::move(descriptors))) };
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "d3d12basicsfwd.h"
 #include "d3d12descriptorheap.h"
 #include "d3d12committedresources.h"
+#include "d3d12nullcmdlist.h"
+#include "slotmap.h"
 
 // c++ includes
 #include <vector>
@@ -83,6 +85,25 @@ namespace D3D12Basics
         size_t                m_bindingSlot;
         D3D12GpuMemoryHandle  m_memoryHandle;
     };
+    // NOTE gpu memory only valid during the current frame, ie from AllocateTransientMemory
+    struct D3D12TransientConstantBufferView
+    {
+        size_t                      m_bindingSlot;
+        D3D12_GPU_VIRTUAL_ADDRESS   m_gpuPtr;
+    };
+    // NOTE a buffer (ie a structured buffer) bound as a root shader resource view
+    struct D3D12ShaderResourceView
+    {
+        size_t                m_bindingSlot;
+        D3D12GpuMemoryHandle  m_memoryHandle;
+    };
+    // NOTE a buffer (ie a structured buffer) bound as a root shader resource view. Same
+    // as the transient constant buffer views the memory is only valid during the current frame.
+    struct D3D12TransientShaderResourceView
+    {
+        size_t                      m_bindingSlot;
+        D3D12_GPU_VIRTUAL_ADDRESS   m_gpuPtr;
+    };
     struct D3D12DescriptorTable
     {
         size_t                              m_bindingSlot;
@@ -90,9 +111,12 @@ namespace D3D12Basics
     };
     struct D3D12Bindings
     {
-        std::vector<D3D1232BitConstants>        m_32BitConstants;
-        std::vector<D3D12ConstantBufferView>    m_constantBufferViews;
-        std::vector<D3D12DescriptorTable>       m_descriptorTables;
+        std::vector<D3D1232BitConstants>                m_32BitConstants;
+        std::vector<D3D12ConstantBufferView>            m_constantBufferViews;
+        std::vector<D3D12TransientConstantBufferView>   m_transientConstantBufferViews;
+        std::vector<D3D12ShaderResourceView>            m_shaderResourceViews;
+        std::vector<D3D12TransientShaderResourceView>   m_transientShaderResourceViews;
+        std::vector<D3D12DescriptorTable>               m_descriptorTables;
     };
 
     struct D3D12GpuShareableState;
@@ -117,6 +141,11 @@ namespace D3D12Basics
                              UINT64 cmdQueueTimestampFrequency, FrameStats::NamedCmdListTimes& cmdListsTimes,
                              StopClock::SplitTimeBuffer& splitTimes, const std::wstring& debugName);
 
+        // Note Null backend cmd list. Theres no allocators, no timestamps and nothing to execute,
+        // the commands recorded are only counted.
+        D3D12GraphicsCmdList(D3D12GpuShareableState* gpuState, FrameStats::NamedCmdListTimes& cmdListsTimes,
+                             const std::wstring& debugName);
+
         // Note Forcing the compiler to use a definition of the destructor in order to
         // not trigger a default inline destructor usage. In that case the compiler will
         // need the complete definition of D3D12CmdListTimeStamp which doesn't have as
@@ -129,12 +158,19 @@ namespace D3D12Basics
 
         ID3D12GraphicsCommandListPtr GetCmdList() const { return m_cmdList; }
 
+        bool IsNull() const { return m_nullCmdList != nullptr; }
+
+        const D3D12NullCmdListCounters& NullCounters() const;
+
     private:
         D3D12GpuShareableState*         m_gpuState;
         std::wstring                    m_debugName;
         D3D12CmdListTimeStampPtr        m_timeStamp;
         FrameStats::NamedCmdListTimes&  m_cmdListsTimes;
 
+        // Note owned by m_cmdList
+        D3D12NullGraphicsCmdList*       m_nullCmdList;
+
         ID3D12GraphicsCommandListPtr    m_cmdList;
         ID3D12CommandAllocatorPtr       m_cmdAllocators[D3D12GpuConfig::m_framesInFlight];
     };
@@ -146,13 +182,23 @@ namespace D3D12Basics
     // a 3d command queue, a command list, a swap chain, double buffering, etc...
     // Right now is a bag where you have a mix of high level and low level
     // data, ie depth buffer or simplematerial
+    // NOTE with the null backend theres no adapter, output or swap chain. The device is a
+    // D3D12NullDevice so it runs without a gpu, ie to measure the cpu side of a frame.
     class D3D12Gpu
     {
     public:
-        D3D12Gpu(bool isWaitableForPresentEnabled);
+        enum class Backend
+        {
+            Device,
+            Null
+        };
+
+        D3D12Gpu(bool isWaitableForPresentEnabled, Backend backend = Backend::Device);
 
         ~D3D12Gpu();
 
+        bool IsNullBackend() const { return m_backend == Backend::Null; }
+
         // Features support
         unsigned int GetFormatPlaneCount(DXGI_FORMAT format) const;
 
@@ -173,6 +219,9 @@ namespace D3D12Basics
         D3D12GpuMemoryHandle AllocateStaticMemory(const void* data, size_t  sizeBytes, 
                                                   const std::wstring& debugName);
 
+        // NOTE no initial data, its regions are uploaded with UpdateStaticMemory
+        D3D12GpuMemoryHandle AllocateStaticMemory(size_t  sizeBytes, const std::wstring& debugName);
+
         D3D12GpuMemoryHandle AllocateStaticMemory(const std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
                                                   const D3D12_RESOURCE_DESC& desc,
                                                   const std::wstring& debugName);
@@ -186,8 +235,30 @@ namespace D3D12Basics
         void UpdateMemory(D3D12GpuMemoryHandle memHandle, const void* data, size_t sizeBytes, 
                             size_t offsetBytes = 0);
 
+        // Uploads a region of a static buffer. IsMemoryReady is false until this upload
+        // finishes but the rest of the buffer can be used by the gpu meanwhile.
+        // NOTE returns the upload id so the region readiness can be tracked with
+        // IsUploadFinished while newer regions are uploaded
+        D3D12UploadQueue::UploadId UpdateStaticMemory(D3D12GpuMemoryHandle memHandle, const void* data,
+                                                      size_t sizeBytes, size_t offsetBytes);
+
+        bool IsUploadFinished(D3D12UploadQueue::UploadId uploadId);
+
+        // Static memory is uploaded asynchronously. It is ready once the upload finished.
+        // NOTE cmd lists executed after the upload was submitted can use it already as
+        //      the uploads and the cmd lists go through the same queue.
+        bool IsMemoryReady(D3D12GpuMemoryHandle memHandle);
+
+        // Maximum bytes uploaded per frame. 0 means no budget.
+        void SetUploadBudget(size_t budgetSizeBytes);
+
         void FreeMemory(D3D12GpuMemoryHandle memHandle);
 
+        // Memory valid only until the end of the current frame. Write it through m_cpuPtr
+        // and bind it through m_gpuPtr. No need to free it.
+        D3D12TransientAllocation AllocateTransientMemory(size_t sizeBytes, 
+                                                         size_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
         // Views handling
         D3D12GpuViewHandle CreateConstantBufferView(D3D12GpuMemoryHandle memHandle);
 
@@ -208,6 +279,7 @@ namespace D3D12Basics
 
         // Execution
         D3D12GraphicsCmdListPtr CreateCmdList(const std::wstring& debugName);
+        D3D12GraphicsCmdListPtr CreateNullCmdList(const std::wstring& debugName);
         void ExecuteCmdLists(const D3D12CmdLists& cmdLists);
         void PresentFrame();
         void WaitAll();
@@ -223,6 +295,10 @@ namespace D3D12Basics
 
         // Utils
         const FrameStats& GetFrameStats() const { return m_frameStats; }
+        D3D12DynamicBufferAllocator::Stats GetDynamicMemoryStats() const;
+        size_t GetTransientMemoryPagesCount() const;
+        size_t GetTransientMemoryUsedSizeBytes() const;
+        const D3D12UploadQueue::Stats& GetUploadQueueStats() const;
 
         // Others
         // NOTE not sure about these ones here. Exposing too much detail? 
@@ -232,8 +308,9 @@ namespace D3D12Basics
                          unsigned int concurrentBinderIndex);
         void SetVertexBuffer(ID3D12GraphicsCommandListPtr cmdList, D3D12GpuMemoryHandle memHandle,
                              size_t vertexBufferSizeBytes, size_t vertexSizeBytes);
+        // NOTE indexSizeBytes is either 2 or 4
         void SetIndexBuffer(ID3D12GraphicsCommandListPtr cmdList, D3D12GpuMemoryHandle memHandle,
-                            size_t indexBufferSizeBytes);
+                            size_t indexBufferSizeBytes, size_t indexSizeBytes);
         D3D12_CPU_DESCRIPTOR_HANDLE GetViewCPUHandle(D3D12GpuViewHandle gpuViewHandle) const;
         ID3D12Resource* GetResource(D3D12GpuMemoryHandle memHandle);
 
@@ -253,7 +330,6 @@ namespace D3D12Basics
             D3D12GpuMemoryHandle    m_memHandle;
             DescriptorHandlesPtrs   m_frameDescriptors;
         };
-        using D3D12GpuMemoryViewPtr = std::unique_ptr<D3D12GpuMemoryView>;
 
         struct StaticMemoryAlloc
         {
@@ -265,7 +341,8 @@ namespace D3D12Basics
         };
         struct StaticTextureAlloc : StaticMemoryAlloc
         {
-            ID3D12ResourcePtr   m_resource;
+            ID3D12ResourcePtr           m_resource;
+            D3D12UploadQueue::UploadId  m_uploadId = D3D12UploadQueue::m_finishedUploadId;
         };
         // TODO allocate the memory on demand instead of pre allocating the maximum needed
         struct DynamicMemoryAlloc
@@ -276,6 +353,10 @@ namespace D3D12Basics
 
         static const uint32_t   m_smallPageSize;
         static const uint32_t   m_bigPageSize;
+        static const uint32_t   m_transientPageSize;
+        static const uint32_t   m_stagingPageSize;
+
+        Backend                 m_backend;
 
         // dxgi data
         IDXGIFactoryPtr         m_factory;
@@ -306,18 +387,17 @@ namespace D3D12Basics
 
         // TODO wrap this into its own class?
         // Gpu memory management
-        // TODO unordered_map is suboptimal. Use a multiindirection vector based as in a packedarray/slot map
-        // http://bitsquid.blogspot.ca/2011/09/managing-decoupling-part-4-id-lookup.html
-        // http://seanmiddleditch.com/data-structures-for-game-developers-the-slot-map/
-        D3D12GpuHandle::HandleType                                          m_nextHandleId;
-        std::unordered_map<D3D12GpuHandle::HandleType, StaticBufferAlloc>   m_staticBufferMemoryAllocations;
-        std::unordered_map<D3D12GpuHandle::HandleType, StaticTextureAlloc>  m_staticTextureMemoryAllocations;
-        std::unordered_map<D3D12GpuHandle::HandleType, DynamicMemoryAlloc>  m_dynamicMemoryAllocations;
-        std::vector<D3D12GpuMemoryHandle>                                   m_retiredAllocations;
-        D3D12DynamicBufferAllocatorPtr                                      m_dynamicMemoryAllocator;
-        D3D12CommittedResourceAllocatorPtr                                  m_committedResourceAllocator;
-
-        std::vector<D3D12GpuMemoryViewPtr>  m_memoryViews;
+        // Note handles ids are slot map ids. The slot map generation catches stale handles.
+        SlotMap<StaticBufferAlloc>          m_staticBufferMemoryAllocations;
+        SlotMap<StaticTextureAlloc>         m_staticTextureMemoryAllocations;
+        SlotMap<DynamicMemoryAlloc>         m_dynamicMemoryAllocations;
+        std::vector<D3D12GpuMemoryHandle>   m_retiredAllocations;
+        D3D12DynamicBufferAllocatorPtr      m_dynamicMemoryAllocator;
+        D3D12FrameLinearAllocatorPtr        m_transientMemoryAllocator;
+        D3D12UploadQueuePtr                 m_uploadQueue;
+        D3D12CommittedResourceAllocatorPtr  m_committedResourceAllocator;
+
+        SlotMap<D3D12GpuMemoryView>         m_memoryViews;
 
         FrameStats                              m_frameStats;
 
@@ -331,6 +411,8 @@ namespace D3D12Basics
 
         void CreateDevice(IDXGIAdapterPtr adapter);
 
+        void CreateNullDevice();
+
         IDXGIAdapterPtr CreateDXGIInfrastructure();
 
         void CreateDescriptorHeaps();
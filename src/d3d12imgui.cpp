@@ -191,7 +191,7 @@ ID3D12CommandList* D3D12ImGui::EndFrame(D3D12_CPU_DESCRIPTOR_HANDLE renderTarget
     const unsigned int binderIndex = 0;
     m_gpu.SetBindings(cmdList, bindings, binderIndex);
     m_gpu.SetVertexBuffer(cmdList, m_vertexBuffer, m_vertexBufferSizeBytes, sizeof(ImDrawVert));
-    m_gpu.SetIndexBuffer(cmdList, m_indexBuffer, m_indexBufferSizeBytes);
+    m_gpu.SetIndexBuffer(cmdList, m_indexBuffer, m_indexBufferSizeBytes, sizeof(ImDrawIdx));
 
     int vertexOffset = 0;
     int indexOffset = 0;
@@ -0,0 +1,373 @@
+#include "d3d12nullcmdlist.h"
+
+// c++ includes
+#include <cassert>
+
+using namespace D3D12Basics;
+
+D3D12NullGraphicsCmdList::D3D12NullGraphicsCmdList() : m_refCount(1), m_isOpen(false)
+{
+}
+
+HRESULT D3D12NullGraphicsCmdList::QueryInterface(REFIID riid, void** ppvObject)
+{
+    if (!ppvObject)
+        return E_POINTER;
+
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D12Object) ||
+        riid == __uuidof(ID3D12DeviceChild) || riid == __uuidof(ID3D12CommandList) ||
+        riid == __uuidof(ID3D12GraphicsCommandList))
+    {
+        *ppvObject = static_cast<ID3D12GraphicsCommandList*>(this);
+        AddRef();
+        return S_OK;
+    }
+
+    *ppvObject = nullptr;
+    return E_NOINTERFACE;
+}
+
+ULONG D3D12NullGraphicsCmdList::AddRef()
+{
+    return ++m_refCount;
+}
+
+ULONG D3D12NullGraphicsCmdList::Release()
+{
+    assert(m_refCount > 0);
+    const ULONG refCount = --m_refCount;
+    if (refCount == 0)
+        delete this;
+
+    return refCount;
+}
+
+HRESULT D3D12NullGraphicsCmdList::GetPrivateData(REFGUID, UINT*, void*)
+{
+    return E_NOTIMPL;
+}
+
+HRESULT D3D12NullGraphicsCmdList::SetPrivateData(REFGUID, UINT, const void*)
+{
+    return S_OK;
+}
+
+HRESULT D3D12NullGraphicsCmdList::SetPrivateDataInterface(REFGUID, const IUnknown*)
+{
+    return S_OK;
+}
+
+HRESULT D3D12NullGraphicsCmdList::SetName(LPCWSTR)
+{
+    return S_OK;
+}
+
+// Note theres no device behind a null cmd list
+HRESULT D3D12NullGraphicsCmdList::GetDevice(REFIID, void** ppvDevice)
+{
+    if (ppvDevice)
+        *ppvDevice = nullptr;
+
+    return E_NOINTERFACE;
+}
+
+D3D12_COMMAND_LIST_TYPE D3D12NullGraphicsCmdList::GetType()
+{
+    return D3D12_COMMAND_LIST_TYPE_DIRECT;
+}
+
+HRESULT D3D12NullGraphicsCmdList::Close()
+{
+    assert(m_isOpen);
+    m_isOpen = false;
+
+    return S_OK;
+}
+
+HRESULT D3D12NullGraphicsCmdList::Reset(ID3D12CommandAllocator*, ID3D12PipelineState*)
+{
+    assert(!m_isOpen);
+    m_isOpen = true;
+    m_counters = {};
+
+    return S_OK;
+}
+
+void D3D12NullGraphicsCmdList::ClearState(ID3D12PipelineState*)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::DrawInstanced(UINT, UINT, UINT, UINT)
+{
+    Record(CommandType::Draw);
+}
+
+void D3D12NullGraphicsCmdList::DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT)
+{
+    Record(CommandType::Draw);
+}
+
+void D3D12NullGraphicsCmdList::Dispatch(UINT, UINT, UINT)
+{
+    Record(CommandType::Draw);
+}
+
+void D3D12NullGraphicsCmdList::CopyBufferRegion(ID3D12Resource*, UINT64, ID3D12Resource*, UINT64, UINT64)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION*, UINT, UINT, UINT,
+                                                 const D3D12_TEXTURE_COPY_LOCATION*, const D3D12_BOX*)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::CopyResource(ID3D12Resource*, ID3D12Resource*)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::CopyTiles(ID3D12Resource*, const D3D12_TILED_RESOURCE_COORDINATE*,
+                                         const D3D12_TILE_REGION_SIZE*, ID3D12Resource*, UINT64,
+                                         D3D12_TILE_COPY_FLAGS)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::ResolveSubresource(ID3D12Resource*, UINT, ID3D12Resource*, UINT, DXGI_FORMAT)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::RSSetViewports(UINT, const D3D12_VIEWPORT*)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::RSSetScissorRects(UINT, const D3D12_RECT*)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::OMSetBlendFactor(const FLOAT[4])
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::OMSetStencilRef(UINT)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::SetPipelineState(ID3D12PipelineState*)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::ResourceBarrier(UINT, const D3D12_RESOURCE_BARRIER*)
+{
+    Record(CommandType::Barrier);
+}
+
+void D3D12NullGraphicsCmdList::ExecuteBundle(ID3D12GraphicsCommandList*)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::SetDescriptorHeaps(UINT, ID3D12DescriptorHeap* const*)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetComputeRootSignature(ID3D12RootSignature*)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::SetGraphicsRootSignature(ID3D12RootSignature*)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::SetComputeRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetComputeRoot32BitConstant(UINT, UINT, UINT)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetGraphicsRoot32BitConstant(UINT, UINT, UINT)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetComputeRoot32BitConstants(UINT, UINT, const void*, UINT)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetGraphicsRoot32BitConstants(UINT, UINT, const void*, UINT)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetComputeRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetGraphicsRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetComputeRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetGraphicsRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetComputeRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SetGraphicsRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW*)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::IASetVertexBuffers(UINT, UINT, const D3D12_VERTEX_BUFFER_VIEW*)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::SOSetTargets(UINT, UINT, const D3D12_STREAM_OUTPUT_BUFFER_VIEW*)
+{
+    Record(CommandType::Binding);
+}
+
+void D3D12NullGraphicsCmdList::OMSetRenderTargets(UINT, const D3D12_CPU_DESCRIPTOR_HANDLE*, BOOL,
+                                                  const D3D12_CPU_DESCRIPTOR_HANDLE*)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CLEAR_FLAGS, FLOAT, UINT8,
+                                                     UINT, const D3D12_RECT*)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE, const FLOAT[4], UINT,
+                                                     const D3D12_RECT*)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::ClearUnorderedAccessViewUint(D3D12_GPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE,
+                                                            ID3D12Resource*, const UINT[4], UINT, const D3D12_RECT*)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::ClearUnorderedAccessViewFloat(D3D12_GPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE,
+                                                             ID3D12Resource*, const FLOAT[4], UINT, const D3D12_RECT*)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::DiscardResource(ID3D12Resource*, const D3D12_DISCARD_REGION*)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::BeginQuery(ID3D12QueryHeap*, D3D12_QUERY_TYPE, UINT)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::EndQuery(ID3D12QueryHeap*, D3D12_QUERY_TYPE, UINT)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::ResolveQueryData(ID3D12QueryHeap*, D3D12_QUERY_TYPE, UINT, UINT,
+                                                ID3D12Resource*, UINT64)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::SetPredication(ID3D12Resource*, UINT64, D3D12_PREDICATION_OP)
+{
+    Record(CommandType::StateChange);
+}
+
+void D3D12NullGraphicsCmdList::SetMarker(UINT, const void*, UINT)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::BeginEvent(UINT, const void*, UINT)
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::EndEvent()
+{
+    Record(CommandType::Other);
+}
+
+void D3D12NullGraphicsCmdList::ExecuteIndirect(ID3D12CommandSignature*, UINT, ID3D12Resource*, UINT64,
+                                               ID3D12Resource*, UINT64)
+{
+    Record(CommandType::Draw);
+}
+
+void D3D12NullGraphicsCmdList::Record(CommandType commandType)
+{
+    assert(m_isOpen);
+
+    ++m_counters.m_commandsCount;
+    switch (commandType)
+    {
+    case CommandType::Draw:
+        ++m_counters.m_drawsCount;
+        break;
+    case CommandType::Binding:
+        ++m_counters.m_bindingsCount;
+        break;
+    case CommandType::StateChange:
+        ++m_counters.m_stateChangesCount;
+        break;
+    case CommandType::Barrier:
+        ++m_counters.m_barriersCount;
+        break;
+    default:
+        break;
+    }
+}
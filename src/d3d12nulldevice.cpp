@@ -0,0 +1,882 @@
+#include "d3d12nulldevice.h"
+
+// project includes
+#include "utils.h"
+#include "d3d12nullcmdlist.h"
+
+// c++ includes
+#include <cassert>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+// windows includes
+#include <wrl.h>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const uint64_t g_nullResourceAlignment  = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    const uint64_t g_nullTimestampFrequency = 1000000;
+
+    // NOTE arbitrary but plausible values. Handles and addresses are never dereferenced
+    // by the null objects, they just need to be unique and not null.
+    const UINT      g_nullDescriptorSize        = 32;
+    const uint64_t  g_nullFirstGpuVirtualAddress = 0x100000000ull;
+    const uint64_t  g_nullFirstDescriptorAddress = 0x10000ull;
+
+    // Common implementation of the IUnknown, ID3D12Object and ID3D12DeviceChild
+    // parts of the null device children. The device is kept alive by its children
+    // the same way a d3d12 device is.
+    template<typename Interface>
+    class D3D12NullDeviceChild : public Interface
+    {
+    public:
+        explicit D3D12NullDeviceChild(ID3D12Device* device) : m_refCount(1), m_device(device)
+        {
+            assert(m_device);
+        }
+
+        virtual ~D3D12NullDeviceChild() = default;
+
+        // IUnknown
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+        {
+            if (!ppvObject)
+                return E_POINTER;
+
+            const bool isPageable = std::is_base_of<ID3D12Pageable, Interface>::value &&
+                                    riid == __uuidof(ID3D12Pageable);
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D12Object) ||
+                riid == __uuidof(ID3D12DeviceChild) || isPageable || riid == __uuidof(Interface))
+            {
+                *ppvObject = static_cast<Interface*>(this);
+                AddRef();
+                return S_OK;
+            }
+
+            *ppvObject = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return ++m_refCount;
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            assert(m_refCount > 0);
+            const ULONG refCount = --m_refCount;
+            if (refCount == 0)
+                delete this;
+
+            return refCount;
+        }
+
+        // ID3D12Object
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override
+        {
+            return E_NOTIMPL;
+        }
+
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override
+        {
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override
+        {
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override
+        {
+            return S_OK;
+        }
+
+        // ID3D12DeviceChild
+        HRESULT STDMETHODCALLTYPE GetDevice(REFIID riid, void** ppvDevice) override
+        {
+            return m_device->QueryInterface(riid, ppvDevice);
+        }
+
+    private:
+        std::atomic<ULONG>                      m_refCount;
+        Microsoft::WRL::ComPtr<ID3D12Device>    m_device;
+    };
+
+    class D3D12NullFence : public D3D12NullDeviceChild<ID3D12Fence>
+    {
+    public:
+        D3D12NullFence(ID3D12Device* device, UINT64 initialValue) : D3D12NullDeviceChild(device),
+                                                                    m_value(initialValue)
+        {
+        }
+
+        UINT64 STDMETHODCALLTYPE GetCompletedValue() override
+        {
+            return m_value;
+        }
+
+        HRESULT STDMETHODCALLTYPE SetEventOnCompletion(UINT64 value, HANDLE event) override
+        {
+            // NOTE a null event would block until the value is reached
+            assert(event);
+
+            std::lock_guard<std::mutex> lock(m_eventsMutex);
+            if (m_value >= value)
+                SetEvent(event);
+            else
+                m_pendingEvents.push_back({ value, event });
+
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE Signal(UINT64 value) override
+        {
+            std::lock_guard<std::mutex> lock(m_eventsMutex);
+            m_value = value;
+
+            auto firstPending = std::partition(m_pendingEvents.begin(), m_pendingEvents.end(),
+                                               [value](const PendingEvent& pendingEvent)
+                                               {
+                                                   return pendingEvent.first > value;
+                                               });
+            for (auto it = firstPending; it != m_pendingEvents.end(); ++it)
+                SetEvent(it->second);
+            m_pendingEvents.erase(firstPending, m_pendingEvents.end());
+
+            return S_OK;
+        }
+
+    private:
+        using PendingEvent = std::pair<UINT64, HANDLE>;
+
+        std::atomic<UINT64>         m_value;
+        std::mutex                  m_eventsMutex;
+        std::vector<PendingEvent>   m_pendingEvents;
+    };
+
+    // NOTE the work executed is done as soon as its submitted, so signals are immediate
+    class D3D12NullCommandQueue : public D3D12NullDeviceChild<ID3D12CommandQueue>
+    {
+    public:
+        D3D12NullCommandQueue(ID3D12Device* device, const D3D12_COMMAND_QUEUE_DESC& desc) : D3D12NullDeviceChild(device),
+                                                                                             m_desc(desc)
+        {
+        }
+
+        void STDMETHODCALLTYPE UpdateTileMappings(ID3D12Resource*, UINT, const D3D12_TILED_RESOURCE_COORDINATE*,
+                                                  const D3D12_TILE_REGION_SIZE*, ID3D12Heap*, UINT,
+                                                  const D3D12_TILE_RANGE_FLAGS*, const UINT*, const UINT*,
+                                                  D3D12_TILE_MAPPING_FLAGS) override
+        {
+        }
+
+        void STDMETHODCALLTYPE CopyTileMappings(ID3D12Resource*, const D3D12_TILED_RESOURCE_COORDINATE*,
+                                                ID3D12Resource*, const D3D12_TILED_RESOURCE_COORDINATE*,
+                                                const D3D12_TILE_REGION_SIZE*, D3D12_TILE_MAPPING_FLAGS) override
+        {
+        }
+
+        void STDMETHODCALLTYPE ExecuteCommandLists(UINT, ID3D12CommandList* const*) override
+        {
+        }
+
+        void STDMETHODCALLTYPE SetMarker(UINT, const void*, UINT) override
+        {
+        }
+
+        void STDMETHODCALLTYPE BeginEvent(UINT, const void*, UINT) override
+        {
+        }
+
+        void STDMETHODCALLTYPE EndEvent() override
+        {
+        }
+
+        HRESULT STDMETHODCALLTYPE Signal(ID3D12Fence* fence, UINT64 value) override
+        {
+            if (!fence)
+                return E_INVALIDARG;
+
+            return fence->Signal(value);
+        }
+
+        HRESULT STDMETHODCALLTYPE Wait(ID3D12Fence*, UINT64) override
+        {
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetTimestampFrequency(UINT64* pFrequency) override
+        {
+            if (!pFrequency)
+                return E_POINTER;
+
+            *pFrequency = g_nullTimestampFrequency;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetClockCalibration(UINT64* pGpuTimestamp, UINT64* pCpuTimestamp) override
+        {
+            if (!pGpuTimestamp || !pCpuTimestamp)
+                return E_POINTER;
+
+            LARGE_INTEGER counter;
+            QueryPerformanceCounter(&counter);
+            *pGpuTimestamp = *pCpuTimestamp = static_cast<UINT64>(counter.QuadPart);
+            return S_OK;
+        }
+
+        D3D12_COMMAND_QUEUE_DESC STDMETHODCALLTYPE GetDesc() override
+        {
+            return m_desc;
+        }
+
+    private:
+        D3D12_COMMAND_QUEUE_DESC m_desc;
+    };
+
+    class D3D12NullCommandAllocator : public D3D12NullDeviceChild<ID3D12CommandAllocator>
+    {
+    public:
+        using D3D12NullDeviceChild::D3D12NullDeviceChild;
+
+        HRESULT STDMETHODCALLTYPE Reset() override
+        {
+            return S_OK;
+        }
+    };
+
+    class D3D12NullDescriptorHeap : public D3D12NullDeviceChild<ID3D12DescriptorHeap>
+    {
+    public:
+        D3D12NullDescriptorHeap(ID3D12Device* device, const D3D12_DESCRIPTOR_HEAP_DESC& desc,
+                                uint64_t startAddress) : D3D12NullDeviceChild(device), m_desc(desc),
+                                                         m_cpuStart{ static_cast<SIZE_T>(startAddress) },
+                                                         m_gpuStart{ 0 }
+        {
+            if (m_desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE)
+                m_gpuStart.ptr = startAddress;
+        }
+
+        D3D12_DESCRIPTOR_HEAP_DESC STDMETHODCALLTYPE GetDesc() override
+        {
+            return m_desc;
+        }
+
+        D3D12_CPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetCPUDescriptorHandleForHeapStart() override
+        {
+            return m_cpuStart;
+        }
+
+        D3D12_GPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetGPUDescriptorHandleForHeapStart() override
+        {
+            return m_gpuStart;
+        }
+
+    private:
+        D3D12_DESCRIPTOR_HEAP_DESC  m_desc;
+        D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart;
+        D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart;
+    };
+
+    class D3D12NullQueryHeap : public D3D12NullDeviceChild<ID3D12QueryHeap>
+    {
+    public:
+        using D3D12NullDeviceChild::D3D12NullDeviceChild;
+    };
+
+    class D3D12NullRootSignature : public D3D12NullDeviceChild<ID3D12RootSignature>
+    {
+    public:
+        using D3D12NullDeviceChild::D3D12NullDeviceChild;
+    };
+
+    class D3D12NullPipelineState : public D3D12NullDeviceChild<ID3D12PipelineState>
+    {
+    public:
+        using D3D12NullDeviceChild::D3D12NullDeviceChild;
+
+        HRESULT STDMETHODCALLTYPE GetCachedBlob(ID3DBlob** ppBlob) override
+        {
+            if (ppBlob)
+                *ppBlob = nullptr;
+
+            return E_NOTIMPL;
+        }
+    };
+
+    // NOTE only upload and readback heaps get system memory, so they can be mapped
+    class D3D12NullResource : public D3D12NullDeviceChild<ID3D12Resource>
+    {
+    public:
+        D3D12NullResource(ID3D12Device* device, const D3D12_RESOURCE_DESC& desc,
+                          const D3D12_HEAP_PROPERTIES& heapProperties, D3D12_HEAP_FLAGS heapFlags,
+                          D3D12_GPU_VIRTUAL_ADDRESS gpuVirtualAddress) :    D3D12NullDeviceChild(device), m_desc(desc),
+                                                                            m_heapProperties(heapProperties),
+                                                                            m_heapFlags(heapFlags),
+                                                                            m_gpuVirtualAddress(gpuVirtualAddress),
+                                                                            m_memory(nullptr)
+        {
+            const bool isCpuVisible = m_heapProperties.Type == D3D12_HEAP_TYPE_UPLOAD ||
+                                      m_heapProperties.Type == D3D12_HEAP_TYPE_READBACK;
+            if (isCpuVisible && m_desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+            {
+                m_memory = _aligned_malloc(static_cast<size_t>(m_desc.Width), static_cast<size_t>(g_nullResourceAlignment));
+                assert(m_memory);
+                memset(m_memory, 0, static_cast<size_t>(m_desc.Width));
+            }
+        }
+
+        ~D3D12NullResource()
+        {
+            if (m_memory)
+                _aligned_free(m_memory);
+        }
+
+        HRESULT STDMETHODCALLTYPE Map(UINT subresource, const D3D12_RANGE*, void** ppData) override
+        {
+            if (!m_memory || subresource != 0)
+                return E_INVALIDARG;
+
+            if (ppData)
+                *ppData = m_memory;
+
+            return S_OK;
+        }
+
+        void STDMETHODCALLTYPE Unmap(UINT, const D3D12_RANGE*) override
+        {
+        }
+
+        D3D12_RESOURCE_DESC STDMETHODCALLTYPE GetDesc() override
+        {
+            return m_desc;
+        }
+
+        D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE GetGPUVirtualAddress() override
+        {
+            return m_gpuVirtualAddress;
+        }
+
+        HRESULT STDMETHODCALLTYPE WriteToSubresource(UINT, const D3D12_BOX*, const void*, UINT, UINT) override
+        {
+            return E_NOTIMPL;
+        }
+
+        HRESULT STDMETHODCALLTYPE ReadFromSubresource(void*, UINT, UINT, UINT, const D3D12_BOX*) override
+        {
+            return E_NOTIMPL;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetHeapProperties(D3D12_HEAP_PROPERTIES* pHeapProperties,
+                                                    D3D12_HEAP_FLAGS* pHeapFlags) override
+        {
+            if (pHeapProperties)
+                *pHeapProperties = m_heapProperties;
+            if (pHeapFlags)
+                *pHeapFlags = m_heapFlags;
+
+            return S_OK;
+        }
+
+    private:
+        D3D12_RESOURCE_DESC         m_desc;
+        D3D12_HEAP_PROPERTIES       m_heapProperties;
+        D3D12_HEAP_FLAGS            m_heapFlags;
+        D3D12_GPU_VIRTUAL_ADDRESS   m_gpuVirtualAddress;
+        void*                       m_memory;
+    };
+
+    // Creates a null object and hands it over through riid the same way the device does
+    template<typename T, typename... Args>
+    HRESULT CreateNullObject(REFIID riid, void** ppvObject, Args&&... args)
+    {
+        if (!ppvObject)
+            return E_POINTER;
+
+        T* object = new T(std::forward<Args>(args)...);
+        const HRESULT result = object->QueryInterface(riid, ppvObject);
+        object->Release();
+
+        return result;
+    }
+
+    bool IsBlockCompressed(DXGI_FORMAT format)
+    {
+        return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+               (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+    }
+
+    UINT BlockSizeBytes(DXGI_FORMAT format)
+    {
+        assert(IsBlockCompressed(format));
+
+        const bool is8Bytes = (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC1_UNORM_SRGB) ||
+                              (format >= DXGI_FORMAT_BC4_TYPELESS && format <= DXGI_FORMAT_BC4_SNORM);
+        return is8Bytes ? 8 : 16;
+    }
+
+    // NOTE only the formats with a fixed size per pixel. Block compressed formats are handled apart.
+    UINT BitsPerPixel(DXGI_FORMAT format)
+    {
+        if (format >= DXGI_FORMAT_R32G32B32A32_TYPELESS && format <= DXGI_FORMAT_R32G32B32A32_SINT)
+            return 128;
+        if (format >= DXGI_FORMAT_R32G32B32_TYPELESS && format <= DXGI_FORMAT_R32G32B32_SINT)
+            return 96;
+        if (format >= DXGI_FORMAT_R16G16B16A16_TYPELESS && format <= DXGI_FORMAT_X32_TYPELESS_G8X24_UINT)
+            return 64;
+        if (format >= DXGI_FORMAT_R10G10B10A2_TYPELESS && format <= DXGI_FORMAT_X24_TYPELESS_G8_UINT)
+            return 32;
+        if (format >= DXGI_FORMAT_R8G8_TYPELESS && format <= DXGI_FORMAT_R16_SINT)
+            return 16;
+        if (format >= DXGI_FORMAT_R8_TYPELESS && format <= DXGI_FORMAT_A8_UNORM)
+            return 8;
+        if (format >= DXGI_FORMAT_R9G9B9E5_SHAREDEXP && format <= DXGI_FORMAT_G8R8_G8B8_UNORM)
+            return 32;
+        if (format == DXGI_FORMAT_B5G6R5_UNORM || format == DXGI_FORMAT_B5G5R5A1_UNORM ||
+            format == DXGI_FORMAT_B4G4R4A4_UNORM)
+            return 16;
+        if (format >= DXGI_FORMAT_B8G8R8A8_UNORM && format <= DXGI_FORMAT_B8G8R8X8_UNORM_SRGB)
+            return 32;
+
+        assert(false);
+        return 32;
+    }
+
+    bool IsDepthStencilFormat(DXGI_FORMAT format)
+    {
+        return format == DXGI_FORMAT_R32G8X24_TYPELESS || format == DXGI_FORMAT_D32_FLOAT_S8X24_UINT ||
+               format == DXGI_FORMAT_R24G8_TYPELESS || format == DXGI_FORMAT_D24_UNORM_S8_UINT;
+    }
+}
+
+D3D12NullDevice::D3D12NullDevice() :    m_refCount(1),
+                                        m_nextGpuVirtualAddress(g_nullFirstGpuVirtualAddress),
+                                        m_nextDescriptorAddress(g_nullFirstDescriptorAddress)
+{
+}
+
+HRESULT D3D12NullDevice::QueryInterface(REFIID riid, void** ppvObject)
+{
+    if (!ppvObject)
+        return E_POINTER;
+
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D12Object) || riid == __uuidof(ID3D12Device))
+    {
+        *ppvObject = static_cast<ID3D12Device*>(this);
+        AddRef();
+        return S_OK;
+    }
+
+    *ppvObject = nullptr;
+    return E_NOINTERFACE;
+}
+
+ULONG D3D12NullDevice::AddRef()
+{
+    return ++m_refCount;
+}
+
+ULONG D3D12NullDevice::Release()
+{
+    assert(m_refCount > 0);
+    const ULONG refCount = --m_refCount;
+    if (refCount == 0)
+        delete this;
+
+    return refCount;
+}
+
+HRESULT D3D12NullDevice::GetPrivateData(REFGUID, UINT*, void*)
+{
+    return E_NOTIMPL;
+}
+
+HRESULT D3D12NullDevice::SetPrivateData(REFGUID, UINT, const void*)
+{
+    return S_OK;
+}
+
+HRESULT D3D12NullDevice::SetPrivateDataInterface(REFGUID, const IUnknown*)
+{
+    return S_OK;
+}
+
+HRESULT D3D12NullDevice::SetName(LPCWSTR)
+{
+    return S_OK;
+}
+
+UINT D3D12NullDevice::GetNodeCount()
+{
+    return 1;
+}
+
+HRESULT D3D12NullDevice::CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC* pDesc, REFIID riid, void** ppCommandQueue)
+{
+    if (!pDesc)
+        return E_INVALIDARG;
+
+    return CreateNullObject<D3D12NullCommandQueue>(riid, ppCommandQueue, this, *pDesc);
+}
+
+HRESULT D3D12NullDevice::CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, REFIID riid, void** ppCommandAllocator)
+{
+    return CreateNullObject<D3D12NullCommandAllocator>(riid, ppCommandAllocator, this);
+}
+
+HRESULT D3D12NullDevice::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pDesc, REFIID riid,
+                                                     void** ppPipelineState)
+{
+    if (!pDesc)
+        return E_INVALIDARG;
+
+    return CreateNullObject<D3D12NullPipelineState>(riid, ppPipelineState, this);
+}
+
+HRESULT D3D12NullDevice::CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC* pDesc, REFIID riid,
+                                                    void** ppPipelineState)
+{
+    if (!pDesc)
+        return E_INVALIDARG;
+
+    return CreateNullObject<D3D12NullPipelineState>(riid, ppPipelineState, this);
+}
+
+// NOTE d3d12 creates the cmd lists open
+HRESULT D3D12NullDevice::CreateCommandList(UINT, D3D12_COMMAND_LIST_TYPE type, ID3D12CommandAllocator* pCommandAllocator,
+                                           ID3D12PipelineState* pInitialState, REFIID riid, void** ppCommandList)
+{
+    if (!ppCommandList)
+        return E_POINTER;
+
+    // TODO only direct cmd lists supported
+    if (type != D3D12_COMMAND_LIST_TYPE_DIRECT)
+        return E_NOTIMPL;
+
+    auto cmdList = new D3D12NullGraphicsCmdList();
+    HRESULT result = cmdList->Reset(pCommandAllocator, pInitialState);
+    if (SUCCEEDED(result))
+        result = cmdList->QueryInterface(riid, ppCommandList);
+    cmdList->Release();
+
+    return result;
+}
+
+HRESULT D3D12NullDevice::CheckFeatureSupport(D3D12_FEATURE Feature, void* pFeatureSupportData, UINT FeatureSupportDataSize)
+{
+    if (!pFeatureSupportData)
+        return E_INVALIDARG;
+
+    switch (Feature)
+    {
+        // NOTE the highest version asked is supported
+        case D3D12_FEATURE_ROOT_SIGNATURE:
+            return FeatureSupportDataSize == sizeof(D3D12_FEATURE_DATA_ROOT_SIGNATURE) ? S_OK : E_INVALIDARG;
+
+        case D3D12_FEATURE_FORMAT_INFO:
+        {
+            if (FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_FORMAT_INFO))
+                return E_INVALIDARG;
+
+            auto formatInfo = static_cast<D3D12_FEATURE_DATA_FORMAT_INFO*>(pFeatureSupportData);
+            formatInfo->PlaneCount = IsDepthStencilFormat(formatInfo->Format) ? 2 : 1;
+            return S_OK;
+        }
+
+        default:
+            return E_NOTIMPL;
+    }
+}
+
+HRESULT D3D12NullDevice::CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* pDescriptorHeapDesc, REFIID riid,
+                                              void** ppvHeap)
+{
+    if (!pDescriptorHeapDesc || pDescriptorHeapDesc->NumDescriptors == 0)
+        return E_INVALIDARG;
+
+    const uint64_t heapSizeBytes = static_cast<uint64_t>(pDescriptorHeapDesc->NumDescriptors) * g_nullDescriptorSize;
+    const uint64_t startAddress = ReserveAddressRange(m_nextDescriptorAddress, heapSizeBytes);
+
+    return CreateNullObject<D3D12NullDescriptorHeap>(riid, ppvHeap, this, *pDescriptorHeapDesc, startAddress);
+}
+
+UINT D3D12NullDevice::GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE)
+{
+    return g_nullDescriptorSize;
+}
+
+HRESULT D3D12NullDevice::CreateRootSignature(UINT, const void* pBlobWithRootSignature, SIZE_T blobLengthInBytes,
+                                             REFIID riid, void** ppvRootSignature)
+{
+    if (!pBlobWithRootSignature || blobLengthInBytes == 0)
+        return E_INVALIDARG;
+
+    return CreateNullObject<D3D12NullRootSignature>(riid, ppvRootSignature, this);
+}
+
+void D3D12NullDevice::CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+void D3D12NullDevice::CreateShaderResourceView(ID3D12Resource*, const D3D12_SHADER_RESOURCE_VIEW_DESC*,
+                                               D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+void D3D12NullDevice::CreateUnorderedAccessView(ID3D12Resource*, ID3D12Resource*, const D3D12_UNORDERED_ACCESS_VIEW_DESC*,
+                                                D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+void D3D12NullDevice::CreateRenderTargetView(ID3D12Resource*, const D3D12_RENDER_TARGET_VIEW_DESC*,
+                                             D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+void D3D12NullDevice::CreateDepthStencilView(ID3D12Resource*, const D3D12_DEPTH_STENCIL_VIEW_DESC*,
+                                             D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+void D3D12NullDevice::CreateSampler(const D3D12_SAMPLER_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE)
+{
+}
+
+void D3D12NullDevice::CopyDescriptors(UINT, const D3D12_CPU_DESCRIPTOR_HANDLE*, const UINT*, UINT,
+                                      const D3D12_CPU_DESCRIPTOR_HANDLE*, const UINT*, D3D12_DESCRIPTOR_HEAP_TYPE)
+{
+}
+
+void D3D12NullDevice::CopyDescriptorsSimple(UINT, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE,
+                                            D3D12_DESCRIPTOR_HEAP_TYPE)
+{
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO D3D12NullDevice::GetResourceAllocationInfo(UINT, UINT numResourceDescs,
+                                                                          const D3D12_RESOURCE_DESC* pResourceDescs)
+{
+    D3D12_RESOURCE_ALLOCATION_INFO allocationInfo{ 0, g_nullResourceAlignment };
+    for (UINT i = 0; i < numResourceDescs; ++i)
+    {
+        const auto& desc = pResourceDescs[i];
+
+        UINT64 sizeBytes = desc.Width;
+        if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER)
+        {
+            const UINT arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+            GetCopyableFootprints(&desc, 0, desc.MipLevels * arraySize, 0, nullptr, nullptr, nullptr, &sizeBytes);
+        }
+
+        allocationInfo.SizeInBytes += AlignToPowerof2(sizeBytes, g_nullResourceAlignment);
+    }
+
+    return allocationInfo;
+}
+
+D3D12_HEAP_PROPERTIES D3D12NullDevice::GetCustomHeapProperties(UINT nodeMask, D3D12_HEAP_TYPE heapType)
+{
+    D3D12_HEAP_PROPERTIES heapProperties{};
+    heapProperties.Type = heapType;
+    heapProperties.CPUPageProperty = heapType == D3D12_HEAP_TYPE_DEFAULT ? D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE :
+                                                                           D3D12_CPU_PAGE_PROPERTY_WRITE_BACK;
+    heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;
+    heapProperties.CreationNodeMask = nodeMask;
+    heapProperties.VisibleNodeMask = nodeMask;
+
+    return heapProperties;
+}
+
+HRESULT D3D12NullDevice::CreateCommittedResource(const D3D12_HEAP_PROPERTIES* pHeapProperties, D3D12_HEAP_FLAGS HeapFlags,
+                                                 const D3D12_RESOURCE_DESC* pDesc, D3D12_RESOURCE_STATES,
+                                                 const D3D12_CLEAR_VALUE*, REFIID riidResource, void** ppvResource)
+{
+    if (!pHeapProperties || !pDesc)
+        return E_INVALIDARG;
+
+    // NOTE as d3d12 textures dont have a gpu virtual address
+    D3D12_GPU_VIRTUAL_ADDRESS gpuVirtualAddress = 0;
+    if (pDesc->Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        gpuVirtualAddress = ReserveAddressRange(m_nextGpuVirtualAddress, pDesc->Width);
+
+    return CreateNullObject<D3D12NullResource>(riidResource, ppvResource, this, *pDesc, *pHeapProperties, HeapFlags,
+                                               gpuVirtualAddress);
+}
+
+HRESULT D3D12NullDevice::CreateHeap(const D3D12_HEAP_DESC*, REFIID, void** ppvHeap)
+{
+    if (ppvHeap)
+        *ppvHeap = nullptr;
+
+    return E_NOTIMPL;
+}
+
+HRESULT D3D12NullDevice::CreatePlacedResource(ID3D12Heap*, UINT64, const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES,
+                                              const D3D12_CLEAR_VALUE*, REFIID, void** ppvResource)
+{
+    if (ppvResource)
+        *ppvResource = nullptr;
+
+    return E_NOTIMPL;
+}
+
+HRESULT D3D12NullDevice::CreateReservedResource(const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE*,
+                                                REFIID, void** ppvResource)
+{
+    if (ppvResource)
+        *ppvResource = nullptr;
+
+    return E_NOTIMPL;
+}
+
+HRESULT D3D12NullDevice::CreateSharedHandle(ID3D12DeviceChild*, const SECURITY_ATTRIBUTES*, DWORD, LPCWSTR, HANDLE*)
+{
+    return E_NOTIMPL;
+}
+
+HRESULT D3D12NullDevice::OpenSharedHandle(HANDLE, REFIID, void** ppvObj)
+{
+    if (ppvObj)
+        *ppvObj = nullptr;
+
+    return E_NOTIMPL;
+}
+
+HRESULT D3D12NullDevice::OpenSharedHandleByName(LPCWSTR, DWORD, HANDLE*)
+{
+    return E_NOTIMPL;
+}
+
+HRESULT D3D12NullDevice::MakeResident(UINT, ID3D12Pageable* const*)
+{
+    return S_OK;
+}
+
+HRESULT D3D12NullDevice::Evict(UINT, ID3D12Pageable* const*)
+{
+    return S_OK;
+}
+
+HRESULT D3D12NullDevice::CreateFence(UINT64 InitialValue, D3D12_FENCE_FLAGS, REFIID riid, void** ppFence)
+{
+    return CreateNullObject<D3D12NullFence>(riid, ppFence, this, InitialValue);
+}
+
+HRESULT D3D12NullDevice::GetDeviceRemovedReason()
+{
+    return S_OK;
+}
+
+// NOTE same layout rules as d3d12: rows aligned to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT and
+// subresources to D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT. Planar formats not supported.
+void D3D12NullDevice::GetCopyableFootprints(const D3D12_RESOURCE_DESC* pResourceDesc, UINT FirstSubresource,
+                                            UINT NumSubresources, UINT64 BaseOffset,
+                                            D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts, UINT* pNumRows,
+                                            UINT64* pRowSizeInBytes, UINT64* pTotalBytes)
+{
+    assert(pResourceDesc);
+    const auto& desc = *pResourceDesc;
+
+    UINT64 offset = 0;
+    UINT64 totalBytes = 0;
+    for (UINT i = 0; i < NumSubresources; ++i)
+    {
+        D3D12_SUBRESOURCE_FOOTPRINT footprint{};
+        footprint.Format = desc.Format;
+
+        UINT    rowsCount   = 1;
+        UINT64  rowSize     = desc.Width;
+        if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        {
+            footprint.Width = static_cast<UINT>(desc.Width);
+            footprint.Height = 1;
+            footprint.Depth = 1;
+        }
+        else
+        {
+            const UINT mipLevels = std::max<UINT>(desc.MipLevels, 1);
+            const UINT mip = (FirstSubresource + i) % mipLevels;
+            footprint.Width = std::max<UINT>(static_cast<UINT>(desc.Width >> mip), 1);
+            footprint.Height = std::max<UINT>(desc.Height >> mip, 1);
+            footprint.Depth = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ?
+                              std::max<UINT>(desc.DepthOrArraySize >> mip, 1) : 1;
+
+            if (IsBlockCompressed(desc.Format))
+            {
+                footprint.Width = static_cast<UINT>(AlignToPowerof2(footprint.Width, 4));
+                footprint.Height = static_cast<UINT>(AlignToPowerof2(footprint.Height, 4));
+                rowsCount = footprint.Height / 4;
+                rowSize = (footprint.Width / 4) * BlockSizeBytes(desc.Format);
+            }
+            else
+            {
+                rowsCount = footprint.Height;
+                rowSize = (static_cast<UINT64>(footprint.Width) * BitsPerPixel(desc.Format) + 7) / 8;
+            }
+        }
+        footprint.RowPitch = static_cast<UINT>(AlignToPowerof2(rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
+
+        offset = AlignToPowerof2(offset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        if (pLayouts)
+            pLayouts[i] = { BaseOffset + offset, footprint };
+        if (pNumRows)
+            pNumRows[i] = rowsCount;
+        if (pRowSizeInBytes)
+            pRowSizeInBytes[i] = rowSize;
+
+        const UINT64 sizeBytes = static_cast<UINT64>(footprint.RowPitch) * (rowsCount * footprint.Depth - 1) + rowSize;
+        totalBytes = offset + sizeBytes;
+        offset = totalBytes;
+    }
+
+    if (pTotalBytes)
+        *pTotalBytes = totalBytes;
+}
+
+HRESULT D3D12NullDevice::CreateQueryHeap(const D3D12_QUERY_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap)
+{
+    if (!pDesc)
+        return E_INVALIDARG;
+
+    return CreateNullObject<D3D12NullQueryHeap>(riid, ppvHeap, this);
+}
+
+HRESULT D3D12NullDevice::SetStablePowerState(BOOL)
+{
+    return S_OK;
+}
+
+HRESULT D3D12NullDevice::CreateCommandSignature(const D3D12_COMMAND_SIGNATURE_DESC*, ID3D12RootSignature*, REFIID,
+                                                void** ppvCommandSignature)
+{
+    if (ppvCommandSignature)
+        *ppvCommandSignature = nullptr;
+
+    return E_NOTIMPL;
+}
+
+void D3D12NullDevice::GetResourceTiling(ID3D12Resource*, UINT* pNumTilesForEntireResource, D3D12_PACKED_MIP_INFO*,
+                                        D3D12_TILE_SHAPE*, UINT* pNumSubresourceTilings, UINT, D3D12_SUBRESOURCE_TILING*)
+{
+    if (pNumTilesForEntireResource)
+        *pNumTilesForEntireResource = 0;
+    if (pNumSubresourceTilings)
+        *pNumSubresourceTilings = 0;
+}
+
+LUID D3D12NullDevice::GetAdapterLuid()
+{
+    return LUID{ 0, 0 };
+}
+
+uint64_t D3D12NullDevice::ReserveAddressRange(std::atomic<uint64_t>& nextAddress, uint64_t sizeBytes)
+{
+    const uint64_t alignedSizeBytes = AlignToPowerof2(std::max<uint64_t>(sizeBytes, 1), g_nullResourceAlignment);
+    return nextAddress.fetch_add(alignedSizeBytes);
+}
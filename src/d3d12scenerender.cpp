@@ -3,34 +3,42 @@
 // project includes
 #include "d3d12utils.h"
 #include "d3d12gpu.h"
+#include "vertexformat.h"
+#include "matrixbatch.h"
 
 // c++ includes
 #include <thread>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <iterator>
 
 using namespace D3D12Basics;
 
 namespace
 {
-    static const size_t g_quadVertexSizeBytes = 5 * sizeof(float);
+    static const size_t g_quadVertexSizeBytes = QuadVertexFormat::m_strideBytes;
     static const size_t g_quadVBSizeBytes = 4 * g_quadVertexSizeBytes;
     static const size_t g_quadIndicesCount = 6;
     static const size_t g_quadIBSizeBytes = sizeof(uint16_t) * g_quadIndicesCount;
  
     static const Resolution g_shadowMapResolution = { 4096, 4096 };
 
+    // NOTE scenes with fewer gpu meshes are culled in the main thread
+    static const size_t g_parallelCullingMinCount = 4096;
+    static const size_t g_cullingTaskRange = 1024;
+
+    // NOTE gpu meshes per object data block
+    static const size_t g_objectDataBlockSize = 1024;
+
+    // NOTE the models not added to the scene render yet
+    static const size_t g_invalidGpuMeshIndex = static_cast<size_t>(-1);
+
     D3D12_DEPTH_STENCIL_DESC CreateDepthStencilDesc();
 
     const D3D12PipelineStateDesc g_stdMaterialPipeDesc =
     {
-        {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "BINORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 44, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        },
+        QuantizedVertexFormat::InputElements(),
         L"./data/shaders/stdmaterial.hlsl",
         L"./data/shaders/stdmaterial.hlsl",
         std::move(CreateDefaultRasterizerState()),
@@ -45,11 +53,7 @@ namespace
 
     const D3D12PipelineStateDesc g_defaultMaterialPipeDesc =
     {
-        {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-        },
+        QuantizedVertexFormat::InputElements(),
         L"./data/shaders/defaultmaterial.hlsl",
         L"./data/shaders/defaultmaterial.hlsl",
         std::move(CreateDefaultRasterizerState()),
@@ -64,11 +68,7 @@ namespace
 
     const D3D12PipelineStateDesc g_defaultMaterialFixedColorPipeDesc =
     {
-        {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-        },
+        QuantizedVertexFormat::InputElements(),
         L"./data/shaders/defaultmaterial_fixedcolor.hlsl",
         L"./data/shaders/defaultmaterial_fixedcolor.hlsl",
         std::move(CreateDefaultRasterizerState()),
@@ -83,9 +83,7 @@ namespace
 
     const D3D12PipelineStateDesc g_defaultMaterialFixedColorNoShadowsPipeDesc =
     {
-        {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        },
+        QuantizedVertexFormat::InputElements(),
         L"./data/shaders/defaultmaterial_fixedcolor_noshadows.hlsl",
         L"./data/shaders/defaultmaterial_fixedcolor_noshadows.hlsl",
         std::move(CreateDefaultRasterizerState()),
@@ -100,9 +98,7 @@ namespace
 
     const D3D12PipelineStateDesc g_shadowPipeDesc =
     {
-        {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        },
+        QuantizedVertexFormat::InputElements(),
         L"./data/shaders/depthonly.hlsl",
         L"./data/shaders/depthonly.hlsl",
         std::move(CreateDefaultRasterizerState()),
@@ -117,10 +113,7 @@ namespace
 
     const D3D12PipelineStateDesc g_shadowDebugPipeDesc =
     {
-        {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        },
+        QuadVertexFormat::InputElements(),
         L"./data/shaders/depthdebug.hlsl",
         L"./data/shaders/depthdebug.hlsl",
         std::move(CreateDefaultRasterizerState()),
@@ -133,19 +126,6 @@ namespace
         { 1, 0 }
     };
 
-    struct ShadingData
-    {
-        Matrix44 m_worldCamProj;
-        Matrix44 m_worldLightProj[2];
-        Matrix44 m_tInvWorld;
-        Float4   m_lightDirection[2];
-    };
-
-    struct ShadingDataNoShadows
-    {
-        Matrix44 m_worldCamProj;
-    };
-
     D3D12GpuViewHandle CreateDefaultTexture2D(D3D12Gpu& gpu)
     {
         std::vector<D3D12_SUBRESOURCE_DATA> subresources(1);
@@ -230,12 +210,11 @@ namespace
 }
 
 D3D12SceneRender::D3D12SceneRender(D3D12Gpu& gpu, FileMonitor& fileMonitor, const Scene& scene,
-                                   const D3D12Basics::TextureDataCache& textureDataCache,
                                    const D3D12Basics::MeshDataCache& meshDataCache) :
     m_gpu(gpu), m_scene(scene),
-    m_textureDataCache(textureDataCache),
     m_meshDataCache(meshDataCache),
     m_gpuResourcesLoaded(false),
+    m_staticGeometry(gpu, g_16mb, g_4mb),
     m_stdMaterialPipeState(gpu, fileMonitor, g_stdMaterialPipeDesc, L"D3D12 std material"),
     m_defaultMaterialPipeState(gpu, fileMonitor, g_defaultMaterialPipeDesc, L"D3D12 default material"),
     m_defaultMaterialFixedColorPipeState(gpu, fileMonitor, g_defaultMaterialFixedColorPipeDesc, L"D3D12 default material - fixed color"),
@@ -243,6 +222,12 @@ D3D12SceneRender::D3D12SceneRender(D3D12Gpu& gpu, FileMonitor& fileMonitor, cons
     m_shadowPipeState(gpu, fileMonitor, g_shadowPipeDesc, L"D3D12 depth only"),
     m_shadowDebugPipeState(gpu, fileMonitor, g_shadowDebugPipeDesc, L"D3D12 depth only debug"),
     m_lastDrawCallsCount(0),
+    m_batchesDirty(false),
+    m_instancingEnabled(true),
+    m_cullingEnabled(true),
+    m_frameDataVersions{},
+    m_frameDataPendingUploadsCount(static_cast<uint8_t>(D3D12GpuConfig::m_framesInFlight)),
+    m_nullCmdLists(false),
     m_shadowPassBinderOffset(0),
     m_forwardPassBinderOffset(0)
 {
@@ -263,171 +248,458 @@ void D3D12SceneRender::LoadGpuResources()
         m_shadowResPerLight.push_back(CreateShadowResources(m_gpu, i));
     }
 
-    // Load models gpu resources
+    m_frameData = m_gpu.AllocateDynamicMemory(sizeof(FrameData), L"Dynamic CB - Frame data");
+
+    m_gpuResourcesLoaded = true;
+    m_sceneStats.m_loadingGPUResourcesTime += loadingTime.Time();
+}
+
+void D3D12SceneRender::AddModel(const Model& model)
+{
+    assert(m_gpuResourcesLoaded);
+    assert(m_gpuMeshCache.count(model.m_id) == 0);
+
+    RunningTime loadingTime;
+
     // TODO rework this code to use the least amount of copies
-    for (const auto& model : m_scene.m_models)
+    const size_t gpuMeshIndex = m_gpuMeshes.size();
+    GPUMesh gpuMesh;
     {
-        assert(m_gpuMeshCache.count(model.m_id) == 0);
+        // NOTE the instances list is transient memory allocated every frame in Update
+        gpuMesh.m_forwardPassBindings.m_transientShaderResourceViews = { { 0, 0 } };
 
-        GPUMesh gpuMesh;
+        // TODO encapsulate define permutations
+        D3D12DescriptorTable slot3DescTable{ 3, {} };
+        const bool isDiffuseTextureSet = !model.m_material.m_diffuseTexture.empty();
+        if (isDiffuseTextureSet)
         {
-            {
-                if (model.m_material.m_shadowReceiver)
-                {
-                    gpuMesh.m_forwardTransformsGpuMemHandle = m_gpu.AllocateDynamicMemory(sizeof(ShadingData), 
-                                                                                          L"Dynamic CB - ShadingData " + model.m_name);
-                    assert(gpuMesh.m_forwardTransformsGpuMemHandle.IsValid());
-                }
-                else
-                {
-                    gpuMesh.m_forwardTransformsGpuMemHandle = m_gpu.AllocateDynamicMemory(sizeof(ShadingDataNoShadows),
-                                                                                          L"Dynamic CB - ShadingData NoShadows" + model.m_name);
-                    assert(gpuMesh.m_forwardTransformsGpuMemHandle.IsValid());
-                }
-
-                gpuMesh.m_forwardPassBindings.m_constantBufferViews = { { 0, gpuMesh.m_forwardTransformsGpuMemHandle } };
-            }
+            auto diffuseTextureView = TextureView(model.m_material.m_diffuseTexture, gpuMeshIndex,
+                                                  slot3DescTable.m_views.size());
+            slot3DescTable.m_views.emplace_back(diffuseTextureView);
+        }
 
-            // TODO encapsulate define permutations
-            D3D12DescriptorTable slot1DescTable{ 1, {} };
-            const bool isDiffuseTextureSet = !model.m_material.m_diffuseTexture.empty();
-            if (isDiffuseTextureSet)
-            {
-                auto diffuseTextureView = CreateTexture(model.m_material.m_diffuseTexture);
-                slot1DescTable.m_views.emplace_back(diffuseTextureView);
-            }
+        const bool isNormalTextureSet = !model.m_material.m_normalsTexture.empty();
+        if (isNormalTextureSet)
+        {
+            auto normalTextureView = TextureView(model.m_material.m_normalsTexture, gpuMeshIndex,
+                                                 slot3DescTable.m_views.size());
+            slot3DescTable.m_views.emplace_back(normalTextureView);
 
-            const bool isNormalTextureSet = !model.m_material.m_normalsTexture.empty();
-            if (isNormalTextureSet)
-            {
-                auto normalTextureView = CreateTexture(model.m_material.m_normalsTexture);
-                slot1DescTable.m_views.emplace_back(normalTextureView);
+            assert(isDiffuseTextureSet);
+        }
+        
+        if (isDiffuseTextureSet && isNormalTextureSet)
+            gpuMesh.m_pipelineStateId = PipelineStateId::StdMaterial;
+        else if (isDiffuseTextureSet)
+            gpuMesh.m_pipelineStateId = PipelineStateId::DefaultMaterial;
+        else
+        {
+            assert(slot3DescTable.m_views.empty());
+            gpuMesh.m_materialGpuMemHandle = m_gpu.AllocateStaticMemory(&model.m_material.m_diffuseColor, sizeof(Float3), L"Static CB - MaterialData " + model.m_name);
+            D3D12GpuViewHandle staticCBView = m_gpu.CreateConstantBufferView(gpuMesh.m_materialGpuMemHandle);
+            slot3DescTable.m_views.push_back(staticCBView);
+            gpuMesh.m_pipelineStateId = model.m_material.m_shadowReceiver?  PipelineStateId::DefaultMaterial_FixedColor :
+                                                                            PipelineStateId::DefaultMaterial_FixedColorNoShadows;
+        }
 
-                assert(isDiffuseTextureSet);
-            }
-            
-            if (isDiffuseTextureSet && isNormalTextureSet)
-                gpuMesh.m_pipelineStateId = PipelineStateId::StdMaterial;
-            else if (isDiffuseTextureSet)
-                gpuMesh.m_pipelineStateId = PipelineStateId::DefaultMaterial;
-            else
+        if (model.m_material.m_shadowReceiver)
+        {
+            for (const auto& shadowResource : m_shadowResPerLight)
             {
-                assert(slot1DescTable.m_views.empty());
-                gpuMesh.m_materialGpuMemHandle = m_gpu.AllocateStaticMemory(&model.m_material.m_diffuseColor, sizeof(Float3), L"Static CB - MaterialData " + model.m_name);
-                D3D12GpuViewHandle staticCBView = m_gpu.CreateConstantBufferView(gpuMesh.m_materialGpuMemHandle);
-                slot1DescTable.m_views.push_back(staticCBView);
-                gpuMesh.m_pipelineStateId = model.m_material.m_shadowReceiver?  PipelineStateId::DefaultMaterial_FixedColor :
-                                                                                PipelineStateId::DefaultMaterial_FixedColorNoShadows;
+                slot3DescTable.m_views.emplace_back(shadowResource.m_shadowTexture.m_srv);
             }
+        }
 
-            if (model.m_material.m_shadowReceiver)
-            {
-                for (const auto& shadowResource : m_shadowResPerLight)
-                {
-                    slot1DescTable.m_views.emplace_back(shadowResource.m_shadowTexture.m_srv);
-                }
-            }
+        gpuMesh.m_forwardPassBindings.m_descriptorTables = { slot3DescTable };
+    }
 
-            gpuMesh.m_forwardPassBindings.m_descriptorTables = { slot1DescTable };
-        }
+    // NOTE the shadow pass reads the light transform from the frame data with the
+    // light index
+    // TODO lights count
+    for (size_t i = 0; i < 2; ++i)
+    {
+        gpuMesh.m_shadowPassBindings[i].m_transientShaderResourceViews = { { 0, 0 } };
+        gpuMesh.m_shadowPassBindings[i].m_32BitConstants = { { 3, { static_cast<uint32_t>(i) } } };
+    }
 
-        // TODO lights count
-        for (size_t i = 0; i < 2; ++i)
-        {
-            std::wstringstream ss;
-            ss << L"Shadow pass" << i << L" Dynamic CB - Transform " + model.m_name;
-            gpuMesh.m_shadowsTransformGpuMemHandles[i] = m_gpu.AllocateDynamicMemory(sizeof(Matrix44), ss.str());
-            assert(gpuMesh.m_shadowsTransformGpuMemHandles[i].IsValid());
-            gpuMesh.m_shadowPassBindings[i].m_constantBufferViews = { { 0, gpuMesh.m_shadowsTransformGpuMemHandles[i] } };
-        }
+    AddObjectData(gpuMeshIndex);
 
-        assert(m_meshDataCache.count(model.m_id) == 1);
-        const auto& meshData = m_meshDataCache.at(model.m_id);
+    const auto& objectDataBlock = m_objectData.m_blocks[gpuMeshIndex / g_objectDataBlockSize];
+    gpuMesh.m_forwardPassBindings.m_shaderResourceViews = { { 1, objectDataBlock } };
+    gpuMesh.m_forwardPassBindings.m_constantBufferViews = { { 2, m_frameData } };
+    for (size_t i = 0; i < 2; ++i)
+    {
+        gpuMesh.m_shadowPassBindings[i].m_shaderResourceViews = { { 1, objectDataBlock } };
+        gpuMesh.m_shadowPassBindings[i].m_constantBufferViews = { { 2, m_frameData } };
+    }
 
-        gpuMesh.m_vertexBuffer = m_gpu.AllocateStaticMemory(&meshData.Vertices()[0], meshData.VertexBufferSizeBytes(), L"vb - " + model.m_name);
-        gpuMesh.m_indexBuffer = m_gpu.AllocateStaticMemory(&meshData.Indices()[0], meshData.IndexBufferSizeBytes(), L"ib - " + model.m_name);
-        gpuMesh.m_vertexBufferSizeBytes = meshData.VertexBufferSizeBytes();
-        gpuMesh.m_vertexSizeBytes = meshData.VertexSizeBytes();
-        gpuMesh.m_indexBufferSizeBytes = meshData.IndexBufferSizeBytes();
-        gpuMesh.m_indicesCount = meshData.IndicesCount();
-        m_gpuMeshes.push_back(std::move(gpuMesh));
-        m_gpuMeshCache[model.m_id] = m_gpuMeshes.size() - 1;
+    assert(&model >= &m_scene.m_models[0] && &model < &m_scene.m_models[0] + m_scene.m_models.size());
+    gpuMesh.m_modelIndex = static_cast<size_t>(&model - &m_scene.m_models[0]);
+    gpuMesh.m_shadowReceiver = model.m_material.m_shadowReceiver;
+
+    const size_t meshId = model.MeshId();
+    auto meshGeometry = m_meshGeometries.find(meshId);
+    if (meshGeometry == m_meshGeometries.end())
+    {
+        assert(m_meshDataCache.count(meshId) == 1);
+        const auto& meshData = m_meshDataCache.at(meshId);
+
+        meshGeometry = m_meshGeometries.emplace(meshId, MeshGeometry{ m_staticGeometry.AddMesh(meshData),
+                                                                      CalculateAabb(meshData) }).first;
     }
+    gpuMesh.m_meshRange = meshGeometry->second.m_meshRange;
+    gpuMesh.m_bounds = meshGeometry->second.m_bounds;
+    gpuMesh.m_meshId = meshId;
+    m_gpuMeshes.push_back(std::move(gpuMesh));
+    m_uploadingGpuMeshes.push_back(gpuMeshIndex);
+
+    m_worldTransforms.push_back(model.m_transform);
+    m_normalTransforms.push_back(model.m_normalTransform);
+    m_addedGpuMeshes.push_back(gpuMeshIndex);
+    const size_t modelIndex = m_gpuMeshes[gpuMeshIndex].m_modelIndex;
+    if (m_modelsGpuMesh.size() <= modelIndex)
+        m_modelsGpuMesh.resize(modelIndex + 1, g_invalidGpuMeshIndex);
+    m_modelsGpuMesh[modelIndex] = gpuMeshIndex;
+    m_localBounds.Resize(m_gpuMeshes.size());
+    m_localBounds.Set(gpuMeshIndex, meshGeometry->second.m_bounds);
+    m_gpuMeshCache[model.m_id] = gpuMeshIndex;
+    m_batchesDirty = true;
+
+    m_sceneStats.m_loadingGPUResourcesTime += loadingTime.Time();
+}
 
-    m_gpuResourcesLoaded = true;
-    m_sceneStats.m_loadingGPUResourcesTime = loadingTime.Time();
+void D3D12SceneRender::AddTexture(const std::wstring& textureFile, const TextureData& textureData)
+{
+    assert(m_textureCache.count(textureFile) == 0);
+    assert(std::none_of(m_uploadingTextures.begin(), m_uploadingTextures.end(),
+                        [&textureFile](const UploadingTexture& texture) { return texture.m_textureFile == textureFile; }));
+
+    RunningTime loadingTime;
+
+    auto memory = m_gpu.AllocateStaticMemory(textureData.GetSubResources(), textureData.GetDesc(), textureFile);
+    auto memoryView = m_gpu.CreateTextureView(memory, textureData.GetDesc());
+    m_uploadingTextures.push_back({ textureFile, memory, memoryView });
+
+    m_sceneStats.m_loadingGPUResourcesTime += loadingTime.Time();
+}
+
+void D3D12SceneRender::FlushModels()
+{
+    RunningTime loadingTime;
+
+    m_staticGeometry.Flush();
+    m_sceneStats.m_staticGeometryStats = m_staticGeometry.GetStats();
+
+    m_sceneStats.m_loadingGPUResourcesTime += loadingTime.Time();
 }
 
-void D3D12SceneRender::Update()
+void D3D12SceneRender::SetInstancingEnabled(bool enabled)
 {
-    // TODO Culling?
-    if (m_scene.m_models.empty())
+    if (m_instancingEnabled == enabled)
         return;
 
-    // Update transforms
+    m_instancingEnabled = enabled;
+    m_batchesDirty = true;
+}
+
+void D3D12SceneRender::Update(enki::TaskScheduler& taskScheduler)
+{
+    UpdateUploads();
+
+    if (m_gpuMeshes.empty())
+        return;
+
+    if (m_batchesDirty)
+        BuildBatches();
+
+    // Update the frame data
+    // NOTE the object data does not depend on the camera or the lights so only the frame
+    // data is written when they change
     assert(m_scene.m_lights.size() == 2);
-    const D3D12Basics::Matrix44 worldToCameraClip = m_scene.m_camera.WorldToLocal() * m_scene.m_camera.LocalToClip();
-    const D3D12Basics::Matrix44 worldToLightClip[2] = 
+    const uint64_t frameDataVersions[3] = { m_scene.m_camera.Version(), m_scene.m_lights[0].m_transform.Version(),
+                                            m_scene.m_lights[1].m_transform.Version() };
+    if (!std::equal(std::begin(frameDataVersions), std::end(frameDataVersions), std::begin(m_frameDataVersions)))
     {
-        m_scene.m_lights[0].m_transform.WorldToLocal() * m_scene.m_lights[0].m_transform.LocalToClip(),
-        m_scene.m_lights[1].m_transform.WorldToLocal() * m_scene.m_lights[1].m_transform.LocalToClip()
-    };
-    const Float4 light0Fwd{ -m_scene.m_lights[0].m_transform.Forward().x,
-                            -m_scene.m_lights[0].m_transform.Forward().y,
-                            -m_scene.m_lights[0].m_transform.Forward().z, 0.0f };
-    const Float4 light1Fwd{ -m_scene.m_lights[1].m_transform.Forward().x,
-                            -m_scene.m_lights[1].m_transform.Forward().y,
-                            -m_scene.m_lights[1].m_transform.Forward().z, 0.0f };
+        std::copy(std::begin(frameDataVersions), std::end(frameDataVersions), std::begin(m_frameDataVersions));
+        m_frameDataPendingUploadsCount = static_cast<uint8_t>(D3D12GpuConfig::m_framesInFlight);
+    }
 
-    for (auto& model : m_scene.m_models)
+    const Matrix44 worldToCameraClip = m_scene.m_camera.WorldToLocal() * m_scene.m_camera.LocalToClip();
+    Matrix44 worldToLightClip[2];
+    FrameData frameData;
+    frameData.m_cameraViewProj = worldToCameraClip.Transpose();
+    for (size_t i = 0; i < 2; ++i)
     {
-        assert(m_gpuMeshCache.count(model.m_id));
-        const size_t gpuMeshIndex = m_gpuMeshCache[model.m_id];
-        assert(m_gpuMeshes.size() > gpuMeshIndex);
-        auto& gpuMesh = m_gpuMeshes[gpuMeshIndex];
+        const auto& lightTransform = m_scene.m_lights[i].m_transform;
+        worldToLightClip[i] = lightTransform.WorldToLocal() * lightTransform.LocalToClip();
+        frameData.m_lightViewProj[i] = worldToLightClip[i].Transpose();
+        frameData.m_lightDirection[i] = Float4{ -lightTransform.Forward().x, -lightTransform.Forward().y,
+                                                -lightTransform.Forward().z, 0.0f };
+    }
 
-        Matrix44 worldCameraProj = (model.m_transform * worldToCameraClip).Transpose();
-        Matrix44 worldLightProj1 = (model.m_transform * worldToLightClip[0]).Transpose();
-        Matrix44 worldLightProj2 = (model.m_transform * worldToLightClip[1]).Transpose();
+    size_t frameDataSizeBytes = 0;
+    if (m_frameDataPendingUploadsCount)
+    {
+        m_gpu.UpdateMemory(m_frameData, &frameData, sizeof(FrameData));
+        --m_frameDataPendingUploadsCount;
+        frameDataSizeBytes = sizeof(FrameData);
+    }
 
-        if (model.m_material.m_shadowReceiver)
+    // Object data of the moved gpu meshes and culling
+    {
+        RunningTime gpuMeshesUpdateTime;
+
+        const Frustum lightsFrustum[2] = { CreateFrustum(worldToLightClip[0]), CreateFrustum(worldToLightClip[1]) };
+        UpdateGpuMeshes(taskScheduler, CreateFrustum(worldToCameraClip), lightsFrustum);
+
+        for (const size_t i : m_uploadingGpuMeshes)
         {
-            ShadingData transforms
-            {
-                worldCameraProj,
-                {worldLightProj1, worldLightProj2},
-                model.m_normalTransform.Transpose(),
-                {light0Fwd, light1Fwd}
-            };
+            m_cameraVisibility[i] = 0;
+            for (auto& lightVisibility : m_lightsVisibility)
+                lightVisibility[i] = 0;
+        }
 
-            m_gpu.UpdateMemory(gpuMesh.m_forwardTransformsGpuMemHandle, &transforms, sizeof(ShadingData));
+        const size_t forwardVisibleCount = FilterInstanceBatches(m_forwardInstances, m_forwardBatches,
+                                                                 m_cameraVisibility, m_forwardVisibleInstances);
+        size_t shadowVisibleCount = 0;
+        for (size_t i = 0; i < 2; ++i)
+        {
+            shadowVisibleCount += FilterInstanceBatches(m_shadowInstances, m_shadowBatches,
+                                                        m_lightsVisibility[i], m_shadowVisibleInstances[i]);
         }
-        else
+
+        m_sceneStats.m_forwardPassVisibleInstancesCount = static_cast<uint32_t>(forwardVisibleCount);
+        m_sceneStats.m_shadowPassVisibleInstancesCount = static_cast<uint32_t>(shadowVisibleCount);
+        m_sceneStats.m_gpuMeshesUpdateTime = gpuMeshesUpdateTime.Time();
+        m_sceneStats.m_updatedGpuMeshesCount = m_changedGpuMeshes.size();
+    }
+
+    // Uploads
+    {
+        RunningTime uploadTime;
+
+        const size_t objectDataSizeBytes = UploadObjectData();
+
+        // NOTE the batch bindings are the bindings of its first visible instance
+        size_t instancesListsSizeBytes = 0;
+        for (size_t batchIndex = 0; batchIndex < m_forwardBatches.size(); ++batchIndex)
+        {
+            const size_t instancesCount = m_forwardVisibleInstances.m_instancesCount[batchIndex];
+            if (!instancesCount)
+                continue;
+
+            const size_t* instances = &m_forwardVisibleInstances.m_instances[m_forwardBatches[batchIndex].m_firstInstance];
+            instancesListsSizeBytes += WriteInstancesList(m_gpuMeshes[instances[0]].m_forwardPassBindings,
+                                                          instances, instancesCount);
+        }
+
+        // TODO lights count
+        for (size_t lightIndex = 0; lightIndex < 2; ++lightIndex)
         {
-            ShadingDataNoShadows transforms
+            const auto& visibleInstances = m_shadowVisibleInstances[lightIndex];
+            for (size_t batchIndex = 0; batchIndex < m_shadowBatches.size(); ++batchIndex)
             {
-                worldCameraProj
-            };
+                const size_t instancesCount = visibleInstances.m_instancesCount[batchIndex];
+                if (!instancesCount)
+                    continue;
 
-            m_gpu.UpdateMemory(gpuMesh.m_forwardTransformsGpuMemHandle, &transforms, sizeof(ShadingDataNoShadows));
+                const size_t* instances = &visibleInstances.m_instances[m_shadowBatches[batchIndex].m_firstInstance];
+                instancesListsSizeBytes += WriteInstancesList(m_gpuMeshes[instances[0]].m_shadowPassBindings[lightIndex],
+                                                              instances, instancesCount);
+            }
+        }
+
+        m_sceneStats.m_frameDataUploadedSizeBytes = frameDataSizeBytes;
+        m_sceneStats.m_objectDataUploadedSizeBytes = objectDataSizeBytes;
+        m_sceneStats.m_instancesListsUploadedSizeBytes = instancesListsSizeBytes;
+        m_sceneStats.m_uploadTime = uploadTime.Time();
+    }
+}
+
+void D3D12SceneRender::UpdateGpuMeshes(enki::TaskScheduler& taskScheduler, const Frustum& cameraFrustum,
+                                       const Frustum (&lightsFrustum)[2])
+{
+    // NOTE sorted so each range finds its changed gpu meshes with a binary search
+    m_changedGpuMeshes.swap(m_addedGpuMeshes);
+    m_addedGpuMeshes.clear();
+    for (const size_t modelIndex : m_scene.m_movedModels)
+    {
+        if (modelIndex < m_modelsGpuMesh.size() && m_modelsGpuMesh[modelIndex] != g_invalidGpuMeshIndex)
+            m_changedGpuMeshes.push_back(m_modelsGpuMesh[modelIndex]);
+    }
+    std::sort(m_changedGpuMeshes.begin(), m_changedGpuMeshes.end());
+    m_changedGpuMeshes.erase(std::unique(m_changedGpuMeshes.begin(), m_changedGpuMeshes.end()),
+                             m_changedGpuMeshes.end());
+
+    const size_t gpuMeshesCount = m_gpuMeshes.size();
+    m_worldBounds.Resize(gpuMeshesCount);
+    m_cameraVisibility.resize(gpuMeshesCount);
+    for (auto& lightVisibility : m_lightsVisibility)
+        lightVisibility.resize(gpuMeshesCount);
+
+    if (gpuMeshesCount < g_parallelCullingMinCount)
+    {
+        UpdateGpuMeshRange(0, gpuMeshesCount, cameraFrustum, lightsFrustum);
+        return;
+    }
+
+    const uint32_t setSize = static_cast<uint32_t>(gpuMeshesCount);
+    const uint32_t minRange = static_cast<uint32_t>(g_cullingTaskRange);
+    enki::TaskSet updateTask(setSize, minRange, minRange,
+                             [this, &cameraFrustum, &lightsFrustum](enki::TaskSetPartition range, uint32_t)
+    {
+        UpdateGpuMeshRange(static_cast<size_t>(range.start), static_cast<size_t>(range.end), 
+                           cameraFrustum, lightsFrustum);
+    });
+    taskScheduler.AddTaskSetToPipe(&updateTask);
+    taskScheduler.WaitforTask(&updateTask);
+}
+
+// NOTE the object data is rewritten, in the cpu copy, only for the changed gpu meshes
+void D3D12SceneRender::UpdateGpuMeshRange(size_t start, size_t end, const Frustum& cameraFrustum,
+                                          const Frustum (&lightsFrustum)[2])
+{
+    const auto changesBegin = std::lower_bound(m_changedGpuMeshes.begin(), m_changedGpuMeshes.end(), start);
+    const auto changesEnd = std::lower_bound(changesBegin, m_changedGpuMeshes.end(), end);
+    if (changesBegin != changesEnd)
+    {
+        const size_t* changes = &*changesBegin;
+        const size_t changesCount = static_cast<size_t>(changesEnd - changesBegin);
+        for (size_t i = 0; i < changesCount; ++i)
+        {
+            const auto& model = m_scene.m_models[m_gpuMeshes[changes[i]].m_modelIndex];
+            m_worldTransforms[changes[i]] = model.m_transform;
+            m_normalTransforms[changes[i]] = model.m_normalTransform;
         }
 
-        m_gpu.UpdateMemory(gpuMesh.m_shadowsTransformGpuMemHandles[0], &worldLightProj1, sizeof(D3D12Basics::Matrix44));
-        m_gpu.UpdateMemory(gpuMesh.m_shadowsTransformGpuMemHandles[1], &worldLightProj2, sizeof(D3D12Basics::Matrix44));
+        m_worldBounds.SetTransformed(m_localBounds, m_worldTransforms.data(), changes, changesCount);
+
+        auto& objectData = m_objectData.m_data;
+        const size_t stride = sizeof(ObjectTransforms);
+        TransposeMatrices(m_worldTransforms.data(), changes, changesCount, &objectData[0].m_world, stride);
+        TransposeMatrices(m_normalTransforms.data(), changes, changesCount, &objectData[0].m_normalWorld, stride);
+
+        const uint8_t pendingUploadsCount = static_cast<uint8_t>(D3D12GpuConfig::m_framesInFlight);
+        for (size_t i = 0; i < changesCount; ++i)
+            m_objectData.m_pendingUploadsCount[changes[i]] = pendingUploadsCount;
+    }
+
+    if (!m_cullingEnabled)
+    {
+        std::fill(m_cameraVisibility.begin() + start, m_cameraVisibility.begin() + end, uint8_t(1));
+        for (auto& lightVisibility : m_lightsVisibility)
+            std::fill(lightVisibility.begin() + start, lightVisibility.begin() + end, uint8_t(1));
+        return;
+    }
+
+    m_worldBounds.Cull(cameraFrustum, start, end, m_cameraVisibility.data());
+    for (size_t i = 0; i < 2; ++i)
+        m_worldBounds.Cull(lightsFrustum[i], start, end, m_lightsVisibility[i].data());
+}
+
+// NOTE the gpu meshes of a batch share the object data block as it is bound per draw
+void D3D12SceneRender::BuildBatches()
+{
+    InstanceKeysBuilder keysBuilder(g_objectDataBlockSize);
+    keysBuilder.Reserve(m_gpuMeshes.size());
+
+    std::vector<size_t> viewsIds;
+    for (const auto& gpuMesh : m_gpuMeshes)
+    {
+        viewsIds.clear();
+        for (const auto& descriptorTable : gpuMesh.m_forwardPassBindings.m_descriptorTables)
+            for (const auto& view : descriptorTable.m_views)
+                viewsIds.push_back(view.m_id);
+
+        keysBuilder.Add(gpuMesh.m_meshId, static_cast<size_t>(gpuMesh.m_pipelineStateId), gpuMesh.m_shadowReceiver,
+                        viewsIds);
+    }
+
+    const size_t maxInstancesCount = m_instancingEnabled ? 0 : 1;
+    BuildInstanceBatches(keysBuilder.ForwardKeys(), maxInstancesCount, m_forwardInstances, m_forwardBatches);
+    BuildInstanceBatches(keysBuilder.ShadowKeys(), maxInstancesCount, m_shadowInstances, m_shadowBatches);
+
+    m_batchesDirty = false;
+}
+
+void D3D12SceneRender::AddObjectData(size_t gpuMeshIndex)
+{
+    assert(m_objectData.m_data.size() == gpuMeshIndex);
+
+    if (gpuMeshIndex % g_objectDataBlockSize == 0)
+    {
+        m_objectData.m_blocks.push_back(m_gpu.AllocateDynamicMemory(g_objectDataBlockSize * sizeof(ObjectTransforms),
+                                                                    L"Dynamic SB - Object data"));
     }
+
+    // NOTE the data is written in the first update as the gpu mesh transforms are outdated
+    m_objectData.m_data.emplace_back();
+    m_objectData.m_pendingUploadsCount.push_back(0);
+}
+
+// NOTE the contiguous pending entries of a block are uploaded with one copy
+size_t D3D12SceneRender::UploadObjectData()
+{
+    auto& pendingGpuMeshes = m_objectData.m_pendingGpuMeshes;
+    auto& mergedGpuMeshes = m_objectData.m_mergedGpuMeshes;
+    mergedGpuMeshes.clear();
+    std::set_union(pendingGpuMeshes.begin(), pendingGpuMeshes.end(), m_changedGpuMeshes.begin(),
+                   m_changedGpuMeshes.end(), std::back_inserter(mergedGpuMeshes));
+    pendingGpuMeshes.swap(mergedGpuMeshes);
+
+    size_t uploadedSizeBytes = 0;
+    for (size_t i = 0; i < pendingGpuMeshes.size();)
+    {
+        const size_t start = pendingGpuMeshes[i];
+        const size_t blockIndex = start / g_objectDataBlockSize;
+        const size_t blockStart = blockIndex * g_objectDataBlockSize;
+        const size_t blockEnd = blockStart + g_objectDataBlockSize;
+        size_t end = start;
+        for (; i < pendingGpuMeshes.size() && pendingGpuMeshes[i] == end && end < blockEnd; ++i, ++end)
+            --m_objectData.m_pendingUploadsCount[end];
+
+        const size_t sizeBytes = (end - start) * sizeof(ObjectTransforms);
+        m_gpu.UpdateMemory(m_objectData.m_blocks[blockIndex], &m_objectData.m_data[start], sizeBytes,
+                           (start - blockStart) * sizeof(ObjectTransforms));
+        uploadedSizeBytes += sizeBytes;
+    }
+
+    const auto& pendingUploadsCount = m_objectData.m_pendingUploadsCount;
+    pendingGpuMeshes.erase(std::remove_if(pendingGpuMeshes.begin(), pendingGpuMeshes.end(),
+                                          [&pendingUploadsCount](size_t i) { return !pendingUploadsCount[i]; }),
+                           pendingGpuMeshes.end());
+
+    return uploadedSizeBytes;
+}
+
+// NOTE the list holds the visible instances indices local to their object data block
+size_t D3D12SceneRender::WriteInstancesList(D3D12Bindings& bindings, const size_t* instances, size_t instancesCount)
+{
+    assert(bindings.m_transientShaderResourceViews.size() == 1);
+
+    const size_t sizeBytes = instancesCount * sizeof(uint32_t);
+    auto allocation = m_gpu.AllocateTransientMemory(sizeBytes);
+    bindings.m_transientShaderResourceViews[0].m_gpuPtr = allocation.m_gpuPtr;
+
+    uint32_t* instancesList = reinterpret_cast<uint32_t*>(allocation.m_cpuPtr);
+    for (size_t i = 0; i < instancesCount; ++i)
+        instancesList[i] = static_cast<uint32_t>(instances[i] % g_objectDataBlockSize);
+
+    return sizeBytes;
 }
 
 D3D12CmdLists D3D12SceneRender::RecordCmdLists(D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
                                                D3D12_CPU_DESCRIPTOR_HANDLE depthStencilBuffer,
                                                enki::TaskScheduler& taskScheduler,
                                                bool enableParallelCmdLists,
-                                               size_t drawCallsCount)
+                                               size_t drawCallsCount,
+                                               bool recordToNullBackend)
 {
     m_shadowPassDrawCallsCount.store(0, std::memory_order_relaxed);
     m_forwardPassDrawCallsCount.store(0, std::memory_order_relaxed);
     m_sceneStats.m_cmdListsTime.ResetMark();
 
-    if (!m_gpuResourcesLoaded)
+    if (!m_gpuResourcesLoaded || m_gpuMeshes.empty())
         return {};
 
     if (!drawCallsCount)
@@ -435,7 +707,7 @@ D3D12CmdLists D3D12SceneRender::RecordCmdLists(D3D12_CPU_DESCRIPTOR_HANDLE rende
 
     // Shadow and forward cmd lists count varies depending on the execution model and
     // the number of draw calls configured
-    UpdateCmdLists(drawCallsCount, enableParallelCmdLists);
+    UpdateCmdLists(drawCallsCount, enableParallelCmdLists, recordToNullBackend);
 
     if (enableParallelCmdLists)
     {
@@ -451,24 +723,41 @@ D3D12CmdLists D3D12SceneRender::RecordCmdLists(D3D12_CPU_DESCRIPTOR_HANDLE rende
     {
         m_sceneStats.m_forwardPassCmdListTime.Mark();
         m_sceneStats.m_shadowPassCmdListTime.Mark();
-        taskScheduler.WaitforAll();
+        // NOTE waiting only for the render tasks, the scheduler could be running
+        // other work (ie, scene loading)
+        for (auto& renderTask : m_renderTasks)
+            taskScheduler.WaitforTask(renderTask.get());
         m_renderTasks.clear();
     }
 
     // TODO add imgui ui option to render the debug elements
     //RenderDebug(cmdList);
 
+    // Note null cmd lists are never executed. Only their counters are collected.
     D3D12CmdLists cmdLists;
+    D3D12NullCmdListCounters nullBackendCounters;
     if (shadowPassDone)
     {
         for (auto& cmdList : m_shadowCmdLists)
-            cmdLists.push_back(cmdList->GetCmdList().Get());
+        {
+            if (cmdList->IsNull())
+                nullBackendCounters += cmdList->NullCounters();
+            else
+                cmdLists.push_back(cmdList->GetCmdList().Get());
+        }
     }
     for (auto& cmdList : m_forwardCmdLists)
-        cmdLists.push_back(cmdList->GetCmdList().Get());
+    {
+        if (cmdList->IsNull())
+            nullBackendCounters += cmdList->NullCounters();
+        else
+            cmdLists.push_back(cmdList->GetCmdList().Get());
+    }
 
     m_sceneStats.m_cmdListsTime.Mark();
 
+    m_sceneStats.m_nullBackendCounters = nullBackendCounters;
+
     m_lastDrawCallsCount = drawCallsCount;
     m_sceneStats.m_forwardPassDrawCallsCount = m_forwardPassDrawCallsCount.load(std::memory_order_relaxed);
     m_sceneStats.m_shadowPassDrawCallsCount = m_shadowPassDrawCallsCount.load(std::memory_order_relaxed);
@@ -476,21 +765,61 @@ D3D12CmdLists D3D12SceneRender::RecordCmdLists(D3D12_CPU_DESCRIPTOR_HANDLE rende
     return cmdLists;
 }
 
-D3D12GpuViewHandle D3D12SceneRender::CreateTexture(const std::wstring& textureFile)
+D3D12GpuViewHandle D3D12SceneRender::TextureView(const std::wstring& textureFile, size_t gpuMeshIndex, size_t viewIndex)
 {
-    if (m_textureCache.count(textureFile))
-        return m_textureCache[textureFile];
+    auto texture = m_textureCache.find(textureFile);
+    if (texture != m_textureCache.end())
+        return texture->second;
 
-    assert(m_textureDataCache.count(textureFile) == 1);
+    m_pendingTextureViews[textureFile].push_back(PendingTextureView{ gpuMeshIndex, viewIndex });
 
-    const auto& textureData = m_textureDataCache.at(textureFile);
-    auto memory = m_gpu.AllocateStaticMemory(textureData.GetSubResources(), textureData.GetDesc(), textureFile);
+    return m_defaultTexture;
+}
 
-    auto memoryView = m_gpu.CreateTextureView(memory, textureData.GetDesc());
+void D3D12SceneRender::UpdateUploads()
+{
+    // NOTE the bindings descriptors are copied every frame so the views can be
+    // replaced while the previous frames are in flight
+    for (size_t i = 0; i < m_uploadingTextures.size(); )
+    {
+        const auto& texture = m_uploadingTextures[i];
+        if (!m_gpu.IsMemoryReady(texture.m_memHandle))
+        {
+            ++i;
+            continue;
+        }
+
+        m_textureCache[texture.m_textureFile] = texture.m_view;
 
-    m_textureCache[textureFile] = std::move(memoryView);
+        auto pendingTextureViews = m_pendingTextureViews.find(texture.m_textureFile);
+        if (pendingTextureViews != m_pendingTextureViews.end())
+        {
+            for (const auto& pendingTextureView : pendingTextureViews->second)
+            {
+                auto& gpuMesh = m_gpuMeshes[pendingTextureView.m_gpuMeshIndex];
+                gpuMesh.m_forwardPassBindings.m_descriptorTables[0].m_views[pendingTextureView.m_viewIndex] = texture.m_view;
+            }
+            m_pendingTextureViews.erase(pendingTextureViews);
 
-    return m_textureCache[textureFile];
+            // NOTE the models that were using the default texture are batched apart now
+            m_batchesDirty = true;
+        }
+
+        m_uploadingTextures[i] = std::move(m_uploadingTextures.back());
+        m_uploadingTextures.pop_back();
+    }
+
+    m_uploadingGpuMeshes.erase(std::remove_if(m_uploadingGpuMeshes.begin(), m_uploadingGpuMeshes.end(),
+                                              [this](size_t i) { return IsGpuMeshReady(m_gpuMeshes[i]); }),
+                               m_uploadingGpuMeshes.end());
+}
+
+bool D3D12SceneRender::IsGpuMeshReady(const GPUMesh& gpuMesh)
+{
+    if (gpuMesh.m_materialGpuMemHandle.IsValid() && !m_gpu.IsMemoryReady(gpuMesh.m_materialGpuMemHandle))
+        return false;
+
+    return m_staticGeometry.IsMeshReady(gpuMesh.m_meshRange);
 }
 
 void D3D12SceneRender::CreateDebugResources()
@@ -506,6 +835,24 @@ void D3D12SceneRender::CreateDebugResources()
     m_quadIb = m_gpu.AllocateStaticMemory(&indices[0], g_quadIBSizeBytes, L"ib - screen quad");
 }
 
+// NOTE vertex and index buffers are only bound when they change from the previous mesh
+void D3D12SceneRender::SetGeometryBuffers(ID3D12GraphicsCommandListPtr cmdList, const GPUMesh& gpuMesh,
+                                          size_t& currentVertexBufferId, size_t& currentIndexBufferId)
+{
+    const auto& meshRange = gpuMesh.m_meshRange;
+    if (meshRange.m_vertexBufferId != currentVertexBufferId)
+    {
+        m_staticGeometry.SetVertexBuffer(cmdList, meshRange.m_vertexBufferId);
+        currentVertexBufferId = meshRange.m_vertexBufferId;
+    }
+
+    if (meshRange.m_indexBufferId != currentIndexBufferId)
+    {
+        m_staticGeometry.SetIndexBuffer(cmdList, meshRange.m_indexBufferId);
+        currentIndexBufferId = meshRange.m_indexBufferId;
+    }
+}
+
 void D3D12SceneRender::SetupRenderDepthFromLight(ID3D12GraphicsCommandListPtr cmdList, size_t lightIndex, bool clear)
 {
     assert(lightIndex < m_shadowResPerLight.size());
@@ -517,7 +864,7 @@ void D3D12SceneRender::SetupRenderDepthFromLight(ID3D12GraphicsCommandListPtr cm
 }
 
 void D3D12SceneRender::RenderDepthFromLight(ID3D12GraphicsCommandListPtr cmdList, size_t lightIndex,
-                                            size_t meshStartIndex, size_t meshEndIndex, 
+                                            size_t batchStartIndex, size_t batchEndIndex, 
                                             unsigned int concurrentBinderIndex)
 {
     UpdateViewportScissor(cmdList, g_shadowMapResolution);
@@ -525,15 +872,24 @@ void D3D12SceneRender::RenderDepthFromLight(ID3D12GraphicsCommandListPtr cmdList
     if (!m_shadowPipeState.ApplyState(cmdList))
         return;
 
-    for (size_t i = meshStartIndex; i < meshEndIndex; ++i)
+    size_t currentVertexBufferId = D3D12StaticGeometryBuffer::m_invalidBufferId;
+    size_t currentIndexBufferId = D3D12StaticGeometryBuffer::m_invalidBufferId;
+    for (size_t i = batchStartIndex; i < batchEndIndex; ++i)
     {
-        auto& gpuMesh = m_gpuMeshes[i];
+        // NOTE batches with all their instances culled are skipped
+        const auto& visibleInstances = m_shadowVisibleInstances[lightIndex];
+        const size_t instancesCount = visibleInstances.m_instancesCount[i];
+        if (!instancesCount)
+            continue;
+
+        auto& gpuMesh = m_gpuMeshes[visibleInstances.m_instances[m_shadowBatches[i].m_firstInstance]];
 
         m_gpu.SetBindings(cmdList, gpuMesh.m_shadowPassBindings[lightIndex], 
                           concurrentBinderIndex + m_shadowPassBinderOffset);
-        m_gpu.SetVertexBuffer(cmdList, gpuMesh.m_vertexBuffer, gpuMesh.m_vertexBufferSizeBytes, gpuMesh.m_vertexSizeBytes);
-        m_gpu.SetIndexBuffer(cmdList, gpuMesh.m_indexBuffer, gpuMesh.m_indexBufferSizeBytes);
-        cmdList->DrawIndexedInstanced(static_cast<UINT>(gpuMesh.m_indicesCount), 1, 0, 0, 0);
+        SetGeometryBuffers(cmdList, gpuMesh, currentVertexBufferId, currentIndexBufferId);
+        const auto& meshRange = gpuMesh.m_meshRange;
+        cmdList->DrawIndexedInstanced(meshRange.m_indicesCount, static_cast<UINT>(instancesCount),
+                                      meshRange.m_startIndex, meshRange.m_baseVertex, 0);
         m_shadowPassDrawCallsCount++;
     }
 }
@@ -541,7 +897,7 @@ void D3D12SceneRender::RenderDepthFromLight(ID3D12GraphicsCommandListPtr cmdList
 TaskSetPtr D3D12SceneRender::CreateRenderDepthFromLightTask(size_t lightIndex, size_t cmdListStartIndex, 
                                                             size_t cmdListEndIndex, size_t drawCallsCount)
 {
-    const uint32_t setSize = static_cast<uint32_t>(m_gpuMeshes.size());
+    const uint32_t setSize = static_cast<uint32_t>(m_shadowBatches.size());
     const uint32_t minRange = static_cast<uint32_t>(drawCallsCount);
     const uint32_t maxRange = static_cast<uint32_t>(drawCallsCount);
     TaskSetPtr renderDepthFromLightTask = std::make_unique<enki::TaskSet>(setSize, minRange, maxRange,
@@ -594,7 +950,6 @@ bool D3D12SceneRender::RenderShadowPass(enki::TaskScheduler& taskScheduler, size
         m_sceneStats.m_shadowPassCmdListTime.ResetMark();
 
         assert(m_shadowCmdLists.size() == 1);
-        const size_t maxDrawCallsCount = m_gpuMeshes.size();
         m_shadowCmdLists[0]->Open();
         auto cmdList = m_shadowCmdLists[0]->GetCmdList();
 
@@ -604,7 +959,7 @@ bool D3D12SceneRender::RenderShadowPass(enki::TaskScheduler& taskScheduler, size
         for (size_t lightIndex = 0; lightIndex < lightsCount; ++lightIndex)
         {
             SetupRenderDepthFromLight(cmdList, lightIndex);
-            RenderDepthFromLight(cmdList, lightIndex, 0, m_gpuMeshes.size(), concurrentCmdListIndex);
+            RenderDepthFromLight(cmdList, lightIndex, 0, m_shadowBatches.size(), concurrentCmdListIndex);
         }
 
         AddShadowResourcesBarrier(cmdList, D3D12_RESOURCE_STATE_DEPTH_WRITE,
@@ -617,7 +972,7 @@ bool D3D12SceneRender::RenderShadowPass(enki::TaskScheduler& taskScheduler, size
     else
     {
         const size_t totalCmdListsCount = m_shadowCmdLists.size();
-        const size_t cmdListCountPerLight = CalculateCmdListsCount(drawCallsCount);
+        const size_t cmdListCountPerLight = CalculateCmdListsCount(m_shadowBatches.size(), drawCallsCount);
 
         for (size_t lightIndex = 0; lightIndex < lightsCount; ++lightIndex)
         {
@@ -636,7 +991,7 @@ bool D3D12SceneRender::RenderShadowPass(enki::TaskScheduler& taskScheduler, size
 void D3D12SceneRender::RenderForwardPassMeshRange(const D3D12GraphicsCmdListPtr& d3d12CmdList,
                                                   D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
                                                   D3D12_CPU_DESCRIPTOR_HANDLE depthStencilBuffer,
-                                                  size_t meshStartIndex, size_t meshEndIndex,
+                                                  size_t batchStartIndex, size_t batchEndIndex,
                                                   unsigned int concurrentBinderIndex)
 {
     d3d12CmdList->Open();
@@ -647,9 +1002,16 @@ void D3D12SceneRender::RenderForwardPassMeshRange(const D3D12GraphicsCmdListPtr&
 
     UpdateViewportScissor(cmdList, m_gpu.GetCurrentResolution());
 
-    for (size_t i = meshStartIndex; i < meshEndIndex; ++i)
+    size_t currentVertexBufferId = D3D12StaticGeometryBuffer::m_invalidBufferId;
+    size_t currentIndexBufferId = D3D12StaticGeometryBuffer::m_invalidBufferId;
+    for (size_t i = batchStartIndex; i < batchEndIndex; ++i)
     {
-        auto& gpuMesh = m_gpuMeshes[i];
+        // NOTE batches with all their instances culled are skipped
+        const size_t instancesCount = m_forwardVisibleInstances.m_instancesCount[i];
+        if (!instancesCount)
+            continue;
+
+        auto& gpuMesh = m_gpuMeshes[m_forwardVisibleInstances.m_instances[m_forwardBatches[i].m_firstInstance]];
 
         // TODO generalize this into a material system
         if (gpuMesh.m_pipelineStateId == PipelineStateId::StdMaterial)
@@ -676,10 +1038,10 @@ void D3D12SceneRender::RenderForwardPassMeshRange(const D3D12GraphicsCmdListPtr&
 
         m_gpu.SetBindings(cmdList, gpuMesh.m_forwardPassBindings, 
                           concurrentBinderIndex + m_forwardPassBinderOffset);
-        m_gpu.SetVertexBuffer(cmdList, gpuMesh.m_vertexBuffer, gpuMesh.m_vertexBufferSizeBytes, 
-                              gpuMesh.m_vertexSizeBytes);
-        m_gpu.SetIndexBuffer(cmdList, gpuMesh.m_indexBuffer, gpuMesh.m_indexBufferSizeBytes);
-        cmdList->DrawIndexedInstanced(static_cast<UINT>(gpuMesh.m_indicesCount), 1, 0, 0, 0);
+        SetGeometryBuffers(cmdList, gpuMesh, currentVertexBufferId, currentIndexBufferId);
+        const auto& meshRange = gpuMesh.m_meshRange;
+        cmdList->DrawIndexedInstanced(meshRange.m_indicesCount, static_cast<UINT>(instancesCount),
+                                      meshRange.m_startIndex, meshRange.m_baseVertex, 0);
 
         m_forwardPassDrawCallsCount++;
     }
@@ -691,7 +1053,7 @@ TaskSetPtr D3D12SceneRender::CreateForwardPassTask(D3D12_CPU_DESCRIPTOR_HANDLE r
                                                    D3D12_CPU_DESCRIPTOR_HANDLE depthStencilBuffer,
                                                    size_t drawCallsCount)
 {
-    const uint32_t setSize = static_cast<uint32_t>(m_gpuMeshes.size());
+    const uint32_t setSize = static_cast<uint32_t>(m_forwardBatches.size());
     const uint32_t minRange = static_cast<uint32_t>(drawCallsCount);
     const uint32_t maxRange = static_cast<uint32_t>(drawCallsCount);
     TaskSetPtr forwardPassTask = std::make_unique<enki::TaskSet>(setSize, minRange, maxRange,
@@ -729,7 +1091,7 @@ void D3D12SceneRender::RenderForwardPass(enki::TaskScheduler& taskScheduler,
         assert(m_forwardCmdLists.size() == 1);
         const unsigned int cmdListIndex = 0;
         RenderForwardPassMeshRange(m_forwardCmdLists[0], renderTarget,
-                                   depthStencilBuffer, 0, m_gpuMeshes.size(), cmdListIndex);
+                                   depthStencilBuffer, 0, m_forwardBatches.size(), cmdListIndex);
 
         m_sceneStats.m_forwardPassCmdListTime.Mark();
     }
@@ -737,17 +1099,24 @@ void D3D12SceneRender::RenderForwardPass(enki::TaskScheduler& taskScheduler,
 
 // Note m_forwardPassBinderOffset is always set to 0. Why is it a variable then? It makes reasoning about 
 // the concurrency approach to setting the bindings very clear.
-void D3D12SceneRender::UpdateCmdLists(size_t drawCallsCount, bool enableParallelCmdLists)
+void D3D12SceneRender::UpdateCmdLists(size_t drawCallsCount, bool enableParallelCmdLists, bool recordToNullBackend)
 {
     const size_t shadowCmdListsCount = m_shadowCmdLists.size();
     const size_t forwardCmdListsCount = m_forwardCmdLists.size();
+    const bool backendChanged = m_nullCmdLists != recordToNullBackend;
+    m_nullCmdLists = recordToNullBackend;
+
+    // Note switching backends destroys the current cmd lists which might still be in flight
+    if (backendChanged)
+        m_gpu.WaitAll();
+
     if (!enableParallelCmdLists)
     {
-        if (shadowCmdListsCount != 1)
+        if (shadowCmdListsCount != 1 || backendChanged)
         {
             ResetCmdLists(1);
-            m_shadowCmdLists.push_back(m_gpu.CreateCmdList(L"Shadow cmd list single thread"));
-            m_forwardCmdLists.push_back(m_gpu.CreateCmdList(L"Forward cmd list single thread"));
+            m_shadowCmdLists.push_back(CreateCmdList(L"Shadow cmd list single thread", recordToNullBackend));
+            m_forwardCmdLists.push_back(CreateCmdList(L"Forward cmd list single thread", recordToNullBackend));
 
             m_shadowPassBinderOffset = 0;
             m_forwardPassBinderOffset = 0;
@@ -756,9 +1125,10 @@ void D3D12SceneRender::UpdateCmdLists(size_t drawCallsCount, bool enableParallel
     else
     {
         const size_t lightsCount = m_shadowResPerLight.size();
-        const size_t newShadowCmdlistsCount = lightsCount * CalculateCmdListsCount(drawCallsCount);
-        const size_t newForwardCmdlistsCount = CalculateCmdListsCount(drawCallsCount);
-        if (shadowCmdListsCount != newShadowCmdlistsCount || m_lastDrawCallsCount != drawCallsCount)
+        const size_t newShadowCmdlistsCount = lightsCount * CalculateCmdListsCount(m_shadowBatches.size(), drawCallsCount);
+        const size_t newForwardCmdlistsCount = CalculateCmdListsCount(m_forwardBatches.size(), drawCallsCount);
+        if (shadowCmdListsCount != newShadowCmdlistsCount || forwardCmdListsCount != newForwardCmdlistsCount ||
+            m_lastDrawCallsCount != drawCallsCount || backendChanged)
         {
             const unsigned int concurrentBinders = static_cast<unsigned int>(newShadowCmdlistsCount +
                                                                              newForwardCmdlistsCount);
@@ -768,13 +1138,13 @@ void D3D12SceneRender::UpdateCmdLists(size_t drawCallsCount, bool enableParallel
             {
                 std::wstringstream converter;
                 converter << L"Shadow cmd list " << i << " for drawCallsCount " << drawCallsCount;
-                m_shadowCmdLists.push_back(m_gpu.CreateCmdList(converter.str()));
+                m_shadowCmdLists.push_back(CreateCmdList(converter.str(), recordToNullBackend));
             }
             for (size_t i = 0; i < newForwardCmdlistsCount; ++i)
             {
                 std::wstringstream converter;
                 converter << L"Forward cmd list " << i << " for drawCallsCount " << drawCallsCount;
-                m_forwardCmdLists.push_back(m_gpu.CreateCmdList(converter.str()));
+                m_forwardCmdLists.push_back(CreateCmdList(converter.str(), recordToNullBackend));
             }
             m_shadowPassBinderOffset = static_cast<unsigned int>(newForwardCmdlistsCount);
             m_forwardPassBinderOffset = 0;
@@ -782,6 +1152,14 @@ void D3D12SceneRender::UpdateCmdLists(size_t drawCallsCount, bool enableParallel
     }
 }
 
+D3D12GraphicsCmdListPtr D3D12SceneRender::CreateCmdList(const std::wstring& debugName, bool isNull)
+{
+    if (isNull)
+        return m_gpu.CreateNullCmdList(L"Null " + debugName);
+
+    return m_gpu.CreateCmdList(debugName);
+}
+
 void D3D12SceneRender::ResetCmdLists(unsigned int concurrentBinders)
 {
     assert((!m_shadowCmdLists.empty() && !m_forwardCmdLists.empty()) ||
@@ -823,9 +1201,9 @@ void D3D12SceneRender::AddShadowResourcesBarrier(ID3D12GraphicsCommandListPtr cm
     cmdList->ResourceBarrier(static_cast<UINT>(barriersDepthBufferReadWrite.size()), &barriersDepthBufferReadWrite[0]);
 }
 
-size_t D3D12SceneRender::CalculateCmdListsCount(size_t drawCallsCount)
+size_t D3D12SceneRender::CalculateCmdListsCount(size_t batchesCount, size_t drawCallsCount)
 {
-    return static_cast<size_t>(std::ceilf(m_gpuMeshes.size() / static_cast<float>(drawCallsCount)));
+    return static_cast<size_t>(std::ceilf(batchesCount / static_cast<float>(drawCallsCount)));
 }
 
 void D3D12SceneRender::RenderDebug(ID3D12GraphicsCommandListPtr cmdList)
@@ -844,7 +1222,7 @@ void D3D12SceneRender::RenderDebug(ID3D12GraphicsCommandListPtr cmdList)
         const unsigned int concurrentBinderIndex = 0;
         m_gpu.SetBindings(cmdList, bindings, concurrentBinderIndex);
         m_gpu.SetVertexBuffer(cmdList, m_quadVb, g_quadVBSizeBytes, g_quadVertexSizeBytes);
-        m_gpu.SetIndexBuffer(cmdList, m_quadIb, g_quadIBSizeBytes);
+        m_gpu.SetIndexBuffer(cmdList, m_quadIb, g_quadIBSizeBytes, sizeof(uint16_t));
         cmdList->DrawIndexedInstanced(static_cast<UINT>(g_quadIndicesCount), 1, 0, 0, 0);
     }
 }
@@ -9,6 +9,9 @@
 #include "d3d12gpu.h"
 #include "filemonitor.h"
 #include "d3d12pipelinestate.h"
+#include "d3d12staticgeometrybuffer.h"
+#include "instancebatches.h"
+#include "frustumculling.h"
 
 // thirdparty libraries include
 #include "imgui/imgui.h"
@@ -23,34 +26,76 @@ namespace D3D12Basics
         uint32_t m_shadowPassDrawCallsCount;
         uint32_t m_forwardPassDrawCallsCount;
 
+        // NOTE the shadow pass count is summed over the lights
+        uint32_t m_shadowPassVisibleInstancesCount = 0;
+        uint32_t m_forwardPassVisibleInstancesCount = 0;
+
+        // Time updating the gpu meshes (the data of the changed ones, their bounds and
+        // their visibility) and time uploading the changed data and the instances lists
+        float    m_gpuMeshesUpdateTime = 0.0f;
+        float    m_uploadTime = 0.0f;
+
+        // Gpu meshes whose transforms changed this frame, only those are updated
+        size_t   m_updatedGpuMeshesCount = 0;
+
+        // Bytes written to gpu memory this frame. The per object data is only written
+        // when the model moved, the frame data when the camera or the lights moved and
+        // the lists of visible instances every frame.
+        size_t   m_frameDataUploadedSizeBytes = 0;
+        size_t   m_objectDataUploadedSizeBytes = 0;
+        size_t   m_instancesListsUploadedSizeBytes = 0;
+
         StopClock m_shadowPassCmdListTime;
         StopClock m_forwardPassCmdListTime;
         StopClock m_cmdListsTime;
+
+        // Note only filled when the scene is recorded into the null backend
+        D3D12NullCmdListCounters m_nullBackendCounters;
+
+        D3D12StaticGeometryBuffer::Stats m_staticGeometryStats;
     };
 
     class D3D12SceneRender
     {
     public:
         D3D12SceneRender(D3D12Gpu& gpu, FileMonitor& fileMonitor, const Scene& scene,
-                         const TextureDataCache& textureDataCache,
                          const MeshDataCache& meshDataCache);
 
         bool AreGpuResourcesLoaded() const { return m_gpuResourcesLoaded; }
 
+        // Creates the per light resources. The models are added afterwards, as their
+        // meshes and textures are loaded, so the scene is drawn progressively.
         void LoadGpuResources();
 
-        void Update();
+        // NOTE the model textures not added yet are bound to the default texture until
+        // they are added. The model is drawn once FlushModels is called.
+        void AddModel(const Model& model);
+
+        void AddTexture(const std::wstring& textureFile, const TextureData& textureData);
+
+        // Uploads the meshes of the models added since the last flush
+        void FlushModels();
+
+        // NOTE big scenes are culled in parallel on the task scheduler
+        void Update(enki::TaskScheduler& taskScheduler);
 
         D3D12CmdLists RecordCmdLists(D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
                                      D3D12_CPU_DESCRIPTOR_HANDLE depthStencilBuffer,
                                      enki::TaskScheduler& taskScheduler,
                                      bool enableParallelCmdLists,
-                                     size_t drawCallsCount);
+                                     size_t drawCallsCount,
+                                     bool recordToNullBackend = false);
 
         const SceneStats& GetStats() const { return m_sceneStats; }
 
         size_t GpuMeshesCount() const { return m_gpuMeshCache.size(); }
 
+        // NOTE when disabled every model is drawn with its own draw call
+        void SetInstancingEnabled(bool enabled);
+
+        // NOTE when disabled every model is drawn in every pass
+        void SetCullingEnabled(bool enabled) { m_cullingEnabled = enabled; }
+
     private:
         enum class PipelineStateId
         {
@@ -65,20 +110,73 @@ namespace D3D12Basics
             // TODO lights count
             D3D12Bindings               m_shadowPassBindings[2];
             D3D12Bindings               m_forwardPassBindings;
-            D3D12GpuMemoryHandle        m_vertexBuffer;
-            D3D12GpuMemoryHandle        m_indexBuffer;
-            size_t m_vertexBufferSizeBytes;
-            size_t m_vertexSizeBytes;
-            size_t m_indexBufferSizeBytes;
-            size_t m_indicesCount;
+
+            D3D12StaticGeometryBuffer::MeshRange m_meshRange;
 
             // TODO think a better place for these. convenient for now.
             D3D12GpuMemoryHandle    m_materialGpuMemHandle;
-            D3D12GpuMemoryHandle    m_forwardTransformsGpuMemHandle;
-            D3D12GpuMemoryHandle    m_shadowsTransformGpuMemHandles[2];
 
             // TODO find a generalized way of setting up pipestates
             PipelineStateId m_pipelineStateId;
+
+            // Index into the scene models
+            size_t  m_modelIndex;
+            size_t  m_meshId;
+            bool    m_shadowReceiver;
+
+            // NOTE object space
+            Aabb    m_bounds;
+        };
+
+        // NOTE transposed for the shaders. The shaders combine them with the frame data
+        // transforms so the object data does not depend on the camera or the lights.
+        struct ObjectTransforms
+        {
+            Matrix44 m_world;
+            Matrix44 m_normalWorld;
+        };
+
+        // NOTE transposed for the shaders
+        struct FrameData
+        {
+            Matrix44 m_cameraViewProj;
+            Matrix44 m_lightViewProj[2];
+            Float4   m_lightDirection[2];
+        };
+
+        // Per object data of the gpu meshes in blocks of g_objectDataBlockSize, the
+        // blocks in dynamic memory. A copy of the data is kept in the cpu and only the
+        // data that changed is uploaded. As dynamic memory has a copy per frame in flight
+        // the changed data is uploaded for as many frames.
+        // NOTE the forward and the shadow passes share it
+        struct ObjectData
+        {
+            std::vector<ObjectTransforms>       m_data;
+            std::vector<uint8_t>                m_pendingUploadsCount;
+            // NOTE sorted, the gpu meshes with pending uploads
+            std::vector<size_t>                 m_pendingGpuMeshes;
+            std::vector<size_t>                 m_mergedGpuMeshes;
+            std::vector<D3D12GpuMemoryHandle>   m_blocks;
+        };
+
+        struct MeshGeometry
+        {
+            D3D12StaticGeometryBuffer::MeshRange    m_meshRange;
+            Aabb                                    m_bounds;
+        };
+
+        // Forward pass view bound to the default texture until the texture is uploaded
+        struct PendingTextureView
+        {
+            size_t m_gpuMeshIndex;
+            size_t m_viewIndex;
+        };
+
+        struct UploadingTexture
+        {
+            std::wstring            m_textureFile;
+            D3D12GpuMemoryHandle    m_memHandle;
+            D3D12GpuViewHandle      m_view;
         };
 
         struct ShadowResources
@@ -90,7 +188,6 @@ namespace D3D12Basics
         D3D12Gpu& m_gpu;
 
         const Scene& m_scene;
-        const TextureDataCache& m_textureDataCache;
         const MeshDataCache&    m_meshDataCache;
 
         D3D12PipelineState m_stdMaterialPipeState;
@@ -103,11 +200,62 @@ namespace D3D12Basics
         D3D12GpuViewHandle m_defaultTexture;
         D3D12GpuViewHandle m_nullTexture;
 
+        // NOTE the textures and the gpu meshes are used once their static memory is
+        // uploaded, see D3D12Gpu::IsMemoryReady. Until then the textures views are bound
+        // to the default texture and the gpu meshes are not drawn.
         std::unordered_map<std::wstring, D3D12GpuViewHandle> m_textureCache;
+        std::unordered_map<std::wstring, std::vector<PendingTextureView>> m_pendingTextureViews;
+        std::vector<UploadingTexture>       m_uploadingTextures;
         std::unordered_map<size_t, size_t>  m_gpuMeshCache;
         std::vector<GPUMesh>                m_gpuMeshes;
+        std::vector<size_t>                 m_uploadingGpuMeshes;
+
+        // NOTE keyed by the model mesh id so the models sharing a mesh share its
+        // geometry
+        std::unordered_map<size_t, MeshGeometry> m_meshGeometries;
+
+        // Gpu meshes drawn together with one instanced draw per batch. The first gpu
+        // mesh of a batch holds the batch bindings and its per instance data is the
+        // list of the batch gpu meshes, as indices into their object data block.
+        // NOTE a batch never crosses object data blocks
+        // NOTE rebuilt in Update when models or textures are added
+        std::vector<size_t>         m_forwardInstances;
+        std::vector<InstanceBatch>  m_forwardBatches;
+        std::vector<size_t>         m_shadowInstances;
+        std::vector<InstanceBatch>  m_shadowBatches;
+        bool                        m_batchesDirty;
+        bool                        m_instancingEnabled;
+
+        // Transforms and world bounds of the gpu meshes and their visibility from the camera and
+        // from each light, updated every frame. The visible instances keep the
+        // batches layout so the cmd lists split stays the same from frame to frame.
+        // NOTE the transforms and bounds are only updated for the changed gpu meshes: the
+        // ones added since the last update and the ones of the scene moved models
+        // TODO lights count
+        std::vector<Matrix44>       m_worldTransforms;
+        std::vector<Matrix44>       m_normalTransforms;
+        std::vector<size_t>         m_addedGpuMeshes;
+        std::vector<size_t>         m_modelsGpuMesh;
+        std::vector<size_t>         m_changedGpuMeshes;
+        AabbsSoA                    m_localBounds;
+        AabbsSoA                    m_worldBounds;
+        std::vector<uint8_t>        m_cameraVisibility;
+        std::vector<uint8_t>        m_lightsVisibility[2];
+        VisibleInstances            m_forwardVisibleInstances;
+        VisibleInstances            m_shadowVisibleInstances[2];
+        bool                        m_cullingEnabled;
+
+        ObjectData                  m_objectData;
+
+        // Camera and lights transforms. Written, for as many frames as frames in flight,
+        // when the camera or the lights versions change.
+        D3D12GpuMemoryHandle        m_frameData;
+        uint64_t                    m_frameDataVersions[3];
+        uint8_t                     m_frameDataPendingUploadsCount;
 
         bool m_gpuResourcesLoaded;
+
+        D3D12StaticGeometryBuffer           m_staticGeometry;
         
         std::vector<ShadowResources> m_shadowResPerLight;
 
@@ -116,6 +264,7 @@ namespace D3D12Basics
 
         std::vector<D3D12GraphicsCmdListPtr> m_forwardCmdLists;
         std::vector<D3D12GraphicsCmdListPtr> m_shadowCmdLists;
+        bool                                 m_nullCmdLists;
         
         SceneStats m_sceneStats;
 
@@ -129,14 +278,37 @@ namespace D3D12Basics
         std::atomic<uint32_t> m_shadowPassDrawCallsCount;
         std::atomic<uint32_t> m_forwardPassDrawCallsCount;
 
-        D3D12GpuViewHandle CreateTexture(const std::wstring& textureFile);
+        D3D12GpuViewHandle TextureView(const std::wstring& textureFile, size_t gpuMeshIndex, size_t viewIndex);
+
+        void UpdateUploads();
+
+        bool IsGpuMeshReady(const GPUMesh& gpuMesh);
 
         void CreateDebugResources();
 
+        void SetGeometryBuffers(ID3D12GraphicsCommandListPtr cmdList, const GPUMesh& gpuMesh,
+                                size_t& currentVertexBufferId, size_t& currentIndexBufferId);
+
+        void BuildBatches();
+
+        void AddObjectData(size_t gpuMeshIndex);
+
+        size_t UploadObjectData();
+
+        void UpdateGpuMeshes(enki::TaskScheduler& taskScheduler, const Frustum& cameraFrustum,
+                             const Frustum (&lightsFrustum)[2]);
+
+        void UpdateGpuMeshRange(size_t start, size_t end, const Frustum& cameraFrustum,
+                                const Frustum (&lightsFrustum)[2]);
+
+        // Returns the list size in bytes
+        size_t WriteInstancesList(D3D12Bindings& bindings, const size_t* instances, size_t instancesCount);
+
+
         void SetupRenderDepthFromLight(ID3D12GraphicsCommandListPtr cmdList, size_t lightIndex, bool clear = true);
 
         void RenderDepthFromLight(ID3D12GraphicsCommandListPtr cmdList, size_t lightIndex,
-                                  size_t meshStartIndex, size_t meshEndIndex,
+                                  size_t batchStartIndex, size_t batchEndIndex,
                                   unsigned int concurrentBinderIndex);
 
         TaskSetPtr CreateRenderDepthFromLightTask(size_t lightIndex, size_t cmdListStartIndex,
@@ -147,7 +319,7 @@ namespace D3D12Basics
         void RenderForwardPassMeshRange(const D3D12GraphicsCmdListPtr& d3d12CmdList,
                                         D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
                                         D3D12_CPU_DESCRIPTOR_HANDLE depthStencilBuffer,
-                                        size_t meshStartIndex, size_t meshEndIndex,
+                                        size_t batchStartIndex, size_t batchEndIndex,
                                         unsigned int concurrentBinderIndex);
 
         TaskSetPtr CreateForwardPassTask(D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
@@ -160,7 +332,9 @@ namespace D3D12Basics
                                size_t drawCallsCount,
                                bool enableParallelCmdLists);
 
-        void UpdateCmdLists(size_t drawCallsCount, bool enableParallelCmdLists);
+        void UpdateCmdLists(size_t drawCallsCount, bool enableParallelCmdLists, bool recordToNullBackend);
+
+        D3D12GraphicsCmdListPtr CreateCmdList(const std::wstring& debugName, bool isNull);
 
         void ResetCmdLists(unsigned int concurrentBinders);
 
@@ -168,7 +342,7 @@ namespace D3D12Basics
                                        D3D12_RESOURCE_STATES stateBefore,
                                        D3D12_RESOURCE_STATES stateAfter);
 
-        size_t CalculateCmdListsCount(size_t drawCallsCount);
+        size_t CalculateCmdListsCount(size_t batchesCount, size_t drawCallsCount);
 
         void RenderDebug(ID3D12GraphicsCommandListPtr cmdList);
 
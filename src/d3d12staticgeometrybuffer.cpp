@@ -0,0 +1,200 @@
+#include "d3d12staticgeometrybuffer.h"
+
+// project includes
+#include "utils.h"
+
+// c++ includes
+#include <cassert>
+#include <string>
+#include <algorithm>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    // Committed resources are placed with 64kb alignment
+    size_t CommittedResourceSizeBytes(size_t sizeBytes)
+    {
+        return AlignToPowerof2(sizeBytes, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+    }
+}
+
+D3D12StaticGeometryBuffer::D3D12StaticGeometryBuffer(D3D12Gpu& gpu, size_t maxVertexBufferSizeBytes,
+                                                     size_t maxIndexBufferSizeBytes) :  m_gpu(gpu),
+                                                                                        m_maxVertexBufferSizeBytes(maxVertexBufferSizeBytes),
+                                                                                        m_maxIndexBufferSizeBytes(maxIndexBufferSizeBytes)
+{
+    assert(m_maxVertexBufferSizeBytes > 0);
+    assert(m_maxIndexBufferSizeBytes > 0);
+}
+
+D3D12StaticGeometryBuffer::MeshRange D3D12StaticGeometryBuffer::AddMesh(const MeshData& meshData)
+{
+    assert(meshData.VerticesCount() > 0);
+    assert(meshData.IndicesCount() > 0);
+
+    MeshRange meshRange;
+
+    // Vertices
+    {
+        const size_t vertexSizeBytes = meshData.VertexSizeBytes();
+        const size_t vertexBufferSizeBytes = meshData.VertexBufferSizeBytes();
+        meshRange.m_vertexBufferId = ReserveBuffer(m_vertexBuffers, m_currentVertexBuffers, vertexSizeBytes,
+                                                   vertexBufferSizeBytes, m_maxVertexBufferSizeBytes,
+                                                   L"vb - static geometry " + std::to_wstring(vertexSizeBytes) +
+                                                   L" bytes vertex " + std::to_wstring(m_vertexBuffers.size()));
+
+        auto& vertexBuffer = m_vertexBuffers[meshRange.m_vertexBufferId];
+        meshRange.m_baseVertex = static_cast<int>(vertexBuffer.m_sizeBytes / vertexSizeBytes);
+        meshRange.m_verticesCount = static_cast<uint32_t>(meshData.VerticesCount());
+
+        auto& pendingVertices = vertexBuffer.m_pendingData;
+        pendingVertices.resize(pendingVertices.size() + vertexBufferSizeBytes);
+        memcpy(&pendingVertices[pendingVertices.size() - vertexBufferSizeBytes], &meshData.Vertices()[0],
+               vertexBufferSizeBytes);
+        vertexBuffer.m_sizeBytes += vertexBufferSizeBytes;
+    }
+
+    // Indices
+    {
+        const size_t indexSizeBytes = meshData.IndexSizeBytes();
+        const size_t indexBufferSizeBytes = meshData.IndexBufferSizeBytes();
+        meshRange.m_indexBufferId = ReserveBuffer(m_indexBuffers, m_currentIndexBuffers, indexSizeBytes,
+                                                  indexBufferSizeBytes, m_maxIndexBufferSizeBytes,
+                                                  L"ib - static geometry " + std::to_wstring(indexSizeBytes * 8) +
+                                                  L" bits index " + std::to_wstring(m_indexBuffers.size()));
+
+        auto& indexBuffer = m_indexBuffers[meshRange.m_indexBufferId];
+        meshRange.m_startIndex = static_cast<uint32_t>(indexBuffer.m_sizeBytes / indexSizeBytes);
+        meshRange.m_indicesCount = static_cast<uint32_t>(meshData.IndicesCount());
+
+        const auto& indices = meshData.Indices();
+        auto& pendingIndices = indexBuffer.m_pendingData;
+        pendingIndices.resize(pendingIndices.size() + indexBufferSizeBytes);
+        uint8_t* dest = &pendingIndices[pendingIndices.size() - indexBufferSizeBytes];
+        if (indexSizeBytes == sizeof(uint32_t))
+        {
+            memcpy(dest, &indices[0], indexBufferSizeBytes);
+            ++m_stats.m_32BitsIndicesMeshesCount;
+        }
+        else
+        {
+            for (size_t i = 0; i < indices.size(); ++i)
+            {
+                const uint16_t index = static_cast<uint16_t>(indices[i]);
+                memcpy(dest + i * sizeof(uint16_t), &index, sizeof(uint16_t));
+            }
+        }
+        indexBuffer.m_sizeBytes += indexBufferSizeBytes;
+    }
+
+    ++m_stats.m_meshesCount;
+    m_stats.m_vertexBuffersCount = m_vertexBuffers.size();
+    m_stats.m_indexBuffersCount = m_indexBuffers.size();
+    m_stats.m_usedSizeBytes += meshData.VertexBufferSizeBytes() + meshData.IndexBufferSizeBytes();
+    m_stats.m_separateSizeBytes += CommittedResourceSizeBytes(meshData.VertexBufferSizeBytes()) +
+                                   CommittedResourceSizeBytes(meshData.IndexBufferSizeBytes());
+
+    return meshRange;
+}
+
+void D3D12StaticGeometryBuffer::Flush()
+{
+    for (const auto& currentVertexBuffer : m_currentVertexBuffers)
+        FlushBuffer(m_vertexBuffers[currentVertexBuffer.second]);
+
+    for (const auto& currentIndexBuffer : m_currentIndexBuffers)
+        FlushBuffer(m_indexBuffers[currentIndexBuffer.second]);
+}
+
+bool D3D12StaticGeometryBuffer::IsMeshReady(const MeshRange& meshRange)
+{
+    assert(meshRange.m_vertexBufferId < m_vertexBuffers.size());
+    assert(meshRange.m_indexBufferId < m_indexBuffers.size());
+    auto& vertexBuffer = m_vertexBuffers[meshRange.m_vertexBufferId];
+    auto& indexBuffer = m_indexBuffers[meshRange.m_indexBufferId];
+
+    const size_t verticesEndBytes = (static_cast<size_t>(meshRange.m_baseVertex) + meshRange.m_verticesCount) *
+                                    vertexBuffer.m_strideBytes;
+    const size_t indicesEndBytes = (static_cast<size_t>(meshRange.m_startIndex) + meshRange.m_indicesCount) *
+                                   indexBuffer.m_strideBytes;
+
+    return IsRangeReady(vertexBuffer, verticesEndBytes) && IsRangeReady(indexBuffer, indicesEndBytes);
+}
+
+void D3D12StaticGeometryBuffer::SetVertexBuffer(ID3D12GraphicsCommandListPtr cmdList, size_t vertexBufferId)
+{
+    assert(vertexBufferId < m_vertexBuffers.size());
+    const auto& vertexBuffer = m_vertexBuffers[vertexBufferId];
+    assert(vertexBuffer.m_memHandle.IsValid());
+
+    m_gpu.SetVertexBuffer(cmdList, vertexBuffer.m_memHandle, vertexBuffer.m_capacityBytes, vertexBuffer.m_strideBytes);
+}
+
+void D3D12StaticGeometryBuffer::SetIndexBuffer(ID3D12GraphicsCommandListPtr cmdList, size_t indexBufferId)
+{
+    assert(indexBufferId < m_indexBuffers.size());
+    const auto& indexBuffer = m_indexBuffers[indexBufferId];
+    assert(indexBuffer.m_memHandle.IsValid());
+
+    m_gpu.SetIndexBuffer(cmdList, indexBuffer.m_memHandle, indexBuffer.m_capacityBytes, indexBuffer.m_strideBytes);
+}
+
+size_t D3D12StaticGeometryBuffer::ReserveBuffer(std::vector<Buffer>& buffers,
+                                                std::unordered_map<size_t, size_t>& currentBuffers,
+                                                size_t strideBytes, size_t sizeBytes, size_t maxSizeBytes,
+                                                const std::wstring& debugName)
+{
+    auto currentBufferIt = currentBuffers.find(strideBytes);
+    if (currentBufferIt != currentBuffers.end())
+    {
+        auto& currentBuffer = buffers[currentBufferIt->second];
+        if (currentBuffer.m_sizeBytes + sizeBytes <= currentBuffer.m_capacityBytes)
+            return currentBufferIt->second;
+
+        FlushBuffer(currentBuffer);
+        std::vector<uint8_t>().swap(currentBuffer.m_pendingData);
+    }
+
+    // NOTE a mesh bigger than the max size gets a buffer of its own
+    Buffer buffer;
+    buffer.m_capacityBytes = std::max(maxSizeBytes, sizeBytes);
+    buffer.m_strideBytes = strideBytes;
+    buffer.m_memHandle = m_gpu.AllocateStaticMemory(buffer.m_capacityBytes, debugName);
+    assert(buffer.m_memHandle.IsValid());
+
+    m_stats.m_sizeBytes += CommittedResourceSizeBytes(buffer.m_capacityBytes);
+
+    const size_t bufferId = buffers.size();
+    buffers.push_back(std::move(buffer));
+    currentBuffers[strideBytes] = bufferId;
+
+    return bufferId;
+}
+
+void D3D12StaticGeometryBuffer::FlushBuffer(Buffer& buffer)
+{
+    if (buffer.m_pendingData.empty())
+        return;
+
+    assert(buffer.m_uploadedSizeBytes + buffer.m_pendingData.size() == buffer.m_sizeBytes);
+    const auto uploadId = m_gpu.UpdateStaticMemory(buffer.m_memHandle, &buffer.m_pendingData[0],
+                                                   buffer.m_pendingData.size(), buffer.m_uploadedSizeBytes);
+    buffer.m_regionUploads.AddUpload(uploadId, buffer.m_sizeBytes);
+
+    buffer.m_uploadedSizeBytes = buffer.m_sizeBytes;
+    buffer.m_pendingData.clear();
+}
+
+bool D3D12StaticGeometryBuffer::IsRangeReady(Buffer& buffer, size_t endBytes)
+{
+    if (endBytes <= buffer.m_regionUploads.ReadySizeBytes())
+        return true;
+
+    const size_t readySizeBytes = buffer.m_regionUploads.Update([this](RegionUploadTracker::UploadId uploadId)
+    {
+        return m_gpu.IsUploadFinished(uploadId);
+    });
+
+    return endBytes <= readySizeBytes;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+// project includes
+#include "d3d12gpu.h"
+#include "uploadtracker.h"
+
+// c++ includes
+#include <vector>
+#include <unordered_map>
+
+namespace D3D12Basics
+{
+    // Packs static meshes into a few big vertex and index buffers (arenas) instead of
+    // a committed resource per buffer (each one padded to 64kb).
+    // Meshes with the same vertex size share the vertex buffer so they are drawn
+    // with base vertex and start index without rebinding the buffers.
+    // Same for the index buffers with the index size (16 or 32 bits) of each mesh.
+    // An arena is allocated with its max size the first time it is needed. Meshes are
+    // appended on the cpu and Flush uploads the region appended since the last one
+    // through the upload queue, so the meshes already uploaded keep being drawn.
+    // A new arena is started only when the current one is full so there can be
+    // several buffers per vertex or index size.
+    // NOTE Flush is cheap when nothing was added, it can be called every frame.
+    class D3D12StaticGeometryBuffer
+    {
+    public:
+        static const size_t m_invalidBufferId = static_cast<size_t>(-1);
+
+        struct MeshRange
+        {
+            size_t      m_vertexBufferId    = m_invalidBufferId;
+            size_t      m_indexBufferId     = m_invalidBufferId;
+            int         m_baseVertex        = 0;
+            uint32_t    m_verticesCount     = 0;
+            uint32_t    m_startIndex        = 0;
+            uint32_t    m_indicesCount      = 0;
+        };
+
+        struct Stats
+        {
+            size_t m_meshesCount            = 0;
+            size_t m_32BitsIndicesMeshesCount = 0;
+            size_t m_vertexBuffersCount     = 0;
+            size_t m_indexBuffersCount      = 0;
+
+            // Committed resources size vs the size it would take with a committed
+            // resource per mesh vertex and index buffers.
+            size_t m_sizeBytes              = 0;
+            size_t m_usedSizeBytes          = 0;
+            size_t m_separateSizeBytes      = 0;
+        };
+
+        D3D12StaticGeometryBuffer(D3D12Gpu& gpu, size_t maxVertexBufferSizeBytes, size_t maxIndexBufferSizeBytes);
+
+        D3D12StaticGeometryBuffer(const D3D12StaticGeometryBuffer&) = delete;
+
+        // NOTE the mesh can be drawn once Flush was called
+        MeshRange AddMesh(const MeshData& meshData);
+
+        void Flush();
+
+        // NOTE false until the ranges of the mesh are flushed and their upload finished
+        bool IsMeshReady(const MeshRange& meshRange);
+
+        void SetVertexBuffer(ID3D12GraphicsCommandListPtr cmdList, size_t vertexBufferId);
+
+        void SetIndexBuffer(ID3D12GraphicsCommandListPtr cmdList, size_t indexBufferId);
+
+        const Stats& GetStats() const { return m_stats; }
+
+    private:
+        struct Buffer
+        {
+            D3D12GpuMemoryHandle    m_memHandle;
+            size_t                  m_capacityBytes     = 0;
+            size_t                  m_sizeBytes         = 0;
+            size_t                  m_uploadedSizeBytes = 0;
+            size_t                  m_strideBytes       = 0;
+
+            // NOTE a region upload per flush, the meshes of the finished ones are drawn
+            //      while the newer ones upload
+            RegionUploadTracker     m_regionUploads;
+
+            // NOTE the bytes appended after m_uploadedSizeBytes. Indices are already
+            //      packed to the index size.
+            std::vector<uint8_t>    m_pendingData;
+        };
+
+        D3D12Gpu& m_gpu;
+
+        const size_t m_maxVertexBufferSizeBytes;
+        const size_t m_maxIndexBufferSizeBytes;
+
+        // NOTE buffer ids are indices into these
+        std::vector<Buffer> m_vertexBuffers;
+        std::vector<Buffer> m_indexBuffers;
+
+        // Buffer ids being appended to by vertex and index size
+        std::unordered_map<size_t, size_t> m_currentVertexBuffers;
+        std::unordered_map<size_t, size_t> m_currentIndexBuffers;
+
+        Stats m_stats;
+
+        // NOTE flushes the current buffer and starts a new one when sizeBytes doesnt fit
+        size_t ReserveBuffer(std::vector<Buffer>& buffers, std::unordered_map<size_t, size_t>& currentBuffers,
+                             size_t strideBytes, size_t sizeBytes, size_t maxSizeBytes,
+                             const std::wstring& debugName);
+
+        void FlushBuffer(Buffer& buffer);
+
+        bool IsRangeReady(Buffer& buffer, size_t endBytes);
+    };
+}
@@ -0,0 +1,357 @@
+#include "d3d12uploadqueue.h"
+
+// project includes
+#include "utils.h"
+#include "d3d12utils.h"
+#include "d3d12committedresources.h"
+
+// c++ includes
+#include <cassert>
+#include <algorithm>
+
+using namespace D3D12Basics;
+
+D3D12UploadQueue::D3D12UploadQueue(ID3D12DevicePtr device, ID3D12CommandQueuePtr cmdQueue,
+                                   size_t stagingPageSizeInBytes) : m_device(device), m_cmdQueue(cmdQueue),
+                                                                    m_nextFenceValue(1),
+                                                                    m_tracker(stagingPageSizeInBytes)
+{
+    assert(m_device);
+    assert(m_cmdQueue);
+
+    AssertIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+    assert(m_fence);
+
+    m_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    assert(m_event);
+    if (!m_event)
+        AssertIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+    auto cmdAllocator = GetCmdAllocator();
+    AssertIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, cmdAllocator.Get(),
+                                               nullptr, IID_PPV_ARGS(&m_cmdList)));
+    assert(m_cmdList);
+    AssertIfFailed(m_cmdList->Close());
+    m_cmdList->SetName(L"Command List D3D12UploadQueue");
+    m_freeCmdAllocators.push_back(cmdAllocator);
+}
+
+D3D12UploadQueue::~D3D12UploadQueue()
+{
+    WaitAll();
+
+    D3D12_RANGE writtenRange{ 0, 0 };
+    for (auto& page : m_stagingPages)
+    {
+        if (page.m_resource)
+            page.m_resource->Unmap(0, &writtenRange);
+    }
+
+    CloseHandle(m_event);
+}
+
+D3D12UploadQueue::UploadId D3D12UploadQueue::EnqueueBufferUpload(ID3D12ResourcePtr dest, const void* data,
+                                                                 size_t sizeBytes, D3D12_RESOURCE_STATES stateAfter)
+{
+    return EnqueueBufferRegionUpload(dest, 0, data, sizeBytes, D3D12_RESOURCE_STATE_COPY_DEST, stateAfter);
+}
+
+D3D12UploadQueue::UploadId D3D12UploadQueue::EnqueueBufferRegionUpload(ID3D12ResourcePtr dest, size_t destOffsetBytes,
+                                                                       const void* data, size_t sizeBytes,
+                                                                       D3D12_RESOURCE_STATES stateBefore,
+                                                                       D3D12_RESOURCE_STATES stateAfter)
+{
+    assert(dest);
+    assert(data);
+    assert(sizeBytes > 0);
+
+    PendingUpload upload;
+    upload.m_dest = dest;
+    upload.m_stateBefore = stateBefore;
+    upload.m_stateAfter = stateAfter;
+    upload.m_sizeBytes = sizeBytes;
+    upload.m_destOffset = destOffsetBytes;
+
+    const auto staging = AllocateStaging(sizeBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    const auto& stagingPage = m_stagingPages[staging.m_pageIndex];
+    upload.m_id = m_tracker.AddPendingUpload(staging.m_pageIndex, sizeBytes);
+    upload.m_staging = stagingPage.m_resource;
+    upload.m_stagingOffset = staging.m_offset;
+
+    memcpy(stagingPage.m_cpuPtr + upload.m_stagingOffset, data, sizeBytes);
+
+    m_pendingUploads.push_back(std::move(upload));
+    UpdateStats();
+
+    return m_pendingUploads.back().m_id;
+}
+
+D3D12UploadQueue::UploadId D3D12UploadQueue::EnqueueTextureUpload(ID3D12ResourcePtr dest, const D3D12_RESOURCE_DESC& desc,
+                                                                  const std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+                                                                  D3D12_RESOURCE_STATES stateAfter)
+{
+    assert(dest);
+    assert(!subresources.empty());
+
+    const UINT subresourcesCount = static_cast<UINT>(subresources.size());
+
+    PendingUpload upload;
+    upload.m_dest = dest;
+    upload.m_stateAfter = stateAfter;
+    upload.m_layouts.resize(subresourcesCount);
+
+    std::vector<UINT64> rowSizesInBytes(subresourcesCount);
+    std::vector<UINT>   rowsCounts(subresourcesCount);
+    UINT64              requiredSize = 0;
+    // NOTE the layouts offsets are relative to the start of the upload. They get moved
+    // to the staging offset below.
+    m_device->GetCopyableFootprints(&desc, 0, subresourcesCount, 0, &upload.m_layouts[0],
+                                    &rowsCounts[0], &rowSizesInBytes[0], &requiredSize);
+    upload.m_sizeBytes = static_cast<size_t>(requiredSize);
+
+    const auto staging = AllocateStaging(upload.m_sizeBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    const auto& stagingPage = m_stagingPages[staging.m_pageIndex];
+    upload.m_id = m_tracker.AddPendingUpload(staging.m_pageIndex, upload.m_sizeBytes);
+    upload.m_staging = stagingPage.m_resource;
+    upload.m_stagingOffset = staging.m_offset;
+
+    for (UINT i = 0; i < subresourcesCount; ++i)
+    {
+        assert(rowSizesInBytes[i] <= (SIZE_T)-1);
+        auto& layout = upload.m_layouts[i];
+        layout.Offset += upload.m_stagingOffset;
+
+        const auto& rowSizeBytes = rowSizesInBytes[i];
+        const auto& rowsCount = rowsCounts[i];
+
+        const BYTE* srcData = reinterpret_cast<const BYTE*>(subresources[i].pData);
+        SIZE_T srcRowPitch = subresources[i].RowPitch;
+        SIZE_T srcSlicePitch = subresources[i].SlicePitch;
+
+        BYTE* dstData = stagingPage.m_cpuPtr + layout.Offset;
+        SIZE_T dstRowPitch = layout.Footprint.RowPitch;
+        SIZE_T dstSlicePitch = layout.Footprint.RowPitch * rowsCount;
+        for (UINT z = 0; z < layout.Footprint.Depth; ++z)
+        {
+            BYTE* pDestSlice = dstData + dstSlicePitch * z;
+            const BYTE* pSrcSlice = srcData + srcSlicePitch * z;
+            for (UINT y = 0; y < rowsCount; ++y)
+            {
+                memcpy(pDestSlice + dstRowPitch * y,
+                       pSrcSlice + srcRowPitch * y,
+                       rowSizeBytes);
+            }
+        }
+    }
+
+    m_pendingUploads.push_back(std::move(upload));
+    UpdateStats();
+
+    return m_pendingUploads.back().m_id;
+}
+
+void D3D12UploadQueue::Submit()
+{
+    SubmitPending(false);
+}
+
+void D3D12UploadQueue::SubmitPending(bool ignoreBudget)
+{
+    RetireCompletedBatches();
+
+    m_stats.m_lastSubmitSizeBytes = 0;
+    const size_t uploadsCount = m_tracker.PendingUploadsToSubmit(ignoreBudget);
+    if (!uploadsCount)
+        return;
+
+    Batch batch;
+    batch.m_cmdAllocator = GetCmdAllocator();
+    AssertIfFailed(m_cmdList->Reset(batch.m_cmdAllocator.Get(), nullptr));
+
+    // NOTE a buffer can get several region uploads in the same batch. It transitions to
+    // copy dest before its first copy and to its state after once all the copies are done.
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    for (size_t i = 0; i < uploadsCount; ++i)
+    {
+        auto& upload = m_pendingUploads.front();
+
+        auto isSameDest = [&upload](const D3D12_RESOURCE_BARRIER& barrier)
+        {
+            return barrier.Transition.pResource == upload.m_dest.Get();
+        };
+        auto barrierIt = std::find_if(barriers.begin(), barriers.end(), isSameDest);
+        if (barrierIt == barriers.end())
+        {
+            D3D12_RESOURCE_BARRIER copyDestToStateAfter;
+            copyDestToStateAfter.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            copyDestToStateAfter.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+            copyDestToStateAfter.Transition.pResource = upload.m_dest.Get();
+            copyDestToStateAfter.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            copyDestToStateAfter.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+            copyDestToStateAfter.Transition.StateAfter = upload.m_stateAfter;
+            barriers.push_back(copyDestToStateAfter);
+
+            if (upload.m_stateBefore != D3D12_RESOURCE_STATE_COPY_DEST)
+            {
+                D3D12_RESOURCE_BARRIER stateBeforeToCopyDest = copyDestToStateAfter;
+                stateBeforeToCopyDest.Transition.StateBefore = upload.m_stateBefore;
+                stateBeforeToCopyDest.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                m_cmdList->ResourceBarrier(1, &stateBeforeToCopyDest);
+            }
+        }
+        else
+        {
+            // NOTE the last upload decides the state after
+            barrierIt->Transition.StateAfter = upload.m_stateAfter;
+        }
+
+        if (upload.m_layouts.empty())
+        {
+            m_cmdList->CopyBufferRegion(upload.m_dest.Get(), upload.m_destOffset, upload.m_staging.Get(),
+                                        upload.m_stagingOffset, upload.m_sizeBytes);
+        }
+        else
+        {
+            D3D12_TEXTURE_COPY_LOCATION dest;
+            dest.pResource = upload.m_dest.Get();
+            dest.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+
+            D3D12_TEXTURE_COPY_LOCATION src;
+            src.pResource = upload.m_staging.Get();
+            src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+
+            for (UINT i = 0; i < upload.m_layouts.size(); ++i)
+            {
+                src.PlacedFootprint = upload.m_layouts[i];
+                dest.SubresourceIndex = i;
+                m_cmdList->CopyTextureRegion(&dest, 0, 0, 0, &src, nullptr);
+            }
+        }
+
+        batch.m_resources.push_back(std::move(upload.m_dest));
+        batch.m_resources.push_back(std::move(upload.m_staging));
+        m_pendingUploads.pop_front();
+    }
+
+    m_cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), &barriers[0]);
+
+    AssertIfFailed(m_cmdList->Close());
+    ID3D12CommandList* ppCommandLists[] = { m_cmdList.Get() };
+    m_cmdQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+
+    const UINT64 fenceValue = m_nextFenceValue++;
+    AssertIfFailed(m_cmdQueue->Signal(m_fence.Get(), fenceValue));
+    m_inFlightBatches.push_back(std::move(batch));
+
+    m_stats.m_lastSubmitSizeBytes = m_tracker.Submit(uploadsCount, fenceValue);
+    ++m_stats.m_submittedBatchesCount;
+    UpdateStats();
+}
+
+bool D3D12UploadQueue::IsUploadFinished(UploadId uploadId)
+{
+    if (m_tracker.IsUploadFinished(uploadId))
+        return true;
+
+    RetireCompletedBatches();
+
+    return m_tracker.IsUploadFinished(uploadId);
+}
+
+void D3D12UploadQueue::WaitAll()
+{
+    SubmitPending(true);
+
+    const UINT64 lastFenceValue = m_nextFenceValue - 1;
+    if (m_fence->GetCompletedValue() < lastFenceValue)
+    {
+        AssertIfFailed(m_fence->SetEventOnCompletion(lastFenceValue, m_event));
+        AssertIfFailed(WaitForSingleObject(m_event, INFINITE), WAIT_FAILED);
+    }
+
+    RetireCompletedBatches();
+    assert(m_inFlightBatches.empty());
+}
+
+UploadTracker::StagingAllocation D3D12UploadQueue::AllocateStaging(size_t sizeBytes, size_t alignment)
+{
+    if (m_tracker.IsSubmitNeeded(sizeBytes, alignment))
+        SubmitPending(true);
+
+    const auto allocation = m_tracker.AllocateStaging(sizeBytes, alignment);
+    if (allocation.m_isNewPage)
+    {
+        if (allocation.m_pageIndex >= m_stagingPages.size())
+            m_stagingPages.resize(allocation.m_pageIndex + 1);
+
+        assert(!m_stagingPages[allocation.m_pageIndex].m_resource);
+        m_stagingPages[allocation.m_pageIndex] = CreateStagingPage(allocation.m_pageSizeBytes);
+    }
+    UpdateStats();
+
+    return allocation;
+}
+
+D3D12UploadQueue::StagingPage D3D12UploadQueue::CreateStagingPage(size_t sizeBytes)
+{
+    StagingPage page;
+    page.m_resource = CreateResourceHeap(m_device, CreateBufferDesc(sizeBytes), ResourceHeapType::UploadHeap,
+                                         D3D12_RESOURCE_STATE_GENERIC_READ);
+    assert(page.m_resource);
+    page.m_resource->SetName(L"Upload heap - D3D12UploadQueue staging page");
+
+    D3D12_RANGE readRange{ 0, 0 };
+    AssertIfFailed(page.m_resource->Map(0, &readRange, reinterpret_cast<void**>(&page.m_cpuPtr)));
+    assert(page.m_cpuPtr);
+
+    return page;
+}
+
+ID3D12CommandAllocatorPtr D3D12UploadQueue::GetCmdAllocator()
+{
+    ID3D12CommandAllocatorPtr cmdAllocator;
+    if (!m_freeCmdAllocators.empty())
+    {
+        cmdAllocator = m_freeCmdAllocators.back();
+        m_freeCmdAllocators.pop_back();
+        AssertIfFailed(cmdAllocator->Reset());
+    }
+    else
+    {
+        AssertIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&cmdAllocator)));
+        assert(cmdAllocator);
+        cmdAllocator->SetName(L"Command Allocator D3D12UploadQueue");
+    }
+
+    return cmdAllocator;
+}
+
+void D3D12UploadQueue::RetireCompletedBatches()
+{
+    m_releasedPages.clear();
+    const size_t retiredBatchesCount = m_tracker.RetireCompletedBatches(m_fence->GetCompletedValue(), m_releasedPages);
+    assert(retiredBatchesCount <= m_inFlightBatches.size());
+    for (size_t i = 0; i < retiredBatchesCount; ++i)
+    {
+        m_freeCmdAllocators.push_back(std::move(m_inFlightBatches.front().m_cmdAllocator));
+        m_inFlightBatches.pop_front();
+    }
+
+    // NOTE the pages bigger than the page size are released once their upload is finished
+    D3D12_RANGE writtenRange{ 0, 0 };
+    for (const size_t pageIndex : m_releasedPages)
+    {
+        auto& page = m_stagingPages[pageIndex];
+        page.m_resource->Unmap(0, &writtenRange);
+        page = StagingPage{};
+    }
+
+    UpdateStats();
+}
+
+void D3D12UploadQueue::UpdateStats()
+{
+    m_stats.m_stagingPagesCount = m_tracker.StagingPagesCount();
+    m_stats.m_pendingUploadsCount = m_tracker.PendingUploadsCount();
+    m_stats.m_pendingSizeBytes = m_tracker.PendingSizeBytes();
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+// project includes
+#include "d3d12fwd.h"
+#include "uploadtracker.h"
+
+// c++ includes
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+// windows includes
+#include <windows.h>
+
+// directx includes
+#include <d3d12.h>
+
+namespace D3D12Basics
+{
+    // Batches the uploads of static buffers and textures instead of doing a cpu/gpu
+    // round trip per resource.
+    // Enqueueing copies the data into shared staging pages (persistently mapped upload
+    // buffers) and returns an upload id. Submit records all the pending copies into one
+    // cmd list, executes it and signals the fence once for the whole batch.
+    // An upload id is finished once the fence of its batch passes. Staging pages and cmd
+    // allocators are recycled at that point. The bookkeeping is done by UploadTracker.
+    // Optionally Submit can be limited to a byte budget so streaming uploads are spread
+    // across frames. The uploads that dont fit stay pending for the next Submit.
+    // The staging pages holding pending uploads are capped to the budget, rounded up to
+    // pages, or to one page without budget. When a page gets full at the cap all the
+    // pending uploads are submitted so a load doesnt grow the staging memory up to the
+    // size of everything uploaded.
+    // Regions of a buffer can be uploaded while the gpu uses the rest of it. The buffer
+    // transitions to copy dest and back around the copies, once per batch.
+    // NOTE uploads are executed in the queue passed in so any cmd list executed after
+    // the Submit in that queue sees the uploaded data.
+    // NOTE not thread safe
+    class D3D12UploadQueue
+    {
+    public:
+        using UploadId = UploadTracker::UploadId;
+
+        static const UploadId m_finishedUploadId = UploadTracker::m_finishedUploadId;
+
+        struct Stats
+        {
+            size_t      m_stagingPagesCount     = 0;
+            size_t      m_pendingUploadsCount   = 0;
+            size_t      m_pendingSizeBytes      = 0;
+            size_t      m_lastSubmitSizeBytes   = 0;
+            uint64_t    m_submittedBatchesCount = 0;
+        };
+
+        D3D12UploadQueue(ID3D12DevicePtr device, ID3D12CommandQueuePtr cmdQueue, size_t stagingPageSizeInBytes);
+
+        ~D3D12UploadQueue();
+
+        D3D12UploadQueue(const D3D12UploadQueue&) = delete;
+
+        // NOTE dest has to be in D3D12_RESOURCE_STATE_COPY_DEST. It will transition
+        // to stateAfter when the copy is executed.
+        UploadId EnqueueBufferUpload(ID3D12ResourcePtr dest, const void* data, size_t sizeBytes,
+                                     D3D12_RESOURCE_STATES stateAfter);
+
+        // Copies data at destOffsetBytes. dest is in stateBefore until the batch
+        // executes and in stateAfter after it.
+        // NOTE the gpu can keep using dest in stateBefore in cmd lists executed before
+        // the Submit, ie the regions not being uploaded.
+        UploadId EnqueueBufferRegionUpload(ID3D12ResourcePtr dest, size_t destOffsetBytes, const void* data,
+                                           size_t sizeBytes, D3D12_RESOURCE_STATES stateBefore,
+                                           D3D12_RESOURCE_STATES stateAfter);
+
+        UploadId EnqueueTextureUpload(ID3D12ResourcePtr dest, const D3D12_RESOURCE_DESC& desc,
+                                      const std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+                                      D3D12_RESOURCE_STATES stateAfter);
+
+        void Submit();
+
+        // 0 means no budget, ie all the pending uploads are submitted
+        // NOTE at least one upload is always submitted so uploads bigger than the budget
+        // dont get stuck
+        void SetSubmitBudget(size_t budgetSizeBytes) { m_tracker.SetSubmitBudget(budgetSizeBytes); }
+
+        bool IsUploadFinished(UploadId uploadId);
+
+        // Submits everything and blocks until the gpu is done with it
+        void WaitAll();
+
+        const Stats& GetStats() const { return m_stats; }
+
+    private:
+        struct StagingPage
+        {
+            ID3D12ResourcePtr   m_resource;
+            uint8_t*            m_cpuPtr = nullptr;
+        };
+
+        struct PendingUpload
+        {
+            UploadId                m_id;
+            ID3D12ResourcePtr       m_dest;
+            ID3D12ResourcePtr       m_staging;
+            D3D12_RESOURCE_STATES   m_stateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+            D3D12_RESOURCE_STATES   m_stateAfter;
+            size_t                  m_sizeBytes;
+            UINT64                  m_stagingOffset;
+            UINT64                  m_destOffset = 0;
+
+            // NOTE empty for buffers
+            std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> m_layouts;
+        };
+
+        struct Batch
+        {
+            ID3D12CommandAllocatorPtr       m_cmdAllocator;
+
+            // Keep the resources alive until the gpu is done with them
+            std::vector<ID3D12ResourcePtr>  m_resources;
+        };
+
+        ID3D12DevicePtr                 m_device;
+        ID3D12CommandQueuePtr           m_cmdQueue;
+        ID3D12GraphicsCommandListPtr    m_cmdList;
+
+        ID3D12FencePtr  m_fence;
+        HANDLE          m_event;
+        UINT64          m_nextFenceValue;
+
+        UploadTracker m_tracker;
+
+        // NOTE indexed by the tracker page index. Released pages have no resource.
+        std::vector<StagingPage>        m_stagingPages;
+
+        // NOTE in the same order as the tracker ones
+        std::deque<PendingUpload>               m_pendingUploads;
+        std::deque<Batch>                       m_inFlightBatches;
+        std::vector<ID3D12CommandAllocatorPtr>  m_freeCmdAllocators;
+
+        std::vector<size_t>     m_releasedPages;
+
+        Stats       m_stats;
+
+        // NOTE submits the pending uploads first when the tracker says so
+        UploadTracker::StagingAllocation AllocateStaging(size_t sizeBytes, size_t alignment);
+
+        void SubmitPending(bool ignoreBudget);
+
+        void UpdateStats();
+
+        StagingPage CreateStagingPage(size_t sizeBytes);
+
+        ID3D12CommandAllocatorPtr GetCmdAllocator();
+
+        void RetireCompletedBatches();
+    };
+}
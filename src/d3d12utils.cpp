@@ -206,5 +206,24 @@ D3D12_RESOURCE_DESC D3D12Basics::CreateTexture2DDesc(unsigned int width, unsigne
     resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
     resourceDesc.Flags = flags;
 
+    return resourceDesc;
+}
+
+D3D12_RESOURCE_DESC D3D12Basics::CreateBufferDesc(uint64_t sizeBytes)
+{
+    D3D12_RESOURCE_DESC resourceDesc;
+    resourceDesc.Dimension           = D3D12_RESOURCE_DIMENSION_BUFFER;
+    // https://msdn.microsoft.com/en-us/library/windows/desktop/dn903813(v=vs.85).aspx
+    // Alignment must be 64KB (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) or 0, which is effectively 64KB.
+    resourceDesc.Alignment           = 0;
+    resourceDesc.Width               = sizeBytes;
+    resourceDesc.Height              = 1;
+    resourceDesc.DepthOrArraySize    = 1;
+    resourceDesc.MipLevels           = 1;
+    resourceDesc.Format              = DXGI_FORMAT_UNKNOWN;
+    resourceDesc.SampleDesc          = { 1, 0 };
+    resourceDesc.Layout              = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    resourceDesc.Flags               = D3D12_RESOURCE_FLAG_NONE;
+
     return resourceDesc;
 }
\ No newline at end of file
@@ -36,4 +36,6 @@ namespace D3D12Basics
     void OutputDebugBlobErrorMsg(ID3DBlobPtr errorMsg);
 
     D3D12_RESOURCE_DESC CreateTexture2DDesc(unsigned int width, unsigned int height, DXGI_FORMAT format, D3D12_RESOURCE_FLAGS flags);
+
+    D3D12_RESOURCE_DESC CreateBufferDesc(uint64_t sizeBytes);
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "deriveddatacache.h"
+
+// project includes
+#include "assetserialization.h"
+
+// c++ includes
+#include <cassert>
+#include <vector>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    // NOTE "D3DD" in memory
+    const uint32_t g_derivedDataMagic = 0x44443344;
+
+    // NOTE bump it whenever the layout of the entries changes
+    const uint32_t g_derivedDataVersion = 1;
+
+    const wchar_t* g_entryExtension = L".ddc";
+    const wchar_t* g_tempExtension = L".tmp";
+
+    struct EntryHeader
+    {
+        uint32_t    m_magic;
+        uint32_t    m_version;
+        uint32_t    m_type;
+        uint32_t    m_padding;
+        uint64_t    m_sourceHash;
+        uint64_t    m_paramsHash;
+        uint64_t    m_fileSizeBytes;
+    };
+    static_assert(std::is_trivially_copyable_v<EntryHeader>, "EntryHeader is written as is");
+
+    struct EntryFileInfo
+    {
+        std::filesystem::path           m_path;
+        std::filesystem::file_time_type m_writeTime;
+        size_t                          m_sizeBytes;
+    };
+
+    // Entries and temporary files left by a previous run
+    void ListEntries(const std::wstring& path, std::vector<EntryFileInfo>& entries,
+                     std::vector<std::filesystem::path>& tempFiles)
+    {
+        std::error_code error;
+        for (const auto& file : std::filesystem::directory_iterator(path, error))
+        {
+            if (!file.is_regular_file(error))
+                continue;
+
+            const auto extension = file.path().extension();
+            if (extension == g_tempExtension)
+                tempFiles.push_back(file.path());
+            else if (extension == g_entryExtension)
+            {
+                const auto writeTime = file.last_write_time(error);
+                const auto sizeBytes = file.file_size(error);
+                if (!error)
+                    entries.push_back({ file.path(), writeTime, static_cast<size_t>(sizeBytes) });
+            }
+        }
+    }
+}
+
+DerivedDataCache::DerivedDataCache(const std::wstring& path, size_t maxSizeBytes) : m_path(path),
+                                                                                    m_maxSizeBytes(maxSizeBytes),
+                                                                                    m_tempFilesCount(0)
+{
+    assert(!m_path.empty());
+
+    std::error_code error;
+    std::filesystem::create_directories(m_path, error);
+
+    std::vector<EntryFileInfo> entries;
+    std::vector<std::filesystem::path> tempFiles;
+    ListEntries(m_path, entries, tempFiles);
+
+    for (const auto& tempFile : tempFiles)
+        std::filesystem::remove(tempFile, error);
+
+    for (const auto& entry : entries)
+        m_stats.m_sizeBytes += entry.m_sizeBytes;
+
+    if (m_stats.m_sizeBytes > m_maxSizeBytes)
+        Evict();
+}
+
+bool DerivedDataCache::LoadModels(const DerivedDataKey& key, size_t modelIdStart, std::vector<Model>& models)
+{
+    auto file = OpenEntry(key, EntryType::Models);
+    if (!file)
+        return false;
+
+    BinaryReader reader(file->Data(), file->SizeBytes());
+    reader.Read<EntryHeader>();
+    const size_t modelsCount = static_cast<size_t>(reader.Read<uint64_t>());
+    models.reserve(models.size() + modelsCount);
+    for (size_t i = 0; i < modelsCount; ++i)
+    {
+        size_t meshIndex = 0;
+        Model model = ReadModel(reader, meshIndex);
+        model.m_id = modelIdStart + i;
+        model.m_meshId = modelIdStart + meshIndex;
+
+        models.push_back(std::move(model));
+    }
+
+    return true;
+}
+
+void DerivedDataCache::StoreModels(const DerivedDataKey& key, size_t modelIdStart, const std::vector<Model>& models)
+{
+    WriteEntry(key, EntryType::Models, [&](BinaryWriter& writer)
+    {
+        writer.Write(static_cast<uint64_t>(models.size()));
+        for (const auto& model : models)
+        {
+            assert(model.MeshId() >= modelIdStart);
+            WriteModel(writer, model, model.MeshId() - modelIdStart);
+        }
+    });
+}
+
+bool DerivedDataCache::LoadMesh(const DerivedDataKey& key, MeshData& meshData, 
+                                MeshOptimizationStats& meshOptimizationStats)
+{
+    auto file = OpenEntry(key, EntryType::Mesh);
+    if (!file)
+        return false;
+
+    BinaryReader reader(file->Data(), file->SizeBytes());
+    reader.Read<EntryHeader>();
+    meshOptimizationStats = reader.Read<MeshOptimizationStats>();
+    meshData = ReadMeshData(reader);
+
+    return true;
+}
+
+void DerivedDataCache::StoreMesh(const DerivedDataKey& key, const MeshData& meshData,
+                                 const MeshOptimizationStats& meshOptimizationStats)
+{
+    WriteEntry(key, EntryType::Mesh, [&](BinaryWriter& writer)
+    {
+        writer.Write(meshOptimizationStats);
+        WriteMeshData(writer, meshData);
+    });
+}
+
+bool DerivedDataCache::LoadTexture(const DerivedDataKey& key, TextureData& textureData)
+{
+    auto file = OpenEntry(key, EntryType::Texture);
+    if (!file)
+        return false;
+
+    BinaryReader reader(file->Data(), file->SizeBytes());
+    reader.Read<EntryHeader>();
+    textureData = ReadTextureData(reader, file);
+
+    return true;
+}
+
+void DerivedDataCache::StoreTexture(const DerivedDataKey& key, const TextureData& textureData)
+{
+    WriteEntry(key, EntryType::Texture, [&](BinaryWriter& writer)
+    {
+        WriteTextureData(writer, textureData);
+    });
+}
+
+DerivedDataCache::Stats DerivedDataCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::wstring DerivedDataCache::EntryFile(const DerivedDataKey& key) const
+{
+    std::wstringstream entryFile;
+    entryFile << std::hex << std::setfill(L'0') << std::setw(16) << key.m_sourceHash 
+              << std::setw(16) << key.m_paramsHash;
+
+    return (std::filesystem::path(m_path) / (entryFile.str() + g_entryExtension)).wstring();
+}
+
+MappedFilePtr DerivedDataCache::OpenEntry(const DerivedDataKey& key, EntryType type)
+{
+    const std::wstring entryFile = EntryFile(key);
+
+    // NOTE the write time is the last use of the entry
+    std::error_code error;
+    std::filesystem::last_write_time(entryFile, std::filesystem::file_time_type::clock::now(), error);
+
+    auto file = std::make_shared<MappedFile>(entryFile);
+    bool isValid = !error && file->IsValid() && file->SizeBytes() >= sizeof(EntryHeader);
+    if (isValid)
+    {
+        EntryHeader header;
+        memcpy(&header, file->Data(), sizeof(EntryHeader));
+        isValid =   header.m_magic == g_derivedDataMagic &&
+                    header.m_version == g_derivedDataVersion &&
+                    header.m_type == static_cast<uint32_t>(type) &&
+                    header.m_sourceHash == key.m_sourceHash &&
+                    header.m_paramsHash == key.m_paramsHash &&
+                    header.m_fileSizeBytes == file->SizeBytes();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!isValid)
+    {
+        ++m_stats.m_missesCount;
+        return nullptr;
+    }
+
+    ++m_stats.m_hitsCount;
+    m_stats.m_readSizeBytes += file->SizeBytes();
+
+    return file;
+}
+
+template<typename WriteData>
+void DerivedDataCache::WriteEntry(const DerivedDataKey& key, EntryType type, const WriteData& writeData)
+{
+    const std::wstring entryFile = EntryFile(key);
+
+    // NOTE the same entry can be written by several tasks at once
+    const std::wstring tempFile = entryFile + L"." + std::to_wstring(m_tempFilesCount++) + g_tempExtension;
+
+    EntryHeader header{};
+    header.m_magic = g_derivedDataMagic;
+    header.m_version = g_derivedDataVersion;
+    header.m_type = static_cast<uint32_t>(type);
+    header.m_sourceHash = key.m_sourceHash;
+    header.m_paramsHash = key.m_paramsHash;
+    {
+        BinaryWriter writer(tempFile);
+        if (writer.IsValid())
+        {
+            // NOTE written again at the end with the file size
+            writer.Write(header);
+            writeData(writer);
+
+            header.m_fileSizeBytes = writer.Offset();
+            writer.Seek(0);
+            writer.Write(header);
+        }
+
+        if (!writer.IsValid())
+            header.m_fileSizeBytes = 0;
+    }
+
+    std::error_code error;
+    const auto replacedSizeBytes = std::filesystem::file_size(entryFile, error);
+    const size_t replacedEntrySizeBytes = error ? 0 : static_cast<size_t>(replacedSizeBytes);
+
+    if (header.m_fileSizeBytes)
+        std::filesystem::rename(tempFile, entryFile, error);
+    if (!header.m_fileSizeBytes || error)
+    {
+        std::filesystem::remove(tempFile, error);
+        return;
+    }
+
+    // NOTE same clock as the loads, the file system one can be coarser so a new entry
+    // would look older than the ones loaded just before
+    std::filesystem::last_write_time(entryFile, std::filesystem::file_time_type::clock::now(), error);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.m_writesCount;
+    m_stats.m_writtenSizeBytes += static_cast<size_t>(header.m_fileSizeBytes);
+    m_stats.m_sizeBytes += static_cast<size_t>(header.m_fileSizeBytes) - replacedEntrySizeBytes;
+
+    if (m_stats.m_sizeBytes > m_maxSizeBytes)
+        Evict();
+}
+
+void DerivedDataCache::Evict()
+{
+    std::vector<EntryFileInfo> entries;
+    std::vector<std::filesystem::path> tempFiles;
+    ListEntries(m_path, entries, tempFiles);
+
+    std::sort(entries.begin(), entries.end(), [](const EntryFileInfo& a, const EntryFileInfo& b)
+    {
+        return a.m_writeTime < b.m_writeTime;
+    });
+
+    m_stats.m_sizeBytes = 0;
+    for (const auto& entry : entries)
+        m_stats.m_sizeBytes += entry.m_sizeBytes;
+
+    // NOTE the entries mapped by loaded textures cant be removed
+    for (auto entry = entries.begin(); entry != entries.end() && m_stats.m_sizeBytes > m_maxSizeBytes; ++entry)
+    {
+        std::error_code error;
+        if (std::filesystem::remove(entry->m_path, error))
+        {
+            m_stats.m_sizeBytes -= entry->m_sizeBytes;
+            ++m_stats.m_evictionsCount;
+        }
+    }
+}
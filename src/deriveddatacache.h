@@ -0,0 +1,113 @@
+#pragma once
+
+// project includes
+#include "scene.h"
+#include "meshoptimizer.h"
+
+// c++ includes
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+namespace D3D12Basics
+{
+    // Hash of the source file contents and hash of the parameters used to process it
+    // (loader version, vertex format, settings...)
+    struct DerivedDataKey
+    {
+        uint64_t m_sourceHash = 0;
+        uint64_t m_paramsHash = 0;
+    };
+
+    // NOTE the parameters are hashed as bytes so they cant have padding
+    template<typename Params>
+    DerivedDataKey CreateDerivedDataKey(uint64_t sourceHash, const Params& params)
+    {
+        static_assert(std::has_unique_object_representations_v<Params>, "Params are hashed as bytes");
+        return DerivedDataKey{ sourceHash, HashBytes(&params, sizeof(Params)) };
+    }
+
+    // Processed meshes and textures and the models of the scene files stored on disk, a
+    // file per entry named after its key, so the work is not redone between runs.
+    // NOTE the entries are written to a temporary file and renamed afterwards so a partially
+    // written entry is never loaded
+    // NOTE the least recently used entries (file write time, updated on load) are removed
+    // when the size goes over the maximum. Entries in use are not removed.
+    // NOTE safe to use from several tasks at once
+    class DerivedDataCache
+    {
+    public:
+        // NOTE requests = hits + misses
+        struct Stats
+        {
+            size_t  m_hitsCount             = 0;
+            size_t  m_missesCount           = 0;
+            size_t  m_writesCount           = 0;
+            size_t  m_evictionsCount        = 0;
+            size_t  m_readSizeBytes         = 0;
+            size_t  m_writtenSizeBytes      = 0;
+            size_t  m_sizeBytes             = 0;
+
+            float HitRate() const
+            {
+                const size_t requestsCount = m_hitsCount + m_missesCount;
+                return requestsCount ? m_hitsCount / static_cast<float>(requestsCount) : 0.0f;
+            }
+        };
+
+        DerivedDataCache(const std::wstring& path, size_t maxSizeBytes);
+
+        DerivedDataCache(const DerivedDataCache&) = delete;
+        DerivedDataCache& operator=(const DerivedDataCache&) = delete;
+
+        // Appends the models to models with ids from modelIdStart. Their mesh ids are
+        // modelIdStart plus the index of the mesh in the scene file, as SceneLoader does.
+        bool LoadModels(const DerivedDataKey& key, size_t modelIdStart, std::vector<Model>& models);
+
+        // NOTE the models mesh ids start at modelIdStart
+        void StoreModels(const DerivedDataKey& key, size_t modelIdStart, const std::vector<Model>& models);
+
+        bool LoadMesh(const DerivedDataKey& key, MeshData& meshData, MeshOptimizationStats& meshOptimizationStats);
+
+        void StoreMesh(const DerivedDataKey& key, const MeshData& meshData,
+                       const MeshOptimizationStats& meshOptimizationStats);
+
+        // NOTE the texture data points into the mapped entry file
+        bool LoadTexture(const DerivedDataKey& key, TextureData& textureData);
+
+        void StoreTexture(const DerivedDataKey& key, const TextureData& textureData);
+
+        Stats GetStats() const;
+
+    private:
+        enum class EntryType : uint32_t
+        {
+            Mesh,
+            Texture,
+            Models
+        };
+
+        const std::wstring      m_path;
+        const size_t            m_maxSizeBytes;
+
+        std::atomic<uint32_t>   m_tempFilesCount;
+
+        // NOTE guards the stats and the eviction
+        mutable std::mutex      m_mutex;
+        Stats                   m_stats;
+
+        std::wstring EntryFile(const DerivedDataKey& key) const;
+
+        // Returns the mapped entry file if the entry is valid. NOTE the data starts after
+        // the header and the blobs are aligned from the beginning of the file
+        MappedFilePtr OpenEntry(const DerivedDataKey& key, EntryType type);
+
+        template<typename WriteData>
+        void WriteEntry(const DerivedDataKey& key, EntryType type, const WriteData& writeData);
+
+        // Removes the least recently used entries until the size is below the maximum
+        void Evict();
+    };
+}
@@ -0,0 +1,246 @@
+#include "frustumculling.h"
+
+// c++ includes
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// simd includes
+#include <xmmintrin.h>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    Float4 ClipPlane(const Matrix44& worldToClip, size_t column, float sign)
+    {
+        return Float4(  worldToClip.m[0][3] + sign * worldToClip.m[0][column],
+                        worldToClip.m[1][3] + sign * worldToClip.m[1][column],
+                        worldToClip.m[2][3] + sign * worldToClip.m[2][column],
+                        worldToClip.m[3][3] + sign * worldToClip.m[3][column]);
+    }
+
+    bool IsAabbBehindPlane(const Float4& plane, float centerX, float centerY, float centerZ,
+                           float extentsX, float extentsY, float extentsZ)
+    {
+        const float distance = plane.x * centerX + plane.y * centerY + plane.z * centerZ + plane.w;
+        const float radius = std::fabs(plane.x) * extentsX + std::fabs(plane.y) * extentsY + std::fabs(plane.z) * extentsZ;
+        return distance + radius < 0.0f;
+    }
+
+    // NOTE contiguous indices are loaded and stored with one instruction
+    bool AreContiguous(const size_t* indices)
+    {
+        return indices[1] == indices[0] + 1 && indices[2] == indices[0] + 2 && indices[3] == indices[0] + 3;
+    }
+
+    __m128 Load4(const std::vector<float>& values, const size_t* indices, bool contiguous)
+    {
+        if (contiguous)
+            return _mm_loadu_ps(&values[indices[0]]);
+
+        return _mm_setr_ps(values[indices[0]], values[indices[1]], values[indices[2]], values[indices[3]]);
+    }
+
+    void Store4(__m128 value, std::vector<float>& values, const size_t* indices, bool contiguous)
+    {
+        if (contiguous)
+        {
+            _mm_storeu_ps(&values[indices[0]], value);
+            return;
+        }
+
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, value);
+        for (size_t i = 0; i < 4; ++i)
+            values[indices[i]] = lanes[i];
+    }
+}
+
+Aabb D3D12Basics::CalculateAabb(const MeshData& meshData)
+{
+    if (!meshData.VerticesCount())
+        return Aabb{ Float3(0.0f, 0.0f, 0.0f), Float3(0.0f, 0.0f, 0.0f) };
+
+    assert(meshData.VertexSizeBytes() % sizeof(float) == 0);
+    const size_t vertexStride = meshData.VertexSizeBytes() / sizeof(float);
+    const float* position = meshData.Vertices().data();
+
+    Float3 min( std::numeric_limits<float>::max());
+    Float3 max(-std::numeric_limits<float>::max());
+    for (size_t i = 0; i < meshData.VerticesCount(); ++i, position += vertexStride)
+    {
+        min.x = std::min(min.x, position[0]);
+        min.y = std::min(min.y, position[1]);
+        min.z = std::min(min.z, position[2]);
+        max.x = std::max(max.x, position[0]);
+        max.y = std::max(max.y, position[1]);
+        max.z = std::max(max.z, position[2]);
+    }
+
+    return Aabb{ (min + max) * 0.5f, (max - min) * 0.5f };
+}
+
+// NOTE Arvo's method: the extents of the transformed box are the box extents
+// transformed by the absolute value of the transform
+Aabb D3D12Basics::TransformAabb(const Aabb& aabb, const Matrix44& transform)
+{
+    Aabb result;
+    result.m_center = Float3::Transform(aabb.m_center, transform);
+    result.m_extents.x = std::fabs(transform._11) * aabb.m_extents.x + std::fabs(transform._21) * aabb.m_extents.y +
+                         std::fabs(transform._31) * aabb.m_extents.z;
+    result.m_extents.y = std::fabs(transform._12) * aabb.m_extents.x + std::fabs(transform._22) * aabb.m_extents.y +
+                         std::fabs(transform._32) * aabb.m_extents.z;
+    result.m_extents.z = std::fabs(transform._13) * aabb.m_extents.x + std::fabs(transform._23) * aabb.m_extents.y +
+                         std::fabs(transform._33) * aabb.m_extents.z;
+    return result;
+}
+
+// NOTE Gribb and Hartmann planes extraction. Clip space is -w <= x, y <= w and
+// 0 <= z <= w.
+Frustum D3D12Basics::CreateFrustum(const Matrix44& worldToClip)
+{
+    Frustum frustum;
+    frustum.m_planes[0] = ClipPlane(worldToClip, 0, 1.0f);
+    frustum.m_planes[1] = ClipPlane(worldToClip, 0, -1.0f);
+    frustum.m_planes[2] = ClipPlane(worldToClip, 1, 1.0f);
+    frustum.m_planes[3] = ClipPlane(worldToClip, 1, -1.0f);
+    frustum.m_planes[4] = Float4(worldToClip.m[0][2], worldToClip.m[1][2], worldToClip.m[2][2], worldToClip.m[3][2]);
+    frustum.m_planes[5] = ClipPlane(worldToClip, 2, -1.0f);
+    return frustum;
+}
+
+bool D3D12Basics::IsAabbOutside(const Frustum& frustum, const Aabb& aabb)
+{
+    for (size_t i = 0; i < 6; ++i)
+    {
+        if (IsAabbBehindPlane(frustum.m_planes[i], aabb.m_center.x, aabb.m_center.y, aabb.m_center.z,
+                              aabb.m_extents.x, aabb.m_extents.y, aabb.m_extents.z))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AabbsSoA::Resize(size_t count)
+{
+    m_centerX.resize(count);
+    m_centerY.resize(count);
+    m_centerZ.resize(count);
+    m_extentsX.resize(count);
+    m_extentsY.resize(count);
+    m_extentsZ.resize(count);
+}
+
+// NOTE TransformAabb 4 boxes at a time. Once transposed, row i of the 4 transforms
+// gives element [i][j] of the 4 of them in column j.
+void AabbsSoA::SetTransformed(const AabbsSoA& aabbs, const Matrix44* transforms, const size_t* indices,
+                              size_t count)
+{
+    assert(aabbs.Size() == Size());
+
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const size_t* indices4 = indices + i;
+        const Matrix44& transform0 = transforms[indices4[0]];
+        const Matrix44& transform1 = transforms[indices4[1]];
+        const Matrix44& transform2 = transforms[indices4[2]];
+        const Matrix44& transform3 = transforms[indices4[3]];
+
+        __m128 elements[4][4];
+        for (size_t row = 0; row < 4; ++row)
+        {
+            elements[row][0] = _mm_loadu_ps(transform0.m[row]);
+            elements[row][1] = _mm_loadu_ps(transform1.m[row]);
+            elements[row][2] = _mm_loadu_ps(transform2.m[row]);
+            elements[row][3] = _mm_loadu_ps(transform3.m[row]);
+            _MM_TRANSPOSE4_PS(elements[row][0], elements[row][1], elements[row][2], elements[row][3]);
+        }
+
+        const bool contiguous = AreContiguous(indices4);
+        const __m128 centerX = Load4(aabbs.m_centerX, indices4, contiguous);
+        const __m128 centerY = Load4(aabbs.m_centerY, indices4, contiguous);
+        const __m128 centerZ = Load4(aabbs.m_centerZ, indices4, contiguous);
+        const __m128 extentsX = Load4(aabbs.m_extentsX, indices4, contiguous);
+        const __m128 extentsY = Load4(aabbs.m_extentsY, indices4, contiguous);
+        const __m128 extentsZ = Load4(aabbs.m_extentsZ, indices4, contiguous);
+
+        std::vector<float>* results[2][3] = { { &m_centerX, &m_centerY, &m_centerZ },
+                                              { &m_extentsX, &m_extentsY, &m_extentsZ } };
+        for (size_t column = 0; column < 3; ++column)
+        {
+            __m128 center = _mm_add_ps(_mm_mul_ps(centerX, elements[0][column]), elements[3][column]);
+            center = _mm_add_ps(center, _mm_mul_ps(centerY, elements[1][column]));
+            center = _mm_add_ps(center, _mm_mul_ps(centerZ, elements[2][column]));
+
+            __m128 extents = _mm_mul_ps(extentsX, _mm_andnot_ps(signMask, elements[0][column]));
+            extents = _mm_add_ps(extents, _mm_mul_ps(extentsY, _mm_andnot_ps(signMask, elements[1][column])));
+            extents = _mm_add_ps(extents, _mm_mul_ps(extentsZ, _mm_andnot_ps(signMask, elements[2][column])));
+
+            Store4(center, *results[0][column], indices4, contiguous);
+            Store4(extents, *results[1][column], indices4, contiguous);
+        }
+    }
+
+    for (; i < count; ++i)
+        Set(indices[i], TransformAabb(aabbs.Get(indices[i]), transforms[indices[i]]));
+}
+
+void AabbsSoA::Cull(const Frustum& frustum, size_t start, size_t end, uint8_t* visibility) const
+{
+    assert(start <= end && end <= Size());
+
+    __m128 planesX[6], planesY[6], planesZ[6], planesW[6];
+    __m128 planesAbsX[6], planesAbsY[6], planesAbsZ[6];
+    for (size_t i = 0; i < 6; ++i)
+    {
+        const auto& plane = frustum.m_planes[i];
+        planesX[i] = _mm_set1_ps(plane.x);
+        planesY[i] = _mm_set1_ps(plane.y);
+        planesZ[i] = _mm_set1_ps(plane.z);
+        planesW[i] = _mm_set1_ps(plane.w);
+        planesAbsX[i] = _mm_set1_ps(std::fabs(plane.x));
+        planesAbsY[i] = _mm_set1_ps(std::fabs(plane.y));
+        planesAbsZ[i] = _mm_set1_ps(std::fabs(plane.z));
+    }
+
+    // NOTE a box is outside when it is fully behind any plane:
+    // dot(n, c) + w + dot(|n|, e) < 0
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = start;
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 centerX = _mm_loadu_ps(&m_centerX[i]);
+        const __m128 centerY = _mm_loadu_ps(&m_centerY[i]);
+        const __m128 centerZ = _mm_loadu_ps(&m_centerZ[i]);
+        const __m128 extentsX = _mm_loadu_ps(&m_extentsX[i]);
+        const __m128 extentsY = _mm_loadu_ps(&m_extentsY[i]);
+        const __m128 extentsZ = _mm_loadu_ps(&m_extentsZ[i]);
+
+        __m128 outside = zero;
+        for (size_t j = 0; j < 6; ++j)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(planesX[j], centerX), planesW[j]);
+            distance = _mm_add_ps(distance, _mm_mul_ps(planesY[j], centerY));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planesZ[j], centerZ));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planesAbsX[j], extentsX));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planesAbsY[j], extentsY));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planesAbsZ[j], extentsZ));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+        }
+
+        const int outsideMask = _mm_movemask_ps(outside);
+        visibility[i + 0] = (outsideMask & 1) ? 0 : 1;
+        visibility[i + 1] = (outsideMask & 2) ? 0 : 1;
+        visibility[i + 2] = (outsideMask & 4) ? 0 : 1;
+        visibility[i + 3] = (outsideMask & 8) ? 0 : 1;
+    }
+
+    for (; i < end; ++i)
+        visibility[i] = IsAabbOutside(frustum, Get(i)) ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// project includes
+#include "utils.h"
+
+// c++ includes
+#include <vector>
+
+namespace D3D12Basics
+{
+    // Axis aligned bounding box
+    struct Aabb
+    {
+        Float3 m_center;
+        Float3 m_extents;
+    };
+
+    // NOTE assumes the position is the first element of the vertex
+    Aabb CalculateAabb(const MeshData& meshData);
+
+    // Bounds of the transformed box (row vectors, translation in the last row)
+    Aabb TransformAabb(const Aabb& aabb, const Matrix44& transform);
+
+    // Planes (xyz normal, w distance) pointing inwards
+    // NOTE the planes are not normalized, the culling only needs the sign
+    struct Frustum
+    {
+        Float4 m_planes[6];
+    };
+
+    // Planes of the clip volume of a world to clip transform: a camera frustum or
+    // the ortho box of a directional light.
+    Frustum CreateFrustum(const Matrix44& worldToClip);
+
+    // True when the box is fully behind any of the planes
+    // NOTE one box at a time, AabbsSoA::Cull is the fast path
+    bool IsAabbOutside(const Frustum& frustum, const Aabb& aabb);
+
+    // Boxes as structure of arrays so the culling tests 4 boxes at a time
+    class AabbsSoA
+    {
+    public:
+        void Resize(size_t count);
+
+        size_t Size() const { return m_centerX.size(); }
+
+        void Set(size_t index, const Aabb& aabb)
+        {
+            m_centerX[index] = aabb.m_center.x;
+            m_centerY[index] = aabb.m_center.y;
+            m_centerZ[index] = aabb.m_center.z;
+            m_extentsX[index] = aabb.m_extents.x;
+            m_extentsY[index] = aabb.m_extents.y;
+            m_extentsZ[index] = aabb.m_extents.z;
+        }
+
+        Aabb Get(size_t index) const
+        {
+            return Aabb{ Float3(m_centerX[index], m_centerY[index], m_centerZ[index]),
+                         Float3(m_extentsX[index], m_extentsY[index], m_extentsZ[index]) };
+        }
+
+        // Sets the boxes of the count indices to the boxes of aabbs at the same indices
+        // transformed by transforms[index] (row vectors, translation in the last row)
+        // NOTE 4 boxes per pass, the rows of their 4 transforms are transposed so each
+        // register holds an element of the 4 transforms
+        void SetTransformed(const AabbsSoA& aabbs, const Matrix44* transforms, const size_t* indices,
+                            size_t count);
+
+        // Writes 1 to visibility for the boxes in [start, end) intersecting the frustum
+        // and 0 for the rest
+        void Cull(const Frustum& frustum, size_t start, size_t end, uint8_t* visibility) const;
+
+    private:
+        std::vector<float> m_centerX;
+        std::vector<float> m_centerY;
+        std::vector<float> m_centerZ;
+        std::vector<float> m_extentsX;
+        std::vector<float> m_extentsY;
+        std::vector<float> m_extentsZ;
+    };
+}
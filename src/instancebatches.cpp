@@ -0,0 +1,114 @@
+#include "instancebatches.h"
+
+// c++ includes
+#include <cassert>
+#include <unordered_map>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    struct InstanceKeyHash
+    {
+        size_t operator()(const InstanceKey& key) const
+        {
+            return std::hash<size_t>()(key.m_meshId) ^ (std::hash<size_t>()(key.m_stateId) * 0x9e3779b97f4a7c15ull);
+        }
+    };
+}
+
+InstanceKeysBuilder::InstanceKeysBuilder(size_t blockSize) : m_blockSize(blockSize)
+{
+    assert(m_blockSize > 0);
+}
+
+void InstanceKeysBuilder::Reserve(size_t itemsCount)
+{
+    m_forwardKeys.reserve(itemsCount);
+    m_shadowKeys.reserve(itemsCount);
+}
+
+void InstanceKeysBuilder::Add(size_t meshId, size_t pipelineStateId, bool shadowReceiver,
+                              const std::vector<size_t>& viewsIds)
+{
+    const size_t block = m_forwardKeys.size() / m_blockSize;
+
+    m_forwardState.clear();
+    m_forwardState.push_back(block);
+    m_forwardState.push_back(pipelineStateId);
+    m_forwardState.push_back(shadowReceiver ? 1 : 0);
+    m_forwardState.insert(m_forwardState.end(), viewsIds.begin(), viewsIds.end());
+
+    const size_t forwardStateId = m_forwardStates.emplace(m_forwardState, m_forwardStates.size()).first->second;
+    m_forwardKeys.push_back({ meshId, forwardStateId });
+    m_shadowKeys.push_back({ meshId, block });
+}
+
+void D3D12Basics::BuildInstanceBatches(const std::vector<InstanceKey>& keys, size_t maxInstancesCount,
+                                       std::vector<size_t>& instances, std::vector<InstanceBatch>& batches)
+{
+    instances.resize(keys.size());
+    batches.clear();
+
+    // Batch of each item and items count of each batch
+    std::vector<size_t> itemsBatch(keys.size());
+    {
+        std::unordered_map<InstanceKey, size_t, InstanceKeyHash> openBatches;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            auto openBatch = openBatches.find(keys[i]);
+            if (openBatch == openBatches.end() || 
+                (maxInstancesCount && batches[openBatch->second].m_instancesCount == maxInstancesCount))
+            {
+                openBatches[keys[i]] = batches.size();
+                batches.push_back(InstanceBatch{ keys[i], 0, 0 });
+                openBatch = openBatches.find(keys[i]);
+            }
+
+            itemsBatch[i] = openBatch->second;
+            ++batches[openBatch->second].m_instancesCount;
+        }
+    }
+
+    // NOTE counting sort by batch, stable so the items keep their order
+    size_t firstInstance = 0;
+    for (auto& batch : batches)
+    {
+        batch.m_firstInstance = firstInstance;
+        firstInstance += batch.m_instancesCount;
+    }
+    assert(firstInstance == keys.size());
+
+    std::vector<size_t> batchesInstancesCount(batches.size(), 0);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const size_t batchIndex = itemsBatch[i];
+        instances[batches[batchIndex].m_firstInstance + batchesInstancesCount[batchIndex]++] = i;
+    }
+}
+
+size_t D3D12Basics::FilterInstanceBatches(const std::vector<size_t>& instances, const std::vector<InstanceBatch>& batches,
+                                          const std::vector<uint8_t>& visibility, VisibleInstances& visibleInstances)
+{
+    visibleInstances.m_instances.resize(instances.size());
+    visibleInstances.m_instancesCount.resize(batches.size());
+
+    size_t visibleInstancesCount = 0;
+    for (size_t i = 0; i < batches.size(); ++i)
+    {
+        const auto& batch = batches[i];
+        size_t batchVisibleCount = 0;
+        for (size_t j = batch.m_firstInstance; j < batch.m_firstInstance + batch.m_instancesCount; ++j)
+        {
+            const size_t instance = instances[j];
+            assert(instance < visibility.size());
+            if (visibility[instance])
+                visibleInstances.m_instances[batch.m_firstInstance + batchVisibleCount++] = instance;
+        }
+
+        visibleInstances.m_instancesCount[i] = batchVisibleCount;
+        visibleInstancesCount += batchVisibleCount;
+    }
+
+    return visibleInstancesCount;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+// c++ includes
+#include <map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace D3D12Basics
+{
+    // What the draws of a batch share: the mesh and the state (pipeline state and
+    // bindings other than the per instance data)
+    struct InstanceKey
+    {
+        size_t m_meshId;
+        size_t m_stateId;
+
+        bool operator==(const InstanceKey& other) const
+        {
+            return m_meshId == other.m_meshId && m_stateId == other.m_stateId;
+        }
+    };
+
+    // Keys of the forward and shadow passes items, in the order they are added.
+    // The forward pass batches the items with the same mesh, pipeline state, shadow
+    // receiving and views. The shadow pass only needs the same mesh. Both split at the
+    // blocks boundaries as the block of per item data is bound per draw.
+    class InstanceKeysBuilder
+    {
+    public:
+        explicit InstanceKeysBuilder(size_t blockSize);
+
+        void Reserve(size_t itemsCount);
+
+        // NOTE viewsIds are the views bound by the forward pass draw
+        void Add(size_t meshId, size_t pipelineStateId, bool shadowReceiver, const std::vector<size_t>& viewsIds);
+
+        const std::vector<InstanceKey>& ForwardKeys() const { return m_forwardKeys; }
+        const std::vector<InstanceKey>& ShadowKeys() const { return m_shadowKeys; }
+
+    private:
+        const size_t m_blockSize;
+
+        // Id of each distinct forward state
+        std::map<std::vector<size_t>, size_t>   m_forwardStates;
+        std::vector<size_t>                     m_forwardState;
+
+        std::vector<InstanceKey> m_forwardKeys;
+        std::vector<InstanceKey> m_shadowKeys;
+    };
+
+    // Instances [m_firstInstance, m_firstInstance + m_instancesCount) drawn with one
+    // instanced draw
+    struct InstanceBatch
+    {
+        InstanceKey m_key;
+        size_t      m_firstInstance;
+        size_t      m_instancesCount;
+    };
+
+    // Groups the items with the same key. instances gets the items indices grouped by
+    // batch, the batches in the order their first item appears and the items of a
+    // batch in their original order.
+    // NOTE maxInstancesCount splits the bigger batches, 0 means no limit and 1 a batch
+    // per item
+    void BuildInstanceBatches(const std::vector<InstanceKey>& keys, size_t maxInstancesCount,
+                              std::vector<size_t>& instances, std::vector<InstanceBatch>& batches);
+
+    // Instances of each batch that are visible, packed at the start of the batch range
+    // so the batches keep their instances ranges
+    struct VisibleInstances
+    {
+        std::vector<size_t> m_instances;
+        std::vector<size_t> m_instancesCount;
+    };
+
+    // Keeps the instances with a non zero visibility, in their order. Returns the
+    // visible instances count.
+    size_t FilterInstanceBatches(const std::vector<size_t>& instances, const std::vector<InstanceBatch>& batches,
+                                 const std::vector<uint8_t>& visibility, VisibleInstances& visibleInstances);
+}
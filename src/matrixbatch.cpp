@@ -0,0 +1,37 @@
+#include "matrixbatch.h"
+
+// c++ includes
+#include <cassert>
+
+// simd includes
+#include <xmmintrin.h>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    void StoreTransposed(__m128 row0, __m128 row1, __m128 row2, __m128 row3, float* result)
+    {
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+        _mm_storeu_ps(result, row0);
+        _mm_storeu_ps(result + 4, row1);
+        _mm_storeu_ps(result + 8, row2);
+        _mm_storeu_ps(result + 12, row3);
+    }
+}
+
+void D3D12Basics::TransposeMatrices(const Matrix44* matrices, const size_t* indices, size_t count,
+                                    void* results, size_t resultsStrideBytes)
+{
+    assert(resultsStrideBytes >= sizeof(Matrix44));
+
+    uint8_t* results8 = static_cast<uint8_t*>(results);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Matrix44& matrix = matrices[indices[i]];
+        uint8_t* result = results8 + indices[i] * resultsStrideBytes;
+        StoreTransposed(_mm_loadu_ps(matrix.m[0]), _mm_loadu_ps(matrix.m[1]),
+                        _mm_loadu_ps(matrix.m[2]), _mm_loadu_ps(matrix.m[3]),
+                        reinterpret_cast<float*>(result));
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+// project includes
+#include "utils.h"
+
+namespace D3D12Basics
+{
+    // results[index] = matrices[index]^T for the count indices, so only the matrices
+    // that changed are updated.
+    // NOTE the results are resultsStrideBytes apart so they can be a member of an array
+    // of structs
+    void TransposeMatrices(const Matrix44* matrices, const size_t* indices, size_t count,
+                           void* results, size_t resultsStrideBytes);
+}
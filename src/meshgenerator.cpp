@@ -2,77 +2,55 @@
 
 using namespace D3D12Basics;
 
-MeshData D3D12Basics::CreatePlane(const VertexDesc& vertexDesc, const Float4& uvScaleOffset)
+namespace
 {
-    std::vector<uint16_t> indices = { 0, 1, 2, 0, 2, 3 };
+    Float2 ScaleOffsetUV(const Float2& uv, const Float4& uvScaleOffset)
+    {
+        return Float2(uv.x * uvScaleOffset.x + uvScaleOffset.z, uv.y * uvScaleOffset.y + uvScaleOffset.w);
+    }
+}
+
+template<typename Format>
+MeshData D3D12Basics::CreatePlane(const Float4& uvScaleOffset)
+{
+    std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
     const size_t verticesCount = 4;
 
-    VertexStreams streams;
-    const size_t positionElementsCount = 3;
-    streams.AddStream(positionElementsCount,
-    {
-        // Positions
-        -0.5f, -0.5f, 0.0f,
-        -0.5f, 0.5f, 0.0f,
-        0.5f, 0.5f, 0.0f,
-        0.5f, -0.5f, 0.0f
-    });
-
-    if (vertexDesc.m_uv0)
+    const Float3 positions[verticesCount] =
     {
-        const size_t uvElementsCount = 2;
-        streams.AddStream(uvElementsCount, 
-        {
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w
-        });
-    }
+        { -0.5f, -0.5f, 0.0f },
+        { -0.5f, 0.5f, 0.0f },
+        { 0.5f, 0.5f, 0.0f },
+        { 0.5f, -0.5f, 0.0f }
+    };
 
-    if (vertexDesc.m_normal)
+    const Float2 uvs[verticesCount] =
     {
-        const size_t normalsElementsCount = 3;
-        streams.AddStream(normalsElementsCount,
-        {
-            0.0f, 0.0f, -1.0f,
-            0.0f, 0.0f, -1.0f,
-            0.0f, 0.0f, -1.0f,
-            0.0f, 0.0f, -1.0f
-        });
-    }
+        { 0.0f, 1.0f },
+        { 0.0f, 0.0f },
+        { 1.0f, 0.0f },
+        { 1.0f, 1.0f }
+    };
 
-    if (vertexDesc.m_tangent_bitangent)
+    auto vertices = Format::CreateVertices(verticesCount);
+    for (size_t i = 0; i < verticesCount; ++i)
     {
-        const size_t tangentsElementsCount = 3;
-        streams.AddStream(tangentsElementsCount,
-        {
-            1.0f, 0.0f, 0.0f,
-            1.0f, 0.0f, 0.0f,
-            1.0f, 0.0f, 0.0f,
-            1.0f, 0.0f, 0.0f
-        });
-        const size_t bitangentsElementsCount = 3;
-        streams.AddStream(bitangentsElementsCount,
-        {
-            0.0f, 0.0f, 1.0f,
-            0.0f, 0.0f, 1.0f,
-            0.0f, 0.0f, 1.0f,
-            0.0f, 0.0f, 1.0f
-        });
+        Format::template Write<PositionAttribute>(vertices, i, positions[i]);
+        Format::template Write<UVAttribute>(vertices, i, ScaleOffsetUV(uvs[i], uvScaleOffset));
+        Format::template Write<NormalAttribute>(vertices, i, Float3(0.0f, 0.0f, -1.0f));
+        Format::template Write<TangentAttribute>(vertices, i, Float3(1.0f, 0.0f, 0.0f));
+        Format::template Write<BitangentAttribute>(vertices, i, Float3(0.0f, 0.0f, 1.0f));
     }
-    const auto vertexElementsCount = streams.VertexElementsCount();
 
-    return MeshData{streams.GetStreams(), std::move(indices), verticesCount, vertexElementsCount * sizeof(float), vertexElementsCount};
+    return MeshData{ std::move(vertices), std::move(indices), verticesCount, Format::m_strideBytes };
 }
 
 // NOTE: Check https://github.com/caosdoar/spheres
 // Review of ways of creating a mesh sphere by @caosdoar
 // TODO fix uv issues
 // TODO optimization proposed by @caosdoar: cache the angles to avoid unnecessary calculations
-// TODO templatize this function depending on its configuration
-MeshData D3D12Basics::CreateSphere(const VertexDesc& vertexDesc, const Float4& uvScaleOffset, 
-                                   unsigned int parallelsCount, unsigned int meridiansCount)
+template<typename Format>
+MeshData D3D12Basics::CreateSphere(const Float4& uvScaleOffset, unsigned int parallelsCount, unsigned int meridiansCount)
 {
     // TODO tangents generation not supported yet
     assert(parallelsCount > 1 && meridiansCount > 3);
@@ -86,30 +64,8 @@ MeshData D3D12Basics::CreateSphere(const VertexDesc& vertexDesc, const Float4& u
     const unsigned int indicesPerTri = 3;
     const unsigned int indicesCount = indicesPerTri * meridiansCount * (2 * (parallelsCount - 1) + polesCount);
 
-    const size_t positionElementsCount = 3;
-    std::vector<float> positions((parallelsCount * meridiansCount + polesCount) * positionElementsCount);
-    std::vector<float> uvs;
-    const size_t uvElementsCount = 2;
-    if (vertexDesc.m_uv0)
-    {
-        uvs.resize((parallelsCount * meridiansCount + polesCount) * uvElementsCount);
-    }
-    const size_t normalsElementsCount = 3;
-    std::vector<float> normals;
-    if (vertexDesc.m_normal)
-    {
-        normals.resize(positions.size());
-    }
-    const size_t tangentElementsCount = 3;
-    const size_t bitangentElementsCount = 3;
-    std::vector<float> tangents;
-    std::vector<float> bitangents;
-    if (vertexDesc.m_tangent_bitangent)
-    {
-        tangents.resize((parallelsCount * meridiansCount + polesCount) * tangentElementsCount);
-        bitangents.resize((parallelsCount * meridiansCount + polesCount) * bitangentElementsCount);
-    }
-    std::vector<uint16_t> indices(indicesCount);
+    auto vertices = Format::CreateVertices(verticesCount);
+    std::vector<uint32_t> indices(indicesCount);
 
     // parallels = latitude = altitude = phi 
     // meridians = longitude = azimuth = theta
@@ -133,37 +89,37 @@ MeshData D3D12Basics::CreateSphere(const VertexDesc& vertexDesc, const Float4& u
         {
             const float longitude = i * longitudeDiff;
             auto position = SphericalToCartersian(longitude, latitude) * Float3(0.5f, 0.5f, 0.5f);
-            memcpy(&positions[currentVertexIndex * positionElementsCount], 
-                   &position, sizeof(Float3));
+            Format::template Write<PositionAttribute>(vertices, currentVertexIndex, position);
 
             // NOTE: this mapping has horrendous distortions on the poles
-            if (vertexDesc.m_uv0)
+            if constexpr (Format::template Has<UVAttribute>())
             {
                 auto uv = i == meridiansCount - 1 ? Float2(1.0f, latitude * M_RCP_PI) :
                                                     Float2(longitude * M_RCP_2PI, latitude * M_RCP_PI);
                 uv *= uvScale;
                 uv += uvOffset;
-                memcpy(&uvs[currentVertexIndex * uvElementsCount],
-                        &uv, sizeof(Float2));
+                Format::template Write<UVAttribute>(vertices, currentVertexIndex, uv);
             }
 
-            if (vertexDesc.m_normal)
+            if constexpr (Format::template Has<NormalAttribute>())
             {
                 auto normal = position;
                 normal.Normalize();
-                memcpy(&normals[currentVertexIndex * positionElementsCount], &normal, sizeof(Float3));
+                Format::template Write<NormalAttribute>(vertices, currentVertexIndex, normal);
             }
 
-            if (vertexDesc.m_tangent_bitangent)
+            if constexpr (Format::template Has<TangentAttribute>())
             {
                 auto tangent = DDLonSphericalToCartesian(longitude, latitude) * Float3(0.5f, 0.5f, 0.5f);
                 tangent.Normalize();
-                memcpy(&tangents[currentVertexIndex * tangentElementsCount],
-                        &tangent, sizeof(Float3));
+                Format::template Write<TangentAttribute>(vertices, currentVertexIndex, tangent);
+            }
+
+            if constexpr (Format::template Has<BitangentAttribute>())
+            {
                 auto bitangent = DDLatSphericalToCartesian(longitude, latitude) * Float3(0.5f, 0.5f, 0.5f);
                 bitangent.Normalize();
-                memcpy(&bitangents[currentVertexIndex * bitangentElementsCount],
-                        &bitangent, sizeof(Float3));
+                Format::template Write<BitangentAttribute>(vertices, currentVertexIndex, bitangent);
             }
 
             // Build rings indices
@@ -184,37 +140,19 @@ MeshData D3D12Basics::CreateSphere(const VertexDesc& vertexDesc, const Float4& u
     }
 
     // Build poles
-    auto position = Float3(0.0f, 0.5f, 0.0f);
-    memcpy(&positions[(verticesCount - 2) * positionElementsCount], &position, sizeof(Float3));
-    position = Float3(0.0f, -0.5f, 0.0f);
-    memcpy(&positions[(verticesCount - 1) * positionElementsCount], &position, sizeof(Float3));
-    if (vertexDesc.m_uv0)
-    {
-        auto uv = Float2(0.0f, 0.0f);
-        memcpy(&uvs[(verticesCount - 2) * uvElementsCount], &uv, sizeof(Float2));
-        uv = Float2(0.0f, 1.0f);
-        uv *= uvScale;
-        uv += uvOffset;
-        memcpy(&uvs[(verticesCount - 1) * uvElementsCount], &uv, sizeof(Float2));
-    }
-    if (vertexDesc.m_normal)
-    {
-        auto normal = Float3(0.0f, 1.0f, 0.0f);
-        memcpy(&normals[(verticesCount - 2) * normalsElementsCount], &normal, sizeof(Float3));
-        normal = Float3(0.0f, -1.0f, 0.0f);
-        memcpy(&normals[(verticesCount - 1) * normalsElementsCount], &normal, sizeof(Float3));
-    }
-    if (vertexDesc.m_tangent_bitangent)
-    {
-        auto tangent = Float3(1.0f, 0.0f, 0.0f);
-        memcpy(&tangents[(verticesCount - 2) * tangentElementsCount], &tangent, sizeof(Float3));
-        tangent = Float3(-1.0f, 0.0f, 0.0f);
-        memcpy(&tangents[(verticesCount - 1) * tangentElementsCount], &tangent, sizeof(Float3));
-        auto bitangent = Float3(0.0f, 0.0f, 1.0f);
-        memcpy(&bitangents[(verticesCount - 2) * bitangentElementsCount], &bitangent, sizeof(Float3));
-        bitangent = Float3(0.0f, 0.0f, -1.0f);
-        memcpy(&bitangents[(verticesCount - 1) * bitangentElementsCount], &bitangent, sizeof(Float3));
-    }
+    const size_t northPoleIndex = verticesCount - 2;
+    const size_t southPoleIndex = verticesCount - 1;
+    Format::template Write<PositionAttribute>(vertices, northPoleIndex, Float3(0.0f, 0.5f, 0.0f));
+    Format::template Write<PositionAttribute>(vertices, southPoleIndex, Float3(0.0f, -0.5f, 0.0f));
+    Format::template Write<UVAttribute>(vertices, northPoleIndex, Float2(0.0f, 0.0f));
+    Format::template Write<UVAttribute>(vertices, southPoleIndex, Float2(0.0f, 1.0f) * uvScale + uvOffset);
+    Format::template Write<NormalAttribute>(vertices, northPoleIndex, Float3(0.0f, 1.0f, 0.0f));
+    Format::template Write<NormalAttribute>(vertices, southPoleIndex, Float3(0.0f, -1.0f, 0.0f));
+    Format::template Write<TangentAttribute>(vertices, northPoleIndex, Float3(1.0f, 0.0f, 0.0f));
+    Format::template Write<TangentAttribute>(vertices, southPoleIndex, Float3(-1.0f, 0.0f, 0.0f));
+    Format::template Write<BitangentAttribute>(vertices, northPoleIndex, Float3(0.0f, 0.0f, 1.0f));
+    Format::template Write<BitangentAttribute>(vertices, southPoleIndex, Float3(0.0f, 0.0f, -1.0f));
+
     for (uint16_t i = 0; i < meridiansCount; ++i)
     {
        indices[currentPrimitive++] = static_cast<uint16_t>(verticesCount - 2);
@@ -229,27 +167,14 @@ MeshData D3D12Basics::CreateSphere(const VertexDesc& vertexDesc, const Float4& u
         indices[currentPrimitive++] = verticesBuilt + i;
         indices[currentPrimitive++] = i == meridiansCount - 1 ? verticesBuilt : verticesBuilt + i + 1;
     }
-    
-    VertexStreams streams;
-    streams.AddStream(positionElementsCount, std::move(positions));
-    if (vertexDesc.m_uv0)
-        streams.AddStream(uvElementsCount, std::move(uvs));
-    if (vertexDesc.m_normal)
-        streams.AddStream(normalsElementsCount, std::move(normals));
-    if (vertexDesc.m_tangent_bitangent)
-    {
-        streams.AddStream(tangentElementsCount, std::move(tangents));
-        streams.AddStream(bitangentElementsCount, std::move(bitangents));
-    }
-    const auto vertexElementsCount = streams.VertexElementsCount();
 
-    return MeshData{ streams.GetStreams(), std::move(indices), verticesCount, vertexElementsCount * sizeof(float), vertexElementsCount };
+    return MeshData{ std::move(vertices), std::move(indices), verticesCount, Format::m_strideBytes };
 }
 
-MeshData D3D12Basics::CreateCube(const VertexDesc& vertexDesc, const Float4& uvScaleOffset, 
-                                    Cube_TexCoord_MappingType /*texcoordType*/)
+template<typename Format>
+MeshData D3D12Basics::CreateCube(const Float4& uvScaleOffset, Cube_TexCoord_MappingType /*texcoordType*/)
 {
-    std::vector<uint16_t> indices =
+    std::vector<uint32_t> indices =
     {
         0, 1, 2, 0, 2, 3,
         4, 5, 6, 4, 6, 7,
@@ -258,218 +183,104 @@ MeshData D3D12Basics::CreateCube(const VertexDesc& vertexDesc, const Float4& uvS
         16, 17, 18, 16, 18, 19,
         20, 21, 22, 20, 22, 23,
     };
-    const size_t verticesCount = 24;
+    const size_t facesCount = 6;
+    const size_t faceVerticesCount = 4;
+    const size_t verticesCount = facesCount * faceVerticesCount;
 
-    VertexStreams streams;
-    const size_t positionElementsCount = 3;
-    streams.AddStream(positionElementsCount,
+    const Float3 positions[verticesCount] =
     {
         // Back
-        -0.5f, -0.5f, -0.5f,
-        -0.5f, 0.5f, -0.5f,
-        0.5f, 0.5f, -0.5f,
-        0.5f, -0.5f, -0.5f,
+        { -0.5f, -0.5f, -0.5f },
+        { -0.5f, 0.5f, -0.5f },
+        { 0.5f, 0.5f, -0.5f },
+        { 0.5f, -0.5f, -0.5f },
 
         // Front
-        0.5f, -0.5f, 0.5f,
-        0.5f, 0.5f, 0.5f,
-        -0.5f, 0.5f, 0.5f,
-        -0.5f, -0.5f, 0.5f,
+        { 0.5f, -0.5f, 0.5f },
+        { 0.5f, 0.5f, 0.5f },
+        { -0.5f, 0.5f, 0.5f },
+        { -0.5f, -0.5f, 0.5f },
 
         // Left
-        -0.5f, -0.5f, 0.5f,
-        -0.5f, 0.5f, 0.5f,
-        -0.5f, 0.5f, -0.5f,
-        -0.5f, -0.5f, -0.5f,
+        { -0.5f, -0.5f, 0.5f },
+        { -0.5f, 0.5f, 0.5f },
+        { -0.5f, 0.5f, -0.5f },
+        { -0.5f, -0.5f, -0.5f },
 
         // Right
-        0.5f, -0.5f, -0.5f,
-        0.5f, 0.5f, -0.5f,
-        0.5f, 0.5f, 0.5f,
-        0.5f, -0.5f, 0.5f,
+        { 0.5f, -0.5f, -0.5f },
+        { 0.5f, 0.5f, -0.5f },
+        { 0.5f, 0.5f, 0.5f },
+        { 0.5f, -0.5f, 0.5f },
 
         //Bottom
-        0.5f, -0.5f, -0.5f,
-        0.5f, -0.5f, 0.5f,
-        -0.5f, -0.5f, 0.5f,
-        -0.5f, -0.5f, -0.5f,
+        { 0.5f, -0.5f, -0.5f },
+        { 0.5f, -0.5f, 0.5f },
+        { -0.5f, -0.5f, 0.5f },
+        { -0.5f, -0.5f, -0.5f },
 
         //Top
-        -0.5f, 0.5f, -0.5f,
-        -0.5f, 0.5f, 0.5f,
-        0.5f, 0.5f, 0.5f,
-        0.5f, 0.5f, -0.5f,
-    });
+        { -0.5f, 0.5f, -0.5f },
+        { -0.5f, 0.5f, 0.5f },
+        { 0.5f, 0.5f, 0.5f },
+        { 0.5f, 0.5f, -0.5f },
+    };
 
-    if (vertexDesc.m_uv0)
+    // NOTE same uvs for every face
+    const Float2 faceUVs[faceVerticesCount] =
     {
-        const size_t uvElementsCount = 2;
-        streams.AddStream(uvElementsCount,
-        {
-            // Back
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-
-            //Front
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-
-            //Left
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-
-            //Right
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-
-            //Bottom
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-
-            //Top 
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-            0.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 0.0f * uvScaleOffset.y + uvScaleOffset.w,
-            1.0f * uvScaleOffset.x + uvScaleOffset.z, 1.0f * uvScaleOffset.y + uvScaleOffset.w,
-        });
-    }
+        { 0.0f, 1.0f },
+        { 0.0f, 0.0f },
+        { 1.0f, 0.0f },
+        { 1.0f, 1.0f }
+    };
 
-    if (vertexDesc.m_normal)
+    // Back, front, left, right, bottom and top
+    const Float3 faceNormals[facesCount] =
     {
-        const size_t normalElementCount = 3;
-        streams.AddStream(normalElementCount,
-        {
-                // Back
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-
-                // Front
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-
-                // Left
-                -1.0f, 0.0f, 0.0f,
-                -1.0f, 0.0f, 0.0f,
-                -1.0f, 0.0f, 0.0f,
-                -1.0f, 0.0f, 0.0f,
-
-                // Right
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-
-                //Bottom
-                0.0f, -1.0f, 0.0f,
-                0.0f, -1.0f, 0.0f,
-                0.0f, -1.0f, 0.0f,
-                0.0f, -1.0f, 0.0f,
-
-                //Top
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-        });
-    }
+        { 0.0f, 0.0f, 1.0f },
+        { 0.0f, 0.0f, -1.0f },
+        { -1.0f, 0.0f, 0.0f },
+        { 1.0f, 0.0f, 0.0f },
+        { 0.0f, -1.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f }
+    };
 
-    if (vertexDesc.m_tangent_bitangent)
+    const Float3 faceTangents[facesCount] =
     {
-        const size_t tangentElementCount = 3;
-        streams.AddStream(tangentElementCount,
-        {
-                // Back
-                -1.0f, 0.0f, 0.0f,
-                -1.0f, 0.0f, 0.0f,
-                -1.0f, 0.0f, 0.0f,
-                -1.0f, 0.0f, 0.0f,
-
-                // Front
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-
-                // Left
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-
-                // Right
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-
-                //Bottom
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-
-                //Top
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-                1.0f, 0.0f, 0.0f,
-        });
-
-        const size_t bitangentElementCount = 3;
-        streams.AddStream(bitangentElementCount,
-            {
-                // Back
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-
-                // Front
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-
-                // Left
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-
-                // Right
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-                0.0f, 1.0f, 0.0f,
-
-                //Bottom
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-                0.0f, 0.0f, -1.0f,
-
-                //Top
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-                0.0f, 0.0f, 1.0f,
-            });
+        { -1.0f, 0.0f, 0.0f },
+        { 1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, -1.0f },
+        { 0.0f, 0.0f, 1.0f },
+        { 1.0f, 0.0f, 0.0f },
+        { 1.0f, 0.0f, 0.0f }
+    };
+
+    const Float3 faceBitangents[facesCount] =
+    {
+        { 0.0f, 1.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f },
+        { 0.0f, 0.0f, -1.0f },
+        { 0.0f, 0.0f, 1.0f }
+    };
+
+    auto vertices = Format::CreateVertices(verticesCount);
+    for (size_t i = 0; i < verticesCount; ++i)
+    {
+        const size_t face = i / faceVerticesCount;
+        Format::template Write<PositionAttribute>(vertices, i, positions[i]);
+        Format::template Write<UVAttribute>(vertices, i, ScaleOffsetUV(faceUVs[i % faceVerticesCount], uvScaleOffset));
+        Format::template Write<NormalAttribute>(vertices, i, faceNormals[face]);
+        Format::template Write<TangentAttribute>(vertices, i, faceTangents[face]);
+        Format::template Write<BitangentAttribute>(vertices, i, faceBitangents[face]);
     }
-    const auto vertexElementsCount = streams.VertexElementsCount();
 
-    return MeshData{ streams.GetStreams(), std::move(indices), verticesCount, vertexElementsCount * sizeof(float), vertexElementsCount };
-}
\ No newline at end of file
+    return MeshData{ std::move(vertices), std::move(indices), verticesCount, Format::m_strideBytes };
+}
+
+template MeshData D3D12Basics::CreatePlane<FullVertexFormat>(const Float4& uvScaleOffset);
+template MeshData D3D12Basics::CreateSphere<FullVertexFormat>(const Float4& uvScaleOffset, unsigned int parallelsCount,
+                                                              unsigned int meridiansCount);
+template MeshData D3D12Basics::CreateCube<FullVertexFormat>(const Float4& uvScaleOffset, Cube_TexCoord_MappingType texcoordType);
\ No newline at end of file
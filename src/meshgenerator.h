@@ -1,5 +1,6 @@
 // project includes
 #include "utils.h"
+#include "vertexformat.h"
 
 // c++ includes
 #include <vector>
@@ -14,14 +15,18 @@ namespace D3D12Basics
         Cube_TexCoord_UVW_CubeFaces
     };
 
-    // TODO move vertex composition to compile time?
-    MeshData CreatePlane(const VertexDesc& vertexDesc, const Float4& uvScaleOffset);
+    // NOTE the generators are instantiated for FullVertexFormat. The attributes
+    // missing from the format are skipped at compile time.
+    template<typename Format>
+    MeshData CreatePlane(const Float4& uvScaleOffset);
 
     // NOTE: Check https://github.com/caosdoar/spheres
     // Review of ways of creating a mesh sphere by @caosdoar
     // TODO fix uv issues
-    MeshData CreateSphere(const VertexDesc& vertexDesc, const Float4& uvScaleOffset, unsigned int parallelsCount = 2, unsigned int meridiansCount = 4);
+    template<typename Format>
+    MeshData CreateSphere(const Float4& uvScaleOffset, unsigned int parallelsCount = 2, unsigned int meridiansCount = 4);
 
-    MeshData CreateCube(const VertexDesc& vertexDesc, const Float4& uvScaleOffset,
+    template<typename Format>
+    MeshData CreateCube(const Float4& uvScaleOffset,
                         Cube_TexCoord_MappingType texcoordType = Cube_TexCoord_MappingType::Cube_TexCoord_UV_SingleFace);
 }
\ No newline at end of file
@@ -0,0 +1,350 @@
+#include "meshoptimizer.h"
+
+// c++ includes
+#include <cmath>
+#include <limits>
+#include <cassert>
+#include <numeric>
+#include <algorithm>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const size_t g_triangleIndicesCount = 3;
+
+    const size_t g_invalidTriangle = std::numeric_limits<size_t>::max();
+
+    // NOTE: https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+    const size_t    g_forsythCacheSize      = 32;
+    const float     g_cacheDecayPower       = 1.5f;
+    const float     g_lastTriangleScore     = 0.75f;
+    const float     g_valenceBoostScale     = 2.0f;
+    const float     g_valenceBoostPower     = 0.5f;
+
+    float VertexScore(int cachePosition, size_t remainingTrianglesCount)
+    {
+        // No triangles left to emit using this vertex
+        if (remainingTrianglesCount == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            // The vertices of the last triangle get a fixed score so the next triangle
+            // doesnt go back to the same edge
+            if (cachePosition < static_cast<int>(g_triangleIndicesCount))
+            {
+                score = g_lastTriangleScore;
+            }
+            else
+            {
+                const float scaler = 1.0f / (g_forsythCacheSize - g_triangleIndicesCount);
+                score = 1.0f - (cachePosition - g_triangleIndicesCount) * scaler;
+                score = std::pow(score, g_cacheDecayPower);
+            }
+        }
+
+        // Boost the vertices with few triangles left so they dont get stranded
+        score += g_valenceBoostScale * std::pow(static_cast<float>(remainingTrianglesCount), -g_valenceBoostPower);
+
+        return score;
+    }
+
+    std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t verticesCount)
+    {
+        const size_t trianglesCount = indices.size() / g_triangleIndicesCount;
+
+        // Triangles using each vertex
+        std::vector<size_t> adjacencyOffsets(verticesCount + 1, 0);
+        for (auto index : indices)
+            ++adjacencyOffsets[index + 1];
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+        std::vector<size_t> adjacency(indices.size());
+        std::vector<size_t> remainingTriangles(verticesCount, 0);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            const auto index = indices[i];
+            adjacency[adjacencyOffsets[index] + remainingTriangles[index]++] = i / g_triangleIndicesCount;
+        }
+
+        std::vector<int> cachePositions(verticesCount, -1);
+        std::vector<float> vertexScores(verticesCount);
+        for (size_t i = 0; i < verticesCount; ++i)
+            vertexScores[i] = VertexScore(-1, remainingTriangles[i]);
+
+        std::vector<float> triangleScores(trianglesCount, 0.0f);
+        std::vector<bool> isTriangleEmitted(trianglesCount, false);
+        size_t bestTriangle = 0;
+        for (size_t i = 0; i < trianglesCount; ++i)
+        {
+            for (size_t j = 0; j < g_triangleIndicesCount; ++j)
+                triangleScores[i] += vertexScores[indices[i * g_triangleIndicesCount + j]];
+
+            if (triangleScores[i] > triangleScores[bestTriangle])
+                bestTriangle = i;
+        }
+
+        std::vector<uint32_t> optimizedIndices;
+        optimizedIndices.reserve(indices.size());
+
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> newCache;
+        cache.reserve(g_forsythCacheSize + g_triangleIndicesCount);
+        newCache.reserve(g_forsythCacheSize + g_triangleIndicesCount);
+
+        size_t nextTriangle = 0;
+        while (optimizedIndices.size() < indices.size())
+        {
+            // None of the cached vertices has triangles left. Start over from the first
+            // triangle not emitted yet.
+            // NOTE not the best scored one so the whole pass stays linear
+            if (bestTriangle == g_invalidTriangle)
+            {
+                while (isTriangleEmitted[nextTriangle])
+                    ++nextTriangle;
+                bestTriangle = nextTriangle;
+            }
+
+            // Emit the triangle and put its vertices at the front of the cache
+            const uint32_t* triangle = &indices[bestTriangle * g_triangleIndicesCount];
+            isTriangleEmitted[bestTriangle] = true;
+            newCache.clear();
+            for (size_t i = 0; i < g_triangleIndicesCount; ++i)
+            {
+                const auto index = triangle[i];
+                optimizedIndices.push_back(index);
+                newCache.push_back(index);
+
+                auto begin = adjacency.begin() + adjacencyOffsets[index];
+                auto end = begin + remainingTriangles[index];
+                auto it = std::find(begin, end, bestTriangle);
+                assert(it != end);
+                std::swap(*it, *(end - 1));
+                --remainingTriangles[index];
+            }
+
+            for (auto index : cache)
+            {
+                if (index != triangle[0] && index != triangle[1] && index != triangle[2])
+                    newCache.push_back(index);
+            }
+            cache.swap(newCache);
+
+            // Update the scores of the cached and evicted vertices and their triangles
+            for (size_t i = 0; i < cache.size(); ++i)
+            {
+                const auto index = cache[i];
+                cachePositions[index] = i < g_forsythCacheSize ? static_cast<int>(i) : -1;
+
+                const float score = VertexScore(cachePositions[index], remainingTriangles[index]);
+                const float scoreDelta = score - vertexScores[index];
+                vertexScores[index] = score;
+
+                const size_t adjacencyStart = adjacencyOffsets[index];
+                for (size_t j = 0; j < remainingTriangles[index]; ++j)
+                    triangleScores[adjacency[adjacencyStart + j]] += scoreDelta;
+            }
+            if (cache.size() > g_forsythCacheSize)
+                cache.resize(g_forsythCacheSize);
+
+            // Next triangle is the best scored one using the cached vertices
+            bestTriangle = g_invalidTriangle;
+            float bestScore = -1.0f;
+            for (auto index : cache)
+            {
+                const size_t adjacencyStart = adjacencyOffsets[index];
+                for (size_t j = 0; j < remainingTriangles[index]; ++j)
+                {
+                    const size_t triangleIndex = adjacency[adjacencyStart + j];
+                    if (triangleScores[triangleIndex] > bestScore)
+                    {
+                        bestScore = triangleScores[triangleIndex];
+                        bestTriangle = triangleIndex;
+                    }
+                }
+            }
+        }
+
+        return optimizedIndices;
+    }
+
+    // Splits the triangles in clusters where the vertex cache misses all the vertices of
+    // a triangle, ie where the vertex cache optimisation had to start over. Then sorts the
+    // clusters so the ones facing away from the mesh center are drawn first. Sorting
+    // whole clusters keeps most of the vertex cache gains.
+    // NOTE: Check "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+    // by Sander, Nehab and Barczak
+    std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<float>& vertices,
+                                           size_t verticesCount, size_t vertexElementsCount)
+    {
+        const size_t trianglesCount = indices.size() / g_triangleIndicesCount;
+
+        std::vector<size_t> clusterStarts;
+        {
+            std::vector<size_t> cacheTimestamps(verticesCount, 0);
+            size_t timestamp = g_vertexCacheSimulationSize + 1;
+            for (size_t i = 0; i < trianglesCount; ++i)
+            {
+                size_t cacheMissesCount = 0;
+                for (size_t j = 0; j < g_triangleIndicesCount; ++j)
+                {
+                    const auto index = indices[i * g_triangleIndicesCount + j];
+                    if (timestamp - cacheTimestamps[index] > g_vertexCacheSimulationSize)
+                    {
+                        cacheTimestamps[index] = timestamp++;
+                        ++cacheMissesCount;
+                    }
+                }
+
+                if (i == 0 || cacheMissesCount == g_triangleIndicesCount)
+                    clusterStarts.push_back(i);
+            }
+        }
+        const size_t clustersCount = clusterStarts.size();
+        clusterStarts.push_back(trianglesCount);
+
+        auto position = [&](uint32_t index)
+        {
+            const float* vertex = &vertices[index * vertexElementsCount];
+            return Float3(vertex[0], vertex[1], vertex[2]);
+        };
+
+        // Area weighted centroids and normals
+        std::vector<Float3> clusterCentroids(clustersCount);
+        std::vector<Float3> clusterNormals(clustersCount);
+        Float3 meshCentroid;
+        float meshArea = 0.0f;
+        for (size_t i = 0; i < clustersCount; ++i)
+        {
+            Float3 centroid;
+            Float3 normal;
+            float area = 0.0f;
+            for (size_t j = clusterStarts[i]; j < clusterStarts[i + 1]; ++j)
+            {
+                const auto p0 = position(indices[j * g_triangleIndicesCount]);
+                const auto p1 = position(indices[j * g_triangleIndicesCount + 1]);
+                const auto p2 = position(indices[j * g_triangleIndicesCount + 2]);
+
+                // NOTE the cross product length is twice the triangle area
+                const auto triangleNormal = (p1 - p0).Cross(p2 - p0);
+                const float triangleArea = triangleNormal.Length();
+
+                centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+                normal += triangleNormal;
+                area += triangleArea;
+            }
+
+            meshCentroid += centroid;
+            meshArea += area;
+
+            clusterCentroids[i] = area > 0.0f ? centroid / area : centroid;
+            clusterNormals[i] = normal;
+            clusterNormals[i].Normalize();
+        }
+        if (meshArea > 0.0f)
+            meshCentroid /= meshArea;
+
+        std::vector<float> clusterSortKeys(clustersCount);
+        for (size_t i = 0; i < clustersCount; ++i)
+            clusterSortKeys[i] = (clusterCentroids[i] - meshCentroid).Dot(clusterNormals[i]);
+
+        std::vector<size_t> clusterOrder(clustersCount);
+        std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+        std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](size_t a, size_t b)
+        {
+            return clusterSortKeys[a] > clusterSortKeys[b];
+        });
+
+        std::vector<uint32_t> sortedIndices;
+        sortedIndices.reserve(indices.size());
+        for (auto cluster : clusterOrder)
+        {
+            sortedIndices.insert(sortedIndices.end(),
+                                 indices.begin() + clusterStarts[cluster] * g_triangleIndicesCount,
+                                 indices.begin() + clusterStarts[cluster + 1] * g_triangleIndicesCount);
+        }
+
+        return sortedIndices;
+    }
+
+    // Reorders the vertices in the order the indices use them first. Returns the new
+    // vertices count.
+    size_t OptimizeVertexFetch(std::vector<uint32_t>& indices, const std::vector<float>& vertices,
+                               size_t verticesCount, size_t vertexElementsCount,
+                               std::vector<float>& optimizedVertices)
+    {
+        const uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(verticesCount, invalidIndex);
+
+        optimizedVertices.clear();
+        optimizedVertices.reserve(vertices.size());
+
+        uint32_t nextIndex = 0;
+        for (auto& index : indices)
+        {
+            if (remap[index] == invalidIndex)
+            {
+                remap[index] = nextIndex++;
+                optimizedVertices.insert(optimizedVertices.end(),
+                                         vertices.begin() + index * vertexElementsCount,
+                                         vertices.begin() + (index + 1) * vertexElementsCount);
+            }
+
+            index = remap[index];
+        }
+
+        return nextIndex;
+    }
+}
+
+VertexCacheStats D3D12Basics::AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t verticesCount,
+                                                 size_t cacheSize)
+{
+    assert(indices.size() % g_triangleIndicesCount == 0);
+    assert(cacheSize > 0);
+
+    VertexCacheStats stats;
+    stats.m_trianglesCount = indices.size() / g_triangleIndicesCount;
+    stats.m_verticesCount = verticesCount;
+
+    // Fifo cache simulated with timestamps: a vertex is still cached if less than
+    // cacheSize vertices were added after it
+    std::vector<size_t> cacheTimestamps(verticesCount, 0);
+    size_t timestamp = cacheSize + 1;
+    for (auto index : indices)
+    {
+        assert(index < verticesCount);
+        if (timestamp - cacheTimestamps[index] > cacheSize)
+        {
+            cacheTimestamps[index] = timestamp++;
+            ++stats.m_cacheMissesCount;
+        }
+    }
+
+    return stats;
+}
+
+MeshData D3D12Basics::OptimizeMesh(const MeshData& meshData, bool optimizeOverdraw, MeshOptimizationStats& stats)
+{
+    assert(meshData.IndicesCount() % g_triangleIndicesCount == 0);
+    assert(meshData.VertexSizeBytes() % sizeof(float) == 0);
+
+    const size_t vertexElementsCount = meshData.VertexSizeBytes() / sizeof(float);
+
+    stats.m_before = AnalyzeVertexCache(meshData.Indices(), meshData.VerticesCount());
+
+    auto indices = OptimizeVertexCache(meshData.Indices(), meshData.VerticesCount());
+
+    if (optimizeOverdraw)
+        indices = OptimizeOverdraw(indices, meshData.Vertices(), meshData.VerticesCount(), vertexElementsCount);
+
+    std::vector<float> vertices;
+    const size_t verticesCount = OptimizeVertexFetch(indices, meshData.Vertices(), meshData.VerticesCount(),
+                                                     vertexElementsCount, vertices);
+
+    stats.m_after = AnalyzeVertexCache(indices, verticesCount);
+
+    return MeshData{ std::move(vertices), std::move(indices), verticesCount, meshData.VertexSizeBytes() };
+}
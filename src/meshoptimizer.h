@@ -0,0 +1,57 @@
+#pragma once
+
+// project includes
+#include "utils.h"
+
+// c++ includes
+#include <vector>
+
+namespace D3D12Basics
+{
+    // NOTE fifo size used to simulate the post transform vertex cache
+    const size_t g_vertexCacheSimulationSize = 16;
+
+    struct VertexCacheStats
+    {
+        size_t m_cacheMissesCount   = 0;
+        size_t m_trianglesCount     = 0;
+        size_t m_verticesCount      = 0;
+
+        // Average cache miss ratio: transformed vertices per triangle. 0.5 is the
+        // best case for big regular meshes, 3 the worst.
+        float ACMR() const { return m_trianglesCount ? m_cacheMissesCount / static_cast<float>(m_trianglesCount) : 0.0f; }
+
+        // Average transform to vertex ratio: 1 means each vertex is transformed once.
+        float ATVR() const { return m_verticesCount ? m_cacheMissesCount / static_cast<float>(m_verticesCount) : 0.0f; }
+
+        void Add(const VertexCacheStats& stats)
+        {
+            m_cacheMissesCount += stats.m_cacheMissesCount;
+            m_trianglesCount += stats.m_trianglesCount;
+            m_verticesCount += stats.m_verticesCount;
+        }
+    };
+
+    struct MeshOptimizationStats
+    {
+        VertexCacheStats m_before;
+        VertexCacheStats m_after;
+
+        void Add(const MeshOptimizationStats& stats)
+        {
+            m_before.Add(stats.m_before);
+            m_after.Add(stats.m_after);
+        }
+    };
+
+    VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t verticesCount,
+                                        size_t cacheSize = g_vertexCacheSimulationSize);
+
+    // Reorders the triangles for the post transform vertex cache (Tom Forsyth's linear
+    // speed vertex cache optimisation), optionally sorts clusters of triangles so the
+    // ones facing outwards are drawn first to reduce overdraw and finally reorders the
+    // vertices in the order they are first used to improve the vertex fetch locality.
+    // NOTE vertices not referenced by any triangle are removed
+    // NOTE the overdraw sort assumes the position is the first element of the vertex
+    MeshData OptimizeMesh(const MeshData& meshData, bool optimizeOverdraw, MeshOptimizationStats& stats);
+}
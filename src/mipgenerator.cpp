@@ -0,0 +1,317 @@
+#include "mipgenerator.h"
+
+// c++ includes
+#include <cmath>
+#include <cassert>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <emmintrin.h>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const size_t g_linearToSRGBTableSize = 16384;
+
+    float SRGBToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSRGB(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // NOTE encoding through the table is off by less than a quarter of a 8 bits
+    // step, good enough for mips
+    struct SRGBTables
+    {
+        SRGBTables()
+        {
+            for (size_t i = 0; i < 256; ++i)
+                m_srgb8ToLinear[i] = SRGBToLinear(i / 255.0f);
+
+            for (size_t i = 0; i < g_linearToSRGBTableSize; ++i)
+                m_linearToSRGB[i] = LinearToSRGB(i / static_cast<float>(g_linearToSRGBTableSize - 1));
+        }
+
+        float m_srgb8ToLinear[256];
+        float m_linearToSRGB[g_linearToSRGBTableSize];
+    };
+
+    const SRGBTables& GetSRGBTables()
+    {
+        static const SRGBTables srgbTables;
+        return srgbTables;
+    }
+
+    // Pixels are loaded as normalized rgba floats in a sse register and stored back
+    // with rounding
+    __m128 LoadPixelRGBA8(const uint8_t* pixel)
+    {
+        uint32_t value;
+        memcpy(&value, pixel, sizeof(value));
+
+        const __m128i zero = _mm_setzero_si128();
+        __m128i channels = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(value)), zero);
+        channels = _mm_unpacklo_epi16(channels, zero);
+
+        return _mm_mul_ps(_mm_cvtepi32_ps(channels), _mm_set1_ps(1.0f / 255.0f));
+    }
+
+    void StorePixelRGBA8(__m128 color, uint8_t* pixel)
+    {
+        __m128i channels = _mm_cvtps_epi32(_mm_mul_ps(color, _mm_set1_ps(255.0f)));
+        channels = _mm_packs_epi32(channels, channels);
+        channels = _mm_packus_epi16(channels, channels);
+
+        const uint32_t value = static_cast<uint32_t>(_mm_cvtsi128_si32(channels));
+        memcpy(pixel, &value, sizeof(value));
+    }
+
+    __m128 LoadPixelRGBA16(const uint8_t* pixel)
+    {
+        const __m128i channels = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixel)),
+                                                    _mm_setzero_si128());
+
+        return _mm_mul_ps(_mm_cvtepi32_ps(channels), _mm_set1_ps(1.0f / 65535.0f));
+    }
+
+    void StorePixelRGBA16(__m128 color, uint8_t* pixel)
+    {
+        // NOTE there is no unsigned 32 to 16 bits pack in sse2 so the values are
+        // biased to the signed range and unbiased after the pack
+        __m128i channels = _mm_cvtps_epi32(_mm_mul_ps(color, _mm_set1_ps(65535.0f)));
+        channels = _mm_sub_epi32(channels, _mm_set1_epi32(0x8000));
+        channels = _mm_packs_epi32(channels, channels);
+        channels = _mm_xor_si128(channels, _mm_set1_epi16(static_cast<short>(0x8000)));
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pixel), channels);
+    }
+
+    __m128 LoadPixelSRGBA8(const uint8_t* pixel)
+    {
+        const auto& toLinear = GetSRGBTables().m_srgb8ToLinear;
+        return _mm_set_ps(pixel[3] / 255.0f, toLinear[pixel[2]], toLinear[pixel[1]], toLinear[pixel[0]]);
+    }
+
+    __m128 LoadPixelSRGBA16(const uint8_t* pixel)
+    {
+        alignas(16) float color[4];
+        _mm_store_ps(color, LoadPixelRGBA16(pixel));
+
+        return _mm_set_ps(color[3], SRGBToLinear(color[2]), SRGBToLinear(color[1]), SRGBToLinear(color[0]));
+    }
+
+    __m128 EncodeSRGB8(__m128 color)
+    {
+        const auto& toSRGB = GetSRGBTables().m_linearToSRGB;
+        const float scale = static_cast<float>(g_linearToSRGBTableSize - 1);
+
+        // NOTE the 3 taps weights dont add up to exactly 1 in floating point
+        const __m128 clampedColor = _mm_min_ps(_mm_max_ps(color, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+        alignas(16) int indices[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvtps_epi32(_mm_mul_ps(clampedColor, _mm_set1_ps(scale))));
+
+        alignas(16) float alpha[4];
+        _mm_store_ps(alpha, color);
+
+        return _mm_set_ps(alpha[3], toSRGB[indices[2]], toSRGB[indices[1]], toSRGB[indices[0]]);
+    }
+
+    // NOTE 16 bits channels need more precision than the table
+    __m128 EncodeSRGB16(__m128 color)
+    {
+        alignas(16) float channels[4];
+        _mm_store_ps(channels, color);
+
+        return _mm_set_ps(channels[3], LinearToSRGB(channels[2]), LinearToSRGB(channels[1]), LinearToSRGB(channels[0]));
+    }
+
+    // Source pixels of a destination pixel along one axis and their weights
+    struct FilterTaps
+    {
+        size_t  m_indices[3];
+        float   m_weights[3];
+        size_t  m_count;
+    };
+
+    // Even sizes average 2 pixels. Odd sizes use 3 pixels weighted by how much of each
+    // one the destination pixel covers so the last row or column is not dropped, ie
+    // from 5 to 2 pixels the weights are (2/5, 2/5, 1/5) and (1/5, 2/5, 2/5).
+    FilterTaps CreateFilterTaps(size_t dstIndex, size_t srcSize, size_t dstSize)
+    {
+        if (srcSize == 1)
+            return { { 0, 0, 0 }, { 1.0f, 0.0f, 0.0f }, 1 };
+
+        if (srcSize % 2 == 0)
+            return { { 2 * dstIndex, 2 * dstIndex + 1, 0 }, { 0.5f, 0.5f, 0.0f }, 2 };
+
+        const float rcpSrcSize = 1.0f / static_cast<float>(srcSize);
+        return  {
+                    { 2 * dstIndex, 2 * dstIndex + 1, 2 * dstIndex + 2 },
+                    { 
+                        static_cast<float>(dstSize - dstIndex) * rcpSrcSize,
+                        static_cast<float>(dstSize) * rcpSrcSize,
+                        static_cast<float>(dstIndex + 1) * rcpSrcSize
+                    },
+                    3
+                };
+    }
+
+    // 2x2 box filter when both sizes are even, 3 taps along the odd ones otherwise.
+    template<typename LoadPixel, typename StorePixel>
+    void DownsampleLevel(const uint8_t* src, size_t srcWidth, size_t srcHeight, size_t srcRowPitch,
+                         uint8_t* dst, size_t dstWidth, size_t dstHeight, size_t dstRowPitch, 
+                         size_t pixelSizeBytes, LoadPixel loadPixel, StorePixel storePixel)
+    {
+        if (srcWidth % 2 == 0 && srcHeight % 2 == 0)
+        {
+            const __m128 quarter = _mm_set1_ps(0.25f);
+
+            for (size_t y = 0; y < dstHeight; ++y)
+            {
+                const uint8_t* srcRow0 = src + 2 * y * srcRowPitch;
+                const uint8_t* srcRow1 = srcRow0 + srcRowPitch;
+                uint8_t* dstRow = dst + y * dstRowPitch;
+
+                for (size_t x = 0; x < dstWidth; ++x)
+                {
+                    const size_t x0 = 2 * x * pixelSizeBytes;
+                    const size_t x1 = x0 + pixelSizeBytes;
+
+                    const __m128 sum = _mm_add_ps(_mm_add_ps(loadPixel(srcRow0 + x0), loadPixel(srcRow0 + x1)),
+                                                  _mm_add_ps(loadPixel(srcRow1 + x0), loadPixel(srcRow1 + x1)));
+
+                    storePixel(_mm_mul_ps(sum, quarter), dstRow + x * pixelSizeBytes);
+                }
+            }
+
+            return;
+        }
+
+        std::vector<FilterTaps> columnsTaps(dstWidth);
+        for (size_t x = 0; x < dstWidth; ++x)
+            columnsTaps[x] = CreateFilterTaps(x, srcWidth, dstWidth);
+
+        for (size_t y = 0; y < dstHeight; ++y)
+        {
+            const FilterTaps rowTaps = CreateFilterTaps(y, srcHeight, dstHeight);
+            uint8_t* dstRow = dst + y * dstRowPitch;
+
+            for (size_t x = 0; x < dstWidth; ++x)
+            {
+                const FilterTaps& columnTaps = columnsTaps[x];
+
+                __m128 sum = _mm_setzero_ps();
+                for (size_t i = 0; i < rowTaps.m_count; ++i)
+                {
+                    const uint8_t* srcRow = src + rowTaps.m_indices[i] * srcRowPitch;
+
+                    __m128 rowSum = _mm_setzero_ps();
+                    for (size_t j = 0; j < columnTaps.m_count; ++j)
+                    {
+                        const __m128 pixel = loadPixel(srcRow + columnTaps.m_indices[j] * pixelSizeBytes);
+                        rowSum = _mm_add_ps(rowSum, _mm_mul_ps(pixel, _mm_set1_ps(columnTaps.m_weights[j])));
+                    }
+
+                    sum = _mm_add_ps(sum, _mm_mul_ps(rowSum, _mm_set1_ps(rowTaps.m_weights[i])));
+                }
+
+                storePixel(sum, dstRow + x * pixelSizeBytes);
+            }
+        }
+    }
+}
+
+uint16_t D3D12Basics::MipLevelsCount(size_t width, size_t height)
+{
+    uint16_t levelsCount = 1;
+    for (size_t size = std::max(width, height); size > 1; size >>= 1)
+        ++levelsCount;
+
+    return levelsCount;
+}
+
+TextureData D3D12Basics::GenerateMips(const TextureData& textureData, bool isSRGB)
+{
+    auto desc = textureData.GetDesc();
+    const auto& subresources = textureData.GetSubResources();
+
+    const bool isRGBA8 = desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM;
+    const bool isRGBA16 = desc.Format == DXGI_FORMAT_R16G16B16A16_UNORM;
+    const bool isSupported = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D && desc.DepthOrArraySize == 1 &&
+                             desc.MipLevels == 1 && subresources.size() == 1 && (isRGBA8 || isRGBA16);
+    const uint16_t levelsCount = MipLevelsCount(static_cast<size_t>(desc.Width), desc.Height);
+    if (!isSupported || levelsCount == 1)
+        return textureData;
+
+    const size_t pixelSizeBytes = isRGBA8 ? 4 : 8;
+
+    // NOTE levels are tightly packed one after the other
+    size_t mipChainSizeBytes = 0;
+    for (uint16_t level = 0; level < levelsCount; ++level)
+    {
+        const size_t levelWidth = std::max<size_t>(static_cast<size_t>(desc.Width) >> level, 1);
+        const size_t levelHeight = std::max<size_t>(desc.Height >> level, 1);
+        mipChainSizeBytes += levelWidth * levelHeight * pixelSizeBytes;
+    }
+
+    auto rawData = std::make_unique<uint8_t[]>(mipChainSizeBytes);
+    std::vector<D3D12_SUBRESOURCE_DATA> mipSubresources(levelsCount);
+
+    size_t width = static_cast<size_t>(desc.Width);
+    size_t height = desc.Height;
+    uint8_t* level = rawData.get();
+    {
+        const size_t rowSizeBytes = width * pixelSizeBytes;
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(subresources[0].pData);
+        for (size_t y = 0; y < height; ++y)
+            memcpy(level + y * rowSizeBytes, src + y * subresources[0].RowPitch, rowSizeBytes);
+
+        mipSubresources[0] = { level, static_cast<LONG_PTR>(rowSizeBytes), static_cast<LONG_PTR>(rowSizeBytes * height) };
+    }
+
+    for (uint16_t i = 1; i < levelsCount; ++i)
+    {
+        const size_t levelWidth = std::max<size_t>(width >> 1, 1);
+        const size_t levelHeight = std::max<size_t>(height >> 1, 1);
+        const size_t srcRowPitch = width * pixelSizeBytes;
+        const size_t dstRowPitch = levelWidth * pixelSizeBytes;
+        uint8_t* nextLevel = level + srcRowPitch * height;
+
+        if (isRGBA8 && isSRGB)
+        {
+            DownsampleLevel(level, width, height, srcRowPitch, nextLevel, levelWidth, levelHeight, dstRowPitch,
+                            pixelSizeBytes, LoadPixelSRGBA8, [](__m128 color, uint8_t* pixel) { StorePixelRGBA8(EncodeSRGB8(color), pixel); });
+        }
+        else if (isRGBA8)
+        {
+            DownsampleLevel(level, width, height, srcRowPitch, nextLevel, levelWidth, levelHeight, dstRowPitch,
+                            pixelSizeBytes, LoadPixelRGBA8, StorePixelRGBA8);
+        }
+        else if (isSRGB)
+        {
+            DownsampleLevel(level, width, height, srcRowPitch, nextLevel, levelWidth, levelHeight, dstRowPitch,
+                            pixelSizeBytes, LoadPixelSRGBA16, [](__m128 color, uint8_t* pixel) { StorePixelRGBA16(EncodeSRGB16(color), pixel); });
+        }
+        else
+        {
+            DownsampleLevel(level, width, height, srcRowPitch, nextLevel, levelWidth, levelHeight, dstRowPitch,
+                            pixelSizeBytes, LoadPixelRGBA16, StorePixelRGBA16);
+        }
+
+        mipSubresources[i] = { nextLevel, static_cast<LONG_PTR>(dstRowPitch), static_cast<LONG_PTR>(dstRowPitch * levelHeight) };
+
+        level = nextLevel;
+        width = levelWidth;
+        height = levelHeight;
+    }
+
+    desc.MipLevels = levelsCount;
+
+    return TextureData{ desc, std::move(rawData), std::move(mipSubresources) };
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// project includes
+#include "scene.h"
+
+namespace D3D12Basics
+{
+    // Levels of the full mip chain down to 1x1
+    uint16_t MipLevelsCount(size_t width, size_t height);
+
+    // Returns the texture with the full mip chain in its subresources. Each level is
+    // a box filter of the previous one, 2x2 or 3 taps along the odd sizes. Colour textures (isSRGB) are filtered in
+    // linear space and encoded back to srgb. Alpha is always filtered as linear.
+    // NOTE only 2d R8G8B8A8_UNORM and R16G16B16A16_UNORM textures without mips are
+    // supported, any other texture is returned as it is
+    TextureData GenerateMips(const TextureData& textureData, bool isSRGB);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// project includes
+#include "scene.h"
+
+namespace D3D12Basics
+{
+    // The scene of the sample: a ground plane, a ring of spheres, a ring of cubes, a wave
+    // of spheres and sponza. Shared by the sample and the benchmarks.
+    // NOTE it only creates the scene description, it wont load any resources.
+    Scene CreateSampleScene();
+
+    // Animates the ring of spheres and the wave
+    void UpdateSampleScene(Scene& scene, float totalTime);
+}
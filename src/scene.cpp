@@ -1,17 +1,49 @@
 #include "scene.h"
 
+// project includes
+#include "meshgenerator.h"
+
+// c++ libraries
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <atomic>
+#include <cstdlib>
+
+namespace
+{
+    // NOTE the stb allocations are counted to keep an eye on the memory used to decode
+    // the images. Reallocations count as new allocations.
+    std::atomic<size_t> g_decoderAllocationsCount{ 0 };
+    std::atomic<size_t> g_decoderAllocatedSizeBytes{ 0 };
+
+    void* DecoderMalloc(size_t sizeBytes)
+    {
+        ++g_decoderAllocationsCount;
+        g_decoderAllocatedSizeBytes += sizeBytes;
+        return malloc(sizeBytes);
+    }
+
+    void* DecoderRealloc(void* data, size_t sizeBytes)
+    {
+        ++g_decoderAllocationsCount;
+        g_decoderAllocatedSizeBytes += sizeBytes;
+        return realloc(data, sizeBytes);
+    }
+}
+
 // Third party libraries
 #define STB_IMAGE_IMPLEMENTATION
+#define STBI_MALLOC(sizeBytes)          DecoderMalloc(sizeBytes)
+#define STBI_REALLOC(data, sizeBytes)   DecoderRealloc(data, sizeBytes)
+#define STBI_FREE(data)                 free(data)
 #include "stb/stb_image.h"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
 #include "directxtk12/ddstextureloader_custom.h"
 #include "imgui/imgui.h"
 
-// c++ libraries
-#include <fstream>
-#include <algorithm>
-
 using namespace D3D12Basics;
 
 namespace
@@ -30,7 +62,69 @@ namespace
         return {};
     }
 
-    D3D12_RESOURCE_DESC CreateSTBTextureDesc(unsigned int width, unsigned int height)
+    // NOTE assimp matrices transform column vectors and ours row vectors
+    Matrix44 ConvertFromAssimp(const aiMatrix4x4& matrix)
+    {
+        return Matrix44(matrix.a1, matrix.b1, matrix.c1, matrix.d1,
+                        matrix.a2, matrix.b2, matrix.c2, matrix.d2,
+                        matrix.a3, matrix.b3, matrix.c3, matrix.d3,
+                        matrix.a4, matrix.b4, matrix.c4, matrix.d4);
+    }
+
+    // NOTE the mesh id is the index of the mesh in the assimp scene plus the scene
+    // file ids start
+    Model CreateMeshModel(const aiScene& assimpScene, unsigned int meshIndex, const std::wstring& name,
+                          const Matrix44& transform, size_t idStart, const std::wstring& dataWorkingPath,
+                          size_t modelId)
+    {
+        assert(meshIndex < assimpScene.mNumMeshes);
+        const auto& mesh = *assimpScene.mMeshes[meshIndex];
+
+        Model model;
+        model.m_name = name;
+        model.m_type = Model::Type::MeshFile;
+        model.m_transform = transform;
+        Matrix44 rotationScale = transform;
+        rotationScale.Translation(Float3::Zero);
+        model.m_normalTransform = rotationScale.Invert().Transpose();
+        model.m_id = modelId;
+        model.m_meshId = idStart + meshIndex;
+        model.m_uvScaleOffset = Float4{ 1.0f, 1.0f, 0.0f, 0.0f };
+
+        auto material = assimpScene.mMaterials[mesh.mMaterialIndex];
+        model.m_material.m_diffuseTexture = ExtractAssimpTextureFile(material, aiTextureType_DIFFUSE, dataWorkingPath);
+        model.m_material.m_specularTexture = ExtractAssimpTextureFile(material, aiTextureType_SPECULAR, dataWorkingPath);
+        model.m_material.m_normalsTexture = ExtractAssimpTextureFile(material, aiTextureType_NORMALS, dataWorkingPath);
+        model.m_material.m_shadowReceiver = true;
+        model.m_material.m_shadowCaster = true;
+
+        return model;
+    }
+
+    // A model per mesh of the node and its children with their world transforms
+    void AddNodeModels(const aiScene& assimpScene, const aiNode& node, const Matrix44& parentTransform,
+                       size_t idStart, const std::wstring& dataWorkingPath, size_t& modelId,
+                       std::vector<Model>& models)
+    {
+        const Matrix44 transform = ConvertFromAssimp(node.mTransformation) * parentTransform;
+
+        const std::wstring nodeName = ConvertFromUTF8ToUTF16(node.mName.C_Str());
+        for (unsigned int i = 0; i < node.mNumMeshes; ++i)
+        {
+            const unsigned int meshIndex = node.mMeshes[i];
+            const std::wstring meshName = ConvertFromUTF8ToUTF16(assimpScene.mMeshes[meshIndex]->mName.C_Str());
+            models.push_back(CreateMeshModel(assimpScene, meshIndex, nodeName + L"/" + meshName, transform,
+                                             idStart, dataWorkingPath, modelId++));
+        }
+
+        for (unsigned int i = 0; i < node.mNumChildren; ++i)
+        {
+            assert(node.mChildren[i]);
+            AddNodeModels(assimpScene, *node.mChildren[i], transform, idStart, dataWorkingPath, modelId, models);
+        }
+    }
+
+    D3D12_RESOURCE_DESC CreateSTBTextureDesc(unsigned int width, unsigned int height, DXGI_FORMAT format)
     {
         D3D12_RESOURCE_DESC resourceDesc;
         resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
@@ -39,7 +133,7 @@ namespace
         resourceDesc.Height = height;
         resourceDesc.DepthOrArraySize = 1;
         resourceDesc.MipLevels = 1;
-        resourceDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        resourceDesc.Format = format;
         resourceDesc.SampleDesc = { 1, 0 };
         resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
         resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
@@ -47,12 +141,12 @@ namespace
         return resourceDesc;
     }
 
-    TextureData LoadSTBLoadableImage(const std::wstring& textureFileName, bool is16bit)
+    TextureData LoadSTBLoadableImage(const uint8_t* buffer, size_t bufferSizeBytes, bool is16bit)
     {
-        auto buffer = ReadFullFile(textureFileName, true);
+        assert(buffer && bufferSizeBytes);
 
-        const stbi_uc* bufferPtr = reinterpret_cast<const stbi_uc*>(&buffer[0]);
-        const int bufferLength = static_cast<int>(buffer.size());
+        const stbi_uc* bufferPtr = reinterpret_cast<const stbi_uc*>(buffer);
+        const int bufferLength = static_cast<int>(bufferSizeBytes);
         int textureChannelsCount;
         const int requestedChannelsCount = 4;
         int textureWidth = 0;
@@ -71,15 +165,16 @@ namespace
                                                &textureHeight, &textureChannelsCount,
                                                 requestedChannelsCount);
         }
+        assert(stbiBuffer);
 
-        const auto textureRowSizeBytes = textureWidth * requestedChannelsCount;
+        const int channelSizeBytes = is16bit ? sizeof(uint16_t) : sizeof(uint8_t);
+        const auto textureRowSizeBytes = textureWidth * requestedChannelsCount * channelSizeBytes;
         const auto textureDataSizeBytes = textureRowSizeBytes * textureHeight;
-        // Copy the raw data to be able to free it later without using stbi_image_free
-        auto rawData = std::make_unique<uint8_t[]>(textureDataSizeBytes);
-        memcpy(rawData.get(), stbiBuffer, textureDataSizeBytes);
-        stbi_image_free(stbiBuffer);
+        // NOTE the texture owns the stb buffer, freed with stbi_image_free
+        std::shared_ptr<uint8_t[]> rawData(static_cast<uint8_t*>(stbiBuffer), stbi_image_free);
 
-        auto resourceDesc = CreateSTBTextureDesc(textureWidth, textureHeight);
+        auto resourceDesc = CreateSTBTextureDesc(textureWidth, textureHeight, is16bit ? DXGI_FORMAT_R16G16B16A16_UNORM :
+                                                                                        DXGI_FORMAT_R8G8B8A8_UNORM);
         std::vector<D3D12_SUBRESOURCE_DATA> subresources;
         subresources.push_back(D3D12_SUBRESOURCE_DATA{ rawData.get(), textureRowSizeBytes, textureDataSizeBytes });
 
@@ -101,9 +196,93 @@ namespace
 
         return TextureData{ resourceDesc, std::move(rawData), std::move(subresources) };
     }
+
+    const unsigned int g_sphereParallelsCount = 40;
+    const unsigned int g_sphereMeridiansCount = 40;
+
+    // What a procedural mesh is generated from
+    struct ProceduralMeshParams
+    {
+        Model::Type     m_type;
+        unsigned int    m_parallelsCount;
+        unsigned int    m_meridiansCount;
+        Float4          m_uvScaleOffset;
+
+        bool operator<(const ProceduralMeshParams& other) const
+        {
+            return  std::tie(m_type, m_parallelsCount, m_meridiansCount, m_uvScaleOffset.x, m_uvScaleOffset.y,
+                             m_uvScaleOffset.z, m_uvScaleOffset.w) <
+                    std::tie(other.m_type, other.m_parallelsCount, other.m_meridiansCount, other.m_uvScaleOffset.x,
+                             other.m_uvScaleOffset.y, other.m_uvScaleOffset.z, other.m_uvScaleOffset.w);
+        }
+    };
+
+    ProceduralMeshParams CreateProceduralMeshParams(const Model& model)
+    {
+        assert(model.m_type != Model::Type::MeshFile);
+
+        const bool isSphere = model.m_type == Model::Type::Sphere;
+        return ProceduralMeshParams
+        {
+            model.m_type,
+            isSphere ? g_sphereParallelsCount : 0,
+            isSphere ? g_sphereMeridiansCount : 0,
+            model.m_uvScaleOffset
+        };
+    }
 }
 
-EntityTransform::EntityTransform(ProjectionType projectionType)
+void D3D12Basics::ShareProceduralMeshes(std::vector<Model>& models)
+{
+    std::map<ProceduralMeshParams, size_t> meshIds;
+    for (auto& model : models)
+    {
+        if (model.m_type == Model::Type::MeshFile)
+            continue;
+
+        auto meshId = meshIds.emplace(CreateProceduralMeshParams(model), model.MeshId());
+        if (!meshId.second)
+            model.m_meshId = meshId.first->second;
+    }
+}
+
+void D3D12Basics::MoveModel(Scene& scene, size_t modelIndex, const Matrix44& transform)
+{
+    assert(modelIndex < scene.m_models.size());
+    auto& model = scene.m_models[modelIndex];
+    model.m_transform = transform;
+
+    if (!model.m_moved)
+    {
+        model.m_moved = true;
+        scene.m_movedModels.push_back(modelIndex);
+    }
+}
+
+void D3D12Basics::ClearMovedModels(Scene& scene)
+{
+    for (const size_t modelIndex : scene.m_movedModels)
+        scene.m_models[modelIndex].m_moved = false;
+    scene.m_movedModels.clear();
+}
+
+MeshData D3D12Basics::CreateProceduralMesh(const Model& model)
+{
+    switch (model.m_type)
+    {
+    case Model::Type::Cube:
+        return CreateCube<FullVertexFormat>(model.m_uvScaleOffset);
+    case Model::Type::Plane:
+        return CreatePlane<FullVertexFormat>(model.m_uvScaleOffset);
+    case Model::Type::Sphere:
+        return CreateSphere<FullVertexFormat>(model.m_uvScaleOffset, g_sphereParallelsCount, g_sphereMeridiansCount);
+    default:
+        assert(false);
+        return {};
+    }
+}
+
+EntityTransform::EntityTransform(ProjectionType projectionType) : m_version(0)
 {
     // NOTE this should not be harcoded here but good enough for this project
     if (projectionType == EntityTransform::ProjectionType::Perspective)
@@ -131,7 +310,11 @@ EntityTransform::EntityTransform(ProjectionType projectionType)
 
 void EntityTransform::TranslateLookingAt(const Float3& position, const Float3& target, const Float3& up)
 {
-    m_worldToLocal = Matrix44::CreateLookAtLH(position, target, up);
+    const Matrix44 worldToLocal = Matrix44::CreateLookAtLH(position, target, up);
+    if (worldToLocal != m_worldToLocal || position != m_position)
+        ++m_version;
+
+    m_worldToLocal = worldToLocal;
  
     UpdateLocalToWorld(position);
 
@@ -145,44 +328,55 @@ void EntityTransform::UpdateLocalToWorld(const Float3& position)
     m_localToWorld.Translation(position);
 }
 
-SceneLoader::SceneLoader(const std::wstring& sceneFile, Scene& scene, const std::wstring& dataWorkingPath) : m_outScene(scene)
+SceneLoader::SceneLoader(const std::wstring& sceneFile, Scene& scene, const std::wstring& dataWorkingPath,
+                         bool keepHierarchy) : m_outScene(scene)
 {
     if (sceneFile.empty())
         return;
 
-    // TODO flattening the hierarchy of nodes for now
-    m_assImporter.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, 0x0000ffff);
-    const int importFlags = aiProcess_PreTransformVertices | aiProcess_Triangulate |
-                            aiProcess_CalcTangentSpace |  aiProcess_ConvertToLeftHanded | aiProcess_SplitLargeMeshes;
+    // NOTE big meshes are not split. They use 32 bits indices instead.
+    int importFlags = aiProcess_Triangulate | aiProcess_CalcTangentSpace |  aiProcess_ConvertToLeftHanded;
+    if (!keepHierarchy)
+        importFlags |= aiProcess_PreTransformVertices;
     auto assimpScene = m_assImporter.ReadFile(ConvertFromUTF16ToUTF8(sceneFile), importFlags);
     assert(assimpScene);
  
     m_assimpModelIdStart = scene.m_models.empty() ? 0 : static_cast<unsigned int>(scene.m_models.back().m_id) + 1;
 
-    for (unsigned int i = 0; i < assimpScene->mNumMeshes; ++i)
+    size_t modelId = m_assimpModelIdStart;
+    if (keepHierarchy)
+    {
+        assert(assimpScene->mRootNode);
+        AddNodeModels(*assimpScene, *assimpScene->mRootNode, Matrix44::Identity, m_assimpModelIdStart, 
+                      dataWorkingPath, modelId, m_outScene.m_models);
+    }
+    else
     {
-        auto mesh = assimpScene->mMeshes[i];
+        // NOTE the hierarchy is flattened into a single node with all the meshes
+        for (unsigned int i = 0; i < assimpScene->mNumMeshes; ++i)
+        {
+            const auto& mesh = *assimpScene->mMeshes[i];
+            m_outScene.m_models.push_back(CreateMeshModel(*assimpScene, i, ConvertFromUTF8ToUTF16(mesh.mName.C_Str()),
+                                                          Matrix44::Identity, m_assimpModelIdStart, dataWorkingPath,
+                                                          modelId++));
+        }
+    }
+}
 
-        Model model;
-        model.m_name = ConvertFromUTF8ToUTF16(mesh->mName.C_Str());
-        model.m_type = Model::Type::MeshFile;
-        model.m_transform = D3D12Basics::Matrix44::Identity;
-        model.m_normalTransform = D3D12Basics::Matrix44::Identity;
-        model.m_id = m_assimpModelIdStart + i;
-        model.m_uvScaleOffset = Float4{ 1.0f, 1.0f, 0.0f, 0.0f };
+TextureData SceneLoader::LoadTextureData(const std::wstring& textureFile)
+{
+    if (textureFile.find(L".dds") != std::wstring::npos)
+    {
+        return LoadDDSImage(textureFile);
+    }
 
-        auto material = assimpScene->mMaterials[mesh->mMaterialIndex];
-        model.m_material.m_diffuseTexture = ExtractAssimpTextureFile(material, aiTextureType_DIFFUSE, dataWorkingPath);
-        model.m_material.m_specularTexture = ExtractAssimpTextureFile(material, aiTextureType_SPECULAR, dataWorkingPath);
-        model.m_material.m_normalsTexture = ExtractAssimpTextureFile(material, aiTextureType_NORMALS, dataWorkingPath);
-        model.m_material.m_shadowReceiver = true;
-        model.m_material.m_shadowCaster = true;
+    MappedFile file(textureFile);
+    assert(file.IsValid());
 
-        m_outScene.m_models.push_back(std::move(model));
-    }
+    return LoadTextureData(textureFile, file.Data(), file.SizeBytes());
 }
 
-TextureData SceneLoader::LoadTextureData(const std::wstring& textureFile)
+TextureData SceneLoader::LoadTextureData(const std::wstring& textureFile, const uint8_t* fileData, size_t fileSizeBytes)
 {
     if (textureFile.find(L".dds") != std::wstring::npos)
     {
@@ -190,13 +384,19 @@ TextureData SceneLoader::LoadTextureData(const std::wstring& textureFile)
     }
 
     const bool isHDRTexture = textureFile.find(L".hdr") != std::wstring::npos;
-    return LoadSTBLoadableImage(textureFile, isHDRTexture);
+    return LoadSTBLoadableImage(fileData, fileSizeBytes, isHDRTexture);
 }
 
-MeshData SceneLoader::LoadMesh(size_t modelId)
+SceneLoader::DecoderAllocationStats SceneLoader::GetDecoderAllocationStats()
 {
-    assert(m_assimpModelIdStart <= modelId);
-    auto assimpMeshId = modelId - m_assimpModelIdStart;
+    return DecoderAllocationStats{ g_decoderAllocationsCount, g_decoderAllocatedSizeBytes };
+}
+
+template<typename Format>
+MeshData SceneLoader::LoadMesh(size_t meshId)
+{
+    assert(m_assimpModelIdStart <= meshId);
+    auto assimpMeshId = meshId - m_assimpModelIdStart;
     // TODO compile time assert
     assert(sizeof(aiVector3D) == sizeof(Float3));
 
@@ -207,53 +407,37 @@ MeshData SceneLoader::LoadMesh(size_t modelId)
     auto* model = assimpScene->mMeshes[assimpMeshId];
     assert(model->HasPositions() && model->HasTextureCoords(0) && model->HasNormals() && 
            model->HasTangentsAndBitangents());
-    assert(model->mNumVertices <= MeshData::m_maxVertexCount);
 
     // Copy the indices
     const unsigned int numIndicesPerTriangle = 3;
-    std::vector<uint16_t> indices(model->mNumFaces * numIndicesPerTriangle);
+    std::vector<uint32_t> indices(model->mNumFaces * numIndicesPerTriangle);
     for (size_t i = 0; i < model->mNumFaces; ++i)
     {
         assert(model->mFaces[i].mNumIndices == numIndicesPerTriangle);
         for (unsigned int j = 0; j < numIndicesPerTriangle; ++j)
-            indices[i * numIndicesPerTriangle + j] = static_cast<uint16_t>(model->mFaces[i].mIndices[j]);
+            indices[i * numIndicesPerTriangle + j] = model->mFaces[i].mIndices[j];
     }
-    
-    const size_t positionElementsCount = 3;
-    std::vector<float> positions(model->mNumVertices * positionElementsCount);
-    memcpy(&positions[0], model->mVertices, sizeof(aiVector3D) * model->mNumVertices);
 
     const unsigned int uvElementsCount = 2;
     assert(model->mNumUVComponents[0] == uvElementsCount);
-    std::vector<float> uvs(model->mNumVertices * uvElementsCount);
+
+    auto toFloat3 = [](const aiVector3D& v) { return Float3(v.x, v.y, v.z); };
+
+    auto vertices = Format::CreateVertices(model->mNumVertices);
     for (size_t i = 0; i < model->mNumVertices; ++i)
     {
-        memcpy(&uvs[i * uvElementsCount], &model->mTextureCoords[0][i], sizeof(Float2));
+        Format::template Write<PositionAttribute>(vertices, i, toFloat3(model->mVertices[i]));
+        Format::template Write<UVAttribute>(vertices, i, Float2(model->mTextureCoords[0][i].x, model->mTextureCoords[0][i].y));
+        Format::template Write<NormalAttribute>(vertices, i, toFloat3(model->mNormals[i]));
+        Format::template Write<TangentAttribute>(vertices, i, toFloat3(model->mTangents[i]));
+        Format::template Write<BitangentAttribute>(vertices, i, toFloat3(model->mBitangents[i]));
     }
 
-    const size_t normalsElementsCount = 3;
-    std::vector<float> normals(model->mNumVertices * normalsElementsCount);
-    memcpy(&normals[0], model->mNormals, sizeof(aiVector3D) * model->mNumVertices);
-
-    const size_t tangentElementsCount = 3;
-    std::vector<float> tangents(model->mNumVertices * tangentElementsCount);
-    memcpy(&tangents[0], model->mTangents, sizeof(aiVector3D) * model->mNumVertices);
-
-    const size_t bitangentElementsCount = 3;
-    std::vector<float> bitangents(model->mNumVertices * bitangentElementsCount);
-    memcpy(&bitangents[0], model->mBitangents, sizeof(aiVector3D) * model->mNumVertices);
-
-    VertexStreams streams;
-    streams.AddStream(positionElementsCount, std::move(positions));
-    streams.AddStream(uvElementsCount, std::move(uvs));
-    streams.AddStream(normalsElementsCount, std::move(normals));
-    streams.AddStream(tangentElementsCount, std::move(tangents));
-    streams.AddStream(bitangentElementsCount, std::move(bitangents));
-    const auto vertexElementsCount = streams.VertexElementsCount();
-
-    return MeshData{ streams.GetStreams(), std::move(indices), model->mNumVertices, vertexElementsCount * sizeof(float), vertexElementsCount };
+    return MeshData{ std::move(vertices), std::move(indices), model->mNumVertices, Format::m_strideBytes };
 }
 
+template MeshData SceneLoader::LoadMesh<FullVertexFormat>(size_t meshId);
+
 CameraController::CameraController()
 {
 }
@@ -2,6 +2,7 @@
 
 // project includes
 #include "utils.h"
+#include "vertexformat.h"
 
 // c++ includes
 #include <vector>
@@ -35,7 +36,13 @@ namespace D3D12Basics
         const Float3& Position() const { return m_position; }
         const Float3& Forward() const { return m_forward; }
 
+        // Incremented every time the transform changes
+        // NOTE translating to the same position looking at the same target is not a change
+        uint64_t Version() const { return m_version; }
+
     private:
+        uint64_t m_version;
+
         Matrix44 m_worldToLocal;
         Matrix44 m_localToWorld;
 
@@ -69,13 +76,14 @@ namespace D3D12Basics
        bool m_shadowCaster;
     };
 
+    // NOTE copies share the raw data
     class TextureData
     {
     public:
         TextureData() {}
 
         TextureData(const D3D12_RESOURCE_DESC& resourceDesc,
-                    std::unique_ptr<uint8_t[]> rawData,
+                    std::shared_ptr<uint8_t[]> rawData,
                     std::vector<D3D12_SUBRESOURCE_DATA>&& subresources) :   m_resourceDesc(resourceDesc), m_rawData(std::move(rawData)),
                                                                             m_subresources(subresources)
         {}
@@ -87,7 +95,7 @@ namespace D3D12Basics
     private:
         D3D12_RESOURCE_DESC m_resourceDesc;
 
-        std::unique_ptr<uint8_t[]>          m_rawData;
+        std::shared_ptr<uint8_t[]>          m_rawData;
         std::vector<D3D12_SUBRESOURCE_DATA> m_subresources;
     };
 
@@ -109,6 +117,16 @@ namespace D3D12Basics
         Matrix44 m_transform;
         Matrix44 m_normalTransform;
         Material m_material;
+
+        // Key of the mesh in the mesh data cache. Models instancing the same mesh share it.
+        // NOTE by default it is the model id, the model has its own mesh
+        static const size_t m_ownMeshId = static_cast<size_t>(-1);
+        size_t          m_meshId = m_ownMeshId;
+
+        size_t MeshId() const { return m_meshId == m_ownMeshId ? m_id : m_meshId; }
+
+        // NOTE set by MoveModel while the model is in the scene moved models
+        bool            m_moved = false;
     };
 
     struct Scene
@@ -118,22 +136,62 @@ namespace D3D12Basics
         EntityTransform     m_camera;
         std::vector<Light>  m_lights;
         std::vector<Model>  m_models;
+
+        // Indices of the models moved since the last ClearMovedModels, so the renderer
+        // only updates those
+        std::vector<size_t> m_movedModels;
     };
 
+    // Writes the model transform and adds the model to the scene moved models
+    // NOTE the normal transform is kept, ie the transform only translates or scales
+    // uniformly the model
+    void MoveModel(Scene& scene, size_t modelIndex, const Matrix44& transform);
+
+    void ClearMovedModels(Scene& scene);
+
+    // Models with the same procedural mesh params, ie the spheres with the same uvs, use
+    // the mesh of the first one
+    void ShareProceduralMeshes(std::vector<Model>& models);
+
+    // NOTE the mesh is a FullVertexFormat one
+    MeshData CreateProceduralMesh(const Model& model);
+
     class SceneLoader
     {
     public:
-        SceneLoader(const std::wstring& sceneFile, Scene& scene, const std::wstring& dataWorkingPath);
+        // NOTE keepHierarchy keeps the node transforms instead of baking them into the
+        // vertices: each mesh is loaded once and there is a model per node mesh with
+        // the node world transform, so meshes used by several nodes are instanced
+        SceneLoader(const std::wstring& sceneFile, Scene& scene, const std::wstring& dataWorkingPath,
+                    bool keepHierarchy);
+
+        // Allocations made by the image decoder (stb) since the app started
+        struct DecoderAllocationStats
+        {
+            size_t m_allocationsCount   = 0;
+            size_t m_allocatedSizeBytes = 0;
+        };
 
+        // NOTE the file is memory mapped
         TextureData LoadTextureData(const std::wstring& textureFile);
 
-        MeshData LoadMesh(size_t modelId);
+        // NOTE fileData is the content of textureFile, usually a mapped file, and it is
+        // decoded from there. The texture keeps the decoder output buffer, the pixels
+        // are not copied. dds textures are still loaded from the file.
+        static TextureData LoadTextureData(const std::wstring& textureFile, const uint8_t* fileData, size_t fileSizeBytes);
+
+        static DecoderAllocationStats GetDecoderAllocationStats();
+
+        // NOTE instantiated for FullVertexFormat
+        template<typename Format>
+        MeshData LoadMesh(size_t meshId);
 
     private:
         Assimp::Importer m_assImporter;
 
         Scene& m_outScene;
 
+        // NOTE the scene file models ids and meshes ids start here
         unsigned int m_assimpModelIdStart;
     };
 
@@ -0,0 +1,148 @@
+#pragma once
+
+// c++ includes
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+namespace D3D12Basics
+{
+    // Generational slot map. Inserting returns an id made of the slot index and the
+    // slot generation. Lookups are an indirection through the slots array, no hashing
+    // involved. Erasing bumps the slot generation so any id still pointing to that
+    // slot is detected as stale (use after free).
+    // Values are kept densely packed (erase swaps the last value into the hole) so
+    // references to values are not stable across inserts and erases.
+    // http://bitsquid.blogspot.ca/2011/09/managing-decoupling-part-4-id-lookup.html
+    // http://seanmiddleditch.com/data-structures-for-game-developers-the-slot-map/
+    //
+    // Note ids only use the lower 62 bits so the two msb can be used by the caller
+    // to encode extra data, ie D3D12GpuMemoryHandle.
+    template<class T>
+    class SlotMap
+    {
+    public:
+        using Id = uint64_t;
+
+        static const uint32_t   m_indexBits         = 32;
+        static const uint32_t   m_generationBits    = 30;
+        static const uint32_t   m_generationMask    = (1u << m_generationBits) - 1;
+        static const uint32_t   m_invalidIndex      = std::numeric_limits<uint32_t>::max();
+
+        SlotMap() : m_freeListHead(m_invalidIndex)
+        {
+        }
+
+        Id Insert(T&& value)
+        {
+            uint32_t slotIndex = m_freeListHead;
+            if (slotIndex == m_invalidIndex)
+            {
+                assert(m_slots.size() < m_invalidIndex);
+                slotIndex = static_cast<uint32_t>(m_slots.size());
+                m_slots.push_back(Slot{});
+            }
+            else
+            {
+                m_freeListHead = m_slots[slotIndex].m_nextFree;
+            }
+
+            Slot& slot = m_slots[slotIndex];
+            slot.m_valueIndex = static_cast<uint32_t>(m_values.size());
+            slot.m_nextFree = m_invalidIndex;
+
+            m_values.push_back(std::move(value));
+            m_valueSlots.push_back(slotIndex);
+
+            return EncodeId(slotIndex, slot.m_generation);
+        }
+
+        bool Contains(Id id) const
+        {
+            const uint32_t slotIndex = DecodeIndex(id);
+            if (slotIndex >= m_slots.size())
+                return false;
+
+            const Slot& slot = m_slots[slotIndex];
+            return slot.m_valueIndex != m_invalidIndex && slot.m_generation == DecodeGeneration(id);
+        }
+
+        T& Get(Id id)
+        {
+            assert(Contains(id));
+            return m_values[m_slots[DecodeIndex(id)].m_valueIndex];
+        }
+
+        const T& Get(Id id) const
+        {
+            assert(Contains(id));
+            return m_values[m_slots[DecodeIndex(id)].m_valueIndex];
+        }
+
+        void Erase(Id id)
+        {
+            assert(Contains(id));
+
+            const uint32_t slotIndex = DecodeIndex(id);
+            Slot& slot = m_slots[slotIndex];
+
+            // Keep the values packed moving the last one into the erased one
+            const uint32_t valueIndex = slot.m_valueIndex;
+            const uint32_t lastValueIndex = static_cast<uint32_t>(m_values.size() - 1);
+            if (valueIndex != lastValueIndex)
+            {
+                m_values[valueIndex] = std::move(m_values[lastValueIndex]);
+                m_valueSlots[valueIndex] = m_valueSlots[lastValueIndex];
+                m_slots[m_valueSlots[valueIndex]].m_valueIndex = valueIndex;
+            }
+            m_values.pop_back();
+            m_valueSlots.pop_back();
+
+            slot.m_valueIndex = m_invalidIndex;
+            slot.m_generation = (slot.m_generation + 1) & m_generationMask;
+            slot.m_nextFree = m_freeListHead;
+            m_freeListHead = slotIndex;
+        }
+
+        size_t Size() const { return m_values.size(); }
+
+        bool Empty() const { return m_values.empty(); }
+
+        // Dense access. Order is not the insertion order.
+        typename std::vector<T>::iterator begin() { return m_values.begin(); }
+        typename std::vector<T>::iterator end() { return m_values.end(); }
+        typename std::vector<T>::const_iterator begin() const { return m_values.begin(); }
+        typename std::vector<T>::const_iterator end() const { return m_values.end(); }
+
+    private:
+        struct Slot
+        {
+            uint32_t m_generation   = 0;
+            uint32_t m_valueIndex   = m_invalidIndex;
+            uint32_t m_nextFree     = m_invalidIndex;
+        };
+
+        std::vector<Slot>       m_slots;
+        std::vector<T>          m_values;
+        std::vector<uint32_t>   m_valueSlots;
+        uint32_t                m_freeListHead;
+
+        static Id EncodeId(uint32_t index, uint32_t generation)
+        {
+            assert(generation <= m_generationMask);
+            return (static_cast<Id>(generation) << m_indexBits) | index;
+        }
+
+        static uint32_t DecodeIndex(Id id)
+        {
+            return static_cast<uint32_t>(id & std::numeric_limits<uint32_t>::max());
+        }
+
+        static uint32_t DecodeGeneration(Id id)
+        {
+            return static_cast<uint32_t>(id >> m_indexBits) & m_generationMask;
+        }
+    };
+}
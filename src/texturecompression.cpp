@@ -0,0 +1,666 @@
+#include "texturecompression.h"
+
+// c++ includes
+#include <cassert>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const size_t g_blockDimension       = 4;
+    const size_t g_blockPixelsCount     = 16;
+    const size_t g_pixelSizeBytes       = 4;
+    const size_t g_powerIterationsCount = 4;
+
+    // NOTE: https://docs.microsoft.com/en-us/windows/desktop/direct3d11/bc7-format-mode-reference
+    const int g_bc7Weights4Bits[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    struct Block
+    {
+        uint8_t m_pixels[g_blockPixelsCount][g_pixelSizeBytes];
+    };
+
+    void LoadBlock(const uint8_t* level, size_t width, size_t height, size_t rowPitch,
+                   size_t blockX, size_t blockY, Block& block)
+    {
+        // NOTE blocks of levels smaller than 4x4 repeat the last row and column
+        for (size_t y = 0; y < g_blockDimension; ++y)
+        {
+            const uint8_t* row = level + std::min(blockY * g_blockDimension + y, height - 1) * rowPitch;
+            for (size_t x = 0; x < g_blockDimension; ++x)
+            {
+                const size_t pixelX = std::min(blockX * g_blockDimension + x, width - 1);
+                memcpy(block.m_pixels[y * g_blockDimension + x], row + pixelX * g_pixelSizeBytes, g_pixelSizeBytes);
+            }
+        }
+    }
+
+    // Endpoints of the principal axis of the pixels, found through power iteration
+    // over the covariance matrix, at the extremes of the pixels projections
+    template<size_t ChannelsCount>
+    void FitEndpoints(const Block& block, float (&endpoint0)[ChannelsCount], float (&endpoint1)[ChannelsCount])
+    {
+        float mean[ChannelsCount] = {};
+        float minValue[ChannelsCount];
+        float maxValue[ChannelsCount];
+        std::fill(std::begin(minValue), std::end(minValue), 255.0f);
+        std::fill(std::begin(maxValue), std::end(maxValue), 0.0f);
+        for (const auto& pixel : block.m_pixels)
+        {
+            for (size_t c = 0; c < ChannelsCount; ++c)
+            {
+                mean[c] += pixel[c];
+                minValue[c] = std::min(minValue[c], static_cast<float>(pixel[c]));
+                maxValue[c] = std::max(maxValue[c], static_cast<float>(pixel[c]));
+            }
+        }
+        for (auto& value : mean)
+            value /= g_blockPixelsCount;
+
+        float covariance[ChannelsCount][ChannelsCount] = {};
+        for (const auto& pixel : block.m_pixels)
+        {
+            for (size_t i = 0; i < ChannelsCount; ++i)
+                for (size_t j = 0; j < ChannelsCount; ++j)
+                    covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+        }
+
+        float axis[ChannelsCount];
+        for (size_t c = 0; c < ChannelsCount; ++c)
+            axis[c] = maxValue[c] - minValue[c];
+
+        for (size_t iteration = 0; iteration < g_powerIterationsCount; ++iteration)
+        {
+            float nextAxis[ChannelsCount] = {};
+            float maxComponent = 0.0f;
+            for (size_t i = 0; i < ChannelsCount; ++i)
+            {
+                for (size_t j = 0; j < ChannelsCount; ++j)
+                    nextAxis[i] += covariance[i][j] * axis[j];
+                maxComponent = std::max(maxComponent, std::abs(nextAxis[i]));
+            }
+
+            if (maxComponent == 0.0f)
+                break;
+
+            for (size_t c = 0; c < ChannelsCount; ++c)
+                axis[c] = nextAxis[c] / maxComponent;
+        }
+
+        float axisLengthSquared = 0.0f;
+        for (float component : axis)
+            axisLengthSquared += component * component;
+
+        // Solid block
+        if (axisLengthSquared == 0.0f)
+        {
+            std::copy(std::begin(mean), std::end(mean), std::begin(endpoint0));
+            std::copy(std::begin(mean), std::end(mean), std::begin(endpoint1));
+            return;
+        }
+
+        float minProjection = std::numeric_limits<float>::max();
+        float maxProjection = -std::numeric_limits<float>::max();
+        for (const auto& pixel : block.m_pixels)
+        {
+            float projection = 0.0f;
+            for (size_t c = 0; c < ChannelsCount; ++c)
+                projection += (pixel[c] - mean[c]) * axis[c];
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+
+        for (size_t c = 0; c < ChannelsCount; ++c)
+        {
+            endpoint0[c] = std::clamp(mean[c] + axis[c] * minProjection / axisLengthSquared, 0.0f, 255.0f);
+            endpoint1[c] = std::clamp(mean[c] + axis[c] * maxProjection / axisLengthSquared, 0.0f, 255.0f);
+        }
+    }
+
+    // Little endian bit stream of a 128 bits block
+    class BlockBits
+    {
+    public:
+        BlockBits() : m_bits{}, m_offset(0) {}
+
+        BlockBits(const uint8_t* src) : m_offset(0)
+        {
+            memcpy(m_bits, src, sizeof(m_bits));
+        }
+
+        void Write(uint32_t value, size_t bitsCount)
+        {
+            for (size_t i = 0; i < bitsCount; ++i, ++m_offset)
+                m_bits[m_offset / 8] |= static_cast<uint8_t>(((value >> i) & 1) << (m_offset % 8));
+        }
+
+        uint32_t Read(size_t bitsCount)
+        {
+            uint32_t value = 0;
+            for (size_t i = 0; i < bitsCount; ++i, ++m_offset)
+                value |= ((m_bits[m_offset / 8] >> (m_offset % 8)) & 1u) << i;
+            return value;
+        }
+
+        void Store(uint8_t* dst) const { memcpy(dst, m_bits, sizeof(m_bits)); }
+
+    private:
+        uint8_t m_bits[16];
+        size_t  m_offset;
+    };
+
+    // BC1
+    uint16_t ToRGB565(const float (&color)[3])
+    {
+        const int r = static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f);
+        const int g = static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f);
+        const int b = static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void FromRGB565(uint16_t color, int (&rgb)[3])
+    {
+        const int r = color >> 11;
+        const int g = (color >> 5) & 0x3f;
+        const int b = color & 0x1f;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // NOTE BC3 color blocks always use the 4 colors palette
+    void BC1Palette(uint16_t color0, uint16_t color1, bool isFourColors, int (&palette)[4][3])
+    {
+        FromRGB565(color0, palette[0]);
+        FromRGB565(color1, palette[1]);
+        for (size_t c = 0; c < 3; ++c)
+        {
+            if (isFourColors || color0 > color1)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+    }
+
+    uint32_t BC1Indices(const Block& block, const int (&palette)[4][3], int& error)
+    {
+        uint32_t indices = 0;
+        error = 0;
+        for (size_t i = 0; i < g_blockPixelsCount; ++i)
+        {
+            int bestError = std::numeric_limits<int>::max();
+            uint32_t bestIndex = 0;
+            for (uint32_t index = 0; index < 4; ++index)
+            {
+                int indexError = 0;
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    const int diff = block.m_pixels[i][c] - palette[index][c];
+                    indexError += diff * diff;
+                }
+
+                if (indexError < bestError)
+                {
+                    bestError = indexError;
+                    bestIndex = index;
+                }
+            }
+
+            indices |= bestIndex << (2 * i);
+            error += bestError;
+        }
+
+        return indices;
+    }
+
+    // Least squares endpoints for the given indices
+    bool RefineBC1Endpoints(const Block& block, uint32_t indices, float (&endpoint0)[3], float (&endpoint1)[3])
+    {
+        const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[3] = {}, bx[3] = {};
+        for (size_t i = 0; i < g_blockPixelsCount; ++i)
+        {
+            const float a = weights[(indices >> (2 * i)) & 3];
+            const float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (size_t c = 0; c < 3; ++c)
+            {
+                ax[c] += a * block.m_pixels[i][c];
+                bx[c] += b * block.m_pixels[i][c];
+            }
+        }
+
+        const float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f)
+            return false;
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            endpoint0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+            endpoint1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+        }
+
+        return true;
+    }
+
+    void EncodeBC1Block(const Block& block, uint8_t* dst)
+    {
+        float minEndpoint[3];
+        float maxEndpoint[3];
+        FitEndpoints(block, minEndpoint, maxEndpoint);
+
+        uint16_t color0 = ToRGB565(maxEndpoint);
+        uint16_t color1 = ToRGB565(minEndpoint);
+        int palette[4][3];
+        BC1Palette(color0, color1, true, palette);
+        int error;
+        uint32_t indices = BC1Indices(block, palette, error);
+
+        float refinedEndpoint0[3];
+        float refinedEndpoint1[3];
+        if (error > 0 && RefineBC1Endpoints(block, indices, refinedEndpoint0, refinedEndpoint1))
+        {
+            const uint16_t refinedColor0 = ToRGB565(refinedEndpoint0);
+            const uint16_t refinedColor1 = ToRGB565(refinedEndpoint1);
+            BC1Palette(refinedColor0, refinedColor1, true, palette);
+            int refinedError;
+            const uint32_t refinedIndices = BC1Indices(block, palette, refinedError);
+            if (refinedError < error)
+            {
+                color0 = refinedColor0;
+                color1 = refinedColor1;
+                indices = refinedIndices;
+            }
+        }
+
+        // NOTE color0 > color1 selects the 4 colors palette. Swapping the endpoints
+        // swaps the indices 0 with 1 and 2 with 3.
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+            indices ^= 0x55555555;
+        }
+        else if (color0 == color1)
+        {
+            indices = 0;
+        }
+
+        memcpy(dst, &color0, sizeof(color0));
+        memcpy(dst + 2, &color1, sizeof(color1));
+        memcpy(dst + 4, &indices, sizeof(indices));
+    }
+
+    void DecodeBC1Block(const uint8_t* src, bool isFourColors, Block& block)
+    {
+        uint16_t color0, color1;
+        uint32_t indices;
+        memcpy(&color0, src, sizeof(color0));
+        memcpy(&color1, src + 2, sizeof(color1));
+        memcpy(&indices, src + 4, sizeof(indices));
+
+        int palette[4][3];
+        BC1Palette(color0, color1, isFourColors, palette);
+        for (size_t i = 0; i < g_blockPixelsCount; ++i)
+        {
+            const uint32_t index = (indices >> (2 * i)) & 3;
+            for (size_t c = 0; c < 3; ++c)
+                block.m_pixels[i][c] = static_cast<uint8_t>(palette[index][c]);
+            block.m_pixels[i][3] = (!isFourColors && color0 <= color1 && index == 3) ? 0 : 255;
+        }
+    }
+
+    // BC4: one channel, 8 values palette
+    void BC4Palette(int value0, int value1, int (&palette)[8])
+    {
+        palette[0] = value0;
+        palette[1] = value1;
+        if (value0 > value1)
+        {
+            for (int i = 1; i < 7; ++i)
+                palette[i + 1] = ((7 - i) * value0 + i * value1) / 7;
+        }
+        else
+        {
+            for (int i = 1; i < 5; ++i)
+                palette[i + 1] = ((5 - i) * value0 + i * value1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void EncodeBC4Block(const Block& block, size_t channel, uint8_t* dst)
+    {
+        int minValue = 255;
+        int maxValue = 0;
+        for (const auto& pixel : block.m_pixels)
+        {
+            minValue = std::min(minValue, static_cast<int>(pixel[channel]));
+            maxValue = std::max(maxValue, static_cast<int>(pixel[channel]));
+        }
+
+        int palette[8];
+        BC4Palette(maxValue, minValue, palette);
+
+        uint64_t indices = 0;
+        if (maxValue > minValue)
+        {
+            for (size_t i = 0; i < g_blockPixelsCount; ++i)
+            {
+                int bestError = std::numeric_limits<int>::max();
+                uint64_t bestIndex = 0;
+                for (uint64_t index = 0; index < 8; ++index)
+                {
+                    const int indexError = std::abs(block.m_pixels[i][channel] - palette[index]);
+                    if (indexError < bestError)
+                    {
+                        bestError = indexError;
+                        bestIndex = index;
+                    }
+                }
+
+                indices |= bestIndex << (3 * i);
+            }
+        }
+
+        dst[0] = static_cast<uint8_t>(maxValue);
+        dst[1] = static_cast<uint8_t>(minValue);
+        for (size_t i = 0; i < 6; ++i)
+            dst[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+
+    void DecodeBC4Block(const uint8_t* src, size_t channel, Block& block)
+    {
+        int palette[8];
+        BC4Palette(src[0], src[1], palette);
+
+        uint64_t indices = 0;
+        for (size_t i = 0; i < 6; ++i)
+            indices |= static_cast<uint64_t>(src[2 + i]) << (8 * i);
+
+        for (size_t i = 0; i < g_blockPixelsCount; ++i)
+            block.m_pixels[i][channel] = static_cast<uint8_t>(palette[(indices >> (3 * i)) & 7]);
+    }
+
+    // BC7 mode 6: rgba 7 bits endpoints with a p bit each and 4 bits indices
+    void BC7Mode6Palette(const int (&endpoints)[2][4], int (&palette)[16][4])
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            const int weight = g_bc7Weights4Bits[i];
+            for (size_t c = 0; c < 4; ++c)
+                palette[i][c] = ((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6;
+        }
+    }
+
+    void EncodeBC7Mode6Block(const Block& block, uint8_t* dst)
+    {
+        float fittedEndpoints[2][4];
+        FitEndpoints(block, fittedEndpoints[0], fittedEndpoints[1]);
+
+        // NOTE the p bit is the lsb of all the channels of the endpoint
+        int quantizedEndpoints[2][4];
+        int pBits[2];
+        int endpoints[2][4];
+        for (size_t e = 0; e < 2; ++e)
+        {
+            float bestError = std::numeric_limits<float>::max();
+            for (int pBit = 0; pBit < 2; ++pBit)
+            {
+                int quantized[4];
+                float error = 0.0f;
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    quantized[c] = std::clamp(static_cast<int>((fittedEndpoints[e][c] - pBit) / 2.0f + 0.5f), 0, 127);
+                    const float diff = ((quantized[c] << 1) | pBit) - fittedEndpoints[e][c];
+                    error += diff * diff;
+                }
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    pBits[e] = pBit;
+                    std::copy(std::begin(quantized), std::end(quantized), std::begin(quantizedEndpoints[e]));
+                }
+            }
+
+            for (size_t c = 0; c < 4; ++c)
+                endpoints[e][c] = (quantizedEndpoints[e][c] << 1) | pBits[e];
+        }
+
+        int palette[16][4];
+        BC7Mode6Palette(endpoints, palette);
+
+        uint32_t indices[g_blockPixelsCount];
+        for (size_t i = 0; i < g_blockPixelsCount; ++i)
+        {
+            int bestError = std::numeric_limits<int>::max();
+            for (uint32_t index = 0; index < 16; ++index)
+            {
+                int indexError = 0;
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    const int diff = block.m_pixels[i][c] - palette[index][c];
+                    indexError += diff * diff;
+                }
+
+                if (indexError < bestError)
+                {
+                    bestError = indexError;
+                    indices[i] = index;
+                }
+            }
+        }
+
+        // NOTE the msb of the first index is implicitly 0
+        if (indices[0] >= 8)
+        {
+            std::swap(quantizedEndpoints[0], quantizedEndpoints[1]);
+            std::swap(pBits[0], pBits[1]);
+            for (auto& index : indices)
+                index = 15 - index;
+        }
+
+        BlockBits bits;
+        bits.Write(1 << 6, 7);
+        for (size_t c = 0; c < 4; ++c)
+        {
+            bits.Write(quantizedEndpoints[0][c], 7);
+            bits.Write(quantizedEndpoints[1][c], 7);
+        }
+        bits.Write(pBits[0], 1);
+        bits.Write(pBits[1], 1);
+        for (size_t i = 0; i < g_blockPixelsCount; ++i)
+            bits.Write(indices[i], i == 0 ? 3 : 4);
+
+        bits.Store(dst);
+    }
+
+    void DecodeBC7Mode6Block(const uint8_t* src, Block& block)
+    {
+        BlockBits bits(src);
+        const uint32_t mode = bits.Read(7);
+        assert(mode == (1 << 6));
+
+        int endpoints[2][4];
+        for (size_t c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] = bits.Read(7) << 1;
+            endpoints[1][c] = bits.Read(7) << 1;
+        }
+        const int pBit0 = bits.Read(1);
+        const int pBit1 = bits.Read(1);
+        for (size_t c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] |= pBit0;
+            endpoints[1][c] |= pBit1;
+        }
+
+        int palette[16][4];
+        BC7Mode6Palette(endpoints, palette);
+        for (size_t i = 0; i < g_blockPixelsCount; ++i)
+        {
+            const uint32_t index = bits.Read(i == 0 ? 3 : 4);
+            for (size_t c = 0; c < 4; ++c)
+                block.m_pixels[i][c] = static_cast<uint8_t>(palette[index][c]);
+        }
+    }
+
+    void EncodeBlock(DXGI_FORMAT format, const Block& block, uint8_t* dst)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+            EncodeBC1Block(block, dst);
+            break;
+        case DXGI_FORMAT_BC3_UNORM:
+            EncodeBC4Block(block, 3, dst);
+            EncodeBC1Block(block, dst + 8);
+            break;
+        case DXGI_FORMAT_BC5_UNORM:
+            EncodeBC4Block(block, 0, dst);
+            EncodeBC4Block(block, 1, dst + 8);
+            break;
+        case DXGI_FORMAT_BC7_UNORM:
+            EncodeBC7Mode6Block(block, dst);
+            break;
+        default:
+            assert(false);
+        }
+    }
+
+    // Squared error of the channels the format keeps
+    void AddBlockError(DXGI_FORMAT format, const Block& block, const uint8_t* src, TextureCompressionError& error)
+    {
+        Block decodedBlock = block;
+        size_t channelsCount = 4;
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+            DecodeBC1Block(src, false, decodedBlock);
+            channelsCount = 3;
+            break;
+        case DXGI_FORMAT_BC3_UNORM:
+            DecodeBC4Block(src, 3, decodedBlock);
+            DecodeBC1Block(src + 8, true, decodedBlock);
+            DecodeBC4Block(src, 3, decodedBlock);
+            break;
+        case DXGI_FORMAT_BC5_UNORM:
+            DecodeBC4Block(src, 0, decodedBlock);
+            DecodeBC4Block(src + 8, 1, decodedBlock);
+            channelsCount = 2;
+            break;
+        case DXGI_FORMAT_BC7_UNORM:
+            DecodeBC7Mode6Block(src, decodedBlock);
+            break;
+        default:
+            assert(false);
+        }
+
+        for (size_t i = 0; i < g_blockPixelsCount; ++i)
+        {
+            for (size_t c = 0; c < channelsCount; ++c)
+            {
+                const double diff = static_cast<double>(block.m_pixels[i][c]) - decodedBlock.m_pixels[i][c];
+                error.m_squaredError += diff * diff;
+            }
+        }
+        error.m_samplesCount += g_blockPixelsCount * channelsCount;
+    }
+
+    bool HasAlpha(const D3D12_SUBRESOURCE_DATA& level, size_t width, size_t height)
+    {
+        for (size_t y = 0; y < height; ++y)
+        {
+            const uint8_t* row = reinterpret_cast<const uint8_t*>(level.pData) + y * level.RowPitch;
+            for (size_t x = 0; x < width; ++x)
+            {
+                if (row[x * g_pixelSizeBytes + 3] != 255)
+                    return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+TextureData D3D12Basics::CompressTexture(const TextureData& textureData, TextureUsage usage, 
+                                         TextureCompression compression, TextureCompressionError& error)
+{
+    auto desc = textureData.GetDesc();
+    const auto& subresources = textureData.GetSubResources();
+
+    const size_t width = static_cast<size_t>(desc.Width);
+    const size_t height = desc.Height;
+    const bool isSupported = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D && desc.DepthOrArraySize == 1 &&
+                             desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM && subresources.size() == desc.MipLevels &&
+                             width % g_blockDimension == 0 && height % g_blockDimension == 0;
+    if (compression == TextureCompression::None || !isSupported)
+        return textureData;
+
+    DXGI_FORMAT format = DXGI_FORMAT_BC7_UNORM;
+    if (usage == TextureUsage::Normals)
+        format = DXGI_FORMAT_BC5_UNORM;
+    else if (compression == TextureCompression::Fast)
+        format = HasAlpha(subresources[0], width, height) ? DXGI_FORMAT_BC3_UNORM : DXGI_FORMAT_BC1_UNORM;
+
+    const size_t blockSizeBytes = format == DXGI_FORMAT_BC1_UNORM ? 8 : 16;
+
+    auto blocksCount = [](size_t size) { return std::max<size_t>((size + g_blockDimension - 1) / g_blockDimension, 1); };
+
+    size_t compressedSizeBytes = 0;
+    for (size_t level = 0; level < subresources.size(); ++level)
+    {
+        compressedSizeBytes += blocksCount(std::max<size_t>(width >> level, 1)) * 
+                               blocksCount(std::max<size_t>(height >> level, 1)) * blockSizeBytes;
+    }
+
+    auto rawData = std::make_unique<uint8_t[]>(compressedSizeBytes);
+    std::vector<D3D12_SUBRESOURCE_DATA> compressedSubresources(subresources.size());
+
+    uint8_t* dst = rawData.get();
+    Block block;
+    for (size_t level = 0; level < subresources.size(); ++level)
+    {
+        const size_t levelWidth = std::max<size_t>(width >> level, 1);
+        const size_t levelHeight = std::max<size_t>(height >> level, 1);
+        const size_t blocksX = blocksCount(levelWidth);
+        const size_t blocksY = blocksCount(levelHeight);
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(subresources[level].pData);
+        const size_t srcRowPitch = static_cast<size_t>(subresources[level].RowPitch);
+
+        const size_t rowPitch = blocksX * blockSizeBytes;
+        compressedSubresources[level] = { dst, static_cast<LONG_PTR>(rowPitch), static_cast<LONG_PTR>(rowPitch * blocksY) };
+
+        for (size_t blockY = 0; blockY < blocksY; ++blockY)
+        {
+            for (size_t blockX = 0; blockX < blocksX; ++blockX)
+            {
+                LoadBlock(src, levelWidth, levelHeight, srcRowPitch, blockX, blockY, block);
+                EncodeBlock(format, block, dst);
+
+                if (level == 0)
+                    AddBlockError(format, block, dst, error);
+
+                dst += blockSizeBytes;
+            }
+        }
+    }
+    assert(dst == rawData.get() + compressedSizeBytes);
+
+    desc.Format = format;
+
+    return TextureData{ desc, std::move(rawData), std::move(compressedSubresources) };
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// project includes
+#include "scene.h"
+
+// c++ includes
+#include <cmath>
+
+namespace D3D12Basics
+{
+    enum class TextureUsage
+    {
+        Color,
+        Normals,
+        Data
+    };
+
+    enum class TextureCompression
+    {
+        None,
+        // BC1 for opaque textures, BC3 for textures with alpha and BC5 for normals
+        Fast,
+        // BC7 instead of BC1 and BC3
+        Quality
+    };
+
+    // Compression error of the level 0 of the compressed textures
+    struct TextureCompressionError
+    {
+        double m_squaredError   = 0.0;
+        size_t m_samplesCount   = 0;
+
+        float PSNR() const
+        {
+            if (!m_samplesCount || m_squaredError == 0.0)
+                return 0.0f;
+
+            const double meanSquaredError = m_squaredError / m_samplesCount;
+            return static_cast<float>(10.0 * std::log10(255.0 * 255.0 / meanSquaredError));
+        }
+
+        void Add(const TextureCompressionError& error)
+        {
+            m_squaredError += error.m_squaredError;
+            m_samplesCount += error.m_samplesCount;
+        }
+    };
+
+    // Block compresses every level of the texture. Normals are compressed to BC5 so
+    // only their x and y are kept.
+    // NOTE only 2d R8G8B8A8_UNORM textures with the top level size multiple of 4 are
+    // supported, any other texture is returned as it is
+    // NOTE BC7 uses only the mode 6 (one subset, rgba endpoints, 4 bits indices)
+    TextureData CompressTexture(const TextureData& textureData, TextureUsage usage, TextureCompression compression,
+                                TextureCompressionError& error);
+}
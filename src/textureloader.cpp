@@ -0,0 +1,291 @@
+#include "textureloader.h"
+
+// project includes
+#include "mipgenerator.h"
+
+// c++ includes
+#include <cassert>
+#include <cwctype>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+
+// thirdparty libraries include
+#include "enkiTS/src/TaskScheduler.h"
+
+using namespace D3D12Basics;
+
+namespace
+{
+    // NOTE paths are case insensitive on windows
+    std::wstring NormalizePath(const std::wstring& path)
+    {
+        std::wstring normalizedPath = std::filesystem::path(path).lexically_normal().make_preferred().wstring();
+        std::transform(normalizedPath.begin(), normalizedPath.end(), normalizedPath.begin(), std::towlower);
+
+        return normalizedPath;
+    }
+
+    // NOTE bump it whenever the decoding, the mips generation or the compression change
+    // so the derived data cache entries are not used anymore
+    const uint32_t g_textureLoaderVersion = 1;
+
+    struct TextureDerivedDataParams
+    {
+        uint32_t m_version;
+        uint32_t m_usage;
+        uint32_t m_generateMips;
+        uint32_t m_compression;
+    };
+
+    struct TextureFile
+    {
+        const std::wstring*         m_path;
+        TextureUsage                m_usage;
+        MappedFilePtr               m_file;
+        uint64_t                    m_hash          = 0;
+        size_t                      m_contentIndex  = 0;
+        float                       m_readTime      = 0.0f;
+    };
+
+    struct DecodedTexture
+    {
+        TextureData                 m_data;
+        bool                        m_isCached              = false;
+        float                       m_cacheTime             = 0.0f;
+        size_t                      m_decodedSizeBytes      = 0;
+        float                       m_decodeTime            = 0.0f;
+        float                       m_mipsTime              = 0.0f;
+        float                       m_compressionTime       = 0.0f;
+        size_t                      m_mipsPixelsCount       = 0;
+        size_t                      m_compressedPixelsCount = 0;
+        size_t                      m_uncompressedSizeBytes = 0;
+        size_t                      m_compressedSizeBytes   = 0;
+        TextureCompressionError     m_compressionError;
+    };
+
+    size_t TextureSizeBytes(const TextureData& textureData)
+    {
+        size_t sizeBytes = 0;
+        for (const auto& subresource : textureData.GetSubResources())
+            sizeBytes += static_cast<size_t>(subresource.SlicePitch);
+
+        return sizeBytes;
+    }
+
+    size_t TexturePixelsCount(const TextureData& textureData)
+    {
+        const auto& desc = textureData.GetDesc();
+
+        size_t pixelsCount = 0;
+        for (size_t level = 0; level < desc.MipLevels; ++level)
+        {
+            pixelsCount += std::max<size_t>(static_cast<size_t>(desc.Width) >> level, 1) *
+                           std::max<size_t>(desc.Height >> level, 1);
+        }
+
+        return pixelsCount;
+    }
+}
+
+TextureLoader::TextureLoader(bool generateMips, TextureCompression compression, 
+                             DerivedDataCache* derivedDataCache) :  m_generateMips(generateMips),
+                                                                    m_compression(compression),
+                                                                    m_derivedDataCache(derivedDataCache)
+{
+}
+
+void TextureLoader::Request(const std::wstring& textureFile, TextureUsage usage)
+{
+    assert(!textureFile.empty());
+
+    ++m_stats.m_requestsCount;
+
+    auto& request = m_requests[NormalizePath(textureFile)];
+    if (!request.m_paths.empty())
+        ++m_stats.m_pathHitsCount;
+    else
+        request.m_usage = usage;
+
+    if (std::find(request.m_paths.begin(), request.m_paths.end(), textureFile) == request.m_paths.end())
+        request.m_paths.push_back(textureFile);
+}
+
+void TextureLoader::Load(enki::TaskScheduler& taskScheduler, const TextureLoadedCallback& textureLoaded)
+{
+    if (m_requests.empty())
+        return;
+
+    std::vector<TextureFile> files;
+    std::vector<const std::vector<std::wstring>*> filesRequestedPaths;
+    files.reserve(m_requests.size());
+    filesRequestedPaths.reserve(m_requests.size());
+    for (const auto& request : m_requests)
+    {
+        assert(!request.second.m_paths.empty());
+        files.push_back(TextureFile{ &request.second.m_paths[0], request.second.m_usage });
+        filesRequestedPaths.push_back(&request.second.m_paths);
+    }
+
+    // Map and hash
+    // NOTE hashing faults in the pages of the mapped file, that is the actual read
+    enki::TaskSet readTask(static_cast<uint32_t>(files.size()), 1, 1, [&files](enki::TaskSetPartition range, uint32_t)
+    {
+        for (uint32_t i = range.start; i < range.end; ++i)
+        {
+            RunningTime readTime;
+
+            auto& file = files[i];
+            file.m_file = std::make_shared<MappedFile>(*file.m_path);
+            assert(file.m_file->IsValid());
+            file.m_hash = HashBytes(file.m_file->Data(), file.m_file->SizeBytes());
+
+            file.m_readTime = readTime.Time();
+        }
+    });
+    taskScheduler.AddTaskSetToPipe(&readTask);
+    taskScheduler.WaitforTask(&readTask);
+
+    // Distinct contents
+    // NOTE same hash files are compared byte by byte so collisions dont alias textures.
+    // The same content is decoded twice if it is requested with different usages.
+    std::vector<size_t> contentsFileIndex;
+    std::unordered_map<uint64_t, std::vector<size_t>> contentsByHash;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        auto& file = files[i];
+        m_stats.m_mappedSizeBytes += file.m_file->SizeBytes();
+        m_stats.m_readTime += file.m_readTime;
+
+        auto& sameHashContents = contentsByHash[file.m_hash];
+        auto content = std::find_if(sameHashContents.begin(), sameHashContents.end(), [&](size_t contentIndex)
+        {
+            const auto& contentFile = files[contentsFileIndex[contentIndex]];
+            return  contentFile.m_usage == file.m_usage &&
+                    contentFile.m_file->SizeBytes() == file.m_file->SizeBytes() &&
+                    memcmp(contentFile.m_file->Data(), file.m_file->Data(), file.m_file->SizeBytes()) == 0;
+        });
+
+        if (content != sameHashContents.end())
+        {
+            file.m_contentIndex = *content;
+            ++m_stats.m_contentHitsCount;
+        }
+        else
+        {
+            file.m_contentIndex = contentsFileIndex.size();
+            sameHashContents.push_back(file.m_contentIndex);
+            contentsFileIndex.push_back(i);
+            ++m_stats.m_missesCount;
+        }
+    }
+
+    // Decode
+    std::vector<std::vector<std::wstring>> contentsRequestedPaths(contentsFileIndex.size());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        auto& contentRequestedPaths = contentsRequestedPaths[files[i].m_contentIndex];
+        contentRequestedPaths.insert(contentRequestedPaths.end(), filesRequestedPaths[i]->begin(), filesRequestedPaths[i]->end());
+    }
+
+    // Decode, generate the mips and block compress unless it is in the derived data cache
+    std::vector<DecodedTexture> textures(contentsFileIndex.size());
+    const auto decoderAllocationStats = SceneLoader::GetDecoderAllocationStats();
+    enki::TaskSet decodeTask(static_cast<uint32_t>(textures.size()), 1, 1, [&](enki::TaskSetPartition range, uint32_t)
+    {
+        for (uint32_t i = range.start; i < range.end; ++i)
+        {
+            const auto& file = files[contentsFileIndex[i]];
+            auto& texture = textures[i];
+
+            const TextureDerivedDataParams derivedDataParams
+            {
+                g_textureLoaderVersion,
+                static_cast<uint32_t>(file.m_usage),
+                m_generateMips ? 1u : 0u,
+                static_cast<uint32_t>(m_compression)
+            };
+            const auto derivedDataKey = CreateDerivedDataKey(file.m_hash, derivedDataParams);
+            if (m_derivedDataCache)
+            {
+                RunningTime cacheTime;
+                texture.m_isCached = m_derivedDataCache->LoadTexture(derivedDataKey, texture.m_data);
+                texture.m_cacheTime = cacheTime.Time();
+
+                if (texture.m_isCached)
+                {
+                    textureLoaded(contentsRequestedPaths[i], texture.m_data);
+                    continue;
+                }
+            }
+
+            RunningTime decodeTime;
+
+            texture.m_data = SceneLoader::LoadTextureData(*file.m_path, file.m_file->Data(), file.m_file->SizeBytes());
+            texture.m_decodedSizeBytes = TextureSizeBytes(texture.m_data);
+
+            texture.m_decodeTime = decodeTime.Time();
+
+            if (m_generateMips)
+            {
+                RunningTime mipsTime;
+
+                const auto mipLevelsCount = texture.m_data.GetDesc().MipLevels;
+                texture.m_data = GenerateMips(texture.m_data, file.m_usage == TextureUsage::Color);
+                if (texture.m_data.GetDesc().MipLevels != mipLevelsCount)
+                    texture.m_mipsPixelsCount = static_cast<size_t>(texture.m_data.GetDesc().Width) * texture.m_data.GetDesc().Height;
+
+                texture.m_mipsTime = mipsTime.Time();
+            }
+
+            if (m_compression != TextureCompression::None)
+            {
+                RunningTime compressionTime;
+
+                const auto format = texture.m_data.GetDesc().Format;
+                const size_t uncompressedSizeBytes = TextureSizeBytes(texture.m_data);
+                texture.m_data = CompressTexture(texture.m_data, file.m_usage, m_compression, texture.m_compressionError);
+                if (texture.m_data.GetDesc().Format != format)
+                {
+                    texture.m_compressedPixelsCount = TexturePixelsCount(texture.m_data);
+                    texture.m_uncompressedSizeBytes = uncompressedSizeBytes;
+                    texture.m_compressedSizeBytes = TextureSizeBytes(texture.m_data);
+                }
+
+                texture.m_compressionTime = compressionTime.Time();
+            }
+
+            textureLoaded(contentsRequestedPaths[i], texture.m_data);
+
+            if (m_derivedDataCache)
+            {
+                RunningTime cacheTime;
+                m_derivedDataCache->StoreTexture(derivedDataKey, texture.m_data);
+                texture.m_cacheTime += cacheTime.Time();
+            }
+        }
+    });
+    taskScheduler.AddTaskSetToPipe(&decodeTask);
+    taskScheduler.WaitforTask(&decodeTask);
+
+    const auto decodedAllocationStats = SceneLoader::GetDecoderAllocationStats();
+    m_stats.m_decoderAllocationsCount += decodedAllocationStats.m_allocationsCount - decoderAllocationStats.m_allocationsCount;
+    m_stats.m_decoderAllocatedSizeBytes += decodedAllocationStats.m_allocatedSizeBytes - decoderAllocationStats.m_allocatedSizeBytes;
+
+    for (const auto& texture : textures)
+    {
+        m_stats.m_cachedCount += texture.m_isCached ? 1 : 0;
+        m_stats.m_cacheTime += texture.m_cacheTime;
+        m_stats.m_decodedSizeBytes += texture.m_decodedSizeBytes;
+        m_stats.m_decodeTime += texture.m_decodeTime;
+        m_stats.m_mipsTime += texture.m_mipsTime;
+        m_stats.m_compressionTime += texture.m_compressionTime;
+        m_stats.m_mipsPixelsCount += texture.m_mipsPixelsCount;
+        m_stats.m_compressedPixelsCount += texture.m_compressedPixelsCount;
+        m_stats.m_uncompressedSizeBytes += texture.m_uncompressedSizeBytes;
+        m_stats.m_compressedSizeBytes += texture.m_compressedSizeBytes;
+        m_stats.m_compressionError.Add(texture.m_compressionError);
+    }
+
+    m_requests.clear();
+}
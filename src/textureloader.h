@@ -0,0 +1,105 @@
+#pragma once
+
+// project includes
+#include "scene.h"
+#include "texturecompression.h"
+#include "deriveddatacache.h"
+
+// c++ includes
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+namespace enki
+{
+    class TaskScheduler;
+}
+
+namespace D3D12Basics
+{
+    // Texture load requests deduplicated by normalised path and then by the hash of
+    // the files content, so the same image referenced through different paths or
+    // copied under different names is decoded once. All the requested paths of a
+    // content are handed over together sharing the decoded data.
+    // Each distinct content is looked up in the derived data cache, if any, before
+    // decoding it and stored in it once processed.
+    class TextureLoader
+    {
+    public:
+        // Called with the requested paths of each decoded texture as soon as it is
+        // ready. NOTE called concurrently from the decode tasks
+        using TextureLoadedCallback = std::function<void(const std::vector<std::wstring>& textureFiles,
+                                                         const TextureData& textureData)>;
+
+        // NOTE requests = path hits + content hits + misses
+        struct Stats
+        {
+            size_t  m_requestsCount     = 0;
+            size_t  m_pathHitsCount     = 0;
+            size_t  m_contentHitsCount  = 0;
+            size_t  m_missesCount       = 0;
+            size_t  m_mappedSizeBytes   = 0;
+
+            // Misses loaded from the derived data cache instead of decoded
+            size_t  m_cachedCount       = 0;
+
+            // NOTE cpu time summed over all the tasks
+            float   m_readTime          = 0.0f;
+            float   m_decodeTime        = 0.0f;
+            float   m_mipsTime          = 0.0f;
+            float   m_cacheTime         = 0.0f;
+
+            float   m_compressionTime   = 0.0f;
+
+            // Level 0 pixels of the textures with generated mips
+            size_t  m_mipsPixelsCount   = 0;
+
+            // All the levels pixels of the block compressed textures and their size
+            // before and after the compression
+            size_t  m_compressedPixelsCount     = 0;
+            size_t  m_uncompressedSizeBytes     = 0;
+            size_t  m_compressedSizeBytes       = 0;
+
+            TextureCompressionError m_compressionError;
+
+            // Decoder allocations and the size of the decoded levels 0 kept from them.
+            // NOTE the files are mapped and decoded from the mapping and the decoded
+            // pixels are not copied so there are no other allocations to decode
+            size_t  m_decoderAllocationsCount   = 0;
+            size_t  m_decoderAllocatedSizeBytes = 0;
+            size_t  m_decodedSizeBytes          = 0;
+        };
+
+        // NOTE derivedDataCache is optional
+        TextureLoader(bool generateMips, TextureCompression compression, DerivedDataCache* derivedDataCache);
+
+        // NOTE colour textures get gamma correct mips and normals are compressed to
+        // two channels. A path requested with different usages is loaded with the
+        // first one.
+        void Request(const std::wstring& textureFile, TextureUsage usage);
+
+        // Maps and hashes the requested files and decodes each distinct content,
+        // both in parallel on the task scheduler.
+        // NOTE blocks until all the requests are loaded
+        void Load(enki::TaskScheduler& taskScheduler, const TextureLoadedCallback& textureLoaded);
+
+        const Stats& GetStats() const { return m_stats; }
+
+    private:
+        struct TextureRequest
+        {
+            std::vector<std::wstring>   m_paths;
+            TextureUsage                m_usage = TextureUsage::Color;
+        };
+
+        const bool                  m_generateMips;
+        const TextureCompression    m_compression;
+        DerivedDataCache*           m_derivedDataCache;
+
+        // Requests by normalised path
+        std::unordered_map<std::wstring, TextureRequest> m_requests;
+
+        Stats m_stats;
+    };
+}
@@ -0,0 +1,198 @@
+#include "uploadtracker.h"
+
+// project includes
+#include "utils.h"
+
+// c++ includes
+#include <cassert>
+#include <algorithm>
+
+using namespace D3D12Basics;
+
+UploadTracker::UploadTracker(size_t stagingPageSizeBytes) : m_stagingPageSizeBytes(stagingPageSizeBytes),
+                                                            m_pendingSizeBytes(0),
+                                                            m_nextUploadId(m_finishedUploadId + 1),
+                                                            m_lastSubmittedUploadId(m_finishedUploadId),
+                                                            m_lastCompletedUploadId(m_finishedUploadId),
+                                                            m_submitBudgetSizeBytes(0)
+{
+    assert(m_stagingPageSizeBytes > 0);
+}
+
+bool UploadTracker::IsSubmitNeeded(size_t sizeBytes, size_t alignment) const
+{
+    size_t alignedOffset = 0;
+    if (m_pendingUploads.empty() || FitsCurrentPage(sizeBytes, alignment, alignedOffset))
+        return false;
+
+    const size_t maxPendingPagesCount = std::max<size_t>((m_submitBudgetSizeBytes + m_stagingPageSizeBytes - 1) / 
+                                                         m_stagingPageSizeBytes, 1);
+    const size_t pendingPagesCount = std::count_if(m_usedPages.begin(), m_usedPages.end(), [this](size_t pageIndex)
+    {
+        return m_stagingPages[pageIndex].m_lastUploadId > m_lastSubmittedUploadId;
+    });
+
+    return pendingPagesCount >= maxPendingPagesCount;
+}
+
+UploadTracker::StagingAllocation UploadTracker::AllocateStaging(size_t sizeBytes, size_t alignment)
+{
+    assert(sizeBytes > 0);
+
+    // Bump the offset in the current page
+    size_t alignedOffset = 0;
+    if (FitsCurrentPage(sizeBytes, alignment, alignedOffset))
+    {
+        auto& currentPage = m_stagingPages[m_usedPages.back()];
+        currentPage.m_offset = alignedOffset + sizeBytes;
+        return { m_usedPages.back(), currentPage.m_sizeBytes, alignedOffset, false };
+    }
+
+    // Recycle a free page or create a new one
+    StagingAllocation allocation;
+    if (sizeBytes <= m_stagingPageSizeBytes && !m_freePages.empty())
+    {
+        allocation.m_pageIndex = m_freePages.back();
+        allocation.m_isNewPage = false;
+        m_freePages.pop_back();
+    }
+    else
+    {
+        if (!m_releasedPages.empty())
+        {
+            allocation.m_pageIndex = m_releasedPages.back();
+            m_releasedPages.pop_back();
+        }
+        else
+        {
+            allocation.m_pageIndex = m_stagingPages.size();
+            m_stagingPages.emplace_back();
+        }
+        allocation.m_isNewPage = true;
+        m_stagingPages[allocation.m_pageIndex].m_sizeBytes = std::max(sizeBytes, m_stagingPageSizeBytes);
+    }
+    m_usedPages.push_back(allocation.m_pageIndex);
+
+    auto& page = m_stagingPages[allocation.m_pageIndex];
+    page.m_offset = sizeBytes;
+    page.m_lastUploadId = m_finishedUploadId;
+
+    allocation.m_pageSizeBytes = page.m_sizeBytes;
+    allocation.m_offset = 0;
+
+    return allocation;
+}
+
+UploadTracker::UploadId UploadTracker::AddPendingUpload(size_t pageIndex, size_t sizeBytes)
+{
+    assert(pageIndex < m_stagingPages.size());
+
+    const UploadId uploadId = m_nextUploadId++;
+    m_stagingPages[pageIndex].m_lastUploadId = uploadId;
+
+    m_pendingUploads.push_back({ uploadId, sizeBytes });
+    m_pendingSizeBytes += sizeBytes;
+
+    return uploadId;
+}
+
+size_t UploadTracker::PendingUploadsToSubmit(bool ignoreBudget) const
+{
+    if (ignoreBudget || !m_submitBudgetSizeBytes)
+        return m_pendingUploads.size();
+
+    size_t uploadsCount = 0;
+    size_t sizeBytes = 0;
+    for (const auto& upload : m_pendingUploads)
+    {
+        if (uploadsCount && sizeBytes + upload.m_sizeBytes > m_submitBudgetSizeBytes)
+            break;
+
+        sizeBytes += upload.m_sizeBytes;
+        ++uploadsCount;
+    }
+
+    return uploadsCount;
+}
+
+size_t UploadTracker::Submit(size_t uploadsCount, uint64_t fenceValue)
+{
+    assert(uploadsCount > 0 && uploadsCount <= m_pendingUploads.size());
+    assert(m_inFlightBatches.empty() || m_inFlightBatches.back().m_fenceValue < fenceValue);
+
+    size_t submittedSizeBytes = 0;
+    for (size_t i = 0; i < uploadsCount; ++i)
+    {
+        submittedSizeBytes += m_pendingUploads.front().m_sizeBytes;
+        m_lastSubmittedUploadId = m_pendingUploads.front().m_id;
+        m_pendingUploads.pop_front();
+    }
+    m_pendingSizeBytes -= submittedSizeBytes;
+
+    m_inFlightBatches.push_back({ fenceValue, m_lastSubmittedUploadId });
+
+    return submittedSizeBytes;
+}
+
+size_t UploadTracker::RetireCompletedBatches(uint64_t completedFenceValue, std::vector<size_t>& releasedPages)
+{
+    size_t retiredBatchesCount = 0;
+    while (!m_inFlightBatches.empty() && m_inFlightBatches.front().m_fenceValue <= completedFenceValue)
+    {
+        m_lastCompletedUploadId = m_inFlightBatches.front().m_lastUploadId;
+        m_inFlightBatches.pop_front();
+        ++retiredBatchesCount;
+    }
+
+    // Recycle the pages that only hold finished uploads. The current page is kept,
+    // just rewinded.
+    for (size_t i = 0; i < m_usedPages.size(); )
+    {
+        const size_t pageIndex = m_usedPages[i];
+        auto& page = m_stagingPages[pageIndex];
+        const bool isCurrentPage = i == m_usedPages.size() - 1;
+        if (page.m_lastUploadId > m_lastCompletedUploadId)
+        {
+            ++i;
+        }
+        else if (isCurrentPage)
+        {
+            page.m_offset = 0;
+            ++i;
+        }
+        else
+        {
+            page.m_offset = 0;
+            if (page.m_sizeBytes == m_stagingPageSizeBytes)
+            {
+                m_freePages.push_back(pageIndex);
+            }
+            else
+            {
+                m_releasedPages.push_back(pageIndex);
+                releasedPages.push_back(pageIndex);
+            }
+            m_usedPages.erase(m_usedPages.begin() + i);
+        }
+    }
+
+    return retiredBatchesCount;
+}
+
+bool UploadTracker::FitsCurrentPage(size_t sizeBytes, size_t alignment, size_t& alignedOffset) const
+{
+    if (m_usedPages.empty())
+        return false;
+
+    const auto& currentPage = m_stagingPages[m_usedPages.back()];
+    alignedOffset = AlignToPowerof2(currentPage.m_offset, alignment);
+    return alignedOffset + sizeBytes <= currentPage.m_sizeBytes;
+}
+
+void RegionUploadTracker::AddUpload(UploadId uploadId, size_t endBytes)
+{
+    assert(m_uploads.empty() || (uploadId > m_uploads.back().m_id && endBytes > m_uploads.back().m_endBytes));
+    assert(endBytes > m_readySizeBytes);
+
+    m_uploads.push_back({ uploadId, endBytes });
+}
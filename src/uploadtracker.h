@@ -0,0 +1,156 @@
+#pragma once
+
+// c++ includes
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+
+namespace D3D12Basics
+{
+    // Bookkeeping of D3D12UploadQueue: upload ids, staging pages and batches in flight.
+    // It doesnt know anything about the device so it can be tested without a gpu.
+    // - Upload ids are consecutive. A batch of submitted uploads is finished once the
+    //   fence value signaled for it is completed, and so are all the previous uploads.
+    // - Staging pages are bump allocated and refered to by index, the caller keeps the
+    //   upload buffers behind them. A page is recycled once all its uploads are finished.
+    //   Uploads bigger than the page size get a page of their own that is released then.
+    // - The pages holding uploads not submitted yet are capped to the submit budget,
+    //   rounded up to pages, or to one page without budget. Reaching the cap requires to
+    //   submit all the pending uploads, see IsSubmitNeeded.
+    class UploadTracker
+    {
+    public:
+        using UploadId = uint64_t;
+
+        static const UploadId m_finishedUploadId = 0;
+
+        struct StagingAllocation
+        {
+            size_t  m_pageIndex;
+            size_t  m_pageSizeBytes;
+            size_t  m_offset;
+
+            // NOTE the caller has to create the upload buffer of the page
+            bool    m_isNewPage;
+        };
+
+        UploadTracker(size_t stagingPageSizeBytes);
+
+        // 0 means no budget, ie all the pending uploads are submitted
+        void SetSubmitBudget(size_t budgetSizeBytes) { m_submitBudgetSizeBytes = budgetSizeBytes; }
+
+        // Whether the pending uploads have to be submitted before allocating staging
+        // memory for sizeBytes, as it would need another page over the cap
+        bool IsSubmitNeeded(size_t sizeBytes, size_t alignment) const;
+
+        StagingAllocation AllocateStaging(size_t sizeBytes, size_t alignment);
+
+        UploadId AddPendingUpload(size_t pageIndex, size_t sizeBytes);
+
+        // Count of the pending uploads, oldest first, that fit the budget
+        // NOTE at least one upload is always submitted so uploads bigger than the budget
+        // dont get stuck
+        size_t PendingUploadsToSubmit(bool ignoreBudget) const;
+
+        // Returns the size of the uploads submitted
+        size_t Submit(size_t uploadsCount, uint64_t fenceValue);
+
+        // Returns the count of the batches retired, oldest first. The pages released are
+        // added to releasedPages so the caller can destroy their upload buffers.
+        size_t RetireCompletedBatches(uint64_t completedFenceValue, std::vector<size_t>& releasedPages);
+
+        bool IsUploadFinished(UploadId uploadId) const { return uploadId <= m_lastCompletedUploadId; }
+
+        size_t PendingUploadsCount() const { return m_pendingUploads.size(); }
+
+        size_t PendingSizeBytes() const { return m_pendingSizeBytes; }
+
+        size_t InFlightBatchesCount() const { return m_inFlightBatches.size(); }
+
+        // NOTE the released pages are not counted
+        size_t StagingPagesCount() const { return m_usedPages.size() + m_freePages.size(); }
+
+    private:
+        struct StagingPage
+        {
+            size_t      m_sizeBytes;
+            size_t      m_offset;
+            UploadId    m_lastUploadId;
+        };
+
+        struct PendingUpload
+        {
+            UploadId    m_id;
+            size_t      m_sizeBytes;
+        };
+
+        struct Batch
+        {
+            uint64_t    m_fenceValue;
+            UploadId    m_lastUploadId;
+        };
+
+        const size_t m_stagingPageSizeBytes;
+
+        // NOTE pages are indices into m_stagingPages. The current page is the last used one.
+        std::vector<StagingPage>    m_stagingPages;
+        std::vector<size_t>         m_usedPages;
+        std::vector<size_t>         m_freePages;
+        std::vector<size_t>         m_releasedPages;
+
+        std::deque<PendingUpload>   m_pendingUploads;
+        std::deque<Batch>           m_inFlightBatches;
+        size_t                      m_pendingSizeBytes;
+
+        UploadId    m_nextUploadId;
+        UploadId    m_lastSubmittedUploadId;
+        UploadId    m_lastCompletedUploadId;
+
+        size_t      m_submitBudgetSizeBytes;
+
+        bool FitsCurrentPage(size_t sizeBytes, size_t alignment, size_t& alignedOffset) const;
+    };
+
+    // Bytes ready of a buffer uploaded by regions appended one after another, each
+    // region upload ending where the buffer size was then. The buffer is ready up to the
+    // end of its newest finished region upload, so the regions already uploaded can be
+    // used while newer ones keep being queued.
+    // NOTE the uploads finish in the order they were queued
+    class RegionUploadTracker
+    {
+    public:
+        using UploadId = UploadTracker::UploadId;
+
+        void AddUpload(UploadId uploadId, size_t endBytes);
+
+        // Moves the ready size to the end of the newest finished upload
+        // NOTE isUploadFinished(uploadId) is only called for the oldest uploads not
+        // known to be finished yet
+        template<typename IsUploadFinished>
+        size_t Update(IsUploadFinished isUploadFinished)
+        {
+            while (!m_uploads.empty() && isUploadFinished(m_uploads.front().m_id))
+            {
+                m_readySizeBytes = m_uploads.front().m_endBytes;
+                m_uploads.pop_front();
+            }
+
+            return m_readySizeBytes;
+        }
+
+        size_t ReadySizeBytes() const { return m_readySizeBytes; }
+
+        size_t PendingUploadsCount() const { return m_uploads.size(); }
+
+    private:
+        struct RegionUpload
+        {
+            UploadId    m_id;
+            size_t      m_endBytes;
+        };
+
+        std::deque<RegionUpload>    m_uploads;
+        size_t                      m_readySizeBytes = 0;
+    };
+}
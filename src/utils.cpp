@@ -122,53 +122,19 @@ namespace
     }
 }
 
-VertexStreams::VertexStreams() : m_vertexElementsCount(0)
+MeshData::MeshData(std::vector<float>&& vertices, std::vector<uint32_t>&& indices,
+                   size_t verticesCount, size_t vertexSizeBytes)    :   m_verticesCount(verticesCount), m_vertexSizeBytes(vertexSizeBytes),
+                                                                        m_indexSizeBytes(verticesCount > m_max16BitsIndexedVerticesCount ? 
+                                                                                         sizeof(uint32_t) : sizeof(uint16_t)),
+                                                                        m_vertexBufferSizeBytes(verticesCount * vertexSizeBytes),
+                                                                        m_indexBufferSizeBytes(indices.size() * m_indexSizeBytes),
+                                                                        m_vertices(std::move(vertices)),
+                                                                        m_indices(std::move(indices))
 {
-}
-
-void VertexStreams::AddStream(size_t elementsCount, std::vector<float>&& data)
-{
-    assert(elementsCount);
-    assert(data.size());
-
-    VertexStream stream;
-    stream.m_elementsCount = elementsCount;
-    stream.m_elementOffset = m_vertexElementsCount;
-    stream.m_data = std::move(data);
-
-    m_vertexElementsCount += stream.m_elementsCount;
-
-    m_streams.push_back(std::move(stream));
-}
-
-MeshData::MeshData(const std::vector<VertexStream>& streams,
-                   std::vector<uint16_t>&& indices, size_t verticesCount,
-                   size_t vertexSizeBytes, size_t vertexElementsCount)  :   m_verticesCount(verticesCount), m_vertexSizeBytes(vertexSizeBytes),
-                                                                            m_vertexBufferSizeBytes(0), m_indexBufferSizeBytes(0),
-                                                                            m_indices(std::move(indices))
-{
-    assert(streams.size());
     assert(m_vertexSizeBytes);
     assert(m_indices.size());
     assert(m_verticesCount);
-    assert(vertexElementsCount);
-
-    m_vertexBufferSizeBytes = m_verticesCount * m_vertexSizeBytes;
-    m_indexBufferSizeBytes = m_indices.size() * sizeof(uint16_t);
-    m_vertices.resize(m_verticesCount * vertexElementsCount);
-
-    // Interleave
-    for (auto& stream : streams)
-    {
-        assert(stream.m_data.size() == (stream.m_elementsCount * m_verticesCount));
-
-        for (size_t i = 0; i < verticesCount; ++i)
-        {
-            memcpy(&m_vertices[i * vertexElementsCount + stream.m_elementOffset],
-                   &stream.m_data[i * stream.m_elementsCount],
-                   stream.m_elementsCount * sizeof(float));
-        }
-    }
+    assert(m_vertices.size() * sizeof(float) == m_vertexBufferSizeBytes);
 }
 
 CustomWindow::CustomWindow(const Resolution& resolution)    :   m_resolutionChanged(false), 
@@ -421,4 +387,54 @@ std::vector<char> D3D12Basics::ReadFullFile(const std::wstring& fileName, bool r
     if (!readAsBinary)
         buffer[fileSize] = '\0';
     return buffer;
+}
+
+MappedFile::MappedFile(const std::wstring& fileName) :   m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr),
+                                                        m_data(nullptr), m_sizeBytes(0)
+{
+    m_file = CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0)
+        return;
+
+    // NOTE an empty file cant be mapped
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+        return;
+
+    m_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data)
+        m_sizeBytes = static_cast<size_t>(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+}
+
+uint64_t D3D12Basics::HashBytes(const void* data, size_t sizeBytes)
+{
+    const uint64_t fnvOffsetBasis = 14695981039346656037ull;
+    const uint64_t fnvPrime = 1099511628211ull;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    uint64_t hash = fnvOffsetBasis;
+    for (size_t i = 0; i < sizeBytes; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= fnvPrime;
+    }
+
+    return hash;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <vector>
 #include <array>
+#include <memory>
 
 // windows includes
 #include <windows.h>
@@ -29,6 +30,8 @@ namespace D3D12Basics
     const uint32_t g_1mb    = g_512kb << 1;
     const uint32_t g_2mb    = g_1mb << 1;
     const uint32_t g_4mb    = g_2mb << 1;
+    const uint32_t g_8mb    = g_4mb << 1;
+    const uint32_t g_16mb   = g_8mb << 1;
 
     using Float2    = DirectX::SimpleMath::Vector2;
     using Float3    = DirectX::SimpleMath::Vector3;
@@ -46,47 +49,17 @@ namespace D3D12Basics
     constexpr float M_RCP_PI    = 1.0f / M_PI;
     constexpr float M_RCP_2PI   = 1.0f / M_2PI;
 
-    struct VertexDesc
-    {
-        bool m_uv0;
-        bool m_normal;
-        bool m_tangent_bitangent;
-    };
-
-    struct VertexStream
-    {
-        size_t m_elementsCount;
-        size_t m_elementOffset;
-
-        std::vector<float> m_data;
-    };
-
-    class VertexStreams
-    {
-    public:
-        VertexStreams();
-
-        void AddStream(size_t elementsCount, std::vector<float>&& data);
-
-        const std::vector<VertexStream>& GetStreams() const { return m_streams; }
-
-        size_t VertexElementsCount() const { return m_vertexElementsCount; }
-
-    private:
-        size_t m_vertexElementsCount;
-
-        std::vector<VertexStream> m_streams;
-    };
-
     class MeshData
     {
     public:
-        static const uint32_t m_maxVertexCount = 0x0000ffff;
+        // NOTE meshes with more vertices than this use 32 bits indices in the gpu
+        static const uint32_t m_max16BitsIndexedVerticesCount = 0x0000ffff;
 
         MeshData() {}
 
-        MeshData(const std::vector<VertexStream>& streams, std::vector<uint16_t>&& indices,
-                 size_t verticesCount, size_t vertexSizeBytes, size_t vertexElementsCount);
+        // NOTE vertices interleaved as described by a VertexFormat
+        MeshData(std::vector<float>&& vertices, std::vector<uint32_t>&& indices,
+                 size_t verticesCount, size_t vertexSizeBytes);
 
         size_t VerticesCount() const { return m_verticesCount; }
         size_t VertexSizeBytes() const { return m_vertexSizeBytes; }
@@ -94,7 +67,10 @@ namespace D3D12Basics
         size_t IndicesCount() const { return m_indices.size(); }
 
         const std::vector<float>& Vertices() const { return m_vertices; }
-        const std::vector<uint16_t>& Indices() const { return m_indices; }
+        const std::vector<uint32_t>& Indices() const { return m_indices; }
+
+        // Index size in the gpu index buffer: 2 or 4 bytes depending on the vertices count
+        size_t IndexSizeBytes() const { return m_indexSizeBytes; }
 
         size_t VertexBufferSizeBytes() const { return m_vertexBufferSizeBytes; }
         size_t IndexBufferSizeBytes() const { return m_indexBufferSizeBytes; }
@@ -102,11 +78,12 @@ namespace D3D12Basics
     private:
         size_t m_verticesCount;
         size_t m_vertexSizeBytes;
+        size_t m_indexSizeBytes;
         size_t m_vertexBufferSizeBytes;
         size_t m_indexBufferSizeBytes;
 
         std::vector<float>      m_vertices;
-        std::vector<uint16_t>   m_indices;
+        std::vector<uint32_t>   m_indices;
     };
 
     struct Vector2i
@@ -158,6 +135,15 @@ namespace D3D12Basics
         return (value & (value - 1)) == 0;
     }
 
+    // NOTE rounds down, ie Log2(5) is 2
+    constexpr uint32_t Log2(size_t value)
+    {
+        uint32_t log2 = 0;
+        while (value >>= 1)
+            ++log2;
+        return log2;
+    }
+
     // TODO make it a bit more stdish?
     template<class T, uint8_t Size = 128>
     class CircularBuffer
@@ -271,4 +257,33 @@ namespace D3D12Basics
     bool IsAlignedToPowerof2(size_t value, size_t alignmentPower2);
 
     std::vector<char> ReadFullFile(const std::wstring& fileName, bool readAsBinary = false);
+
+    // Read only view of a whole file mapped in memory
+    class MappedFile
+    {
+    public:
+        // NOTE IsValid is false if the file cant be opened or is empty
+        MappedFile(const std::wstring& fileName);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool IsValid() const { return m_data != nullptr; }
+
+        const uint8_t* Data() const { return m_data; }
+
+        size_t SizeBytes() const { return m_sizeBytes; }
+
+    private:
+        HANDLE          m_file;
+        HANDLE          m_mapping;
+        const uint8_t*  m_data;
+        size_t          m_sizeBytes;
+    };
+    using MappedFilePtr = std::shared_ptr<MappedFile>;
+
+    // NOTE 64 bits FNV-1a, not a cryptographic hash
+    uint64_t HashBytes(const void* data, size_t sizeBytes);
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+
+// project includes
+#include "utils.h"
+
+// c++ includes
+#include <vector>
+#include <cstring>
+#include <cassert>
+#include <type_traits>
+
+// directx includes
+#include <d3d12.h>
+#include <DirectXPackedVector.h>
+
+namespace D3D12Basics
+{
+    // Vertex attributes: the cpu type, the semantic and the format the input assembler
+    // reads it with
+    struct PositionAttribute
+    {
+        using Type = Float3;
+        static constexpr const char*    m_semantic  = "POSITION";
+        static constexpr DXGI_FORMAT    m_format    = DXGI_FORMAT_R32G32B32_FLOAT;
+    };
+
+    struct UVAttribute
+    {
+        using Type = Float2;
+        static constexpr const char*    m_semantic  = "TEXCOORD";
+        static constexpr DXGI_FORMAT    m_format    = DXGI_FORMAT_R32G32_FLOAT;
+    };
+
+    struct NormalAttribute
+    {
+        using Type = Float3;
+        static constexpr const char*    m_semantic  = "NORMAL";
+        static constexpr DXGI_FORMAT    m_format    = DXGI_FORMAT_R32G32B32_FLOAT;
+    };
+
+    struct TangentAttribute
+    {
+        using Type = Float3;
+        static constexpr const char*    m_semantic  = "TANGENT";
+        static constexpr DXGI_FORMAT    m_format    = DXGI_FORMAT_R32G32B32_FLOAT;
+    };
+
+    struct BitangentAttribute
+    {
+        using Type = Float3;
+        static constexpr const char*    m_semantic  = "BINORMAL";
+        static constexpr DXGI_FORMAT    m_format    = DXGI_FORMAT_R32G32B32_FLOAT;
+    };
+
+    struct HalfUVAttribute
+    {
+        using Type = DirectX::PackedVector::XMHALF2;
+        static constexpr const char*    m_semantic  = "TEXCOORD";
+        static constexpr DXGI_FORMAT    m_format    = DXGI_FORMAT_R16G16_FLOAT;
+    };
+
+    // NOTE [-1, 1] mapped to [0, 1]
+    struct PackedNormalAttribute
+    {
+        using Type = DirectX::PackedVector::XMUDECN4;
+        static constexpr const char*    m_semantic  = "NORMAL";
+        static constexpr DXGI_FORMAT    m_format    = DXGI_FORMAT_R10G10B10A2_UNORM;
+    };
+
+    // NOTE [-1, 1] mapped to [0, 1]. w is the bitangent sign.
+    struct PackedTangentAttribute
+    {
+        using Type = DirectX::PackedVector::XMUDECN4;
+        static constexpr const char*    m_semantic  = "TANGENT";
+        static constexpr DXGI_FORMAT    m_format    = DXGI_FORMAT_R10G10B10A2_UNORM;
+    };
+
+    // Interleaved vertex made of the attributes in the given order. Stride and offsets
+    // are known at compile time and the input elements are built from the same
+    // attributes so the cpu layout and the pipelines input layout cant drift apart.
+    // Vertices are stored as 32 bits words in the float vertices of MeshData.
+    template<typename... Attributes>
+    struct VertexFormat
+    {
+        static_assert(sizeof...(Attributes) > 0, "VertexFormat needs at least one attribute");
+
+        static constexpr size_t m_strideBytes = (sizeof(typename Attributes::Type) + ...);
+        static_assert(m_strideBytes % sizeof(float) == 0, "VertexFormat has to fit in 32 bits words");
+
+        static constexpr size_t m_strideElements = m_strideBytes / sizeof(float);
+
+        template<typename Attribute>
+        static constexpr bool Has()
+        {
+            return (std::is_same_v<Attribute, Attributes> || ...);
+        }
+
+        template<typename Attribute>
+        static constexpr size_t OffsetBytes()
+        {
+            static_assert(Has<Attribute>(), "Attribute not in the VertexFormat");
+
+            constexpr bool isAttribute[] = { std::is_same_v<Attribute, Attributes>... };
+            constexpr size_t attributesSizeBytes[] = { sizeof(typename Attributes::Type)... };
+
+            size_t offset = 0;
+            for (size_t i = 0; !isAttribute[i]; ++i)
+                offset += attributesSizeBytes[i];
+
+            return offset;
+        }
+
+        static std::vector<D3D12_INPUT_ELEMENT_DESC> InputElements()
+        {
+            return
+            {
+                {
+                    Attributes::m_semantic, 0, Attributes::m_format, 0, static_cast<UINT>(OffsetBytes<Attributes>()),
+                    D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+                }...
+            };
+        }
+
+        static std::vector<float> CreateVertices(size_t verticesCount)
+        {
+            return std::vector<float>(verticesCount * m_strideElements);
+        }
+
+        // NOTE attributes not in the format are ignored at compile time so the
+        // generators can write all of them regardless of the format
+        template<typename Attribute>
+        static void Write(std::vector<float>& vertices, size_t vertexIndex, const typename Attribute::Type& value)
+        {
+            if constexpr (Has<Attribute>())
+            {
+                assert((vertexIndex + 1) * m_strideElements <= vertices.size());
+                memcpy(reinterpret_cast<uint8_t*>(&vertices[vertexIndex * m_strideElements]) + OffsetBytes<Attribute>(),
+                       &value, sizeof(value));
+            }
+        }
+
+        template<typename Attribute>
+        static typename Attribute::Type Read(const std::vector<float>& vertices, size_t vertexIndex)
+        {
+            assert((vertexIndex + 1) * m_strideElements <= vertices.size());
+
+            typename Attribute::Type value;
+            memcpy(&value, reinterpret_cast<const uint8_t*>(&vertices[vertexIndex * m_strideElements]) + OffsetBytes<Attribute>(),
+                   sizeof(value));
+            return value;
+        }
+    };
+
+    // Layout the meshes are loaded and generated with
+    using FullVertexFormat = VertexFormat<PositionAttribute, UVAttribute, NormalAttribute,
+                                          TangentAttribute, BitangentAttribute>;
+
+    // Layout the scene meshes are rendered with. 24 bytes instead of 56.
+    // NOTE positions are kept as floats so the meshes dont need per mesh bounds to
+    // dequantize them
+    using QuantizedVertexFormat = VertexFormat<PositionAttribute, HalfUVAttribute, PackedNormalAttribute,
+                                               PackedTangentAttribute>;
+    static_assert(QuantizedVertexFormat::m_strideBytes == 24, "Unexpected QuantizedVertexFormat size");
+
+    using QuadVertexFormat = VertexFormat<PositionAttribute, UVAttribute>;
+}
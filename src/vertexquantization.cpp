@@ -0,0 +1,48 @@
+#include "vertexquantization.h"
+
+// c++ includes
+#include <cassert>
+
+using namespace D3D12Basics;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+    // [-1, 1] to the [0, 1] range of the unorm formats
+    XMUDECN4 PackUnitVector(const Float3& v, float w)
+    {
+        return XMUDECN4(v.x * 0.5f + 0.5f, v.y * 0.5f + 0.5f, v.z * 0.5f + 0.5f, w);
+    }
+}
+
+MeshData D3D12Basics::QuantizeMesh(const MeshData& meshData)
+{
+    using SrcFormat = FullVertexFormat;
+    using DstFormat = QuantizedVertexFormat;
+
+    assert(meshData.VertexSizeBytes() == SrcFormat::m_strideBytes);
+
+    const size_t verticesCount = meshData.VerticesCount();
+    const auto& srcVertices = meshData.Vertices();
+    auto vertices = DstFormat::CreateVertices(verticesCount);
+
+    for (size_t i = 0; i < verticesCount; ++i)
+    {
+        const auto uv = SrcFormat::Read<UVAttribute>(srcVertices, i);
+        const auto normal = SrcFormat::Read<NormalAttribute>(srcVertices, i);
+        const auto tangent = SrcFormat::Read<TangentAttribute>(srcVertices, i);
+        const auto bitangent = SrcFormat::Read<BitangentAttribute>(srcVertices, i);
+
+        // 1 means the bitangent is cross(normal, tangent), 0 means it is flipped
+        const float bitangentSign = normal.Cross(tangent).Dot(bitangent) < 0.0f ? 0.0f : 1.0f;
+
+        DstFormat::Write<PositionAttribute>(vertices, i, SrcFormat::Read<PositionAttribute>(srcVertices, i));
+        DstFormat::Write<HalfUVAttribute>(vertices, i, XMHALF2(uv.x, uv.y));
+        DstFormat::Write<PackedNormalAttribute>(vertices, i, PackUnitVector(normal, 0.0f));
+        DstFormat::Write<PackedTangentAttribute>(vertices, i, PackUnitVector(tangent, bitangentSign));
+    }
+
+    auto indices = meshData.Indices();
+
+    return MeshData{ std::move(vertices), std::move(indices), verticesCount, DstFormat::m_strideBytes };
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// project includes
+#include "utils.h"
+#include "vertexformat.h"
+
+namespace D3D12Basics
+{
+    // Converts FullVertexFormat vertices to QuantizedVertexFormat: uv as half2 and
+    // normal and tangent as 10:10:10:2 unorm. The tangent w stores the bitangent sign
+    // so the bitangent is rebuilt in the vertex shader.
+    MeshData QuantizeMesh(const MeshData& meshData);
+}
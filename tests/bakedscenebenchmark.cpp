@@ -0,0 +1,138 @@
+// project includes
+#include "testframework.h"
+#include "bakedscene.h"
+#include "d3d12basicsengine.h"
+#include "meshoptimizer.h"
+#include "textureloader.h"
+#include "vertexformat.h"
+#include "vertexquantization.h"
+#include "utils.h"
+
+// c++ includes
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+
+// thirdparty libraries include
+#include "enkiTS/src/TaskScheduler.h"
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const wchar_t* g_sceneFile = L"./data/sponza/sponza.dae";
+    const wchar_t* g_dataWorkingPath = L"./data/sponza/";
+
+    const int g_bakedLoadsCount = 10;
+
+    // Loads the scene file as the engine does when it is not baked, without the derived
+    // data cache
+    void ImportScene(const D3D12BasicsEngine::Settings& settings, enki::TaskScheduler& taskScheduler, Scene& scene,
+                     MeshDataCache& meshDataCache, TextureDataCache& textureDataCache,
+                     MeshOptimizationStats& meshOptimizationStats)
+    {
+        SceneLoader sceneLoader(g_sceneFile, scene, g_dataWorkingPath, settings.m_keepSceneHierarchy);
+
+        TextureLoader textureLoader(settings.m_generateTextureMips, settings.m_textureCompression, nullptr);
+        auto requestTexture = [&](const std::wstring& textureFile, TextureUsage usage)
+        {
+            if (!textureFile.empty())
+                textureLoader.Request(textureFile, usage);
+        };
+
+        for (const auto& model : scene.m_models)
+        {
+            requestTexture(model.m_material.m_diffuseTexture, TextureUsage::Color);
+            requestTexture(model.m_material.m_normalsTexture, TextureUsage::Normals);
+            requestTexture(model.m_material.m_specularTexture, TextureUsage::Data);
+
+            if (meshDataCache.count(model.MeshId()))
+                continue;
+
+            const MeshData meshData = sceneLoader.LoadMesh<FullVertexFormat>(model.MeshId());
+            meshDataCache[model.MeshId()] = QuantizeMesh(OptimizeMesh(meshData, settings.m_optimizeMeshesOverdraw,
+                                                                      meshOptimizationStats));
+        }
+
+        // NOTE called concurrently from the decode tasks
+        std::mutex textureDataCacheMutex;
+        textureLoader.Load(taskScheduler, [&](const std::vector<std::wstring>& textureFiles,
+                                              const TextureData& textureData)
+        {
+            std::lock_guard<std::mutex> lock(textureDataCacheMutex);
+            for (const auto& textureFile : textureFiles)
+                textureDataCache[textureFile] = textureData;
+        });
+    }
+}
+
+// NOTE imports Sponza, bakes it and loads the baked file with the engine default
+// settings. The baked file is the one the engine writes next to the scene file. Run it
+// from the repository root. The baked file is in the file cache after baking it so it
+// measures a warm load.
+BENCHMARK(BakedSceneLoad)
+{
+    if (!std::filesystem::exists(g_sceneFile))
+    {
+        std::printf("    %ls not found, skipped\n", g_sceneFile);
+        return;
+    }
+
+    const D3D12BasicsEngine::Settings settings;
+    const BakedSceneSettings bakedSceneSettings{ settings.m_optimizeMeshesOverdraw, settings.m_generateTextureMips,
+                                                 settings.m_textureCompression, settings.m_keepSceneHierarchy };
+
+    enki::TaskScheduler taskScheduler;
+    taskScheduler.Initialize();
+
+    Scene importedScene;
+    MeshDataCache importedMeshDataCache;
+    TextureDataCache importedTextureDataCache;
+    MeshOptimizationStats importedMeshOptimizationStats;
+    RunningTime importTime;
+    ImportScene(settings, taskScheduler, importedScene, importedMeshDataCache, importedTextureDataCache,
+                importedMeshOptimizationStats);
+    const float importSeconds = importTime.Time();
+
+    RunningTime bakingTime;
+    CHECK(BakeScene(g_sceneFile, bakedSceneSettings, importedScene.m_models, importedMeshDataCache,
+                    importedTextureDataCache, importedMeshOptimizationStats));
+    const float bakingSeconds = bakingTime.Time();
+
+    float bakedLoadSeconds = 0.0f;
+    for (int i = 0; i < g_bakedLoadsCount; ++i)
+    {
+        Scene scene;
+        MeshDataCache meshDataCache;
+        TextureDataCache textureDataCache;
+        MeshOptimizationStats meshOptimizationStats;
+
+        RunningTime bakedLoadTime;
+        BakedSceneLoader bakedSceneLoader(g_sceneFile, bakedSceneSettings);
+        CHECK(bakedSceneLoader.IsValid());
+        if (!bakedSceneLoader.IsValid())
+            return;
+        bakedSceneLoader.Load(scene, meshDataCache, textureDataCache, meshOptimizationStats);
+        bakedLoadSeconds += bakedLoadTime.Time();
+
+        // NOTE the baked meshes ids are the baked meshes indices so the meshes are
+        // compared through the models
+        CHECK(scene.m_models.size() == importedScene.m_models.size());
+        CHECK(textureDataCache.size() == importedTextureDataCache.size());
+        for (size_t j = 0; j < std::min(scene.m_models.size(), importedScene.m_models.size()); ++j)
+        {
+            const auto& meshData = meshDataCache.at(scene.m_models[j].MeshId());
+            const auto& importedMeshData = importedMeshDataCache.at(importedScene.m_models[j].MeshId());
+            CHECK(meshData.Vertices() == importedMeshData.Vertices());
+            CHECK(meshData.Indices() == importedMeshData.Indices());
+        }
+    }
+
+    std::printf("    import %.3fs, baking %.3fs, baked load %.3fms (%d loads), %zu models %zu textures\n",
+                importSeconds, bakingSeconds, bakedLoadSeconds * 1000.0f / g_bakedLoadsCount, g_bakedLoadsCount,
+                importedScene.m_models.size(), importedTextureDataCache.size());
+    std::printf("    meshes ACMR %.3f -> %.3f ATVR %.3f -> %.3f\n",
+                importedMeshOptimizationStats.m_before.ACMR(), importedMeshOptimizationStats.m_after.ACMR(),
+                importedMeshOptimizationStats.m_before.ATVR(), importedMeshOptimizationStats.m_after.ATVR());
+}
@@ -0,0 +1,205 @@
+// project includes
+#include "testframework.h"
+#include "buddyallocator.h"
+#include "utils.h"
+
+// c++ includes
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    // NOTE same setup as the D3D12Gpu dynamic buffer allocator: 256 bytes min blocks,
+    // 64kb pages for the small allocations and 4mb pages for the rest
+    const size_t g_minBlockSizeBytes = 256;
+    const size_t g_smallPageSizeBytes = g_64kb;
+    const size_t g_bigPageSizeBytes = g_4mb;
+
+    struct TraceEvent
+    {
+        size_t m_allocationIndex;
+        size_t m_sizeBytes;
+        bool   m_isAllocation;
+    };
+
+    struct TraceAllocation
+    {
+        size_t m_pageIndex;
+        bool   m_isSmallPage;
+        size_t m_offset;
+    };
+
+    // Synthetic trace of a frame based renderer. Every frame allocates constant buffers
+    // and instance data that live for the frames in flight, and some buffers that live
+    // for a random amount of frames, ie the ones of the models being streamed in.
+    std::vector<TraceEvent> CreateTrace(size_t framesCount, size_t& allocationsCount)
+    {
+        const size_t framesInFlight = 3;
+        const size_t transientAllocationsPerFrame = 200;
+
+        std::mt19937 randomEngine(0);
+        std::uniform_int_distribution<size_t> transientSizeBytes(16, 16 * g_1kb);
+        std::uniform_int_distribution<size_t> persistentSizeBytes(g_1kb, g_1mb);
+        std::uniform_int_distribution<size_t> persistentLifetime(1, 1000);
+        std::bernoulli_distribution isPersistent(0.001);
+
+        std::vector<std::vector<TraceEvent>> deallocations(framesCount + 1001);
+        std::vector<TraceEvent> trace;
+
+        allocationsCount = 0;
+        for (size_t frame = 0; frame < framesCount; ++frame)
+        {
+            for (const auto& deallocation : deallocations[frame])
+                trace.push_back(deallocation);
+
+            for (size_t i = 0; i < transientAllocationsPerFrame; ++i)
+            {
+                const bool persistent = isPersistent(randomEngine);
+                const size_t sizeBytes = persistent ? persistentSizeBytes(randomEngine) : transientSizeBytes(randomEngine);
+                const size_t lifetime = persistent ? persistentLifetime(randomEngine) : framesInFlight;
+
+                const size_t allocationIndex = allocationsCount++;
+                trace.push_back({ allocationIndex, sizeBytes, true });
+                deallocations[frame + lifetime].push_back({ allocationIndex, sizeBytes, false });
+            }
+        }
+
+        return trace;
+    }
+
+    void AccumulateStats(const std::vector<BuddyAllocator>& pages, size_t& freeSizeBytes,
+                         size_t& largestFreeBlockSizeBytes)
+    {
+        for (const auto& page : pages)
+        {
+            freeSizeBytes += page.FreeSizeBytes();
+            largestFreeBlockSizeBytes = std::max(largestFreeBlockSizeBytes, page.LargestFreeBlockSizeBytes());
+        }
+    }
+}
+
+TEST(BuddyAllocatorSplitsAndCoalesces)
+{
+    const size_t sizeBytes = g_64kb;
+    BuddyAllocator allocator(sizeBytes, g_minBlockSizeBytes);
+
+    CHECK(allocator.Allocate(sizeBytes + 1) == BuddyAllocator::m_invalidOffset);
+    CHECK(allocator.BlockSizeBytes(1) == g_minBlockSizeBytes);
+    CHECK(allocator.BlockSizeBytes(g_minBlockSizeBytes + 1) == 2 * g_minBlockSizeBytes);
+
+    // NOTE offsets are aligned to the block size
+    std::vector<size_t> offsets;
+    for (size_t blockSizeBytes = g_minBlockSizeBytes; blockSizeBytes < sizeBytes; blockSizeBytes <<= 1)
+    {
+        const size_t offset = allocator.Allocate(blockSizeBytes);
+        CHECK(offset != BuddyAllocator::m_invalidOffset);
+        CHECK(IsAlignedToPowerof2(offset, blockSizeBytes));
+        offsets.push_back(offset);
+    }
+    CHECK(allocator.FreeSizeBytes() == g_minBlockSizeBytes);
+    CHECK(allocator.Allocate(g_minBlockSizeBytes) != BuddyAllocator::m_invalidOffset);
+    CHECK(allocator.FreeSizeBytes() == 0);
+    CHECK(allocator.Allocate(1) == BuddyAllocator::m_invalidOffset);
+
+    allocator.Deallocate(offsets.front());
+    CHECK(allocator.LargestFreeBlockSizeBytes() == g_minBlockSizeBytes);
+
+    // NOTE once everything is freed it is coalesced back into a single block
+    BuddyAllocator allocatorB(sizeBytes, g_minBlockSizeBytes);
+    offsets.clear();
+    for (size_t i = 0; i < sizeBytes / g_minBlockSizeBytes; ++i)
+        offsets.push_back(allocatorB.Allocate(g_minBlockSizeBytes));
+    std::shuffle(offsets.begin(), offsets.end(), std::mt19937(0));
+    for (size_t offset : offsets)
+        allocatorB.Deallocate(offset);
+    CHECK(allocatorB.FreeSizeBytes() == sizeBytes);
+    CHECK(allocatorB.LargestFreeBlockSizeBytes() == sizeBytes);
+}
+
+// NOTE replays the trace the way D3D12DynamicBufferAllocator::AllocateBuddy does: the
+// first page with a big enough free block is used, a new page is added otherwise
+BENCHMARK(BuddyAllocatorTraceReplay)
+{
+    const size_t framesCount = 10000;
+    size_t allocationsCount = 0;
+    const auto trace = CreateTrace(framesCount, allocationsCount);
+
+    std::vector<BuddyAllocator> smallPages;
+    std::vector<BuddyAllocator> bigPages;
+    std::vector<TraceAllocation> allocations(allocationsCount);
+
+    size_t maxSmallPagesCount = 0;
+    size_t maxBigPagesCount = 0;
+    float fragmentationSum = 0.0f;
+    float maxFragmentation = 0.0f;
+    size_t samplesCount = 0;
+
+    float replayTime = 0.0f;
+    RunningTime eventsTime;
+    for (size_t i = 0; i < trace.size(); ++i)
+    {
+        const auto& event = trace[i];
+        auto& allocation = allocations[event.m_allocationIndex];
+        if (event.m_isAllocation)
+        {
+            allocation.m_isSmallPage = event.m_sizeBytes < g_smallPageSizeBytes;
+            auto& pages = allocation.m_isSmallPage ? smallPages : bigPages;
+
+            allocation.m_offset = BuddyAllocator::m_invalidOffset;
+            for (size_t pageIndex = 0; pageIndex < pages.size(); ++pageIndex)
+            {
+                allocation.m_offset = pages[pageIndex].Allocate(event.m_sizeBytes);
+                if (allocation.m_offset != BuddyAllocator::m_invalidOffset)
+                {
+                    allocation.m_pageIndex = pageIndex;
+                    break;
+                }
+            }
+
+            if (allocation.m_offset == BuddyAllocator::m_invalidOffset)
+            {
+                pages.emplace_back(allocation.m_isSmallPage ? g_smallPageSizeBytes : g_bigPageSizeBytes,
+                                   g_minBlockSizeBytes);
+                allocation.m_pageIndex = pages.size() - 1;
+                allocation.m_offset = pages.back().Allocate(event.m_sizeBytes);
+            }
+            CHECK(allocation.m_offset != BuddyAllocator::m_invalidOffset);
+        }
+        else
+        {
+            auto& pages = allocation.m_isSmallPage ? smallPages : bigPages;
+            pages[allocation.m_pageIndex].Deallocate(allocation.m_offset);
+        }
+
+        // NOTE sampled outside the timing, once per 1000 events
+        if (i % 1000 == 999)
+        {
+            replayTime += eventsTime.Time();
+
+            size_t freeSizeBytes = 0;
+            size_t largestFreeBlockSizeBytes = 0;
+            AccumulateStats(smallPages, freeSizeBytes, largestFreeBlockSizeBytes);
+            AccumulateStats(bigPages, freeSizeBytes, largestFreeBlockSizeBytes);
+            const float fragmentation = freeSizeBytes ? 1.0f - static_cast<float>(largestFreeBlockSizeBytes) / 
+                                                               static_cast<float>(freeSizeBytes) : 0.0f;
+            fragmentationSum += fragmentation;
+            maxFragmentation = std::max(maxFragmentation, fragmentation);
+            ++samplesCount;
+
+            maxSmallPagesCount = std::max(maxSmallPagesCount, smallPages.size());
+            maxBigPagesCount = std::max(maxBigPagesCount, bigPages.size());
+
+            eventsTime.Reset();
+        }
+    }
+    replayTime += eventsTime.Time();
+
+    std::printf("    %zu events: %.1fns per event\n", trace.size(),
+                replayTime * 1e9f / static_cast<float>(trace.size()));
+    std::printf("    pages: %zu small (64kb), %zu big (4mb)\n", maxSmallPagesCount, maxBigPagesCount);
+    std::printf("    fragmentation: %.3f average, %.3f max\n",
+                fragmentationSum / static_cast<float>(std::max<size_t>(samplesCount, 1)), maxFragmentation);
+}
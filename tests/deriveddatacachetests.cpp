@@ -0,0 +1,247 @@
+// project includes
+#include "testframework.h"
+#include "deriveddatacache.h"
+#include "utils.h"
+
+// c++ includes
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const wchar_t* g_cachePath = L"./derivedcache_tests";
+
+    struct TestParams
+    {
+        uint32_t m_version;
+        uint32_t m_option;
+    };
+
+    // The sample data files when there is a data directory, synthetic contents otherwise
+    std::vector<std::vector<uint8_t>> LoadSources(size_t count)
+    {
+        std::vector<std::vector<uint8_t>> sources;
+
+        std::error_code error;
+        for (auto file = std::filesystem::recursive_directory_iterator("./data", error);
+             !error && file != std::filesystem::recursive_directory_iterator() && sources.size() < count;
+             file.increment(error))
+        {
+            if (!file->is_regular_file(error) || file->file_size(error) > g_1mb)
+                continue;
+
+            std::ifstream stream(file->path(), std::ios::binary);
+            std::vector<uint8_t> source((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            if (!source.empty())
+                sources.push_back(std::move(source));
+        }
+
+        while (sources.size() < count)
+            sources.push_back(std::vector<uint8_t>(256, static_cast<uint8_t>(sources.size())));
+
+        return sources;
+    }
+
+    // A triangle with the first bytes of the source as vertices
+    MeshData CreateMesh(const std::vector<uint8_t>& source)
+    {
+        std::vector<float> vertices(12);
+        for (size_t i = 0; i < vertices.size(); ++i)
+            vertices[i] = source[i % source.size()] / 255.0f;
+
+        return MeshData{ std::move(vertices), { 0, 1, 2 }, 3, 4 * sizeof(float) };
+    }
+
+    TextureData CreateTexture(uint8_t value)
+    {
+        const size_t width = 4;
+        const size_t rowPitch = width * 4;
+        std::shared_ptr<uint8_t[]> rawData(new uint8_t[rowPitch * width]);
+        memset(rawData.get(), value, rowPitch * width);
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width = width;
+        desc.Height = static_cast<UINT>(width);
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+
+        std::vector<D3D12_SUBRESOURCE_DATA> subresources(1);
+        subresources[0].pData = rawData.get();
+        subresources[0].RowPitch = static_cast<LONG_PTR>(rowPitch);
+        subresources[0].SlicePitch = static_cast<LONG_PTR>(rowPitch * width);
+
+        return TextureData{ desc, rawData, std::move(subresources) };
+    }
+
+    Model CreateModel(const std::wstring& name, size_t id, size_t meshId)
+    {
+        Model model{};
+        model.m_name = name;
+        model.m_type = Model::Type::MeshFile;
+        model.m_id = id;
+        model.m_meshId = meshId;
+        model.m_material.m_diffuseTexture = name + L"_diffuse.png";
+        model.m_material.m_shadowCaster = true;
+
+        return model;
+    }
+
+    void RemoveCache()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(g_cachePath, error);
+    }
+}
+
+// A first run misses every entry and writes it, a second run hits all of them
+TEST(DerivedDataCacheHitRate)
+{
+    RemoveCache();
+
+    const auto sources = LoadSources(8);
+    std::vector<DerivedDataKey> keys;
+    for (const auto& source : sources)
+        keys.push_back(CreateDerivedDataKey(HashBytes(source.data(), source.size()), TestParams{ 1, 0 }));
+
+    {
+        DerivedDataCache cache(g_cachePath, g_16mb);
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            MeshData meshData;
+            MeshOptimizationStats meshOptimizationStats;
+            CHECK(!cache.LoadMesh(keys[i], meshData, meshOptimizationStats));
+            cache.StoreMesh(keys[i], CreateMesh(sources[i]), meshOptimizationStats);
+        }
+
+        const auto stats = cache.GetStats();
+        CHECK(stats.m_missesCount == sources.size());
+        CHECK(stats.m_hitsCount == 0);
+        CHECK(stats.HitRate() == 0.0f);
+        CHECK(stats.m_writesCount == sources.size());
+        CHECK(stats.m_sizeBytes == stats.m_writtenSizeBytes);
+    }
+
+    DerivedDataCache cache(g_cachePath, g_16mb);
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        MeshData meshData;
+        MeshOptimizationStats meshOptimizationStats;
+        CHECK(cache.LoadMesh(keys[i], meshData, meshOptimizationStats));
+
+        const auto expectedMesh = CreateMesh(sources[i]);
+        CHECK(meshData.VerticesCount() == expectedMesh.VerticesCount());
+        CHECK(meshData.VertexSizeBytes() == expectedMesh.VertexSizeBytes());
+        CHECK(meshData.Vertices() == expectedMesh.Vertices());
+        CHECK(meshData.Indices() == expectedMesh.Indices());
+    }
+
+    // NOTE other params or another entry type are different entries
+    MeshData meshData;
+    MeshOptimizationStats meshOptimizationStats;
+    const DerivedDataKey otherParamsKey = CreateDerivedDataKey(keys[0].m_sourceHash, TestParams{ 1, 1 });
+    CHECK(!cache.LoadMesh(otherParamsKey, meshData, meshOptimizationStats));
+    TextureData textureData;
+    CHECK(!cache.LoadTexture(keys[0], textureData));
+
+    const auto stats = cache.GetStats();
+    CHECK(stats.m_hitsCount == sources.size());
+    CHECK(stats.m_missesCount == 2);
+    CHECK(stats.HitRate() == sources.size() / static_cast<float>(sources.size() + 2));
+    CHECK(stats.m_writesCount == 0);
+
+    RemoveCache();
+}
+
+TEST(DerivedDataCacheTexturesAndModels)
+{
+    RemoveCache();
+
+    DerivedDataCache cache(g_cachePath, g_16mb);
+
+    const DerivedDataKey textureKey = CreateDerivedDataKey(1, TestParams{ 1, 0 });
+    cache.StoreTexture(textureKey, CreateTexture(77));
+
+    TextureData textureData;
+    CHECK(cache.LoadTexture(textureKey, textureData));
+    CHECK(textureData.GetDesc().Width == 4);
+    CHECK(textureData.GetSubResources().size() == 1);
+    const uint8_t* pixels = static_cast<const uint8_t*>(textureData.GetSubResources()[0].pData);
+    CHECK(pixels[0] == 77 && pixels[63] == 77);
+
+    // NOTE the models are stored with their mesh index in the scene file and loaded
+    // after other models, ie with other ids
+    const std::vector<Model> models
+    {
+        CreateModel(L"floor", 10, 10),
+        CreateModel(L"column", 11, 11),
+        CreateModel(L"column instance", 12, 11)
+    };
+    const DerivedDataKey modelsKey = CreateDerivedDataKey(2, TestParams{ 1, 0 });
+    cache.StoreModels(modelsKey, 10, models);
+
+    std::vector<Model> loadedModels{ CreateModel(L"sphere", 0, 0) };
+    CHECK(cache.LoadModels(modelsKey, 1, loadedModels));
+    CHECK(loadedModels.size() == 4);
+    CHECK(loadedModels[1].m_name == L"floor" && loadedModels[1].m_id == 1 && loadedModels[1].MeshId() == 1);
+    CHECK(loadedModels[2].m_name == L"column" && loadedModels[2].m_id == 2 && loadedModels[2].MeshId() == 2);
+    CHECK(loadedModels[3].m_id == 3 && loadedModels[3].MeshId() == 2);
+    CHECK(loadedModels[3].m_material.m_diffuseTexture == L"column instance_diffuse.png");
+    CHECK(loadedModels[3].m_material.m_shadowCaster);
+    CHECK(!loadedModels[3].m_material.m_shadowReceiver);
+
+    std::vector<Model> missingModels;
+    CHECK(!cache.LoadModels(CreateDerivedDataKey(3, TestParams{ 1, 0 }), 0, missingModels));
+    CHECK(missingModels.empty());
+
+    textureData = TextureData{};
+    RemoveCache();
+}
+
+// The least recently used entries are removed first when going over the maximum size
+TEST(DerivedDataCacheEvictsLeastRecentlyUsed)
+{
+    RemoveCache();
+
+    const auto sources = LoadSources(4);
+    std::vector<DerivedDataKey> keys;
+    for (size_t i = 0; i < sources.size(); ++i)
+        keys.push_back(CreateDerivedDataKey(i, TestParams{ 1, 0 }));
+
+    size_t entrySizeBytes = 0;
+    {
+        DerivedDataCache cache(g_cachePath, g_16mb);
+        cache.StoreMesh(keys[0], CreateMesh(sources[0]), MeshOptimizationStats{});
+        entrySizeBytes = cache.GetStats().m_sizeBytes;
+    }
+
+    // NOTE room for 2 entries. The first one is used after the second and third are
+    // written so they are the least recently used when the fourth goes over the size.
+    DerivedDataCache cache(g_cachePath, entrySizeBytes * 2 + entrySizeBytes / 2);
+    cache.StoreMesh(keys[1], CreateMesh(sources[1]), MeshOptimizationStats{});
+
+    MeshData meshData;
+    MeshOptimizationStats meshOptimizationStats;
+    CHECK(cache.LoadMesh(keys[0], meshData, meshOptimizationStats));
+    CHECK(cache.GetStats().m_evictionsCount == 0);
+
+    cache.StoreMesh(keys[2], CreateMesh(sources[2]), MeshOptimizationStats{});
+    CHECK(cache.GetStats().m_evictionsCount == 1);
+    CHECK(!cache.LoadMesh(keys[1], meshData, meshOptimizationStats));
+
+    cache.StoreMesh(keys[3], CreateMesh(sources[3]), MeshOptimizationStats{});
+    const auto stats = cache.GetStats();
+    CHECK(stats.m_evictionsCount == 2);
+    CHECK(stats.m_sizeBytes == entrySizeBytes * 2);
+    CHECK(!cache.LoadMesh(keys[0], meshData, meshOptimizationStats));
+    CHECK(cache.LoadMesh(keys[2], meshData, meshOptimizationStats));
+    CHECK(cache.LoadMesh(keys[3], meshData, meshOptimizationStats));
+
+    RemoveCache();
+}
@@ -0,0 +1,237 @@
+// project includes
+#include "testframework.h"
+#include "frustumculling.h"
+#include "utils.h"
+
+// c++ includes
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const float g_nearPlane = 0.1f;
+    const float g_farPlane = 500.0f;
+
+    // Left handed perspective (row vectors) of a camera at the origin looking down +z
+    Matrix44 CreateWorldToClip()
+    {
+        const float fovY = 3.14159265f / 3.0f;
+        const float aspectRatio = 16.0f / 9.0f;
+        const float yScale = 1.0f / std::tan(fovY * 0.5f);
+        const float xScale = yScale / aspectRatio;
+        const float zScale = g_farPlane / (g_farPlane - g_nearPlane);
+
+        return Matrix44(xScale, 0.0f,   0.0f,                   0.0f,
+                        0.0f,   yScale, 0.0f,                   0.0f,
+                        0.0f,   0.0f,   zScale,                 1.0f,
+                        0.0f,   0.0f,   -g_nearPlane * zScale,  0.0f);
+    }
+
+    // Local boxes and the transforms placing them around the camera, as the scene models.
+    // About a quarter of them are in the camera frustum.
+    struct Objects
+    {
+        std::vector<Aabb>       m_localAabbs;
+        std::vector<Matrix44>   m_transforms;
+    };
+
+    Objects CreateObjects(size_t count, uint32_t seed)
+    {
+        std::mt19937 randomEngine(seed);
+        std::uniform_real_distribution<float> position(-g_farPlane, g_farPlane);
+        std::uniform_real_distribution<float> height(-50.0f, 50.0f);
+        std::uniform_real_distribution<float> extents(0.1f, 4.0f);
+        std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+        Objects objects;
+        objects.m_localAabbs.reserve(count);
+        objects.m_transforms.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            objects.m_localAabbs.push_back(Aabb{ Float3(0.0f, extents(randomEngine), 0.0f),
+                                                 Float3(extents(randomEngine), extents(randomEngine),
+                                                        extents(randomEngine)) });
+
+            const float s = scale(randomEngine);
+            const float a = angle(randomEngine);
+            objects.m_transforms.push_back(Matrix44(s * std::cos(a),    0.0f,               -s * std::sin(a),   0.0f,
+                                                    0.0f,               s,                  0.0f,               0.0f,
+                                                    s * std::sin(a),    0.0f,               s * std::cos(a),    0.0f,
+                                                    position(randomEngine), height(randomEngine),
+                                                    position(randomEngine), 1.0f));
+        }
+
+        return objects;
+    }
+
+    void UpdateWorldAabbs(const Objects& objects, AabbsSoA& worldAabbs, std::vector<Aabb>& aabbs)
+    {
+        const size_t count = objects.m_localAabbs.size();
+        worldAabbs.Resize(count);
+        aabbs.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            aabbs[i] = TransformAabb(objects.m_localAabbs[i], objects.m_transforms[i]);
+            worldAabbs.Set(i, aabbs[i]);
+        }
+    }
+
+    // Mismatches between the culling of [start, end) and the scalar test of each box
+    size_t CountMismatches(const Frustum& frustum, const std::vector<Aabb>& aabbs, size_t start, size_t end,
+                           const std::vector<uint8_t>& visibility)
+    {
+        size_t mismatchesCount = 0;
+        for (size_t i = start; i < end; ++i)
+        {
+            const uint8_t expected = IsAabbOutside(frustum, aabbs[i]) ? 0 : 1;
+            mismatchesCount += visibility[i] != expected ? 1 : 0;
+        }
+
+        return mismatchesCount;
+    }
+}
+
+TEST(IsAabbOutsideFrustumPlanes)
+{
+    const Frustum frustum = CreateFrustum(CreateWorldToClip());
+    const Float3 extents(1.0f, 1.0f, 1.0f);
+
+    CHECK(!IsAabbOutside(frustum, Aabb{ Float3(0.0f, 0.0f, 10.0f), extents }));
+    CHECK(IsAabbOutside(frustum, Aabb{ Float3(0.0f, 0.0f, -10.0f), extents }));
+    CHECK(IsAabbOutside(frustum, Aabb{ Float3(0.0f, 0.0f, g_farPlane + 2.0f), extents }));
+    CHECK(IsAabbOutside(frustum, Aabb{ Float3(-100.0f, 0.0f, 10.0f), extents }));
+    CHECK(IsAabbOutside(frustum, Aabb{ Float3(100.0f, 0.0f, 10.0f), extents }));
+    CHECK(IsAabbOutside(frustum, Aabb{ Float3(0.0f, -100.0f, 10.0f), extents }));
+    CHECK(IsAabbOutside(frustum, Aabb{ Float3(0.0f, 100.0f, 10.0f), extents }));
+
+    // NOTE the boxes crossing a plane are visible
+    CHECK(!IsAabbOutside(frustum, Aabb{ Float3(0.0f, 0.0f, 0.0f), extents }));
+    CHECK(!IsAabbOutside(frustum, Aabb{ Float3(0.0f, 0.0f, g_farPlane), extents }));
+    CHECK(!IsAabbOutside(frustum, Aabb{ Float3(-100.0f, 0.0f, 10.0f), Float3(95.0f, 1.0f, 1.0f) }));
+}
+
+// The 4 wide culling gives the same result as the scalar test, ranges not multiple of 4
+// and not starting at a multiple of 4 included
+TEST(CullMatchesScalarTest)
+{
+    const Frustum frustum = CreateFrustum(CreateWorldToClip());
+    const Objects objects = CreateObjects(1003, 1);
+
+    AabbsSoA worldAabbs;
+    std::vector<Aabb> aabbs;
+    UpdateWorldAabbs(objects, worldAabbs, aabbs);
+
+    std::vector<uint8_t> visibility(aabbs.size(), 2);
+    worldAabbs.Cull(frustum, 0, aabbs.size(), visibility.data());
+    CHECK(CountMismatches(frustum, aabbs, 0, aabbs.size(), visibility) == 0);
+
+    const size_t visibleCount = std::count(visibility.begin(), visibility.end(), static_cast<uint8_t>(1));
+    CHECK(visibleCount > 0 && visibleCount < aabbs.size());
+
+    std::fill(visibility.begin(), visibility.end(), static_cast<uint8_t>(2));
+    worldAabbs.Cull(frustum, 5, 998, visibility.data());
+    CHECK(CountMismatches(frustum, aabbs, 5, 998, visibility) == 0);
+    CHECK(visibility[4] == 2 && visibility[998] == 2);
+
+    // NOTE the translation moves the center, the rotation and the scale grow the extents
+    const Aabb unitAabb{ Float3(0.0f, 0.0f, 0.0f), Float3(1.0f, 1.0f, 1.0f) };
+    const float c = std::cos(3.14159265f / 4.0f);
+    const Aabb rotatedAabb = TransformAabb(unitAabb, Matrix44(2.0f * c, 0.0f, -2.0f * c, 0.0f,
+                                                              0.0f,     2.0f, 0.0f,      0.0f,
+                                                              2.0f * c, 0.0f, 2.0f * c,  0.0f,
+                                                              1.0f,     2.0f, 3.0f,      1.0f));
+    CHECK(rotatedAabb.m_center.x == 1.0f && rotatedAabb.m_center.y == 2.0f && rotatedAabb.m_center.z == 3.0f);
+    CHECK(std::fabs(rotatedAabb.m_extents.x - 4.0f * c) < 1e-5f);
+    CHECK(std::fabs(rotatedAabb.m_extents.y - 2.0f) < 1e-5f);
+    CHECK(std::fabs(rotatedAabb.m_extents.z - 4.0f * c) < 1e-5f);
+}
+
+// The 4 wide transform gives the bounds of TransformAabb, contiguous indices or not
+TEST(SetTransformedMatchesTransformAabb)
+{
+    const Objects objects = CreateObjects(1003, 3);
+
+    AabbsSoA localAabbs;
+    localAabbs.Resize(objects.m_localAabbs.size());
+    for (size_t i = 0; i < objects.m_localAabbs.size(); ++i)
+        localAabbs.Set(i, objects.m_localAabbs[i]);
+
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < 500; ++i)
+        indices.push_back(i);
+    for (size_t i = 501; i < objects.m_localAabbs.size(); i += 3)
+        indices.push_back(i);
+
+    AabbsSoA worldAabbs;
+    worldAabbs.Resize(objects.m_localAabbs.size());
+    worldAabbs.SetTransformed(localAabbs, objects.m_transforms.data(), indices.data(), indices.size());
+
+    size_t mismatchesCount = 0;
+    for (const size_t i : indices)
+    {
+        const Aabb expected = TransformAabb(objects.m_localAabbs[i], objects.m_transforms[i]);
+        const Aabb aabb = worldAabbs.Get(i);
+        const float error = std::max({ std::fabs(aabb.m_center.x - expected.m_center.x),
+                                       std::fabs(aabb.m_center.y - expected.m_center.y),
+                                       std::fabs(aabb.m_center.z - expected.m_center.z),
+                                       std::fabs(aabb.m_extents.x - expected.m_extents.x),
+                                       std::fabs(aabb.m_extents.y - expected.m_extents.y),
+                                       std::fabs(aabb.m_extents.z - expected.m_extents.z) });
+        mismatchesCount += error < 1e-3f ? 0 : 1;
+    }
+    CHECK(mismatchesCount == 0);
+}
+
+BENCHMARK(FrustumCullingThroughput)
+{
+    const Frustum frustum = CreateFrustum(CreateWorldToClip());
+    const int iterationsCount = 10;
+
+    for (size_t count : { 10000u, 100000u, 1000000u })
+    {
+        const Objects objects = CreateObjects(count, 7);
+
+        AabbsSoA worldAabbs;
+        std::vector<Aabb> aabbs;
+        std::vector<uint8_t> visibility(count);
+
+        // NOTE best of the iterations, the first ones warm up the caches
+        float updateSeconds = std::numeric_limits<float>::max();
+        float cullSeconds = std::numeric_limits<float>::max();
+        float scalarSeconds = std::numeric_limits<float>::max();
+        size_t scalarVisibleCount = 0;
+        for (int i = 0; i < iterationsCount; ++i)
+        {
+            RunningTime updateTime;
+            UpdateWorldAabbs(objects, worldAabbs, aabbs);
+            updateSeconds = std::min(updateSeconds, updateTime.Time());
+
+            RunningTime cullTime;
+            worldAabbs.Cull(frustum, 0, count, visibility.data());
+            cullSeconds = std::min(cullSeconds, cullTime.Time());
+
+            RunningTime scalarTime;
+            scalarVisibleCount = 0;
+            for (const auto& aabb : aabbs)
+                scalarVisibleCount += IsAabbOutside(frustum, aabb) ? 0 : 1;
+            scalarSeconds = std::min(scalarSeconds, scalarTime.Time());
+        }
+
+        const size_t visibleCount = std::count(visibility.begin(), visibility.end(), static_cast<uint8_t>(1));
+        CHECK(visibleCount == scalarVisibleCount);
+        CHECK(CountMismatches(frustum, aabbs, 0, count, visibility) == 0);
+
+        const float nsPerObject = 1000000000.0f / count;
+        std::printf("    %zu objects (%.1f%% visible): cull %.3fms %.2fns per object (scalar %.3fms %.2fns), "
+                    "bounds update %.3fms %.2fns per object\n",
+                    count, visibleCount * 100.0f / count, cullSeconds * 1000.0f, cullSeconds * nsPerObject,
+                    scalarSeconds * 1000.0f, scalarSeconds * nsPerObject, updateSeconds * 1000.0f,
+                    updateSeconds * nsPerObject);
+    }
+}
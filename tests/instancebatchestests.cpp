@@ -0,0 +1,151 @@
+// project includes
+#include "testframework.h"
+#include "instancebatches.h"
+
+using namespace D3D12Basics;
+
+namespace
+{
+    bool IsBatch(const InstanceBatch& batch, size_t meshId, size_t firstInstance, size_t instancesCount)
+    {
+        return  batch.m_key.m_meshId == meshId && batch.m_firstInstance == firstInstance &&
+                batch.m_instancesCount == instancesCount;
+    }
+
+    size_t BatchesCount(const std::vector<InstanceKey>& keys)
+    {
+        std::vector<size_t> instances;
+        std::vector<InstanceBatch> batches;
+        BuildInstanceBatches(keys, 0, instances, batches);
+
+        return batches.size();
+    }
+}
+
+// The batches are in the order their first item appears and the items of a batch keep
+// their order
+TEST(BuildInstanceBatchesIsStable)
+{
+    const std::vector<InstanceKey> keys
+    {
+        { 7, 0 }, { 3, 0 }, { 7, 0 }, { 7, 1 }, { 3, 0 }, { 7, 0 }
+    };
+
+    std::vector<size_t> instances;
+    std::vector<InstanceBatch> batches;
+    BuildInstanceBatches(keys, 0, instances, batches);
+
+    CHECK(instances == std::vector<size_t>({ 0, 2, 5, 1, 4, 3 }));
+    CHECK(batches.size() == 3);
+    CHECK(IsBatch(batches[0], 7, 0, 3) && batches[0].m_key.m_stateId == 0);
+    CHECK(IsBatch(batches[1], 3, 3, 2));
+    CHECK(IsBatch(batches[2], 7, 5, 1) && batches[2].m_key.m_stateId == 1);
+
+    // NOTE the outputs are reused
+    BuildInstanceBatches({ { 1, 1 } }, 0, instances, batches);
+    CHECK(instances == std::vector<size_t>({ 0 }));
+    CHECK(batches.size() == 1 && IsBatch(batches[0], 1, 0, 1));
+
+    BuildInstanceBatches({}, 0, instances, batches);
+    CHECK(instances.empty() && batches.empty());
+}
+
+TEST(BuildInstanceBatchesSplitsAtMaxInstances)
+{
+    const std::vector<InstanceKey> keys
+    {
+        { 1, 0 }, { 2, 0 }, { 1, 0 }, { 1, 0 }, { 1, 0 }, { 2, 0 }, { 1, 0 }
+    };
+
+    std::vector<size_t> instances;
+    std::vector<InstanceBatch> batches;
+    BuildInstanceBatches(keys, 2, instances, batches);
+
+    // NOTE a full batch is closed and the next item of its key opens a new one
+    CHECK(instances == std::vector<size_t>({ 0, 2, 1, 5, 3, 4, 6 }));
+    CHECK(batches.size() == 4);
+    CHECK(IsBatch(batches[0], 1, 0, 2));
+    CHECK(IsBatch(batches[1], 2, 2, 2));
+    CHECK(IsBatch(batches[2], 1, 4, 2));
+    CHECK(IsBatch(batches[3], 1, 6, 1));
+
+    // NOTE 1 is a batch per item, ie instancing disabled
+    BuildInstanceBatches(keys, 1, instances, batches);
+    CHECK(batches.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+        CHECK(instances[i] == i && IsBatch(batches[i], keys[i].m_meshId, i, 1));
+}
+
+// Any difference in the mesh, pipeline state, shadow receiving or views splits the forward
+// pass batches. The shadow pass only splits by mesh. Both split at the blocks boundaries.
+TEST(InstanceKeysBuilderSplits)
+{
+    const std::vector<size_t> views{ 10, 11 };
+    const std::vector<size_t> otherViews{ 10, 12 };
+
+    InstanceKeysBuilder keysBuilder(1024);
+    keysBuilder.Add(1, 0, true, views);
+    keysBuilder.Add(1, 0, true, views);
+    keysBuilder.Add(2, 0, true, views);
+    keysBuilder.Add(1, 5, true, views);
+    keysBuilder.Add(1, 0, false, views);
+    keysBuilder.Add(1, 0, true, otherViews);
+    keysBuilder.Add(1, 0, true, {});
+
+    const auto& forwardKeys = keysBuilder.ForwardKeys();
+    const auto& shadowKeys = keysBuilder.ShadowKeys();
+    CHECK(forwardKeys.size() == 7 && shadowKeys.size() == 7);
+    CHECK(forwardKeys[0] == forwardKeys[1]);
+    CHECK(BatchesCount(forwardKeys) == 6);
+    CHECK(BatchesCount(shadowKeys) == 2);
+
+    // NOTE the state ids dont depend on the mesh
+    CHECK(forwardKeys[2].m_stateId == forwardKeys[0].m_stateId);
+    CHECK(forwardKeys[2].m_meshId != forwardKeys[0].m_meshId);
+
+    InstanceKeysBuilder blocksKeysBuilder(3);
+    for (size_t i = 0; i < 8; ++i)
+        blocksKeysBuilder.Add(1, 0, true, views);
+
+    std::vector<size_t> instances;
+    std::vector<InstanceBatch> batches;
+    BuildInstanceBatches(blocksKeysBuilder.ForwardKeys(), 0, instances, batches);
+    CHECK(batches.size() == 3);
+    CHECK(IsBatch(batches[0], 1, 0, 3) && IsBatch(batches[1], 1, 3, 3) && IsBatch(batches[2], 1, 6, 2));
+
+    BuildInstanceBatches(blocksKeysBuilder.ShadowKeys(), 0, instances, batches);
+    CHECK(batches.size() == 3);
+    CHECK(IsBatch(batches[0], 1, 0, 3) && IsBatch(batches[1], 1, 3, 3) && IsBatch(batches[2], 1, 6, 2));
+    CHECK(instances == std::vector<size_t>({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+}
+
+// The visible instances are packed at the start of their batch range, in order
+TEST(FilterInstanceBatchesKeepsTheVisibleOnes)
+{
+    const std::vector<InstanceKey> keys
+    {
+        { 1, 0 }, { 2, 0 }, { 1, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 1, 0 }
+    };
+
+    std::vector<size_t> instances;
+    std::vector<InstanceBatch> batches;
+    BuildInstanceBatches(keys, 0, instances, batches);
+    CHECK(batches.size() == 3);
+
+    const std::vector<uint8_t> visibility{ 0, 1, 1, 0, 1, 0, 1 };
+    VisibleInstances visibleInstances;
+    CHECK(FilterInstanceBatches(instances, batches, visibility, visibleInstances) == 4);
+    CHECK(visibleInstances.m_instancesCount == std::vector<size_t>({ 2, 2, 0 }));
+
+    const auto& visible = visibleInstances.m_instances;
+    CHECK(visible[batches[0].m_firstInstance] == 2 && visible[batches[0].m_firstInstance + 1] == 6);
+    CHECK(visible[batches[1].m_firstInstance] == 1 && visible[batches[1].m_firstInstance + 1] == 4);
+
+    const std::vector<uint8_t> allVisible(keys.size(), 1);
+    CHECK(FilterInstanceBatches(instances, batches, allVisible, visibleInstances) == keys.size());
+    CHECK(visibleInstances.m_instances == instances);
+
+    const std::vector<uint8_t> noneVisible(keys.size(), 0);
+    CHECK(FilterInstanceBatches(instances, batches, noneVisible, visibleInstances) == 0);
+    CHECK(visibleInstances.m_instancesCount == std::vector<size_t>({ 0, 0, 0 }));
+}
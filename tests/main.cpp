@@ -0,0 +1,63 @@
+// project includes
+#include "testframework.h"
+
+// c++ includes
+#include <cstdio>
+#include <cstring>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    int g_failuresCount = 0;
+}
+
+std::vector<Tests::TestCase>& Tests::TestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+void Tests::ReportFailure(const char* file, int line, const char* expression)
+{
+    ++g_failuresCount;
+    std::printf("    %s(%d): CHECK(%s) failed\n", file, line, expression);
+}
+
+// NOTE usage: D3D12BasicsTests [--bench] [name]
+//  --bench also runs the benchmarks
+//  name    only runs the tests and benchmarks with that name
+int main(int argc, char** argv)
+{
+    bool runBenchmarks = false;
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--bench") == 0)
+            runBenchmarks = true;
+        else
+            filter = argv[i];
+    }
+
+    int failedTestsCount = 0;
+    for (const auto& testCase : Tests::TestCases())
+    {
+        if (testCase.m_isBenchmark && !runBenchmarks)
+            continue;
+        if (filter && std::strcmp(filter, testCase.m_name) != 0)
+            continue;
+
+        std::printf("[ RUN  ] %s\n", testCase.m_name);
+
+        const int failuresCount = g_failuresCount;
+        testCase.m_function();
+
+        const bool failed = g_failuresCount != failuresCount;
+        std::printf("[ %s ] %s\n", failed ? "FAIL" : " OK ", testCase.m_name);
+        failedTestsCount += failed ? 1 : 0;
+    }
+
+    std::printf("%d test(s) failed\n", failedTestsCount);
+
+    return failedTestsCount ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+// project includes
+#include "testframework.h"
+#include "matrixbatch.h"
+#include "frustumculling.h"
+#include "utils.h"
+
+// c++ includes
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    // NOTE as the renderer per object data
+    struct ObjectTransforms
+    {
+        Matrix44 m_world;
+        Matrix44 m_normalWorld;
+    };
+
+    Matrix44 CreateTransform(std::mt19937& randomEngine)
+    {
+        std::uniform_real_distribution<float> values(-10.0f, 10.0f);
+
+        Matrix44 transform;
+        for (auto& row : transform.m)
+            for (auto& value : row)
+                value = values(randomEngine);
+
+        return transform;
+    }
+}
+
+TEST(TransposeMatricesOnlyTheIndices)
+{
+    std::mt19937 randomEngine(1);
+    std::vector<Matrix44> matrices;
+    for (size_t i = 0; i < 8; ++i)
+        matrices.push_back(CreateTransform(randomEngine));
+
+    const std::vector<size_t> indices{ 1, 2, 6 };
+    std::vector<ObjectTransforms> results(matrices.size());
+    TransposeMatrices(matrices.data(), indices.data(), indices.size(), &results[0].m_normalWorld,
+                      sizeof(ObjectTransforms));
+
+    size_t mismatchesCount = 0;
+    for (size_t i = 0; i < matrices.size(); ++i)
+    {
+        const bool transposed = std::find(indices.begin(), indices.end(), i) != indices.end();
+        for (size_t row = 0; row < 4; ++row)
+        {
+            for (size_t column = 0; column < 4; ++column)
+            {
+                const float expected = transposed ? matrices[i].m[column][row] : Matrix44().m[row][column];
+                mismatchesCount += results[i].m_normalWorld.m[row][column] == expected ? 0 : 1;
+                mismatchesCount += results[i].m_world.m[row][column] == Matrix44().m[row][column] ? 0 : 1;
+            }
+        }
+    }
+    CHECK(mismatchesCount == 0);
+}
+
+// The cpu work of the renderer per moved object: the transposed world and normal transforms
+// of the object data, the world bounds and the culling against the camera and the 2 lights.
+// NOTE a single thread, the renderer splits it in task scheduler partitions. The target is
+// 100k dynamic objects under 1ms.
+BENCHMARK(ObjectsUpdateThroughput)
+{
+    const int iterationsCount = 10;
+
+    Frustum frustum;
+    frustum.m_planes[0] = Float4(1.0f, 0.0f, 0.0f, 0.0f);
+    frustum.m_planes[1] = Float4(-1.0f, 0.0f, 0.0f, 5.0f);
+    frustum.m_planes[2] = Float4(0.0f, 1.0f, 0.0f, 5.0f);
+    frustum.m_planes[3] = Float4(0.0f, -1.0f, 0.0f, 5.0f);
+    frustum.m_planes[4] = Float4(0.0f, 0.0f, 1.0f, 5.0f);
+    frustum.m_planes[5] = Float4(0.0f, 0.0f, -1.0f, 5.0f);
+
+    for (size_t count : { 10000u, 100000u })
+    {
+        std::mt19937 randomEngine(7);
+        std::uniform_real_distribution<float> extents(0.1f, 4.0f);
+
+        std::vector<Matrix44> worldTransforms;
+        std::vector<Matrix44> normalTransforms;
+        AabbsSoA localBounds;
+        localBounds.Resize(count);
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < count; ++i)
+        {
+            worldTransforms.push_back(CreateTransform(randomEngine));
+            normalTransforms.push_back(CreateTransform(randomEngine));
+            localBounds.Set(i, Aabb{ Float3(0.0f, 0.0f, 0.0f),
+                                     Float3(extents(randomEngine), extents(randomEngine), extents(randomEngine)) });
+            indices.push_back(i);
+        }
+
+        std::vector<ObjectTransforms> objectData(count);
+        AabbsSoA worldBounds;
+        worldBounds.Resize(count);
+        std::vector<uint8_t> visibility[3];
+        for (auto& viewVisibility : visibility)
+            viewVisibility.resize(count);
+
+        // NOTE best of the iterations, the first ones warm up the caches
+        float transformsSeconds = std::numeric_limits<float>::max();
+        float boundsSeconds = std::numeric_limits<float>::max();
+        float scalarBoundsSeconds = std::numeric_limits<float>::max();
+        float cullSeconds = std::numeric_limits<float>::max();
+        for (int i = 0; i < iterationsCount; ++i)
+        {
+            RunningTime transformsTime;
+            TransposeMatrices(worldTransforms.data(), indices.data(), count, &objectData[0].m_world,
+                              sizeof(ObjectTransforms));
+            TransposeMatrices(normalTransforms.data(), indices.data(), count, &objectData[0].m_normalWorld,
+                              sizeof(ObjectTransforms));
+            transformsSeconds = std::min(transformsSeconds, transformsTime.Time());
+
+            RunningTime scalarBoundsTime;
+            for (const size_t index : indices)
+                worldBounds.Set(index, TransformAabb(localBounds.Get(index), worldTransforms[index]));
+            scalarBoundsSeconds = std::min(scalarBoundsSeconds, scalarBoundsTime.Time());
+
+            RunningTime boundsTime;
+            worldBounds.SetTransformed(localBounds, worldTransforms.data(), indices.data(), count);
+            boundsSeconds = std::min(boundsSeconds, boundsTime.Time());
+
+            RunningTime cullTime;
+            for (auto& viewVisibility : visibility)
+                worldBounds.Cull(frustum, 0, count, viewVisibility.data());
+            cullSeconds = std::min(cullSeconds, cullTime.Time());
+        }
+
+        const float totalSeconds = transformsSeconds + boundsSeconds + cullSeconds;
+        const float per100kSeconds = totalSeconds * 100000.0f / count;
+        std::printf("    %zu objects: %.3fms, %.3fms per 100k (target 1ms): transforms %.3fms bounds %.3fms "
+                    "(scalar %.3fms) culling 3 views %.3fms\n",
+                    count, totalSeconds * 1000.0f, per100kSeconds * 1000.0f, transformsSeconds * 1000.0f,
+                    boundsSeconds * 1000.0f, scalarBoundsSeconds * 1000.0f, cullSeconds * 1000.0f);
+    }
+}
@@ -0,0 +1,153 @@
+// project includes
+#include "testframework.h"
+#include "meshoptimizer.h"
+#include "meshgenerator.h"
+#include "vertexformat.h"
+
+// c++ includes
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    using Vertex = std::vector<float>;
+    using Triangle = std::vector<Vertex>;
+
+    Vertex GetVertex(const MeshData& meshData, uint32_t index)
+    {
+        const size_t strideElements = meshData.VertexSizeBytes() / sizeof(float);
+        const auto begin = meshData.Vertices().begin() + index * strideElements;
+        return Vertex(begin, begin + strideElements);
+    }
+
+    // Triangles by the content of their vertices so they can be compared after the vertices
+    // are reordered. Each triangle starts by its smallest vertex, which keeps the winding.
+    std::vector<Triangle> SortedTriangles(const MeshData& meshData)
+    {
+        const auto& indices = meshData.Indices();
+
+        std::vector<Triangle> triangles;
+        triangles.reserve(indices.size() / 3);
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            Triangle triangle{ GetVertex(meshData, indices[i]), GetVertex(meshData, indices[i + 1]),
+                               GetVertex(meshData, indices[i + 2]) };
+            std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+            triangles.push_back(std::move(triangle));
+        }
+        std::sort(triangles.begin(), triangles.end());
+
+        return triangles;
+    }
+
+    // NOTE the generated meshes are already cache friendly, shuffling the triangles and the
+    // vertices gives the unordered meshes the optimizer is there for
+    MeshData ShuffleMesh(const MeshData& meshData, uint32_t seed)
+    {
+        std::mt19937 randomEngine(seed);
+
+        const size_t verticesCount = meshData.VerticesCount();
+        std::vector<uint32_t> vertexRemap(verticesCount);
+        std::iota(vertexRemap.begin(), vertexRemap.end(), 0);
+        std::shuffle(vertexRemap.begin(), vertexRemap.end(), randomEngine);
+
+        const size_t strideElements = meshData.VertexSizeBytes() / sizeof(float);
+        std::vector<float> vertices(meshData.Vertices().size());
+        for (size_t i = 0; i < verticesCount; ++i)
+            std::copy_n(meshData.Vertices().begin() + i * strideElements, strideElements,
+                        vertices.begin() + vertexRemap[i] * strideElements);
+
+        const auto& indices = meshData.Indices();
+        std::vector<size_t> trianglesOrder(indices.size() / 3);
+        std::iota(trianglesOrder.begin(), trianglesOrder.end(), 0);
+        std::shuffle(trianglesOrder.begin(), trianglesOrder.end(), randomEngine);
+
+        std::vector<uint32_t> shuffledIndices;
+        shuffledIndices.reserve(indices.size());
+        for (const size_t triangle : trianglesOrder)
+            for (size_t i = 0; i < 3; ++i)
+                shuffledIndices.push_back(vertexRemap[indices[triangle * 3 + i]]);
+
+        return MeshData(std::move(vertices), std::move(shuffledIndices), verticesCount, meshData.VertexSizeBytes());
+    }
+
+    bool IndicesInRange(const MeshData& meshData)
+    {
+        const auto& indices = meshData.Indices();
+        return std::all_of(indices.begin(), indices.end(),
+                           [&](uint32_t index) { return index < meshData.VerticesCount(); });
+    }
+}
+
+// The optimizer only reorders: same triangles with the same winding, same vertices
+TEST(OptimizeMeshKeepsTriangles)
+{
+    const MeshData sphere = ShuffleMesh(CreateSphere<FullVertexFormat>(Float4(1.0f, 1.0f, 0.0f, 0.0f), 16, 32), 1);
+
+    for (bool optimizeOverdraw : { false, true })
+    {
+        MeshOptimizationStats stats;
+        const MeshData optimized = OptimizeMesh(sphere, optimizeOverdraw, stats);
+
+        CHECK(optimized.VerticesCount() == sphere.VerticesCount());
+        CHECK(optimized.VertexSizeBytes() == sphere.VertexSizeBytes());
+        CHECK(optimized.Vertices().size() == sphere.Vertices().size());
+        CHECK(optimized.IndicesCount() == sphere.IndicesCount());
+        CHECK(IndicesInRange(optimized));
+        CHECK(SortedTriangles(optimized) == SortedTriangles(sphere));
+    }
+}
+
+// Shuffled meshes transform less vertices per triangle after the pass
+TEST(OptimizeMeshLowersAcmr)
+{
+    const MeshData sphere = ShuffleMesh(CreateSphere<FullVertexFormat>(Float4(1.0f, 1.0f, 0.0f, 0.0f), 32, 64), 2);
+
+    const VertexCacheStats before = AnalyzeVertexCache(sphere.Indices(), sphere.VerticesCount());
+
+    MeshOptimizationStats stats;
+    const MeshData optimized = OptimizeMesh(sphere, false, stats);
+    const VertexCacheStats after = AnalyzeVertexCache(optimized.Indices(), optimized.VerticesCount());
+
+    CHECK(stats.m_before.m_cacheMissesCount == before.m_cacheMissesCount);
+    CHECK(stats.m_after.m_cacheMissesCount == after.m_cacheMissesCount);
+    CHECK(after.ACMR() < before.ACMR());
+    CHECK(after.ATVR() < before.ATVR());
+}
+
+BENCHMARK(MeshOptimizerCacheEfficiency)
+{
+    const Float4 uvScaleOffset(1.0f, 1.0f, 0.0f, 0.0f);
+
+    struct Mesh
+    {
+        const char* m_name;
+        MeshData    m_meshData;
+    };
+    const Mesh meshes[] =
+    {
+        { "sphere 16x32", CreateSphere<FullVertexFormat>(uvScaleOffset, 16, 32) },
+        { "sphere 64x128", CreateSphere<FullVertexFormat>(uvScaleOffset, 64, 128) },
+        { "shuffled sphere 16x32", ShuffleMesh(CreateSphere<FullVertexFormat>(uvScaleOffset, 16, 32), 3) },
+        { "shuffled sphere 64x128", ShuffleMesh(CreateSphere<FullVertexFormat>(uvScaleOffset, 64, 128), 4) },
+    };
+
+    for (const auto& mesh : meshes)
+    {
+        RunningTime optimizeTime;
+        MeshOptimizationStats stats;
+        const MeshData optimized = OptimizeMesh(mesh.m_meshData, true, stats);
+        const float optimizeSeconds = optimizeTime.Time();
+
+        CHECK(optimized.IndicesCount() == mesh.m_meshData.IndicesCount());
+
+        std::printf("    %s (%zu triangles): ACMR %.3f -> %.3f ATVR %.3f -> %.3f, %.3fms\n",
+                    mesh.m_name, mesh.m_meshData.IndicesCount() / 3, stats.m_before.ACMR(), stats.m_after.ACMR(),
+                    stats.m_before.ATVR(), stats.m_after.ATVR(), optimizeSeconds * 1000.0f);
+    }
+}
@@ -0,0 +1,214 @@
+// project includes
+#include "testframework.h"
+#include "mipgenerator.h"
+#include "utils.h"
+
+// c++ includes
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    TextureData CreateTexture(size_t width, size_t height, DXGI_FORMAT format, const std::vector<uint8_t>& pixels)
+    {
+        const size_t pixelSizeBytes = format == DXGI_FORMAT_R8G8B8A8_UNORM ? 4 : 8;
+        const size_t rowPitch = width * pixelSizeBytes;
+        assert(pixels.size() == rowPitch * height);
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width = width;
+        desc.Height = static_cast<UINT>(height);
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.Format = format;
+        desc.SampleDesc.Count = 1;
+
+        std::shared_ptr<uint8_t[]> rawData(new uint8_t[pixels.size()]);
+        memcpy(rawData.get(), pixels.data(), pixels.size());
+
+        std::vector<D3D12_SUBRESOURCE_DATA> subresources(1);
+        subresources[0] = { rawData.get(), static_cast<LONG_PTR>(rowPitch), static_cast<LONG_PTR>(rowPitch * height) };
+
+        return TextureData{ desc, std::move(rawData), std::move(subresources) };
+    }
+
+    const uint8_t* Pixel(const TextureData& textureData, size_t level, size_t x, size_t y, size_t pixelSizeBytes)
+    {
+        const auto& subresource = textureData.GetSubResources()[level];
+        return reinterpret_cast<const uint8_t*>(subresource.pData) + y * subresource.RowPitch + x * pixelSizeBytes;
+    }
+}
+
+TEST(GenerateMipsChainSizes)
+{
+    CHECK(MipLevelsCount(1, 1) == 1);
+    CHECK(MipLevelsCount(1024, 1024) == 11);
+    CHECK(MipLevelsCount(1024, 1) == 11);
+    CHECK(MipLevelsCount(5, 3) == 3);
+
+    for (DXGI_FORMAT format : { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_UNORM })
+    {
+        const size_t pixelSizeBytes = format == DXGI_FORMAT_R8G8B8A8_UNORM ? 4 : 8;
+        const size_t width = 37;
+        const size_t height = 6;
+        const auto textureData = GenerateMips(CreateTexture(width, height, format,
+                                                            std::vector<uint8_t>(width * height * pixelSizeBytes, 0x80)),
+                                              false);
+
+        const auto& subresources = textureData.GetSubResources();
+        CHECK(textureData.GetDesc().MipLevels == 6);
+        CHECK(subresources.size() == 6);
+
+        // NOTE 37x6, 18x3, 9x1, 4x1, 2x1, 1x1, tightly packed one after the other
+        const size_t widths[] = { 37, 18, 9, 4, 2, 1 };
+        const size_t heights[] = { 6, 3, 1, 1, 1, 1 };
+        for (size_t i = 0; i < std::min<size_t>(subresources.size(), 6); ++i)
+        {
+            CHECK(subresources[i].RowPitch == static_cast<LONG_PTR>(widths[i] * pixelSizeBytes));
+            CHECK(subresources[i].SlicePitch == static_cast<LONG_PTR>(widths[i] * heights[i] * pixelSizeBytes));
+            if (i > 0)
+            {
+                CHECK(reinterpret_cast<const uint8_t*>(subresources[i].pData) ==
+                      reinterpret_cast<const uint8_t*>(subresources[i - 1].pData) + subresources[i - 1].SlicePitch);
+            }
+        }
+    }
+
+    // NOTE textures with mips or unsupported formats are returned as they are
+    const auto singlePixel = CreateTexture(1, 1, DXGI_FORMAT_R8G8B8A8_UNORM, std::vector<uint8_t>(4, 0));
+    CHECK(GenerateMips(singlePixel, true).GetSubResources().size() == 1);
+}
+
+TEST(GenerateMipsOddSizesUseAllThePixels)
+{
+    // NOTE 5 to 2 pixels: the last one only contributes to the second pixel
+    std::vector<uint8_t> pixels(5 * 4, 0);
+    pixels[4 * 4 + 0] = 255;
+    pixels[4 * 4 + 3] = 255;
+    const auto row = GenerateMips(CreateTexture(5, 1, DXGI_FORMAT_R8G8B8A8_UNORM, pixels), false);
+    CHECK(Pixel(row, 1, 0, 0, 4)[0] == 0);
+    CHECK(Pixel(row, 1, 1, 0, 4)[0] == 102);
+    CHECK(Pixel(row, 1, 1, 0, 4)[3] == 102);
+
+    // NOTE 3 to 1 pixels, the same along the columns
+    std::vector<uint8_t> column(3 * 4, 0);
+    column[2 * 4 + 1] = 255;
+    const auto columnMips = GenerateMips(CreateTexture(1, 3, DXGI_FORMAT_R8G8B8A8_UNORM, column), false);
+    CHECK(Pixel(columnMips, 1, 0, 0, 4)[1] == 85);
+
+    // NOTE the average of the whole texture is kept, a 2x2 box filter clamping to the
+    // edges would not
+    std::mt19937 randomEngine(0);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    const size_t width = 7;
+    const size_t height = 5;
+    std::vector<uint8_t> randomPixels(width * height * 4);
+    for (auto& value : randomPixels)
+        value = static_cast<uint8_t>(distribution(randomEngine));
+    const auto textureData = GenerateMips(CreateTexture(width, height, DXGI_FORMAT_R8G8B8A8_UNORM, randomPixels), false);
+    for (size_t channel = 0; channel < 4; ++channel)
+    {
+        float average = 0.0f;
+        for (size_t i = channel; i < randomPixels.size(); i += 4)
+            average += randomPixels[i];
+        average /= static_cast<float>(width * height);
+
+        float levelAverage = 0.0f;
+        for (size_t y = 0; y < 2; ++y)
+            for (size_t x = 0; x < 3; ++x)
+                levelAverage += Pixel(textureData, 1, x, y, 4)[channel];
+        levelAverage /= 6.0f;
+
+        CHECK(std::abs(levelAverage - average) <= 0.5f);
+    }
+}
+
+TEST(GenerateMipsSRGBRoundTrip)
+{
+    // NOTE uniform textures keep their colour in all the levels, any error encoding or
+    // decoding srgb would show up
+    for (int value = 0; value < 256; ++value)
+    {
+        const auto rgba8 = GenerateMips(CreateTexture(3, 2, DXGI_FORMAT_R8G8B8A8_UNORM,
+                                                      std::vector<uint8_t>(3 * 2 * 4, static_cast<uint8_t>(value))),
+                                        true);
+        for (size_t level = 1; level < rgba8.GetSubResources().size(); ++level)
+        {
+            for (size_t channel = 0; channel < 4; ++channel)
+                CHECK(Pixel(rgba8, level, 0, 0, 4)[channel] == value);
+        }
+
+        std::vector<uint8_t> pixels16(3 * 2 * 8);
+        const uint16_t value16 = static_cast<uint16_t>(value * 257);
+        for (size_t i = 0; i < pixels16.size(); i += 2)
+            memcpy(&pixels16[i], &value16, sizeof(value16));
+        const auto rgba16 = GenerateMips(CreateTexture(3, 2, DXGI_FORMAT_R16G16B16A16_UNORM, pixels16), true);
+        for (size_t level = 1; level < rgba16.GetSubResources().size(); ++level)
+        {
+            for (size_t channel = 0; channel < 4; ++channel)
+            {
+                uint16_t mipValue16;
+                memcpy(&mipValue16, Pixel(rgba16, level, 0, 0, 8) + channel * 2, sizeof(mipValue16));
+                CHECK(std::abs(static_cast<int>(mipValue16) - static_cast<int>(value16)) <= 1);
+            }
+        }
+    }
+
+    // NOTE black and white average to linear 0.5, srgb 188. Alpha is linear.
+    std::vector<uint8_t> pixels = { 0, 0, 0, 0, 255, 255, 255, 255 };
+    const auto textureData = GenerateMips(CreateTexture(2, 1, DXGI_FORMAT_R8G8B8A8_UNORM, pixels), true);
+    CHECK(Pixel(textureData, 1, 0, 0, 4)[0] == 188);
+    CHECK(Pixel(textureData, 1, 0, 0, 4)[3] == 128);
+}
+
+BENCHMARK(GenerateMipsThroughput)
+{
+    const size_t width = 2048;
+    const size_t height = 2048;
+    const int iterationsCount = 10;
+
+    std::mt19937 randomEngine(0);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    struct Case
+    {
+        const char* m_name;
+        DXGI_FORMAT m_format;
+        bool        m_isSRGB;
+        size_t      m_width;
+    };
+    const Case cases[] =
+    {
+        { "rgba8 linear", DXGI_FORMAT_R8G8B8A8_UNORM, false, width },
+        { "rgba8 srgb", DXGI_FORMAT_R8G8B8A8_UNORM, true, width },
+        { "rgba8 srgb odd", DXGI_FORMAT_R8G8B8A8_UNORM, true, width - 1 },
+        { "rgba16 linear", DXGI_FORMAT_R16G16B16A16_UNORM, false, width },
+        { "rgba16 srgb", DXGI_FORMAT_R16G16B16A16_UNORM, true, width },
+    };
+
+    for (const auto& benchmarkCase : cases)
+    {
+        const size_t pixelSizeBytes = benchmarkCase.m_format == DXGI_FORMAT_R8G8B8A8_UNORM ? 4 : 8;
+        std::vector<uint8_t> pixels(benchmarkCase.m_width * height * pixelSizeBytes);
+        for (auto& value : pixels)
+            value = static_cast<uint8_t>(distribution(randomEngine));
+        const auto textureData = CreateTexture(benchmarkCase.m_width, height, benchmarkCase.m_format, pixels);
+
+        RunningTime time;
+        size_t levelsCount = 0;
+        for (int i = 0; i < iterationsCount; ++i)
+            levelsCount += GenerateMips(textureData, benchmarkCase.m_isSRGB).GetSubResources().size();
+        const float seconds = time.Time() / iterationsCount;
+
+        const float megapixels = static_cast<float>(benchmarkCase.m_width * height) / 1000000.0f;
+        std::printf("    %s %zux%zu: %.3fms, %.3fms per megapixel, %zu levels\n", benchmarkCase.m_name,
+                    benchmarkCase.m_width, height, seconds * 1000.0f, seconds * 1000.0f / megapixels,
+                    levelsCount / iterationsCount);
+    }
+}
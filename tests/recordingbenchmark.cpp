@@ -0,0 +1,129 @@
+// project includes
+#include "testframework.h"
+#include "d3d12gpu.h"
+#include "d3d12utils.h"
+#include "d3d12scenerender.h"
+#include "filemonitor.h"
+#include "meshoptimizer.h"
+#include "vertexquantization.h"
+#include "samplescene.h"
+#include "utils.h"
+
+// c++ includes
+#include <algorithm>
+#include <cstdio>
+
+// thirdparty libraries include
+#include "enkiTS/src/TaskScheduler.h"
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const unsigned int g_renderTargetWidth = 1920;
+    const unsigned int g_renderTargetHeight = 1080;
+
+    const int g_warmUpFramesCount = 10;
+    const int g_framesCount = 500;
+
+    const float g_frameDeltaTime = 1.0f / 60.0f;
+}
+
+// NOTE records the procedural models of the sample scene with the null backend so it
+// measures the cpu side only. Run it from the repository root, the shaders are compiled
+// from ./data/shaders. Sponza is not loaded, it needs the assets and assimp.
+BENCHMARK(RecordingSampleScene)
+{
+    D3D12Gpu gpu(false, D3D12Gpu::Backend::Null);
+    FileMonitor fileMonitor(L"./data");
+
+    enki::TaskScheduler taskScheduler;
+    taskScheduler.Initialize();
+
+    Scene scene = CreateSampleScene();
+    scene.m_sceneFile.clear();
+    ShareProceduralMeshes(scene.m_models);
+
+    const Float3 cameraPosition = SphericalToCartersian(0.0f, M_PI_4 + M_PI_8, 25.0f);
+    scene.m_camera.TranslateLookingAt(cameraPosition, Float3::Zero);
+
+    MeshDataCache meshDataCache;
+    MeshOptimizationStats meshOptimizationStats;
+    for (const auto& model : scene.m_models)
+    {
+        if (meshDataCache.count(model.MeshId()))
+            continue;
+
+        meshDataCache[model.MeshId()] = QuantizeMesh(OptimizeMesh(CreateProceduralMesh(model), true,
+                                                                  meshOptimizationStats));
+    }
+    std::printf("    meshes ACMR %.3f -> %.3f ATVR %.3f -> %.3f\n",
+                meshOptimizationStats.m_before.ACMR(), meshOptimizationStats.m_after.ACMR(),
+                meshOptimizationStats.m_before.ATVR(), meshOptimizationStats.m_after.ATVR());
+
+    D3D12SceneRender sceneRender(gpu, fileMonitor, scene, meshDataCache);
+    sceneRender.LoadGpuResources();
+    for (const auto& model : scene.m_models)
+        sceneRender.AddModel(model);
+    sceneRender.FlushModels();
+
+    D3D12_RESOURCE_DESC renderTargetDesc = CreateTexture2DDesc(g_renderTargetWidth, g_renderTargetHeight,
+                                                               DXGI_FORMAT_R8G8B8A8_UNORM,
+                                                               D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+    auto renderTarget = gpu.AllocateStaticMemory(renderTargetDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr,
+                                                 L"Recording benchmark render target");
+    const auto renderTargetView = gpu.CreateRenderTargetView(renderTarget, renderTargetDesc);
+
+    D3D12_RESOURCE_DESC depthBufferDesc = CreateTexture2DDesc(g_renderTargetWidth, g_renderTargetHeight,
+                                                              DXGI_FORMAT_D24_UNORM_S8_UINT,
+                                                              D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
+    D3D12_CLEAR_VALUE depthClearValue;
+    depthClearValue.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    depthClearValue.DepthStencil = { 1.0f, 0x0 };
+    auto depthBuffer = gpu.AllocateStaticMemory(depthBufferDesc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &depthClearValue,
+                                                L"Recording benchmark depth buffer");
+    const auto depthBufferView = gpu.CreateDepthStencilView(depthBuffer, DXGI_FORMAT_D24_UNORM_S8_UINT);
+
+    const auto renderTargetHandle = gpu.GetViewCPUHandle(renderTargetView);
+    const auto depthBufferHandle = gpu.GetViewCPUHandle(depthBufferView);
+
+    // NOTE as the engine does, a cmd list per worker when recording in parallel
+    const size_t workersCount = std::max<size_t>(taskScheduler.GetNumTaskThreads(), 1);
+    const size_t parallelDrawCallsCount = std::max<size_t>(sceneRender.GpuMeshesCount() / workersCount, 1);
+
+    float totalTime = 0.0f;
+    for (bool enableParallelCmdLists : { false, true })
+    {
+        float recordingTime = 0.0f;
+        for (int i = 0; i < g_warmUpFramesCount + g_framesCount; ++i)
+        {
+            UpdateSampleScene(scene, totalTime);
+            totalTime += g_frameDeltaTime;
+
+            sceneRender.Update(taskScheduler);
+            ClearMovedModels(scene);
+
+            RunningTime frameRecordingTime;
+            const auto cmdLists = sceneRender.RecordCmdLists(renderTargetHandle, depthBufferHandle, taskScheduler,
+                                                             enableParallelCmdLists,
+                                                             enableParallelCmdLists ? parallelDrawCallsCount : 0);
+            if (i >= g_warmUpFramesCount)
+                recordingTime += frameRecordingTime.Time();
+
+            gpu.ExecuteCmdLists(cmdLists);
+            gpu.PresentFrame();
+        }
+
+        const auto& stats = sceneRender.GetStats();
+        std::printf("    %s: %.3fms per frame, %zu cmd lists, %u forward and %u shadow draw calls\n",
+                    enableParallelCmdLists ? "enkiTS" : "single threaded",
+                    recordingTime * 1000.0f / g_framesCount,
+                    enableParallelCmdLists ? workersCount : size_t(1),
+                    stats.m_forwardPassDrawCallsCount, stats.m_shadowPassDrawCallsCount);
+    }
+
+    gpu.WaitAll();
+
+    gpu.FreeMemory(renderTarget);
+    gpu.FreeMemory(depthBuffer);
+}
@@ -0,0 +1,107 @@
+// project includes
+#include "testframework.h"
+#include "slotmap.h"
+#include "utils.h"
+
+// c++ includes
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
+using namespace D3D12Basics;
+
+TEST(SlotMapStaleIdsAreDetected)
+{
+    SlotMap<int> slotMap;
+    const auto id0 = slotMap.Insert(0);
+    const auto id1 = slotMap.Insert(1);
+    const auto id2 = slotMap.Insert(2);
+
+    slotMap.Erase(id0);
+    CHECK(!slotMap.Contains(id0));
+    CHECK(slotMap.Get(id1) == 1);
+    CHECK(slotMap.Get(id2) == 2);
+    CHECK(slotMap.Size() == 2);
+
+    // NOTE the slot is reused with the next generation, the erased id is still stale
+    const auto id3 = slotMap.Insert(3);
+    CHECK(id3 != id0);
+    CHECK((id3 & 0xffffffff) == (id0 & 0xffffffff));
+    CHECK(!slotMap.Contains(id0));
+    CHECK(slotMap.Get(id3) == 3);
+
+    slotMap.Erase(id3);
+    slotMap.Erase(id1);
+    CHECK(!slotMap.Contains(id3));
+    CHECK(!slotMap.Contains(id1));
+    CHECK(slotMap.Get(id2) == 2);
+
+    // NOTE the two msb are left to the caller
+    for (int i = 0; i < 1000; ++i)
+    {
+        const auto id = slotMap.Insert(int(i));
+        CHECK((id >> 62) == 0);
+        slotMap.Erase(id);
+    }
+    CHECK(slotMap.Size() == 1);
+    CHECK(std::accumulate(slotMap.begin(), slotMap.end(), 0) == 2);
+}
+
+// NOTE D3D12Gpu resolved its handles with unordered_maps keyed by a running counter
+// before using slot maps. Half of the handles are erased and inserted again before
+// looking them up so the slots are reused, as they are in the gpu.
+BENCHMARK(SlotMapLookup)
+{
+    std::mt19937 randomEngine(0);
+
+    for (size_t handlesCount : { 10000, 100000, 1000000 })
+    {
+        SlotMap<uint64_t> slotMap;
+        std::unordered_map<uint64_t, uint64_t> map;
+        std::vector<SlotMap<uint64_t>::Id> slotMapIds(handlesCount);
+        std::vector<uint64_t> mapIds(handlesCount);
+
+        uint64_t nextMapId = 0;
+        for (size_t i = 0; i < handlesCount; ++i)
+        {
+            slotMapIds[i] = slotMap.Insert(uint64_t(i));
+            mapIds[i] = nextMapId++;
+            map[mapIds[i]] = i;
+        }
+        for (size_t i = 0; i < handlesCount; i += 2)
+        {
+            slotMap.Erase(slotMapIds[i]);
+            map.erase(mapIds[i]);
+        }
+        for (size_t i = 0; i < handlesCount; i += 2)
+        {
+            slotMapIds[i] = slotMap.Insert(uint64_t(i));
+            mapIds[i] = nextMapId++;
+            map[mapIds[i]] = i;
+        }
+
+        std::vector<size_t> lookupOrder(handlesCount);
+        std::iota(lookupOrder.begin(), lookupOrder.end(), size_t(0));
+        std::shuffle(lookupOrder.begin(), lookupOrder.end(), randomEngine);
+
+        uint64_t slotMapSum = 0;
+        RunningTime slotMapTime;
+        for (size_t i : lookupOrder)
+            slotMapSum += slotMap.Get(slotMapIds[i]);
+        const float slotMapLookupTime = slotMapTime.Time();
+
+        uint64_t mapSum = 0;
+        RunningTime mapTime;
+        for (size_t i : lookupOrder)
+            mapSum += map.find(mapIds[i])->second;
+        const float mapLookupTime = mapTime.Time();
+
+        CHECK(slotMapSum == mapSum);
+
+        const float toNsPerLookup = 1e9f / static_cast<float>(handlesCount);
+        std::printf("    %zu handles: slot map %.2fns, unordered_map %.2fns per lookup\n", handlesCount,
+                    slotMapLookupTime * toNsPerLookup, mapLookupTime * toNsPerLookup);
+    }
+}
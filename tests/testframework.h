@@ -0,0 +1,44 @@
+#pragma once
+
+// c++ includes
+#include <vector>
+
+namespace D3D12Basics
+{
+    namespace Tests
+    {
+        // NOTE benchmarks only run when asked for, see main.cpp
+        struct TestCase
+        {
+            const char* m_name;
+            void (*m_function)();
+            bool m_isBenchmark;
+        };
+
+        std::vector<TestCase>& TestCases();
+
+        struct TestRegistrar
+        {
+            TestRegistrar(const char* name, void (*function)(), bool isBenchmark)
+            {
+                TestCases().push_back({ name, function, isBenchmark });
+            }
+        };
+
+        void ReportFailure(const char* file, int line, const char* expression);
+    }
+}
+
+#define TEST(name)  static void name(); \
+                    static D3D12Basics::Tests::TestRegistrar g_##name##Registrar(#name, &name, false); \
+                    static void name()
+
+#define BENCHMARK(name) static void name(); \
+                        static D3D12Basics::Tests::TestRegistrar g_##name##Registrar(#name, &name, true); \
+                        static void name()
+
+#define CHECK(expression)   do \
+                            { \
+                                if (!(expression)) \
+                                    D3D12Basics::Tests::ReportFailure(__FILE__, __LINE__, #expression); \
+                            } while (false)
@@ -0,0 +1,148 @@
+// project includes
+#include "testframework.h"
+#include "texturecompression.h"
+#include "utils.h"
+
+// c++ includes
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    // Smooth colour gradients with some detail and noise on top, closer to the
+    // textures of a scene than random pixels
+    TextureData CreateTexture(size_t width, size_t height, TextureUsage usage, bool hasAlpha, uint32_t seed)
+    {
+        std::mt19937 randomEngine(seed);
+        std::normal_distribution<float> noise(0.0f, 4.0f);
+
+        const size_t rowPitch = width * 4;
+        std::shared_ptr<uint8_t[]> rawData(new uint8_t[rowPitch * height]);
+        auto toUnorm8 = [](float value) { return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f) + 0.5f); };
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                const float u = static_cast<float>(x) / width;
+                const float v = static_cast<float>(y) / height;
+                const float detail = std::sin(u * 40.0f) * std::cos(v * 25.0f);
+                uint8_t* pixel = rawData.get() + y * rowPitch + x * 4;
+
+                if (usage == TextureUsage::Normals)
+                {
+                    const float nx = 0.3f * detail + noise(randomEngine) * 0.005f;
+                    const float ny = 0.3f * std::sin(v * 31.0f + u * 7.0f) + noise(randomEngine) * 0.005f;
+                    const float nz = std::sqrt(std::max(1.0f - nx * nx - ny * ny, 0.0f));
+                    pixel[0] = toUnorm8((nx * 0.5f + 0.5f) * 255.0f);
+                    pixel[1] = toUnorm8((ny * 0.5f + 0.5f) * 255.0f);
+                    pixel[2] = toUnorm8((nz * 0.5f + 0.5f) * 255.0f);
+                    pixel[3] = 255;
+                }
+                else
+                {
+                    pixel[0] = toUnorm8(255.0f * u + 30.0f * detail + noise(randomEngine));
+                    pixel[1] = toUnorm8(200.0f * v + 30.0f * detail + noise(randomEngine));
+                    pixel[2] = toUnorm8(128.0f + 60.0f * detail + noise(randomEngine));
+                    pixel[3] = hasAlpha ? toUnorm8(255.0f * (0.5f + 0.5f * std::cos(u * 9.0f))) : 255;
+                }
+            }
+        }
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width = width;
+        desc.Height = static_cast<UINT>(height);
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+
+        std::vector<D3D12_SUBRESOURCE_DATA> subresources(1);
+        subresources[0] = { rawData.get(), static_cast<LONG_PTR>(rowPitch), static_cast<LONG_PTR>(rowPitch * height) };
+
+        return TextureData{ desc, std::move(rawData), std::move(subresources) };
+    }
+
+    struct CompressionCase
+    {
+        const char*         m_name;
+        TextureUsage        m_usage;
+        bool                m_hasAlpha;
+        TextureCompression  m_compression;
+        DXGI_FORMAT         m_format;
+        size_t              m_channelsCount;
+        float               m_minPSNR;
+    };
+
+    // NOTE only the channels kept by the format count for the PSNR. The minimum PSNRs
+    // of the test textures are a few dB under what the encoders get so they only
+    // catch broken encoders, not small quality changes
+    const CompressionCase g_compressionCases[] =
+    {
+        { "bc1", TextureUsage::Color, false, TextureCompression::Fast, DXGI_FORMAT_BC1_UNORM, 3, 28.0f },
+        { "bc3", TextureUsage::Color, true, TextureCompression::Fast, DXGI_FORMAT_BC3_UNORM, 4, 29.0f },
+        { "bc5", TextureUsage::Normals, false, TextureCompression::Fast, DXGI_FORMAT_BC5_UNORM, 2, 36.0f },
+        { "bc7 opaque", TextureUsage::Color, false, TextureCompression::Quality, DXGI_FORMAT_BC7_UNORM, 4, 32.0f },
+        { "bc7 alpha", TextureUsage::Color, true, TextureCompression::Quality, DXGI_FORMAT_BC7_UNORM, 4, 27.0f },
+    };
+}
+
+TEST(CompressTextureFormatsAndQuality)
+{
+    for (const auto& compressionCase : g_compressionCases)
+    {
+        const auto textureData = CreateTexture(64, 32, compressionCase.m_usage, compressionCase.m_hasAlpha, 0);
+
+        TextureCompressionError error;
+        const auto compressedTextureData = CompressTexture(textureData, compressionCase.m_usage,
+                                                           compressionCase.m_compression, error);
+        const auto& desc = compressedTextureData.GetDesc();
+        const auto& subresources = compressedTextureData.GetSubResources();
+        const size_t blockSizeBytes = compressionCase.m_format == DXGI_FORMAT_BC1_UNORM ? 8 : 16;
+
+        CHECK(desc.Format == compressionCase.m_format);
+        CHECK(desc.Width == 64 && desc.Height == 32);
+        CHECK(subresources.size() == 1);
+        CHECK(subresources[0].RowPitch == static_cast<LONG_PTR>(16 * blockSizeBytes));
+        CHECK(subresources[0].SlicePitch == static_cast<LONG_PTR>(16 * 8 * blockSizeBytes));
+        CHECK(error.m_samplesCount == 64 * 32 * compressionCase.m_channelsCount);
+        CHECK(error.PSNR() >= compressionCase.m_minPSNR);
+    }
+
+    // NOTE unsupported textures and no compression return the texture as it is
+    TextureCompressionError error;
+    const auto oddTextureData = CreateTexture(6, 4, TextureUsage::Color, false, 0);
+    CHECK(CompressTexture(oddTextureData, TextureUsage::Color, TextureCompression::Fast, error).GetDesc().Format ==
+          DXGI_FORMAT_R8G8B8A8_UNORM);
+    const auto textureData = CreateTexture(8, 8, TextureUsage::Color, false, 0);
+    CHECK(CompressTexture(textureData, TextureUsage::Color, TextureCompression::None, error).GetDesc().Format ==
+          DXGI_FORMAT_R8G8B8A8_UNORM);
+    CHECK(error.m_samplesCount == 0);
+}
+
+BENCHMARK(CompressTextureThroughput)
+{
+    const size_t width = 1024;
+    const size_t height = 1024;
+    const float megapixels = static_cast<float>(width * height) / 1000000.0f;
+
+    for (const auto& compressionCase : g_compressionCases)
+    {
+        const auto textureData = CreateTexture(width, height, compressionCase.m_usage, compressionCase.m_hasAlpha, 1);
+
+        TextureCompressionError error;
+        RunningTime time;
+        const auto compressedTextureData = CompressTexture(textureData, compressionCase.m_usage,
+                                                           compressionCase.m_compression, error);
+        const float seconds = time.Time();
+
+        CHECK(compressedTextureData.GetDesc().Format == compressionCase.m_format);
+        std::printf("    %s %zux%zu: %.3fms, %.2f megapixels/s, PSNR %.2fdB\n", compressionCase.m_name, width, height,
+                    seconds * 1000.0f, megapixels / seconds, error.PSNR());
+    }
+}
@@ -0,0 +1,251 @@
+// project includes
+#include "testframework.h"
+#include "uploadtracker.h"
+
+// c++ includes
+#include <algorithm>
+
+using namespace D3D12Basics;
+
+namespace
+{
+    const size_t g_pageSizeBytes = 1024;
+    const size_t g_alignment = 512;
+
+    // Enqueues an upload the way D3D12UploadQueue does
+    UploadTracker::UploadId Enqueue(UploadTracker& tracker, size_t sizeBytes, uint64_t& nextFenceValue,
+                                    size_t alignment = g_alignment)
+    {
+        if (tracker.IsSubmitNeeded(sizeBytes, alignment))
+            tracker.Submit(tracker.PendingUploadsToSubmit(true), nextFenceValue++);
+
+        const auto staging = tracker.AllocateStaging(sizeBytes, alignment);
+        return tracker.AddPendingUpload(staging.m_pageIndex, sizeBytes);
+    }
+}
+
+TEST(UploadTrackerFinishesBatchesWithTheirFence)
+{
+    UploadTracker tracker(g_pageSizeBytes);
+    std::vector<size_t> releasedPages;
+
+    const auto upload0 = tracker.AddPendingUpload(tracker.AllocateStaging(100, g_alignment).m_pageIndex, 100);
+    const auto upload1 = tracker.AddPendingUpload(tracker.AllocateStaging(100, g_alignment).m_pageIndex, 100);
+    CHECK(upload0 != UploadTracker::m_finishedUploadId);
+    CHECK(upload1 > upload0);
+    CHECK(tracker.IsUploadFinished(UploadTracker::m_finishedUploadId));
+    CHECK(tracker.PendingUploadsCount() == 2);
+    CHECK(tracker.PendingSizeBytes() == 200);
+
+    CHECK(tracker.Submit(1, 1) == 100);
+    CHECK(tracker.Submit(tracker.PendingUploadsToSubmit(false), 2) == 100);
+    CHECK(tracker.PendingUploadsCount() == 0);
+    CHECK(tracker.InFlightBatchesCount() == 2);
+
+    CHECK(tracker.RetireCompletedBatches(0, releasedPages) == 0);
+    CHECK(!tracker.IsUploadFinished(upload0));
+
+    CHECK(tracker.RetireCompletedBatches(1, releasedPages) == 1);
+    CHECK(tracker.IsUploadFinished(upload0));
+    CHECK(!tracker.IsUploadFinished(upload1));
+
+    CHECK(tracker.RetireCompletedBatches(2, releasedPages) == 1);
+    CHECK(tracker.IsUploadFinished(upload1));
+    CHECK(tracker.InFlightBatchesCount() == 0);
+    CHECK(releasedPages.empty());
+}
+
+TEST(UploadTrackerRecyclesStagingPages)
+{
+    UploadTracker tracker(g_pageSizeBytes);
+    std::vector<size_t> releasedPages;
+
+    // NOTE the second allocation is aligned so it doesnt fit the first page
+    const auto staging0 = tracker.AllocateStaging(600, g_alignment);
+    tracker.AddPendingUpload(staging0.m_pageIndex, 600);
+    const auto staging1 = tracker.AllocateStaging(600, g_alignment);
+    tracker.AddPendingUpload(staging1.m_pageIndex, 600);
+    CHECK(staging0.m_isNewPage && staging1.m_isNewPage);
+    CHECK(staging0.m_pageIndex != staging1.m_pageIndex);
+    CHECK(staging0.m_offset == 0 && staging1.m_offset == 0);
+    CHECK(tracker.StagingPagesCount() == 2);
+
+    const auto staging2 = tracker.AllocateStaging(100, 1);
+    tracker.AddPendingUpload(staging2.m_pageIndex, 100);
+    CHECK(staging2.m_pageIndex == staging1.m_pageIndex);
+    CHECK(staging2.m_offset == 600);
+
+    // NOTE the pages are recycled once the gpu is done, not when submitted
+    tracker.Submit(tracker.PendingUploadsToSubmit(false), 1);
+    tracker.RetireCompletedBatches(0, releasedPages);
+    const auto staging3 = tracker.AllocateStaging(600, g_alignment);
+    tracker.AddPendingUpload(staging3.m_pageIndex, 600);
+    CHECK(staging3.m_isNewPage);
+    CHECK(tracker.StagingPagesCount() == 3);
+
+    tracker.Submit(tracker.PendingUploadsToSubmit(false), 2);
+    tracker.RetireCompletedBatches(2, releasedPages);
+    CHECK(releasedPages.empty());
+    CHECK(tracker.StagingPagesCount() == 3);
+
+    // NOTE the current page is rewinded, the others are free
+    const auto staging4 = tracker.AllocateStaging(g_pageSizeBytes, g_alignment);
+    CHECK(!staging4.m_isNewPage);
+    CHECK(staging4.m_offset == 0);
+    CHECK(staging4.m_pageIndex == staging3.m_pageIndex);
+    const auto staging5 = tracker.AllocateStaging(g_pageSizeBytes, g_alignment);
+    CHECK(!staging5.m_isNewPage);
+    CHECK(staging5.m_pageIndex == staging0.m_pageIndex || staging5.m_pageIndex == staging1.m_pageIndex);
+    CHECK(tracker.StagingPagesCount() == 3);
+}
+
+TEST(UploadTrackerReleasesBigPages)
+{
+    UploadTracker tracker(g_pageSizeBytes);
+    std::vector<size_t> releasedPages;
+
+    const auto staging0 = tracker.AllocateStaging(100, g_alignment);
+    tracker.AddPendingUpload(staging0.m_pageIndex, 100);
+    const auto bigStaging = tracker.AllocateStaging(4 * g_pageSizeBytes, g_alignment);
+    tracker.AddPendingUpload(bigStaging.m_pageIndex, 4 * g_pageSizeBytes);
+    CHECK(bigStaging.m_isNewPage);
+    CHECK(bigStaging.m_pageSizeBytes == 4 * g_pageSizeBytes);
+
+    // NOTE the big page is the current one so it is only released once another page is used
+    const auto staging1 = tracker.AllocateStaging(100, g_alignment);
+    tracker.AddPendingUpload(staging1.m_pageIndex, 100);
+    CHECK(staging1.m_pageIndex != bigStaging.m_pageIndex);
+
+    tracker.Submit(tracker.PendingUploadsToSubmit(false), 1);
+    tracker.RetireCompletedBatches(1, releasedPages);
+    CHECK(releasedPages.size() == 1);
+    CHECK(releasedPages[0] == bigStaging.m_pageIndex);
+    CHECK(tracker.StagingPagesCount() == 2);
+
+    // NOTE the released page index is reused for the next page created
+    tracker.AllocateStaging(g_pageSizeBytes, g_alignment);
+    tracker.AllocateStaging(g_pageSizeBytes, g_alignment);
+    const auto newStaging = tracker.AllocateStaging(g_pageSizeBytes, g_alignment);
+    CHECK(newStaging.m_isNewPage);
+    CHECK(newStaging.m_pageIndex == bigStaging.m_pageIndex);
+    CHECK(newStaging.m_pageSizeBytes == g_pageSizeBytes);
+}
+
+TEST(UploadTrackerSubmitsWithinTheBudget)
+{
+    UploadTracker tracker(g_pageSizeBytes);
+    tracker.SetSubmitBudget(250);
+    uint64_t nextFenceValue = 1;
+
+    for (int i = 0; i < 3; ++i)
+        Enqueue(tracker, 100, nextFenceValue, 1);
+    CHECK(nextFenceValue == 1);
+    CHECK(tracker.PendingUploadsToSubmit(false) == 2);
+    CHECK(tracker.PendingUploadsToSubmit(true) == 3);
+
+    // NOTE an upload bigger than the budget is still submitted
+    UploadTracker bigUploadTracker(g_pageSizeBytes);
+    bigUploadTracker.SetSubmitBudget(50);
+    Enqueue(bigUploadTracker, 100, nextFenceValue);
+    CHECK(bigUploadTracker.PendingUploadsToSubmit(false) == 1);
+}
+
+TEST(UploadTrackerCapsThePendingPages)
+{
+    std::vector<size_t> releasedPages;
+
+    // NOTE without budget the pending uploads are submitted when a page gets full
+    UploadTracker tracker(g_pageSizeBytes);
+    uint64_t nextFenceValue = 1;
+    for (int i = 0; i < 16; ++i)
+    {
+        Enqueue(tracker, g_alignment, nextFenceValue);
+        CHECK(tracker.PendingSizeBytes() <= g_pageSizeBytes);
+    }
+    CHECK(nextFenceValue == 8);
+
+    // NOTE with budget the pending uploads stay in staging, up to the budget rounded up
+    // to pages. The gpu never finishes in this test so the staging pages grow with the
+    // batches in flight but not with the pending uploads.
+    UploadTracker budgetTracker(g_pageSizeBytes);
+    budgetTracker.SetSubmitBudget(2 * g_pageSizeBytes + 1);
+    nextFenceValue = 1;
+    for (int i = 0; i < 64; ++i)
+    {
+        Enqueue(budgetTracker, g_alignment, nextFenceValue);
+        CHECK(budgetTracker.PendingSizeBytes() <= 3 * g_pageSizeBytes);
+    }
+    CHECK(nextFenceValue > 1);
+
+    // NOTE once the gpu is done the pages are reused
+    budgetTracker.Submit(budgetTracker.PendingUploadsToSubmit(true), nextFenceValue);
+    budgetTracker.RetireCompletedBatches(nextFenceValue, releasedPages);
+    const size_t stagingPagesCount = budgetTracker.StagingPagesCount();
+    for (int i = 0; i < 64; ++i)
+    {
+        Enqueue(budgetTracker, g_alignment, nextFenceValue);
+        budgetTracker.Submit(budgetTracker.PendingUploadsToSubmit(false), nextFenceValue);
+        budgetTracker.RetireCompletedBatches(nextFenceValue++, releasedPages);
+    }
+    CHECK(budgetTracker.StagingPagesCount() == stagingPagesCount);
+    CHECK(releasedPages.empty());
+}
+
+// A buffer streaming a region per frame while the gpu finishes the uploads 2 frames
+// later: the newest region is never finished when checked but the older ones become
+// ready one after another
+TEST(RegionUploadTrackerReadyWhileStreaming)
+{
+    UploadTracker tracker(g_pageSizeBytes);
+    RegionUploadTracker regionUploads;
+    std::vector<size_t> releasedPages;
+    const auto isUploadFinished = [&tracker](UploadTracker::UploadId uploadId)
+    {
+        return tracker.IsUploadFinished(uploadId);
+    };
+
+    const size_t regionSizeBytes = 100;
+    const uint64_t gpuLatency = 2;
+    uint64_t nextFenceValue = 1;
+    size_t sizeBytes = 0;
+    for (uint64_t frame = 1; frame <= 16; ++frame)
+    {
+        sizeBytes += regionSizeBytes;
+        const auto uploadId = Enqueue(tracker, regionSizeBytes, nextFenceValue, 1);
+        regionUploads.AddUpload(uploadId, sizeBytes);
+        tracker.Submit(tracker.PendingUploadsToSubmit(false), nextFenceValue++);
+
+        if (nextFenceValue > gpuLatency + 1)
+            tracker.RetireCompletedBatches(nextFenceValue - gpuLatency - 1, releasedPages);
+
+        const size_t readySizeBytes = regionUploads.Update(isUploadFinished);
+        CHECK(!tracker.IsUploadFinished(uploadId));
+        CHECK(readySizeBytes == (frame > gpuLatency ? sizeBytes - gpuLatency * regionSizeBytes : 0));
+        CHECK(regionUploads.PendingUploadsCount() == std::min<uint64_t>(frame, gpuLatency));
+    }
+
+    // NOTE once the streaming stops all the regions are ready
+    tracker.RetireCompletedBatches(nextFenceValue - 1, releasedPages);
+    CHECK(regionUploads.Update(isUploadFinished) == sizeBytes);
+    CHECK(regionUploads.PendingUploadsCount() == 0);
+
+    // NOTE with a budget the uploads wait in the tracker, the regions submitted are
+    // ready as soon as their batch is done
+    UploadTracker budgetTracker(g_pageSizeBytes);
+    budgetTracker.SetSubmitBudget(regionSizeBytes);
+    RegionUploadTracker budgetRegionUploads;
+    nextFenceValue = 1;
+    for (size_t i = 1; i <= 4; ++i)
+        budgetRegionUploads.AddUpload(Enqueue(budgetTracker, regionSizeBytes, nextFenceValue, 1), i * regionSizeBytes);
+
+    const auto isBudgetUploadFinished = [&budgetTracker](UploadTracker::UploadId uploadId)
+    {
+        return budgetTracker.IsUploadFinished(uploadId);
+    };
+    for (size_t i = 1; i <= 4; ++i)
+    {
+        CHECK(budgetTracker.Submit(budgetTracker.PendingUploadsToSubmit(false), nextFenceValue) == regionSizeBytes);
+        budgetTracker.RetireCompletedBatches(nextFenceValue++, releasedPages);
+        CHECK(budgetRegionUploads.Update(isBudgetUploadFinished) == i * regionSizeBytes);
+    }
+}
@@ -0,0 +1,137 @@
+// project includes
+#include "testframework.h"
+#include "vertexquantization.h"
+
+// c++ includes
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace D3D12Basics;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+    // Decodes as the input assembler does for R10G10B10A2_UNORM and then as the vertex
+    // shader does to go back to [-1, 1]
+    Float3 UnpackUnitVector(const XMUDECN4& packed, float& w)
+    {
+        const float x = static_cast<float>(packed.v & 0x3ff) / 1023.0f;
+        const float y = static_cast<float>((packed.v >> 10) & 0x3ff) / 1023.0f;
+        const float z = static_cast<float>((packed.v >> 20) & 0x3ff) / 1023.0f;
+        w = static_cast<float>(packed.v >> 30) / 3.0f;
+
+        return Float3(x * 2.0f - 1.0f, y * 2.0f - 1.0f, z * 2.0f - 1.0f);
+    }
+
+    float MaxComponentError(const Float3& a, const Float3& b)
+    {
+        return std::max({ std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z) });
+    }
+
+    Float3 RandomUnitVector(std::mt19937& randomEngine)
+    {
+        std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        Float3 v;
+        do
+        {
+            v = Float3(distribution(randomEngine), distribution(randomEngine), distribution(randomEngine));
+        } while (v.Length() < 0.01f || v.Length() > 1.0f);
+        v.Normalize();
+
+        return v;
+    }
+}
+
+TEST(QuantizeMeshRoundTrip)
+{
+    using SrcFormat = FullVertexFormat;
+    using DstFormat = QuantizedVertexFormat;
+
+    std::mt19937 randomEngine(0);
+    std::uniform_real_distribution<float> positionDistribution(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> uvDistribution(0.0f, 1.0f);
+
+    // NOTE the axis aligned vectors and the uv corners are included as they are the
+    // values that break the range mapping
+    const size_t randomVerticesCount = 10000;
+    std::vector<Float3> normals = { {1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+                                    {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f} };
+    while (normals.size() < randomVerticesCount)
+        normals.push_back(RandomUnitVector(randomEngine));
+    const size_t verticesCount = normals.size();
+
+    auto srcVertices = SrcFormat::CreateVertices(verticesCount);
+    for (size_t i = 0; i < verticesCount; ++i)
+    {
+        const Float3& normal = normals[i];
+        Float3 tangent = normal.Cross(RandomUnitVector(randomEngine));
+        tangent.Normalize();
+        const float bitangentSign = (i & 1) ? -1.0f : 1.0f;
+        const Float3 bitangent = normal.Cross(tangent) * bitangentSign;
+
+        const Float2 uv = i < 4 ? Float2(static_cast<float>(i & 1), static_cast<float>(i >> 1)) :
+                                  Float2(uvDistribution(randomEngine), uvDistribution(randomEngine));
+
+        SrcFormat::Write<PositionAttribute>(srcVertices, i, Float3(positionDistribution(randomEngine),
+                                                                   positionDistribution(randomEngine),
+                                                                   positionDistribution(randomEngine)));
+        SrcFormat::Write<UVAttribute>(srcVertices, i, uv);
+        SrcFormat::Write<NormalAttribute>(srcVertices, i, normal);
+        SrcFormat::Write<TangentAttribute>(srcVertices, i, tangent);
+        SrcFormat::Write<BitangentAttribute>(srcVertices, i, bitangent);
+    }
+    std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3 };
+    const MeshData meshData{ std::move(srcVertices), std::vector<uint32_t>(indices), verticesCount,
+                             SrcFormat::m_strideBytes };
+
+    const MeshData quantizedMeshData = QuantizeMesh(meshData);
+    CHECK(quantizedMeshData.VerticesCount() == verticesCount);
+    CHECK(quantizedMeshData.VertexSizeBytes() == DstFormat::m_strideBytes);
+    CHECK(quantizedMeshData.Indices() == indices);
+
+    float maxPositionError = 0.0f;
+    float maxUVError = 0.0f;
+    float maxNormalError = 0.0f;
+    float maxTangentError = 0.0f;
+    size_t flippedBitangentsCount = 0;
+    for (size_t i = 0; i < verticesCount; ++i)
+    {
+        const auto& src = meshData.Vertices();
+        const auto& dst = quantizedMeshData.Vertices();
+
+        const Float3 position = DstFormat::Read<PositionAttribute>(dst, i);
+        maxPositionError = std::max(maxPositionError, MaxComponentError(position, SrcFormat::Read<PositionAttribute>(src, i)));
+
+        const auto halfUV = DstFormat::Read<HalfUVAttribute>(dst, i);
+        const auto uv = SrcFormat::Read<UVAttribute>(src, i);
+        maxUVError = std::max({ maxUVError, std::abs(XMConvertHalfToFloat(halfUV.x) - uv.x),
+                                std::abs(XMConvertHalfToFloat(halfUV.y) - uv.y) });
+
+        float normalW = 0.0f;
+        const Float3 normal = UnpackUnitVector(DstFormat::Read<PackedNormalAttribute>(dst, i), normalW);
+        maxNormalError = std::max(maxNormalError, MaxComponentError(normal, SrcFormat::Read<NormalAttribute>(src, i)));
+
+        float bitangentSign = 0.0f;
+        const Float3 tangent = UnpackUnitVector(DstFormat::Read<PackedTangentAttribute>(dst, i), bitangentSign);
+        maxTangentError = std::max(maxTangentError, MaxComponentError(tangent, SrcFormat::Read<TangentAttribute>(src, i)));
+        CHECK(bitangentSign == 0.0f || bitangentSign == 1.0f);
+
+        // NOTE the bitangent is rebuilt as the vertex shader does
+        const Float3 bitangent = normal.Cross(tangent) * (bitangentSign * 2.0f - 1.0f);
+        if (bitangent.Dot(SrcFormat::Read<BitangentAttribute>(src, i)) <= 0.0f)
+            ++flippedBitangentsCount;
+    }
+
+    // NOTE half of the 10 bits step for the vectors, half of the half precision ulp at 1
+    // for the uvs
+    CHECK(maxPositionError == 0.0f);
+    CHECK(maxUVError <= 1.0f / 2048.0f);
+    CHECK(maxNormalError <= 1.0f / 1023.0f + 1e-6f);
+    CHECK(maxTangentError <= 1.0f / 1023.0f + 1e-6f);
+    CHECK(flippedBitangentsCount == 0);
+
+    std::printf("    max error position %g uv %g normal %g tangent %g\n", maxPositionError, maxUVError,
+                maxNormalError, maxTangentError);
+}